@@ -12,6 +12,8 @@
  */
 
 #include <string>
+#include <fcntl.h>
+#include <unistd.h>
 #include "gtest/gtest.h"
 #include "com/diag/grandote/Packet.h"
 #include "com/diag/grandote/size.h"
@@ -742,6 +744,484 @@ TEST_F(PacketTest, MixedBag) {
 	delete packet;
 }
 
+TEST_F(PacketTest, ConsumeDelimited) {
+	static const size_t ALLOC = 5;
+	static const size_t ZERO = 0;
+	Packet packet(ALLOC);
+	PacketData * empty = new PacketBuffer(0, 0);
+	packet.append(*empty);
+	EXPECT_EQ(packet.append("ab\ncdefghij\n\nklm", 16), (size_t)16);
+	char buffer[32];
+	EXPECT_EQ(packet.consume(buffer, sizeof(buffer), '\n'), (size_t)3);
+	EXPECT_EQ(std::strncmp(buffer, "ab\n", 3), 0);
+	EXPECT_EQ(packet.consume(buffer, 4, '\n'), (size_t)4);
+	EXPECT_EQ(std::strncmp(buffer, "cdef", 4), 0);
+	EXPECT_EQ(packet.consume(buffer, sizeof(buffer), '\n'), (size_t)5);
+	EXPECT_EQ(std::strncmp(buffer, "ghij\n", 5), 0);
+	EXPECT_EQ(packet.consume(0, sizeof(buffer), '\n'), (size_t)1);
+	EXPECT_EQ(packet.consume(buffer, sizeof(buffer), '\n'), (size_t)3);
+	EXPECT_EQ(std::strncmp(buffer, "klm", 3), 0);
+	EXPECT_TRUE(packet.empty());
+	EXPECT_EQ(packet.consume(buffer, sizeof(buffer), '\n'), ZERO);
+}
+
+TEST_F(PacketTest, Peek) {
+	static const size_t ALLOC = 8;
+	Packet packet(ALLOC);
+	size_t length = 1;
+	EXPECT_EQ(packet.peek('\n', length), (const void *)0);
+	EXPECT_EQ(length, (size_t)0);
+	PacketData * empty = new PacketBuffer(0, 0);
+	packet.append(*empty);
+	EXPECT_EQ(packet.append("abc\ndefghijkl\n", 15), (size_t)15);
+	const char * line = static_cast<const char *>(packet.peek('\n', length));
+	ASSERT_NE(line, (const char *)0);
+	EXPECT_EQ(length, (size_t)4);
+	EXPECT_EQ(std::strncmp(line, "abc\n", length), 0);
+	EXPECT_EQ(packet.length(), (size_t)15);
+	EXPECT_EQ(packet.consume(length), length);
+	// The next line spans two buffers so it cannot be viewed in place.
+	EXPECT_EQ(packet.peek('\n', length), (const void *)0);
+	EXPECT_EQ(length, (size_t)0);
+	EXPECT_EQ(packet.length(), (size_t)11);
+}
+
+TEST_F(PacketTest, LengthSegments) {
+	static const size_t ALLOC = 4;
+	Packet packet(ALLOC);
+	EXPECT_EQ(packet.length(), (size_t)0);
+	EXPECT_EQ(packet.segments(), (size_t)0);
+	EXPECT_EQ(packet.append("abcdefghij", 10), (size_t)10);
+	EXPECT_EQ(packet.length(), (size_t)10);
+	EXPECT_EQ(packet.segments(), (size_t)3);
+	EXPECT_EQ(packet.prepend("0123", 4), (size_t)4);
+	EXPECT_EQ(packet.length(), (size_t)14);
+	EXPECT_EQ(packet.segments(), (size_t)4);
+	EXPECT_EQ(packet.consume(5), (size_t)5);
+	EXPECT_EQ(packet.length(), (size_t)9);
+	EXPECT_EQ(packet.segments(), (size_t)3);
+	char buffer[16];
+	EXPECT_EQ(packet.consume(buffer, sizeof(buffer), 'g'), (size_t)6);
+	EXPECT_EQ(std::strncmp(buffer, "bcdefg", 6), 0);
+	EXPECT_EQ(packet.length(), (size_t)3);
+	// Data changed behind the back of the Packet is still counted.
+	struct Data { char data[3]; } data = { { 'x', 'y', 'z' } };
+	PacketBuffer * pb = new PacketBuffer(&data, sizeof(data), PacketBuffer::APPEND);
+	packet.append(*pb);
+	EXPECT_EQ(packet.length(), (size_t)3);
+	EXPECT_EQ(pb->append("xyz", 3), (size_t)3);
+	EXPECT_EQ(packet.length(), (size_t)6);
+	EXPECT_EQ(packet.consume(buffer, sizeof(buffer)), (size_t)6);
+	EXPECT_EQ(std::strncmp(buffer, "hijxyz", 6), 0);
+	EXPECT_TRUE(packet.empty());
+	EXPECT_EQ(packet.length(), (size_t)0);
+	EXPECT_EQ(packet.segments(), (size_t)0);
+	// Once emptied the length is kept again.
+	EXPECT_EQ(packet.append("abc", 3), (size_t)3);
+	EXPECT_EQ(packet.length(), (size_t)3);
+	EXPECT_EQ(packet.segments(), (size_t)1);
+	packet.clear();
+	EXPECT_EQ(packet.length(), (size_t)0);
+	EXPECT_EQ(packet.segments(), (size_t)0);
+}
+
+TEST_F(PacketTest, ReserveCommit) {
+	static const size_t ALLOC = 8;
+	Packet packet(ALLOC);
+	size_t room = 0;
+	char * space = static_cast<char *>(packet.reserve(room));
+	ASSERT_NE(space, (char *)0);
+	EXPECT_EQ(room, ALLOC);
+	std::memcpy(space, "abcde", 5);
+	EXPECT_EQ(packet.commit(5), (size_t)5);
+	EXPECT_EQ(packet.length(), (size_t)5);
+	space = static_cast<char *>(packet.reserve(room));
+	EXPECT_EQ(room, (size_t)3);
+	std::memcpy(space, "fgh", 3);
+	EXPECT_EQ(packet.commit(room + 1), (size_t)3);
+	EXPECT_EQ(packet.segments(), (size_t)1);
+	space = static_cast<char *>(packet.reserve(room));
+	EXPECT_EQ(room, ALLOC);
+	EXPECT_EQ(packet.segments(), (size_t)2);
+	EXPECT_EQ(packet.commit(0), (size_t)0);
+	EXPECT_EQ(packet.length(), (size_t)8);
+	char buffer[8];
+	EXPECT_EQ(packet.consume(buffer, sizeof(buffer)), sizeof(buffer));
+	EXPECT_EQ(std::strncmp(buffer, "abcdefgh", sizeof(buffer)), 0);
+	// The reserved but uncommitted buffer remains.
+	EXPECT_EQ(packet.length(), (size_t)0);
+	EXPECT_EQ(packet.segments(), (size_t)1);
+	EXPECT_FALSE(packet.empty());
+}
+
+TEST_F(PacketTest, Compact) {
+	static const size_t ALLOC = 16;
+	Packet packet(ALLOC);
+	PacketData * empty = new PacketBuffer(0, 0);
+	packet.append(*empty);
+	for (char ch = 'a'; ch <= 'p'; ++ch) {
+		PacketBuffer * pb = new PacketBufferDynamic(1, PacketBuffer::APPEND);
+		EXPECT_EQ(pb->append(&ch, sizeof(ch)), (size_t)1);
+		packet.append(*pb);
+	}
+	EXPECT_EQ(packet.segments(), (size_t)17);
+	EXPECT_EQ(packet.length(), (size_t)16);
+	EXPECT_EQ(packet.compact(), (size_t)16);
+	EXPECT_EQ(packet.segments(), (size_t)1);
+	EXPECT_EQ(packet.length(), (size_t)16);
+	EXPECT_EQ(packet.compact(), (size_t)0);
+	EXPECT_EQ(packet.append("q", 1), (size_t)1);
+	EXPECT_EQ(packet.segments(), (size_t)2);
+	EXPECT_EQ(packet.compact(), (size_t)0);
+	char buffer[17];
+	EXPECT_EQ(packet.consume(buffer, sizeof(buffer)), sizeof(buffer));
+	EXPECT_EQ(std::strncmp(buffer, "abcdefghijklmnopq", sizeof(buffer)), 0);
+	EXPECT_TRUE(packet.empty());
+	EXPECT_EQ(packet.compact(), (size_t)0);
+}
+
+TEST_F(PacketTest, Linearize) {
+	static const size_t ALLOC = 4;
+	Packet packet(ALLOC);
+	EXPECT_EQ(packet.linearize(), (const void *)0);
+	EXPECT_EQ(packet.append("abc", 3), (size_t)3);
+	const char * here = static_cast<const char *>(packet.linearize());
+	ASSERT_NE(here, (const char *)0);
+	EXPECT_EQ(std::strncmp(here, "abc", 3), 0);
+	EXPECT_EQ(packet.segments(), (size_t)1);
+	EXPECT_EQ(packet.append("defghijklmn", 11), (size_t)11);
+	EXPECT_EQ(packet.segments(), (size_t)4);
+	here = static_cast<const char *>(packet.linearize());
+	ASSERT_NE(here, (const char *)0);
+	EXPECT_EQ(packet.segments(), (size_t)1);
+	EXPECT_EQ(packet.length(), (size_t)14);
+	EXPECT_EQ(std::strncmp(here, "abcdefghijklmn", 14), 0);
+	EXPECT_EQ(packet.consume(2), (size_t)2);
+	here = static_cast<const char *>(packet.linearize());
+	EXPECT_EQ(std::strncmp(here, "cdefghijklmn", 12), 0);
+	EXPECT_EQ(packet.append("op", 2), (size_t)2);
+	here = static_cast<const char *>(packet.linearize());
+	EXPECT_EQ(std::strncmp(here, "cdefghijklmnop", 14), 0);
+	EXPECT_EQ(packet.length(), (size_t)14);
+}
+
+typedef Fixture PacketCursorTest;
+
+TEST_F(PacketCursorTest, Empty) {
+	Packet packet;
+	PacketCursor cursor(packet);
+	EXPECT_TRUE(cursor.end());
+	EXPECT_EQ(cursor.tell(), (size_t)0);
+	size_t length = 1;
+	EXPECT_EQ(cursor.span(length), (const void *)0);
+	EXPECT_EQ(length, (size_t)0);
+	EXPECT_EQ(cursor.advance(1), (size_t)0);
+	char datum;
+	EXPECT_EQ(cursor.read(&datum, sizeof(datum)), (size_t)0);
+	cursor.show(0, &errput);
+}
+
+TEST_F(PacketCursorTest, Spans) {
+	static const size_t SIZE = 256;
+	static const size_t ALLOC = 7;
+	char data[SIZE];
+	for (size_t ii = 0; ii < sizeof(data); ++ii) { data[ii] = ii; }
+	Packet packet(ALLOC, Packet::EITHER);
+	EXPECT_EQ(packet.append(&data[SIZE / 2], SIZE / 2), SIZE / 2);
+	PacketData * empty = new PacketBuffer(0, 0);
+	packet.prepend(*empty);
+	EXPECT_EQ(packet.prepend(&data[0], SIZE / 2), SIZE / 2);
+	char buffer[SIZE];
+	size_t total = 0;
+	size_t spans = 0;
+	size_t length;
+	const void * span;
+	PacketCursor cursor(packet);
+	while ((span = cursor.span(length)) != 0) {
+		ASSERT_GT(length, (size_t)0);
+		ASSERT_LE(length, ALLOC);
+		std::memcpy(&buffer[total], span, length);
+		total += length;
+		++spans;
+		EXPECT_EQ(cursor.advance(length), length);
+		EXPECT_EQ(cursor.tell(), total);
+	}
+	EXPECT_TRUE(cursor.end());
+	EXPECT_EQ(total, SIZE);
+	EXPECT_GE(spans, SIZE / ALLOC);
+	EXPECT_EQ(std::memcmp(data, buffer, sizeof(data)), 0);
+	// Nothing was consumed.
+	EXPECT_EQ(packet.length(), SIZE);
+}
+
+TEST_F(PacketCursorTest, RandomAccess) {
+	static const size_t SIZE = 256;
+	static const size_t ALLOC = 7;
+	char data[SIZE];
+	for (size_t ii = 0; ii < sizeof(data); ++ii) { data[ii] = ii; }
+	Packet packet(ALLOC);
+	EXPECT_EQ(packet.append(data, sizeof(data)), sizeof(data));
+	PacketCursor cursor(packet);
+	static const size_t OFFSETS[] = { 100, 3, 7, 0, 255, 13, 14, 200, 256, 300, 1 };
+	for (size_t ii = 0; ii < countof(OFFSETS); ++ii) {
+		size_t expected = (OFFSETS[ii] < SIZE) ? OFFSETS[ii] : SIZE;
+		EXPECT_EQ(cursor.seek(OFFSETS[ii]), expected);
+		EXPECT_EQ(cursor.tell(), expected);
+		char datum;
+		if (expected < SIZE) {
+			EXPECT_EQ(cursor.peek(&datum, sizeof(datum)), sizeof(datum));
+			EXPECT_EQ(datum, data[expected]);
+			EXPECT_EQ(cursor.tell(), expected);
+		} else {
+			EXPECT_TRUE(cursor.end());
+			EXPECT_EQ(cursor.peek(&datum, sizeof(datum)), (size_t)0);
+		}
+	}
+	char buffer[20];
+	EXPECT_EQ(cursor.seek(30), (size_t)30);
+	PacketCursor saved(cursor);
+	EXPECT_EQ(cursor.read(buffer, sizeof(buffer)), sizeof(buffer));
+	EXPECT_EQ(std::memcmp(buffer, &data[30], sizeof(buffer)), 0);
+	EXPECT_EQ(cursor.tell(), (size_t)50);
+	EXPECT_EQ(saved.tell(), (size_t)30);
+	EXPECT_EQ(saved.peek(buffer, sizeof(buffer)), sizeof(buffer));
+	EXPECT_EQ(std::memcmp(buffer, &data[30], sizeof(buffer)), 0);
+	EXPECT_EQ(packet.length(), SIZE);
+}
+
+TEST_F(PacketCursorTest, ParseThenConsume) {
+	static const size_t ALLOC = 5;
+	Packet packet(ALLOC);
+	EXPECT_EQ(packet.append("LEN=0005HELLOrest", 17), (size_t)17);
+	PacketCursor cursor(packet);
+	char tag[4];
+	EXPECT_EQ(cursor.read(tag, sizeof(tag)), sizeof(tag));
+	EXPECT_EQ(std::strncmp(tag, "LEN=", sizeof(tag)), 0);
+	char digits[5] = { 0 };
+	EXPECT_EQ(cursor.read(digits, 4), (size_t)4);
+	size_t length = std::atoi(digits);
+	EXPECT_EQ(length, (size_t)5);
+	EXPECT_EQ(cursor.advance(length), length);
+	// Commit to the parse by consuming exactly what the cursor passed.
+	EXPECT_EQ(packet.consume(cursor.tell()), (size_t)13);
+	char rest[4];
+	EXPECT_EQ(packet.consume(rest, sizeof(rest)), sizeof(rest));
+	EXPECT_EQ(std::strncmp(rest, "rest", sizeof(rest)), 0);
+	EXPECT_TRUE(packet.empty());
+}
+
+typedef Fixture PacketDataSharedTest;
+
+TEST_F(PacketDataSharedTest, References) {
+	PacketBufferDynamic * pbd = new PacketBufferDynamic(16);
+	EXPECT_EQ(pbd->append("abcdef", 6), (size_t)6);
+	EXPECT_EQ(pbd->shared(), (PacketDataShared *)0);
+	PacketDataShared * one = new PacketDataShared(*pbd);
+	EXPECT_EQ(one->shared(), one);
+	EXPECT_EQ(one->getReferences(), 1);
+	EXPECT_EQ(one->length(), (size_t)6);
+	EXPECT_EQ(one->prefix(), (size_t)0);
+	EXPECT_EQ(one->suffix(), (size_t)0);
+	char buffer[6];
+	EXPECT_EQ(one->consume(buffer, 2), (size_t)2);
+	EXPECT_EQ(one->prefix(), (size_t)0);
+	EXPECT_EQ(one->prepend("xy", 2), (size_t)0);
+	EXPECT_EQ(one->append("xy", 2), (size_t)0);
+	PacketDataShared * two = one->share();
+	EXPECT_EQ(one->getReferences(), 2);
+	EXPECT_EQ(two->getReferences(), 2);
+	EXPECT_EQ(two->length(), (size_t)4);
+	EXPECT_EQ(two->buffer(), one->buffer());
+	delete one;
+	EXPECT_EQ(two->getReferences(), 1);
+	EXPECT_EQ(two->consume(buffer, sizeof(buffer)), (size_t)4);
+	EXPECT_EQ(std::strncmp(buffer, "cdef", 4), 0);
+	delete two;
+}
+
+TEST_F(PacketDataSharedTest, Share) {
+	static const size_t SIZE = 256;
+	static const size_t ALLOC = 7;
+	char data[SIZE];
+	for (size_t ii = 0; ii < sizeof(data); ++ii) { data[ii] = ii; }
+	Packet * original = new Packet(ALLOC, Packet::EITHER);
+	EXPECT_EQ(original->append(data, sizeof(data)), sizeof(data));
+	Packet copy(ALLOC);
+	EXPECT_EQ(original->share(copy), SIZE);
+	EXPECT_EQ(original->share(*original), (size_t)0);
+	EXPECT_EQ(original->length(), SIZE);
+	EXPECT_EQ(copy.length(), SIZE);
+	// Each destination gets its own header without copying the payload.
+	EXPECT_EQ(original->prepend("ONE:", 4), (size_t)4);
+	EXPECT_EQ(copy.prepend("TWO:", 4), (size_t)4);
+	EXPECT_EQ(copy.append(":END", 4), (size_t)4);
+	PacketCursor one(*original);
+	PacketCursor two(copy);
+	size_t length1;
+	size_t length2;
+	one.seek(4);
+	two.seek(4);
+	EXPECT_EQ(one.span(length1), two.span(length2));
+	char header[4];
+	EXPECT_EQ(original->consume(header, sizeof(header)), sizeof(header));
+	EXPECT_EQ(std::strncmp(header, "ONE:", sizeof(header)), 0);
+	char buffer[SIZE];
+	EXPECT_EQ(original->consume(buffer, SIZE / 2), SIZE / 2);
+	EXPECT_EQ(std::memcmp(buffer, data, SIZE / 2), 0);
+	// Delete the original while the copy still refers to its data.
+	delete original;
+	EXPECT_EQ(copy.consume(header, sizeof(header)), sizeof(header));
+	EXPECT_EQ(std::strncmp(header, "TWO:", sizeof(header)), 0);
+	EXPECT_EQ(copy.consume(buffer, sizeof(buffer)), sizeof(buffer));
+	EXPECT_EQ(std::memcmp(buffer, data, sizeof(buffer)), 0);
+	EXPECT_EQ(copy.consume(header, sizeof(header)), sizeof(header));
+	EXPECT_EQ(std::strncmp(header, ":END", sizeof(header)), 0);
+	EXPECT_TRUE(copy.empty());
+}
+
+TEST_F(PacketDataSharedTest, Clone) {
+	static const size_t ALLOC = 4;
+	PacketPool pool(ALLOC);
+	Packet original(pool);
+	EXPECT_EQ(original.append("abcdefghij", 10), (size_t)10);
+	Packet * copies[3];
+	for (size_t ii = 0; ii < countof(copies); ++ii) {
+		copies[ii] = original.clone();
+		ASSERT_NE(copies[ii], (Packet *)0);
+		EXPECT_EQ(copies[ii]->length(), (size_t)10);
+	}
+	size_t misses = pool.getMisses();
+	original.clear();
+	for (size_t ii = 0; ii < countof(copies); ++ii) {
+		char buffer[10];
+		EXPECT_EQ(copies[ii]->consume(buffer, sizeof(buffer)), sizeof(buffer));
+		EXPECT_EQ(std::strncmp(buffer, "abcdefghij", sizeof(buffer)), 0);
+		delete copies[ii];
+	}
+	// The shared buffers went back to the pool only when the last view went.
+	EXPECT_EQ(pool.getMisses(), misses);
+	EXPECT_EQ(pool.getCached(), misses);
+}
+
+TEST_F(PacketDataSharedTest, ConsumeThenPrepend) {
+	Packet original;
+	EXPECT_EQ(original.append("ABCDEFGHIJ", 10), (size_t)10);
+	Packet * copy = original.clone();
+	ASSERT_NE(copy, (Packet *)0);
+	// A partly consumed view has space in front of it, but that space
+	// belongs to the shared data and must not be written into.
+	EXPECT_EQ(original.consume(4), (size_t)4);
+	EXPECT_EQ(original.prepend("xy", 2), (size_t)2);
+	EXPECT_EQ(original.append("z", 1), (size_t)1);
+	char buffer[10];
+	EXPECT_EQ(copy->consume(buffer, sizeof(buffer)), sizeof(buffer));
+	EXPECT_EQ(std::strncmp(buffer, "ABCDEFGHIJ", sizeof(buffer)), 0);
+	char buffer2[9];
+	EXPECT_EQ(original.consume(buffer2, sizeof(buffer2)), sizeof(buffer2));
+	EXPECT_EQ(std::strncmp(buffer2, "xyEFGHIJz", sizeof(buffer2)), 0);
+	EXPECT_TRUE(original.empty());
+	delete copy;
+}
+
+typedef Fixture PacketPoolTest;
+
+TEST_F(PacketPoolTest, HeapAndShow) {
+	PacketPool * pool = new PacketPool;
+	ASSERT_NE(pool, (PacketPool*)0);
+	pool->show(0, &errput);
+	delete pool;
+}
+
+TEST_F(PacketPoolTest, Recycle) {
+	static const size_t ALLOC = 32;
+	static const size_t LIMIT = 2;
+	static const size_t ZERO = 0;
+	PacketPool pool(ALLOC, LIMIT);
+	EXPECT_EQ(pool.size(), ALLOC);
+	PacketBufferPooled * pbp[LIMIT + 1];
+	for (size_t ii = 0; ii < countof(pbp); ++ii) {
+		pbp[ii] = pool.get(PacketBufferPooled::APPEND);
+		ASSERT_NE(pbp[ii], (PacketBufferPooled*)0);
+		EXPECT_TRUE(pbp[ii]->empty());
+		EXPECT_EQ(pbp[ii]->size(), ALLOC);
+		EXPECT_EQ(pbp[ii]->suffix(), ALLOC);
+	}
+	EXPECT_EQ(pool.getHits(), ZERO);
+	EXPECT_EQ(pool.getMisses(), countof(pbp));
+	for (size_t ii = 0; ii < countof(pbp); ++ii) {
+		delete pbp[ii];
+	}
+	EXPECT_EQ(pool.getRecycles(), LIMIT);
+	EXPECT_EQ(pool.getReleases(), (size_t)1);
+	EXPECT_EQ(pool.getCached(), LIMIT);
+	PacketBufferPooled * again = pool.get(PacketBufferPooled::PREPEND);
+	EXPECT_EQ(again, pbp[1]);
+	EXPECT_TRUE(again->empty());
+	EXPECT_EQ(again->prepend("abc", 3), (size_t)3);
+	EXPECT_EQ(again->prefix(), ALLOC - 3);
+	EXPECT_EQ(pool.getHits(), (size_t)1);
+	EXPECT_EQ(pool.getCached(), LIMIT - 1);
+	delete again;
+	EXPECT_EQ(pool.getCached(), LIMIT);
+	pool.show(0, &errput);
+}
+
+TEST_F(PacketPoolTest, ReserveCommit) {
+	static const size_t ALLOC = 8;
+	PacketPool pool(ALLOC);
+	PacketBufferPooled * pbp = pool.get(PacketBufferPooled::EITHER);
+	std::memcpy(pbp->reserve(), "abcde", 5);
+	EXPECT_EQ(pbp->commit(5), (size_t)5);
+	EXPECT_EQ(pbp->length(), (size_t)5);
+	EXPECT_EQ(pbp->prefix(), (size_t)0);
+	std::memcpy(pbp->reserve(), "fgh", 3);
+	EXPECT_EQ(pbp->commit(5), (size_t)3);
+	EXPECT_EQ(pbp->suffix(), (size_t)0);
+	char buffer[ALLOC];
+	EXPECT_EQ(pbp->consume(buffer, sizeof(buffer)), sizeof(buffer));
+	EXPECT_EQ(std::memcmp(buffer, "abcdefgh", sizeof(buffer)), 0);
+	delete pbp;
+}
+
+TEST_F(PacketPoolTest, Packet) {
+	static const size_t SIZE = 256;
+	static const size_t ALLOC = SIZE / 8;
+	char data[SIZE];
+	for (size_t ii = 0; ii < sizeof(data); ++ii) { data[ii] = ii; }
+	PacketPool pool(ALLOC);
+	char buffer[sizeof(data)];
+	for (int round = 0; round < 3; ++round) {
+		Packet packet(pool, Packet::EITHER);
+		EXPECT_EQ(packet.prepend(&data[0], sizeof(data) / 2), sizeof(data) / 2);
+		EXPECT_EQ(packet.append(&data[sizeof(data) / 2], sizeof(data) / 2), sizeof(data) / 2);
+		EXPECT_EQ(packet.length(), sizeof(data));
+		packet.show(1, &errput);
+		EXPECT_EQ(packet.consume(buffer, sizeof(buffer) / 2), sizeof(buffer) / 2);
+		EXPECT_EQ(packet.consume(&buffer[sizeof(buffer) / 2], sizeof(buffer) / 2), sizeof(buffer) / 2);
+		EXPECT_TRUE(packet.empty());
+		EXPECT_EQ(std::memcmp(data, buffer, sizeof(data)), 0);
+	}
+	// Every buffer after the first round should have been recycled.
+	EXPECT_GT(pool.getHits(), (size_t)0);
+	EXPECT_EQ(pool.getHits() + pool.getMisses(), pool.getRecycles() + pool.getReleases());
+	EXPECT_EQ(pool.getMisses(), pool.getCached() + pool.getReleases());
+	pool.show(0, &errput);
+}
+
+TEST_F(PacketPoolTest, MixedBag) {
+	PacketPool pool(4);
+	Packet * packet = new Packet(pool);
+	struct Data1 { char data[3]; } data1 = { { 'd', 'e', 'f' } };
+	PacketData * pd = new PacketData(&data1, sizeof(data1));
+	packet->append(*pd);
+	EXPECT_EQ(packet->prepend("abc", 3), (size_t)3);
+	EXPECT_EQ(packet->append("ghijklm", 7), (size_t)7);
+	packet->clear();
+	EXPECT_EQ(pool.getMisses(), (size_t)3);
+	EXPECT_EQ(pool.getCached(), (size_t)3);
+	delete packet;
+}
+
 typedef Fixture PacketInputOutputTest;
 
 TEST_F(PacketInputOutputTest, Block) {
@@ -851,6 +1331,23 @@ TEST_F(PacketInputOutputTest, String) {
 	}
 }
 
+TEST_F(PacketInputOutputTest, StringTruncated) {
+	Packet packet;
+	EXPECT_EQ(packet.append("abcdefgh\nij", 11), (size_t)11);
+	char buffer[5];
+	EXPECT_EQ((packet.input())(buffer, sizeof(buffer)), (ssize_t)5);
+	EXPECT_EQ(std::strcmp(buffer, "abcd"), 0);
+	EXPECT_EQ((packet.input())(buffer, sizeof(buffer)), (ssize_t)5);
+	EXPECT_EQ(std::strcmp(buffer, "efgh"), 0);
+	EXPECT_EQ((packet.input())(buffer, sizeof(buffer)), (ssize_t)2);
+	EXPECT_EQ(std::strcmp(buffer, "\n"), 0);
+	EXPECT_EQ((packet.input())(buffer, 1), (ssize_t)1);
+	EXPECT_EQ(std::strcmp(buffer, ""), 0);
+	EXPECT_EQ((packet.input())(buffer, sizeof(buffer)), (ssize_t)3);
+	EXPECT_EQ(std::strcmp(buffer, "ij"), 0);
+	EXPECT_EQ((packet.input())(buffer, sizeof(buffer)), (ssize_t)EOF);
+}
+
 TEST_F(PacketInputOutputTest, Formatted) {
 	static const size_t ALLOC = 7;
 	Packet packet(ALLOC, Packet::APPEND);
@@ -870,6 +1367,25 @@ TEST_F(PacketInputOutputTest, Formatted) {
 	}
 }
 
+TEST_F(PacketInputOutputTest, FormattedDirect) {
+	Packet packet;
+	EXPECT_TRUE(packet.empty());
+	Print print(packet.output());
+	for (size_t ii = 0; ii < countof(HENRYV); ++ii) {
+		print("%s", HENRYV[ii]);
+		EXPECT_FALSE(packet.empty());
+	}
+	EXPECT_EQ(packet.segments(), (size_t)1);
+	char buffer[countof(HENRYV)][64];
+	for (size_t ii = 0; ii < countof(buffer); ++ii) {
+		(packet.input())(buffer[ii], sizeof(buffer[ii]));
+	}
+	EXPECT_TRUE(packet.empty());
+	for (size_t ii = 0; ii < countof(buffer); ++ii) {
+		EXPECT_EQ(std::strncmp(HENRYV[ii], buffer[ii], sizeof(buffer[ii])), 0);
+	}
+}
+
 static const char RICHARDII[] = {
 	"This royal throne of kings, this sceptred isle,\n"
 	"This earth of majesty, this seat of Mars,\n"
@@ -899,6 +1415,24 @@ TEST_F(PacketInputOutputTest, SourceSinkBuffer) {
 	EXPECT_EQ(std::strncmp(RICHARDII, buffer, sizeof(buffer)), 0);
 }
 
+TEST_F(PacketInputOutputTest, SourceSinkBufferPooled) {
+	static const size_t ALLOC = 7;
+	PacketPool pool(ALLOC);
+	for (int round = 0; round < 2; ++round) {
+		DataInput datainput(RICHARDII, sizeof(RICHARDII));
+		Packet packet(pool, Packet::APPEND);
+		EXPECT_EQ(packet.source(datainput), sizeof(RICHARDII));
+		EXPECT_EQ(packet.length(), sizeof(RICHARDII));
+		char buffer[sizeof(RICHARDII)];
+		BufferOutput bufferoutput(buffer, sizeof(buffer));
+		EXPECT_EQ(packet.sink(bufferoutput), sizeof(RICHARDII));
+		EXPECT_TRUE(packet.empty());
+		EXPECT_EQ(std::strncmp(RICHARDII, buffer, sizeof(buffer)), 0);
+	}
+	EXPECT_GT(pool.getHits(), (size_t)0);
+	pool.show(0, &errput);
+}
+
 TEST_F(PacketInputOutputTest, SourceSinkPathFile) {
 	PathInput input("dat/unittest.txt", "r");
 	Size inputsize = size(input);
@@ -927,6 +1461,92 @@ TEST_F(PacketInputOutputTest, SourceSinkPathFile) {
 	EXPECT_EQ(::unlink(name), 0);
 }
 
+TEST_F(PacketInputOutputTest, SourceSinkDescriptor) {
+	PathInput input("dat/unittest.txt", "r");
+	Size inputsize = size(input);
+	EXPECT_TRUE(inputsize > 0);
+	int infd = ::open("dat/unittest.txt", O_RDONLY);
+	ASSERT_TRUE(infd >= 0);
+	char name[] = "/tmp/PacketTest.SourceSinkDescriptor.XXXXXX";
+	int outfd = ::mkstemp(name);
+	ASSERT_TRUE(outfd > 0);
+	// Small enough that there are more buffers than fit in one writev(2).
+	static const size_t ALLOC = 64;
+	Packet packet(ALLOC);
+	EXPECT_EQ(packet.source(infd), inputsize);
+	EXPECT_EQ(packet.length(), inputsize);
+	EXPECT_EQ(packet.sink(outfd), inputsize);
+	EXPECT_TRUE(packet.empty());
+	EXPECT_EQ(::close(infd), 0);
+	EXPECT_EQ(::close(outfd), 0);
+	std::string command = "diff ";
+	command += "dat/unittest.txt";
+	command += " ";
+	command += name;
+	EXPECT_EQ(std::system(command.c_str()), 0);
+	EXPECT_EQ(::unlink(name), 0);
+}
+
+TEST_F(PacketInputOutputTest, SourceSinkDescriptorPooled) {
+	static const size_t ALLOC = 256;
+	PacketPool pool(ALLOC);
+	for (int round = 0; round < 2; ++round) {
+		int infd = ::open("dat/unittest.txt", O_RDONLY);
+		ASSERT_TRUE(infd >= 0);
+		char name[] = "/tmp/PacketTest.SourceSinkDescriptorPooled.XXXXXX";
+		int outfd = ::mkstemp(name);
+		ASSERT_TRUE(outfd > 0);
+		Packet packet(pool);
+		EXPECT_EQ(packet.append("Header\n", 7), (size_t)7);
+		size_t sourced = packet.source(infd);
+		EXPECT_TRUE(sourced > 0);
+		EXPECT_EQ(packet.length(), sourced + 7);
+		char header[7];
+		EXPECT_EQ(packet.consume(header, sizeof(header)), sizeof(header));
+		EXPECT_EQ(std::strncmp(header, "Header\n", sizeof(header)), 0);
+		EXPECT_EQ(packet.sink(outfd), sourced);
+		EXPECT_TRUE(packet.empty());
+		EXPECT_EQ(::close(infd), 0);
+		EXPECT_EQ(::close(outfd), 0);
+		std::string command = "diff ";
+		command += "dat/unittest.txt";
+		command += " ";
+		command += name;
+		EXPECT_EQ(std::system(command.c_str()), 0);
+		EXPECT_EQ(::unlink(name), 0);
+	}
+	EXPECT_GT(pool.getHits(), (size_t)0);
+	pool.show(0, &errput);
+}
+
+TEST_F(PacketInputOutputTest, SinkDescriptorWouldBlock) {
+	int fds[2];
+	ASSERT_EQ(::pipe(fds), 0);
+	ASSERT_EQ(::fcntl(fds[1], F_SETFL, ::fcntl(fds[1], F_GETFL) | O_NONBLOCK), 0);
+	ASSERT_EQ(::fcntl(fds[0], F_SETFL, ::fcntl(fds[0], F_GETFL) | O_NONBLOCK), 0);
+	int infd = ::open("dat/unittest.txt", O_RDONLY);
+	ASSERT_TRUE(infd >= 0);
+	Packet packet;
+	size_t sourced = packet.source(infd);
+	EXPECT_EQ(::close(infd), 0);
+	// A pipe holds less than the whole file, so some data must remain.
+	size_t sunk = packet.sink(fds[1]);
+	EXPECT_TRUE(sunk > 0);
+	EXPECT_TRUE(sunk < sourced);
+	EXPECT_EQ(packet.length(), sourced - sunk);
+	Packet drained;
+	size_t total = 0;
+	while (!packet.empty()) {
+		total += drained.source(fds[0]);
+		packet.sink(fds[1]);
+	}
+	total += drained.source(fds[0]);
+	EXPECT_EQ(total, sourced);
+	EXPECT_EQ(drained.length(), sourced);
+	EXPECT_EQ(::close(fds[0]), 0);
+	EXPECT_EQ(::close(fds[1]), 0);
+}
+
 }
 }
 }
@@ -0,0 +1,328 @@
+#ifndef _COM_DIAG_GRANDOTE_ARENAHEAP_H_
+#define _COM_DIAG_GRANDOTE_ARENAHEAP_H_
+
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Declares the ArenaHeap class.
+ *
+ *  @see    ArenaHeap
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/target.h"
+#include "com/diag/grandote/cxxcapi.h"
+#include "com/diag/grandote/Heap.h"
+
+
+#if defined(__cplusplus)
+
+
+namespace com { namespace diag { namespace grandote {
+
+/**
+ *  Implements a Heap whose blocks are carved by advancing a pointer through
+ *  large chunks of memory, each allocated with the C++ new operator. This is
+ *  sometimes called a region or an arena. Allocation is a few instructions
+ *  in the usual case. Freeing an individual block does nothing, except that
+ *  the most recently allocated block is given back to its chunk. Instead,
+ *  all of the blocks are dropped at once by reset() or release(), each of
+ *  which takes time proportional to the number of chunks, not the number
+ *  of blocks. This suits work with a well defined end, like handling a
+ *  request or parsing a message, where every block allocated along the way
+ *  can be discarded together.
+ *
+ *  Blocks have the same alignment and header as those of a Heap, so
+ *  size(), realloc() and calloc() behave the same, and a pointer to an
+ *  ArenaHeap may be passed to the C-callable heap API wherever a pointer
+ *  to a Heap is expected.
+ *
+ *  @see    Heap
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+class ArenaHeap : public Heap {
+
+public:
+
+    /**
+     *  This is the default size of each chunk in bytes.
+     */
+    enum { CHUNK = 65536 };
+
+    /**
+     *  Constructor.
+     *
+     *  @param  chunk       is the size of each chunk in bytes. A block too
+     *                      large to fit in a chunk of this size gets a
+     *                      chunk of its own.
+     *
+     *  @param  po          points to the output object used for tracing.
+     *                      If 0, the platform error object is used.
+     */
+    explicit ArenaHeap(size_t chunk = CHUNK, Output* po = 0);
+
+    /**
+     *  Constructor.
+     *
+     *  @param  chunk       is the size of each chunk in bytes. A block too
+     *                      large to fit in a chunk of this size gets a
+     *                      chunk of its own.
+     *
+     *  @param  ro          refers to the output object used for tracing.
+     */
+    ArenaHeap(size_t chunk, Output& ro);
+
+    /**
+     *  Destructor. All chunks are released.
+     */
+    virtual ~ArenaHeap();
+
+    /**
+     *  Allocates a block of contiguous memory of the specified size from
+     *  the current chunk, allocating a new chunk if the current one does
+     *  not have room.
+     *
+     *  @param  size        is the size of the requested memory
+     *                      memory block in bytes.
+     *
+     *  @return a pointer to the suitably aligned memory block of
+     *          at least the requested size, or null if an error occurred.
+     */
+    virtual void* malloc(size_t size);
+
+    /**
+     *  Releases a block of memory. The memory is not reused until the
+     *  arena is reset or released, unless the block was the one most
+     *  recently allocated.
+     *
+     *  @param  ptr         points to the memory block to release.
+     *                      The pointer must have a value previously
+     *                      returned by malloc(),
+     *                      realloc(), or calloc().
+     *                      It is not an error for this pointer to be null.
+     */
+    virtual void free(void* ptr);
+
+    /**
+     *  Reallocate a block of contiguous memory of the specified size.
+     *  A block that shrinks, or the block most recently allocated if
+     *  its chunk has room, is resized in place. Otherwise a new block
+     *  is allocated and the old block copied into it.
+     *
+     *  @param  ptr         points to the memory block to reallocate.
+     *                      The pointer must have a value previously
+     *                      returned by malloc() or
+     *                      realloc(), or null. If it is null,
+     *                      calling realloc() is equivalent
+     *                      to calling malloc(size).
+     *
+     *  @param  size        is the size of the new requested memory
+     *                      memory block in bytes. If it is zero and
+     *                      ptr is not zero, calling
+     *                      realloc() is equivalent to
+     *                      calling free(ptr).
+     *
+     *  @return a pointer to the suitably aligned memory block of
+     *          at least the requested size, or null if an error occurred.
+     */
+    virtual void* realloc(void* ptr, size_t size);
+
+    /**
+     *  Return the size in bytes of the specified memory block.
+     *
+     *  @param  ptr         points to the memory block to size.
+     *                      The pointer must have a value previously
+     *                      returned by malloc() or
+     *                      realloc().
+     *
+     *  @return             the size in bytes of the specified memory
+     *                      block as specified in its allocation, or
+     *                      zero if a null pointer was specified.
+     */
+    virtual size_t size(void* ptr);
+
+    /**
+     *  Drops every block allocated from this arena. One chunk of the
+     *  default size is kept to be reused, and the rest are released.
+     *  Any pointer to a block allocated before the reset is invalid
+     *  afterwards.
+     */
+    virtual void reset();
+
+    /**
+     *  Drops every block allocated from this arena and releases all of
+     *  its chunks. Any pointer to a block allocated before the release is
+     *  invalid afterwards.
+     */
+    virtual void release();
+
+    /**
+     *  Returns the number of chunks currently held by this arena.
+     *
+     *  @return the number of chunks.
+     */
+    size_t getChunks() const;
+
+    /**
+     *  Displays internal information about this object to the specified
+     *  output object. Useful for debugging and troubleshooting.
+     *
+     *  @param  level   sets the verbosity of the output. What this means
+     *                  is object dependent. However, the level is passed
+     *                  from outer to inner objects this object calls the
+     *                  show methods of its inherited or composited objects.
+     *
+     *  @param display  points to the output object to which output is
+     *                  sent. If null (zero), the default platform output
+     *                  object is used as the effective output object. The
+     *                  effective output object is passed from outer to
+     *                  inner objects as this object calls the show methods
+     *                  of its inherited and composited objects.
+     *
+     *  @param  indent  specifies the level of indentation. One more than
+     *                  this value is passed from outer to inner objects
+     *                  as this object calls the show methods of its
+     *                  inherited and composited objects.
+     */
+    virtual void show(int level = 0, Output* display = 0, int indent = 0) const;
+
+private:
+
+    /**
+     *  This header is at the front of each chunk.
+     */
+    struct Chunk {
+        Chunk* next;
+        size_t words;
+    };
+
+    /**
+     *  Allocates a chunk.
+     *
+     *  @param  words       is the size of the chunk, not including its
+     *                      header, in units of the alignment type.
+     *
+     *  @return a pointer to the chunk or null if the allocation failed.
+     */
+    Chunk* allocate(size_t words);
+
+    /**
+     *  Size of each chunk, not including its header, in units of the
+     *  alignment type.
+     */
+    size_t granularity;
+
+    /**
+     *  List of chunks. The head of the list is the current chunk.
+     */
+    Chunk* chunks;
+
+    /**
+     *  Number of chunks on the list.
+     */
+    size_t count;
+
+    /**
+     *  Next free word in the current chunk.
+     */
+    Alignment* cursor;
+
+    /**
+     *  Word past the end of the current chunk.
+     */
+    Alignment* limit;
+
+    /**
+     *  Header of the block most recently allocated from the current
+     *  chunk, or null.
+     */
+    Alignment* last;
+
+    /**
+     *  Copy constructor.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    ArenaHeap(const ArenaHeap& that);
+
+    /**
+     *  Assignment operator.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    ArenaHeap& operator=(const ArenaHeap& that);
+
+};
+
+
+//
+//  Return the number of chunks.
+//
+inline size_t ArenaHeap::getChunks() const {
+    return this->count;
+}
+
+} } }
+
+
+#endif
+
+
+#if defined(GRANDOTE_HAS_UNITTESTS)
+/**
+ *  Run the ArenaHeap unit test.
+ *  
+ *  @return the number of errors detected by the unit test.
+ */
+CXXCAPI int unittestArenaHeap(void);
+#endif
+
+
+#endif
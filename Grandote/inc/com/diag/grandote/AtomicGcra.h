@@ -0,0 +1,369 @@
+#ifndef _COM_DIAG_GRANDOTE_ATOMICGCRA_H_
+#define _COM_DIAG_GRANDOTE_ATOMICGCRA_H_
+
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Declares the AtomicGcra class.
+ *
+ *  @see    AtomicGcra
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/target.h"
+#include "com/diag/grandote/types.h"
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/Tat.h"
+#include "com/diag/grandote/Output.h"
+
+
+namespace com { namespace diag { namespace grandote {
+
+/**
+ *  Implements the same Generic Cell Rate Algorithm (GCRA) as Gcra, with
+ *  the same increment and limit, but as a one-shot admission decision that
+ *  is safe to make concurrently from many threads without a mutex. Where
+ *  Gcra keeps the time of the last admission and the expected elapsed
+ *  duration since then in separate variables, updated in two phases by
+ *  admissible() and commit(), this class keeps their sum, the theoretical
+ *  arrival time (TAT) of the next event, in a single 64-bit word. The
+ *  tryAdmit() method reads the TAT, decides, and if the events are
+ *  admissible installs the new TAT with a single compare-and-swap,
+ *  retrying only if another thread got there first.
+ *
+ *  For a caller whose times never go backwards, tryAdmit() makes exactly
+ *  the decision that admissible() followed by commit() (if admissible) or
+ *  rollback() (if not) makes on a Gcra of the same increment and limit,
+ *  and leaves the equivalent state. Since an inadmissible request is never
+ *  committed, this throttle never alarms. When threads race, one of them
+ *  may present a time slightly earlier than the last admission; the GCRA
+ *  then sees a slightly larger expected duration than the elapsed time
+ *  warrants, so it errs on the side of the contract.
+ *
+ *  @see    Gcra
+ *
+ *  @see    The ATM Forum, <I>Traffic Management Specification Version
+ *          4.1</I>, af-tm-0121.000, March 1999
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+class AtomicGcra {
+
+public:
+
+    /**
+     *  Constructor. The throttle is reset to the current platform time.
+     *
+     *  @param  increment   is the GCRA increment or I in throttle ticks.
+     *
+     *  @param  limit       is the GCRA limit or L in throttle ticks.
+     */
+    explicit AtomicGcra(ticks_t increment, ticks_t limit);
+
+    /**
+     *  Constructor.
+     *
+     *  @param  increment   is the GCRA increment or I in throttle ticks.
+     *
+     *  @param  limit       is the GCRA limit or L in throttle ticks.
+     *
+     *  @param  ticks       is the current time in throttle ticks.
+     */
+    explicit AtomicGcra(ticks_t increment, ticks_t limit, ticks_t ticks);
+
+    /**
+     *  Destructor.
+     */
+    virtual ~AtomicGcra();
+
+    /**
+     *  Resets the throttle to its just-constructed state as of the
+     *  current platform time.
+     */
+    void reset();
+
+    /**
+     *  Resets the throttle to its just-constructed state.
+     *
+     *  @param  ticks       is the current time in throttle ticks.
+     */
+    void reset(ticks_t ticks);
+
+    /**
+     *  Returns the number of ticks that an event must be delayed to be
+     *  admissible at the current platform time, without admitting it.
+     *
+     *  @return the delay in ticks, or zero if admissible.
+     */
+    ticks_t admissible() const;
+
+    /**
+     *  Returns the number of ticks that an event must be delayed to be
+     *  admissible at the specified time, without admitting it. By the time
+     *  the caller acts on the answer, another thread may have changed it.
+     *
+     *  @param  ticks       is the current time in throttle ticks.
+     *
+     *  @return the delay in ticks, or zero if admissible.
+     */
+    ticks_t admissible(ticks_t ticks) const;
+
+    /**
+     *  Admits the specified number of events at the current platform time
+     *  if they are admissible.
+     *
+     *  @param  n           is the number of events.
+     *
+     *  @return true if admitted, false otherwise.
+     */
+    bool tryAdmit(size_t n = 1);
+
+    /**
+     *  Admits the specified number of events at the specified time if they
+     *  are admissible. As with Gcra, the events are admissible if the
+     *  throttle would admit one event, and admitting them charges the
+     *  throttle for all of them.
+     *
+     *  @param  n           is the number of events.
+     *
+     *  @param  ticks       is the current time in throttle ticks.
+     *
+     *  @return true if admitted, false otherwise.
+     */
+    bool tryAdmit(size_t n, ticks_t ticks);
+
+    /**
+     *  Returns the GCRA increment.
+     *
+     *  @return the GCRA increment in throttle ticks.
+     */
+    ticks_t getIncrement() const;
+
+    /**
+     *  Returns the GCRA limit.
+     *
+     *  @return the GCRA limit in throttle ticks.
+     */
+    ticks_t getLimit() const;
+
+    /**
+     *  Returns true if the event stream is sufficiently out of specification
+     *  such that the throttle is now only approximate. This occurs because
+     *  of integer overflow in the theoretical arrival time.
+     *
+     *  @return true if the throttle is approximate, false otherwise.
+     */
+    bool isApproximate() const;
+
+    /**
+     *  Returns the current time in the units of ticks indicated
+     *  by the throttle frequency. Derived classes may override this
+     *  method to use a different time base.
+     *
+     *  @return the current time in ticks.
+     */
+    virtual ticks_t time() const;
+
+    /**
+     *  Returns the frequency of the throttle in ticks per second.
+     *
+     *  @return the frequency in ticks per second.
+     */
+    virtual ticks_t frequency() const;
+
+    /**
+     *  Displays internal information about this object to the specified
+     *  output object. Useful for debugging and troubleshooting.
+     *
+     *  @param  level   sets the verbosity of the output. What this means
+     *                  is object dependent. However, the level is passed
+     *                  from outer to inner objects this object calls the
+     *                  show methods of its inherited or composited objects.
+     *
+     *  @param display  points to the output object to which output is
+     *                  sent. If null (zero), the default platform output
+     *                  object is used as the effective output object. The
+     *                  effective output object is passed from outer to
+     *                  inner objects as this object calls the show methods
+     *                  of its inherited and composited objects.
+     *
+     *  @param  indent  specifies the level of indentation. One more than
+     *                  this value is passed from outer to inner objects
+     *                  as this object calls the show methods of its
+     *                  inherited and composited objects.
+     */
+    virtual void show(int level = 0, Output* display = 0, int indent = 0) const;
+
+private:
+
+    /**
+     *  Theoretical arrival time of the next event in absolute ticks. This
+     *  is then plus x in the terminology of Gcra.
+     */
+    ticks_t tat;
+
+    /**
+     *  Virtual scheduler increment.
+     */
+    ticks_t i;
+
+    /**
+     *  Virtual scheduler limit.
+     */
+    ticks_t l;
+
+    /**
+     *  Maximum possible number of events.
+     */
+    ticks_t max;
+
+    /**
+     *  If true then throttle is approximate.
+     */
+    bool approximate;
+
+    /**
+     *  Copy constructor.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    AtomicGcra(const AtomicGcra& that);
+
+    /**
+     *  Assignment operator.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    AtomicGcra& operator=(const AtomicGcra& that);
+
+};
+
+
+//
+//  Return the delay until admissible.
+//
+inline ticks_t AtomicGcra::admissible(ticks_t ticks) const {
+    return Tat::delay(__atomic_load_n(&this->tat, __ATOMIC_ACQUIRE), this->l, ticks);
+}
+
+
+//
+//  Admit the events if admissible.
+//
+inline bool AtomicGcra::tryAdmit(size_t n, ticks_t ticks) {
+    ticks_t expected = __atomic_load_n(&this->tat, __ATOMIC_ACQUIRE);
+    ticks_t desired;
+    bool saturated;
+    do {
+        if (Tat::delay(expected, this->l, ticks) > 0) {
+            return false;
+        }
+        desired = Tat::advance(expected, n, this->i, this->max, ticks, saturated);
+    } while (!__atomic_compare_exchange_n(&this->tat, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+    if (saturated) {
+        __atomic_store_n(&this->approximate, true, __ATOMIC_RELAXED);
+    }
+    return true;
+}
+
+
+//
+//  Admit the events at the current time if admissible.
+//
+inline bool AtomicGcra::tryAdmit(size_t n) {
+    return this->tryAdmit(n, this->time());
+}
+
+
+//
+//  Return the delay until admissible at the current time.
+//
+inline ticks_t AtomicGcra::admissible() const {
+    return this->admissible(this->time());
+}
+
+
+//
+//  Return the increment.
+//
+inline ticks_t AtomicGcra::getIncrement() const {
+    return this->i;
+}
+
+
+//
+//  Return the limit.
+//
+inline ticks_t AtomicGcra::getLimit() const {
+    return this->l;
+}
+
+
+//
+//  Return the approximation state.
+//
+inline bool AtomicGcra::isApproximate() const {
+    return __atomic_load_n(&this->approximate, __ATOMIC_RELAXED);
+}
+
+} } }
+
+
+#if defined(GRANDOTE_HAS_UNITTESTS)
+#include "com/diag/grandote/cxxcapi.h"
+/**
+ *  Run the AtomicGcra unit test.
+ *
+ *  @return the number of errors detected.
+ */
+CXXCAPI int unittestAtomicGcra(void);
+#endif
+
+
+#endif
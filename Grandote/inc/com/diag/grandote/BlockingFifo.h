@@ -0,0 +1,454 @@
+#ifndef _COM_DIAG_GRANDOTE_BLOCKINGFIFO_H_
+#define _COM_DIAG_GRANDOTE_BLOCKINGFIFO_H_
+
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+/**
+ *  @file
+ *
+ *  Declares the BlockingFifo class.
+ *
+ *  @see    BlockingFifo
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/target.h"
+#include "com/diag/grandote/Object.h"
+#include "com/diag/grandote/Fifo.h"
+#include "com/diag/grandote/Mutex.h"
+#include "com/diag/grandote/CriticalSection.h"
+#include "com/diag/grandote/Condition.h"
+#include "com/diag/grandote/errno.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/Print.h"
+
+
+namespace com { namespace diag { namespace grandote {
+
+/**
+ *  Combines a Fifo with a Mutex and a pair of Conditions so that threads of
+ *  control inserting into a full queue, or removing from an empty one, can
+ *  block until there is room or there is an entry, or until a timeout
+ *  expires, instead of polling. The memory for the queue is provided by
+ *  the application, as with Fifo.
+ *
+ *  Waiting threads are signaled only when the queue goes from empty to not
+ *  empty, or from full to not full, and then only if some thread is
+ *  waiting. Because a Condition signal is a broadcast, every thread waiting
+ *  at that moment is woken; this is what makes signaling only on these
+ *  transitions safe, since any entries or room that arrive before the woken
+ *  threads run are found when each of them checks the queue again.
+ *
+ *  @see    Fifo
+ *
+ *  @see    Condition
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+template <typename _TYPE_>
+class BlockingFifo : public Object {
+
+public:
+
+    /**
+     *  Use this as the timeout if you want to block indefinitely.
+     */
+    static const ticks_t INFINITE = Condition::INFINITE;
+
+    /**
+     *  Constructor.
+     *
+     *  @param  qq          points the the start of an array of objects
+     *                      used as the queue.
+     *
+     *  @param  cc          is the countof of the number of objects in
+     *                      the array used as the queue.
+     */
+    explicit BlockingFifo(_TYPE_* qq = 0, size_t cc = 0);
+
+    /**
+     *  Destructor.
+     */
+    virtual ~BlockingFifo();
+
+    /**
+     *  Returns the number of used entries in the queue.
+     *
+     *  @return the number of used entries.
+     */
+    size_t used();
+
+    /**
+     *  Returns the number of free entries in the queue.
+     *
+     *  @return the number of free entries.
+     */
+    size_t free();
+
+    /**
+     *  Returns the total number of entries in the queue.
+     *
+     *  @return the number of free entries.
+     */
+    size_t total() const;
+
+    /**
+     *  Returns the queue to its empty state, waking any threads of control
+     *  waiting for room.
+     */
+    void reset();
+
+    /**
+     *  Inserts an object into the queue, waiting if the queue is full until
+     *  there is room for it. The object is copied into an empty position
+     *  in the queue. The object type must permit assignment semantics.
+     *
+     *  @param  entry   refers to the object from which a copy is
+     *                  made into the next unused object in the queue.
+     *
+     *  @param  timeout is the relative timeout period in platform ticks.
+     *                  Zero does not wait at all.
+     *
+     *  @return true if successful, false if the queue was still full when
+     *          the timeout expired.
+     */
+    bool insert(const _TYPE_& entry, ticks_t timeout = INFINITE);
+
+    /**
+     *  Makes a copy of the first item on the queue, but does not
+     *  remove it from the queue. This never waits.
+     *
+     *  @param  result  refers to the object into which the next used
+     *                  object is copied.
+     *
+     *  @return true if successful, false if the queue is empty.
+     */
+    bool peek(_TYPE_& result);
+
+    /**
+     *  Makes a copy of the first item on the queue, and removes it
+     *  from the queue, waiting if the queue is empty until there is an
+     *  item.
+     *
+     *  @param  result  refers to the object into which the next used
+     *                  object is copied.
+     *
+     *  @param  timeout is the relative timeout period in platform ticks.
+     *                  Zero does not wait at all.
+     *
+     *  @return true if successful, false if the queue was still empty when
+     *          the timeout expired.
+     */
+    bool remove(_TYPE_& result, ticks_t timeout = INFINITE);
+
+    /**
+     *  Displays internal information about this object to the specified
+     *  output object. Useful for debugging and troubleshooting.
+     *
+     *  @param  level   sets the verbosity of the output. What this means
+     *                  is object dependent. However, the level is passed
+     *                  from outer to inner objects this object calls the
+     *                  show methods of its inherited or composited objects.
+     *
+     *  @param display  points to the output object to which output is
+     *                  sent. If null (zero), the default platform output
+     *                  object is used as the effective output object. The
+     *                  effective output object is passed from outer to
+     *                  inner objects as this object calls the show methods
+     *                  of its inherited and composited objects.
+     *
+     *  @param  indent  specifies the level of indentation. One more than
+     *                  this value is passed from outer to inner objects
+     *                  as this object calls the show methods of its
+     *                  inherited and composited objects.
+     */
+    virtual void show(int level = 0, Output* display = 0, int indent = 0) const;
+
+private:
+
+    /**
+     *  Waits inside the critical section on a condition until a predicate
+     *  on the queue becomes false or the timeout expires.
+     *
+     *  @param  condition   refers to the condition on which to wait.
+     *
+     *  @param  waiting     refers to the count of threads of control
+     *                      waiting on the condition.
+     *
+     *  @param  blocked     is the predicate, either Fifo::free or
+     *                      Fifo::used, that is zero while the thread of
+     *                      control must wait.
+     *
+     *  @param  timeout     is the relative timeout period in platform ticks.
+     *
+     *  @return true if the predicate became non-zero, false otherwise.
+     */
+    bool wait(Condition& condition, size_t& waiting, size_t (Fifo<_TYPE_>::*blocked)() const, ticks_t timeout);
+
+    /**
+     *  This is the queue.
+     */
+    Fifo<_TYPE_> fifo;
+
+    /**
+     *  This serializes access to the queue.
+     */
+    Mutex mutex;
+
+    /**
+     *  This is signaled when the queue goes from empty to not empty.
+     */
+    Condition notempty;
+
+    /**
+     *  This is signaled when the queue goes from full to not full.
+     */
+    Condition notfull;
+
+    /**
+     *  This is the number of threads of control waiting for an entry.
+     */
+    size_t consumers;
+
+    /**
+     *  This is the number of threads of control waiting for room.
+     */
+    size_t producers;
+
+    /**
+     *  Copy constructor.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    BlockingFifo(const BlockingFifo& that);
+
+    /**
+     *  Assignment operator.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    BlockingFifo& operator=(const BlockingFifo& that);
+
+};
+
+
+//
+// Constructor
+//
+template <typename _TYPE_>
+BlockingFifo<_TYPE_>::BlockingFifo(_TYPE_* qq, size_t cc) :
+    fifo(qq, cc),
+    consumers(0),
+    producers(0)
+{
+}
+
+
+//
+//  Destructor.
+//
+template <typename _TYPE_>
+BlockingFifo<_TYPE_>::~BlockingFifo() {
+}
+
+
+//
+//  Return the number of used entries.
+//
+template <typename _TYPE_>
+size_t BlockingFifo<_TYPE_>::used() {
+    CriticalSection guard(this->mutex);
+    return this->fifo.used();
+}
+
+
+//
+//  Return the number of free entries.
+//
+template <typename _TYPE_>
+size_t BlockingFifo<_TYPE_>::free() {
+    CriticalSection guard(this->mutex);
+    return this->fifo.free();
+}
+
+
+//
+//  Return the total number of entries.
+//
+template <typename _TYPE_>
+inline size_t BlockingFifo<_TYPE_>::total() const {
+    return this->fifo.total();
+}
+
+
+//
+//  Reset to empty state.
+//
+template <typename _TYPE_>
+void BlockingFifo<_TYPE_>::reset() {
+    CriticalSection guard(this->mutex);
+    bool full = (0 == this->fifo.free());
+    this->fifo.reset();
+    if (full && (0 < this->producers)) {
+        this->notfull.signal();
+    }
+}
+
+
+//
+//  Wait for the predicate to become non-zero. The timeout is measured from
+//  the first wait, so that spurious wakeups do not extend it.
+//
+template <typename _TYPE_>
+bool BlockingFifo<_TYPE_>::wait(Condition& condition, size_t& waiting, size_t (Fifo<_TYPE_>::*blocked)() const, ticks_t timeout) {
+    if (0 == timeout) {
+        return false;
+    }
+    Platform& pl = Platform::instance();
+    ticks_t then = (INFINITE == timeout) ? 0 : pl.time();
+    ticks_t remaining = timeout;
+    ++waiting;
+    while (0 == (this->fifo.*blocked)()) {
+        if (INFINITE != timeout) {
+            ticks_t elapsed = pl.time() - then;
+            if (elapsed >= timeout) {
+                break;
+            }
+            remaining = timeout - elapsed;
+        }
+        int rc = condition.wait(this->mutex, remaining);
+        if ((0 != rc) && (ETIMEDOUT != rc)) {
+            break;
+        }
+    }
+    --waiting;
+    return (0 != (this->fifo.*blocked)());
+}
+
+
+//
+//  Insert new entry into queue.
+//
+template <typename _TYPE_>
+bool BlockingFifo<_TYPE_>::insert(const _TYPE_& entry, ticks_t timeout) {
+    CriticalSection guard(this->mutex);
+    if (0 == this->fifo.free()) {
+        if (!this->wait(this->notfull, this->producers, &Fifo<_TYPE_>::free, timeout)) {
+            return false;
+        }
+    }
+    bool empty = (0 == this->fifo.used());
+    this->fifo.insert(entry);
+    if (empty && (0 < this->consumers)) {
+        this->notempty.signal();
+    }
+    return true;
+}
+
+
+//
+//  Peek at oldest used entry in queue.
+//
+template <typename _TYPE_>
+bool BlockingFifo<_TYPE_>::peek(_TYPE_& result) {
+    CriticalSection guard(this->mutex);
+    return this->fifo.peek(result);
+}
+
+
+//
+//  Remove oldest used entry in queue.
+//
+template <typename _TYPE_>
+bool BlockingFifo<_TYPE_>::remove(_TYPE_& result, ticks_t timeout) {
+    CriticalSection guard(this->mutex);
+    if (0 == this->fifo.used()) {
+        if (!this->wait(this->notempty, this->consumers, &Fifo<_TYPE_>::used, timeout)) {
+            return false;
+        }
+    }
+    bool full = (0 == this->fifo.free());
+    this->fifo.remove(result);
+    if (full && (0 < this->producers)) {
+        this->notfull.signal();
+    }
+    return true;
+}
+
+
+//
+//  Show this object on the output object.
+//
+template <typename _TYPE_>
+void BlockingFifo<_TYPE_>::show(int level, Output* display, int indent) const {
+    Platform& pl = Platform::instance();
+    Print printf(display);
+    const char* sp = printf.output().indentation(indent);
+    char component[sizeof(__FILE__)];
+    printf("%s%s(%p)[%lu]:\n",
+        sp, pl.component(__FILE__, component, sizeof(component)),
+        this, sizeof(*this));
+    printf("%s consumers=%u\n", sp, this->consumers);
+    printf("%s producers=%u\n", sp, this->producers);
+    this->fifo.show(level, display, indent + 1);
+    this->mutex.show(level, display, indent + 1);
+}
+
+} } }
+
+
+#if defined(GRANDOTE_HAS_UNITTESTS)
+#include "com/diag/grandote/cxxcapi.h"
+/**
+ *  Run the BlockingFifo unit test.
+ *  
+ *  @return the number of errors detected by the unit test.
+ */
+CXXCAPI int unittestBlockingFifo(void);
+#endif
+
+
+#endif
@@ -294,6 +294,36 @@ public:
      */
     virtual Link* insertPrevious(Link* next, Link* link);
 
+    /**
+     *  Calls a functor for each link on this chain from first to last
+     *  until the functor returns false. Unlike Link::apply, the functor is
+     *  any type with a bool operator()(Link*), called directly rather than
+     *  through a virtual function, so the compiler can inline it into the
+     *  loop. The functor must not change the chain; use removeIf to remove
+     *  links while traversing.
+     *
+     *  @param  functor     refers to the functor.
+     *
+     *  @return a pointer to the link for which the functor returned false,
+     *          or null (0) if it returned true for every link.
+     */
+    template <typename _FUNCTOR_>
+    Link* forEach(_FUNCTOR_& functor) const;
+
+    /**
+     *  Calls a functor for each link on this chain from first to last,
+     *  removing each link for which the functor returns true. The functor
+     *  is any type with a bool operator()(Link*), called directly rather
+     *  than through a virtual function. The functor must not change the
+     *  chain itself.
+     *
+     *  @param  functor     refers to the functor.
+     *
+     *  @return the number of links removed.
+     */
+    template <typename _FUNCTOR_>
+    size_t removeIf(_FUNCTOR_& functor);
+
     /**
      *  Displays internal information about this object to the specified
      *  output object. Useful for debugging and troubleshooting.
@@ -351,6 +381,39 @@ inline bool Chain::isEmpty() const {
     return !this->isChained();
 }
 
+
+//
+//  Call a functor for each link until it returns false.
+//
+template <typename _FUNCTOR_>
+Link* Chain::forEach(_FUNCTOR_& functor) const {
+    for (Link* link = this->getNext(); this != link; link = link->getNext()) {
+        if (!functor(link)) {
+            return link;
+        }
+    }
+    return 0;
+}
+
+
+//
+//  Call a functor for each link, removing those for which it returns
+//  true. The next link is fetched before the functor sees this one.
+//
+template <typename _FUNCTOR_>
+size_t Chain::removeIf(_FUNCTOR_& functor) {
+    size_t count = 0;
+    Link* next;
+    for (Link* link = this->getNext(); this != link; link = next) {
+        next = link->getNext();
+        if (functor(link)) {
+            link->remove();
+            ++count;
+        }
+    }
+    return count;
+}
+
 } } }
 
 
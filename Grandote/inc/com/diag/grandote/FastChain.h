@@ -0,0 +1,502 @@
+#ifndef _COM_DIAG_GRANDOTE_FASTCHAIN_H_
+#define _COM_DIAG_GRANDOTE_FASTCHAIN_H_
+
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Declares the FastChain class.
+ *
+ *  @see    FastChain
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/target.h"
+#include "com/diag/grandote/Link.h"
+#include "com/diag/grandote/Output.h"
+
+
+namespace com { namespace diag { namespace grandote {
+
+/**
+ *  Implements the same circular doubly-linked list of Link objects as
+ *  Chain, with the same operations and the same semantics, including
+ *  the O(1) test for membership by comparing the root of a link to the
+ *  chain. But none of its methods are virtual, and all of them but show
+ *  are inline, so a loop that peeks, inserts, or removes links compiles
+ *  down to a handful of pointer operations with no indirect calls. The
+ *  price is that a FastChain cannot be used where a Chain is expected,
+ *  and an application cannot override its operations. It is not intended
+ *  to be derived from.
+ *
+ *  This class is not thread-safe. Serialization is the responsibility
+ *  of the caller.
+ *
+ *  @see    Chain
+ *
+ *  @see    Link
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+class FastChain : public Link {
+
+public:
+
+    /**
+     *  Constructor. This chain will be empty and its payload
+     *  pointer will be null.
+     */
+    explicit FastChain();
+
+    /**
+     *  Destructor. If this chain contains links, all of the
+     *  links are removed from the chain.
+     */
+    ~FastChain();
+
+    /**
+     *  Return true if this chain is empty.
+     *
+     *  @return true if this chain is empty.
+     */
+    bool isEmpty() const;
+
+    /**
+     *  Returns true if the specified link is on this chain.
+     *
+     *  @param  link        points to a chain link.
+     *
+     *  @return true if the link is on this chain, false otherwise.
+     */
+    bool isMember(const Link* link) const;
+
+    /**
+     *  Returns a pointer to the first link on this chain.
+     *
+     *  @return a pointer to the link or null (0) if empty.
+     */
+    Link* peekFirst() const;
+
+    /**
+     *  Returns a pointer to the last link on this chain.
+     *
+     *  @return a pointer to the link or null (0) if empty.
+     */
+    Link* peekLast() const;
+
+    /**
+     *  Returns a pointer to the link after the specified link.
+     *
+     *  @param  previous    points to a chain link on this chain.
+     *
+     *  @return a pointer to the link or null (0) if the previous link is
+     *          the last or is not on this chain.
+     */
+    Link* peekNext(const Link* previous) const;
+
+    /**
+     *  Returns a pointer to the link before the specified link.
+     *
+     *  @param  next        points to a chain link on this chain.
+     *
+     *  @return a pointer to the link or null (0) if the next link is
+     *          the first or is not on this chain.
+     */
+    Link* peekPrevious(const Link* next) const;
+
+    /**
+     *  Removes the first link on this chain.
+     *
+     *  @return a pointer to the link or null (0) if empty.
+     */
+    Link* removeFirst();
+
+    /**
+     *  Removes the last link on this chain.
+     *
+     *  @return a pointer to the link or null (0) if empty.
+     */
+    Link* removeLast();
+
+    /**
+     *  Removes the link after the specified link.
+     *
+     *  @param  previous    points to a chain link on this chain.
+     *
+     *  @return a pointer to the link or null (0) if the previous link is
+     *          the last or is not on this chain.
+     */
+    Link* removeNext(Link* previous);
+
+    /**
+     *  Removes the link before the specified link.
+     *
+     *  @param  next        points to a chain link on this chain.
+     *
+     *  @return a pointer to the link or null (0) if the next link is
+     *          the first or is not on this chain.
+     */
+    Link* removePrevious(Link* next);
+
+    /**
+     *  Inserts a link at the head of this chain.
+     *
+     *  @param  link        points to a chain link.
+     *
+     *  @return a pointer to the link or null (0) if the link is already
+     *          on a chain.
+     */
+    Link* insertFirst(Link* link);
+
+    /**
+     *  Inserts a link at the tail of this chain.
+     *
+     *  @param  link        points to a chain link.
+     *
+     *  @return a pointer to the link or null (0) if the link is already
+     *          on a chain.
+     */
+    Link* insertLast(Link* link);
+
+    /**
+     *  Inserts a link after the specified link.
+     *
+     *  @param  previous    points to a chain link on this chain.
+     *
+     *  @param  link        points to a chain link.
+     *
+     *  @return a pointer to the link or null (0) if the link is already
+     *          on a chain or the previous link is not on this chain.
+     */
+    Link* insertNext(Link* previous, Link* link);
+
+    /**
+     *  Inserts a link before the specified link.
+     *
+     *  @param  next        points to a chain link on this chain.
+     *
+     *  @param  link        points to a chain link.
+     *
+     *  @return a pointer to the link or null (0) if the link is already
+     *          on a chain or the next link is not on this chain.
+     */
+    Link* insertPrevious(Link* next, Link* link);
+
+    /**
+     *  Calls a functor for each link on this chain from first to last
+     *  until the functor returns false. The functor is any type with a
+     *  bool operator()(Link*). The functor must not change the chain.
+     *
+     *  @param  functor     refers to the functor.
+     *
+     *  @return a pointer to the link for which the functor returned false,
+     *          or null (0) if it returned true for every link.
+     */
+    template <typename _FUNCTOR_>
+    Link* forEach(_FUNCTOR_& functor) const;
+
+    /**
+     *  Calls a functor for each link on this chain from first to last,
+     *  removing each link for which the functor returns true. The functor
+     *  is any type with a bool operator()(Link*). The functor must not
+     *  change the chain itself.
+     *
+     *  @param  functor     refers to the functor.
+     *
+     *  @return the number of links removed.
+     */
+    template <typename _FUNCTOR_>
+    size_t removeIf(_FUNCTOR_& functor);
+
+    /**
+     *  Displays internal information about this object to the specified
+     *  output object. Useful for debugging and troubleshooting.
+     *
+     *  @param  level   sets the verbosity of the output. What this means
+     *                  is object dependent. However, the level is passed
+     *                  from outer to inner objects this object calls the
+     *                  show methods of its inherited or composited objects.
+     *
+     *  @param display  points to the output object to which output is
+     *                  sent. If null (zero), the default platform output
+     *                  object is used as the effective output object. The
+     *                  effective output object is passed from outer to
+     *                  inner objects as this object calls the show methods
+     *                  of its inherited and composited objects.
+     *
+     *  @param  indent  specifies the level of indentation. One more than
+     *                  this value is passed from outer to inner objects
+     *                  as this object calls the show methods of its
+     *                  inherited and composited objects.
+     */
+    void show(int level = 0, Output* display = 0, int indent = 0) const;
+
+private:
+
+    /**
+     *  Copy constructor.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    FastChain(const FastChain& that);
+
+    /**
+     *  Assignment operator.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    FastChain& operator=(const FastChain& that);
+
+};
+
+
+//
+//  Constructor.
+//
+inline FastChain::FastChain() : Link() {
+}
+
+
+//
+//  Destructor. Any links on this chain are removed.
+//
+inline FastChain::~FastChain() {
+    Link* next;
+    while (this != (next = this->getNext())) {
+        next->remove();
+    }
+}
+
+
+//
+//  Return true if this chain is empty.
+//
+inline bool FastChain::isEmpty() const {
+    return !this->isChained();
+}
+
+
+//
+//  Return true if the link has this chain as its root.
+//
+inline bool FastChain::isMember(const Link* link) const {
+    return link->hasRoot(this);
+}
+
+
+//
+//  Return the first link or null.
+//
+inline Link* FastChain::peekFirst() const {
+    Link* next = this->getNext();
+    return (this != next) ? next : 0;
+}
+
+
+//
+//  Return the last link or null.
+//
+inline Link* FastChain::peekLast() const {
+    Link* previous = this->getPrevious();
+    return (this != previous) ? previous : 0;
+}
+
+
+//
+//  Return the link after the previous link or null.
+//
+inline Link* FastChain::peekNext(const Link* previous) const {
+    if (this == previous->getRoot()) {
+        Link* next = previous->getNext();
+        if (this != next) {
+            return next;
+        }
+    }
+    return 0;
+}
+
+
+//
+//  Return the link before the next link or null.
+//
+inline Link* FastChain::peekPrevious(const Link* next) const {
+    if (this == next->getRoot()) {
+        Link* previous = next->getPrevious();
+        if (this != previous) {
+            return previous;
+        }
+    }
+    return 0;
+}
+
+
+//
+//  Remove the first link.
+//
+inline Link* FastChain::removeFirst() {
+    Link* next = this->getNext();
+    return (this != next) ? next->remove() : 0;
+}
+
+
+//
+//  Remove the last link.
+//
+inline Link* FastChain::removeLast() {
+    Link* previous = this->getPrevious();
+    return (this != previous) ? previous->remove() : 0;
+}
+
+
+//
+//  Remove the link after the previous link.
+//
+inline Link* FastChain::removeNext(Link* previous) {
+    if (this == previous->getRoot()) {
+        Link* next = previous->getNext();
+        if (this != next) {
+            return next->remove();
+        }
+    }
+    return 0;
+}
+
+
+//
+//  Remove the link before the next link.
+//
+inline Link* FastChain::removePrevious(Link* next) {
+    if (this == next->getRoot()) {
+        Link* previous = next->getPrevious();
+        if (this != previous) {
+            return previous->remove();
+        }
+    }
+    return 0;
+}
+
+
+//
+//  Insert a link first.
+//
+inline Link* FastChain::insertFirst(Link* link) {
+    return link->isChained() ? 0 : link->insert(this);
+}
+
+
+//
+//  Insert a link last.
+//
+inline Link* FastChain::insertLast(Link* link) {
+    return link->isChained() ? 0 : link->insert(this->getPrevious());
+}
+
+
+//
+//  Insert a link after the previous link.
+//
+inline Link* FastChain::insertNext(Link* previous, Link* link) {
+    return (this == previous->getRoot()) ? link->insert(previous) : 0;
+}
+
+
+//
+//  Insert a link before the next link.
+//
+inline Link* FastChain::insertPrevious(Link* next, Link* link) {
+    return (this == next->getRoot()) ? link->insert(next->getPrevious()) : 0;
+}
+
+
+//
+//  Call a functor for each link until it returns false.
+//
+template <typename _FUNCTOR_>
+Link* FastChain::forEach(_FUNCTOR_& functor) const {
+    for (Link* link = this->getNext(); this != link; link = link->getNext()) {
+        if (!functor(link)) {
+            return link;
+        }
+    }
+    return 0;
+}
+
+
+//
+//  Call a functor for each link, removing those for which it returns
+//  true.
+//
+template <typename _FUNCTOR_>
+size_t FastChain::removeIf(_FUNCTOR_& functor) {
+    size_t count = 0;
+    Link* next;
+    for (Link* link = this->getNext(); this != link; link = next) {
+        next = link->getNext();
+        if (functor(link)) {
+            link->remove();
+            ++count;
+        }
+    }
+    return count;
+}
+
+} } }
+
+
+#if defined(GRANDOTE_HAS_UNITTESTS)
+#include "com/diag/grandote/cxxcapi.h"
+/**
+ *  Run the FastChain unit test.
+ *
+ *  @return the number of errors detected.
+ */
+CXXCAPI int unittestFastChain(void);
+#endif
+
+
+#endif
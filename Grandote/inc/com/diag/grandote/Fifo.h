@@ -62,6 +62,7 @@
 #include "com/diag/grandote/Platform.h"
 #include "com/diag/grandote/Print.h"
 #include "com/diag/grandote/Dump.h"
+#include <algorithm>
 
 
 namespace com { namespace diag { namespace grandote {
@@ -175,6 +176,82 @@ public:
      */
     bool remove(_TYPE_& result);
 
+    /**
+     *  Inserts as many objects from an array into the queue as there is
+     *  room for. The objects are copied in at most two contiguous runs,
+     *  one on either side of the point at which the queue wraps around.
+     *
+     *  @param  entries points to the array of objects from which copies
+     *                  are made into the unused objects in the queue.
+     *
+     *  @param  count   is the number of objects in the array.
+     *
+     *  @return the number of objects inserted, which is less than count
+     *          if the queue became full.
+     */
+    size_t insert(const _TYPE_* entries, size_t count);
+
+    /**
+     *  Removes as many objects from the queue into an array as there are,
+     *  up to the size of the array. The objects are copied out in at most
+     *  two contiguous runs.
+     *
+     *  @param  results points to the array into which the used objects
+     *                  in the queue are copied.
+     *
+     *  @param  count   is the number of objects in the array.
+     *
+     *  @return the number of objects removed, which is less than count
+     *          if the queue became empty.
+     */
+    size_t remove(_TYPE_* results, size_t count);
+
+    /**
+     *  Returns a pointer to the contiguous run of unused objects in the
+     *  queue into which the next objects would be inserted, so that they
+     *  can be placed there directly and then claimed by commit(). The run
+     *  stops at the point at which the queue wraps around.
+     *
+     *  @param  count   is set to the number of unused objects in the run,
+     *                  which is zero if the queue is full.
+     *
+     *  @return a pointer to the first unused object in the run.
+     */
+    _TYPE_* reserve(size_t& count);
+
+    /**
+     *  Claims as inserted no more than the specified number of objects
+     *  placed in the run returned by reserve().
+     *
+     *  @param  count   is the number of objects to claim.
+     *
+     *  @return the number of objects actually claimed.
+     */
+    size_t commit(size_t count);
+
+    /**
+     *  Returns a pointer to the contiguous run of used objects at the front
+     *  of the queue, so that they can be used directly and then discarded
+     *  by release(). The run stops at the point at which the queue wraps
+     *  around.
+     *
+     *  @param  count   is set to the number of used objects in the run,
+     *                  which is zero if the queue is empty.
+     *
+     *  @return a pointer to the first used object in the run.
+     */
+    const _TYPE_* peekSpan(size_t& count) const;
+
+    /**
+     *  Removes no more than the specified number of objects from the front
+     *  of the queue without copying them.
+     *
+     *  @param  count   is the number of objects to remove.
+     *
+     *  @return the number of objects actually removed.
+     */
+    size_t release(size_t count);
+
     /**
      *  Displays internal information about this object to the specified
      *  output object. Useful for debugging and troubleshooting.
@@ -345,6 +422,115 @@ bool Fifo<_TYPE_>::remove(_TYPE_& result) {
 }
 
 
+//
+//  Insert an array of entries into queue in at most two runs.
+//
+template <typename _TYPE_>
+size_t Fifo<_TYPE_>::insert(const _TYPE_* entries, size_t count) {
+    size_t total = 0;
+    size_t run;
+    while (0 < count) {
+        this->reserve(run);
+        if (0 == run) {
+            break;
+        }
+        if (run > count) {
+            run = count;
+        }
+        std::copy(entries, entries + run,
+            &(this->queue[this->head & this->mask]));
+        this->head += run;
+        entries += run;
+        count -= run;
+        total += run;
+    }
+    return total;
+}
+
+
+//
+//  Remove used entries from queue into an array in at most two runs.
+//
+template <typename _TYPE_>
+size_t Fifo<_TYPE_>::remove(_TYPE_* results, size_t count) {
+    size_t total = 0;
+    size_t run;
+    const _TYPE_* here;
+    while (0 < count) {
+        here = this->peekSpan(run);
+        if (0 == run) {
+            break;
+        }
+        if (run > count) {
+            run = count;
+        }
+        std::copy(here, here + run, results);
+        this->tail += run;
+        results += run;
+        count -= run;
+        total += run;
+    }
+    return total;
+}
+
+
+//
+//  Return the run of unused entries up to the wrap point.
+//
+template <typename _TYPE_>
+inline _TYPE_* Fifo<_TYPE_>::reserve(size_t& count) {
+    size_t ii = this->head & this->mask;
+    count = this->free();
+    if (count > (this->count - ii)) {
+        count = this->count - ii;
+    }
+    return &(this->queue[ii]);
+}
+
+
+//
+//  Claim entries placed in the run of unused entries.
+//
+template <typename _TYPE_>
+inline size_t Fifo<_TYPE_>::commit(size_t count) {
+    size_t run;
+    this->reserve(run);
+    if (count > run) {
+        count = run;
+    }
+    this->head += count;
+    return count;
+}
+
+
+//
+//  Return the run of used entries up to the wrap point.
+//
+template <typename _TYPE_>
+inline const _TYPE_* Fifo<_TYPE_>::peekSpan(size_t& count) const {
+    size_t ii = this->tail & this->mask;
+    count = this->used();
+    if (count > (this->count - ii)) {
+        count = this->count - ii;
+    }
+    return &(this->queue[ii]);
+}
+
+
+//
+//  Discard used entries from the front of the queue.
+//
+template <typename _TYPE_>
+inline size_t Fifo<_TYPE_>::release(size_t count) {
+    size_t used = this->used();
+    if (count > used) {
+        count = used;
+    }
+    this->tail += count;
+    return count;
+}
+
+
 //
 //  Show this object on the output object.
 //
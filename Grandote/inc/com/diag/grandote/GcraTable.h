@@ -0,0 +1,356 @@
+#ifndef _COM_DIAG_GRANDOTE_GCRATABLE_H_
+#define _COM_DIAG_GRANDOTE_GCRATABLE_H_
+
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Declares the GcraTable class.
+ *
+ *  @see    GcraTable
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/target.h"
+#include "com/diag/grandote/types.h"
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/Tat.h"
+#include "com/diag/grandote/Output.h"
+
+
+namespace com { namespace diag { namespace grandote {
+
+/**
+ *  Polices many flows, each with its own Generic Cell Rate Algorithm (GCRA)
+ *  contract, using the same arithmetic as Gcra but keeping the state of
+ *  all of the flows in parallel arrays indexed by a flow number: the
+ *  increment, the limit, the maximum event count before overflow, and
+ *  the theoretical arrival time (TAT) of the next event, which is then
+ *  plus x in the terminology of Gcra. Policing a burst of events touches
+ *  only the array elements of the flows involved, with no virtual calls
+ *  and no pointer chasing, which is what matters when there are a hundred
+ *  thousand flows and a cache that holds a fraction of them.
+ *
+ *  Each decision is one-shot: the events are admitted and charged to the
+ *  flow, as with Gcra::admissible followed by Gcra::commit, or refused
+ *  leaving the flow unchanged, as with Gcra::rollback. A newly constructed
+ *  flow has the contract of Gcra's default constructor, which admits
+ *  everything, until it is configured.
+ *
+ *  The batch admit method evaluates its events strictly in order, so that
+ *  several events for the same flow in one batch are each charged before
+ *  the next is evaluated, and its loop body is free of branches other
+ *  than the loop itself. This class is not thread safe.
+ *
+ *  @see    Gcra
+ *
+ *  @see    AtomicGcra
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+class GcraTable {
+
+public:
+
+    /**
+     *  Constructor.
+     *
+     *  @param  count       is the number of flows.
+     */
+    explicit GcraTable(size_t count);
+
+    /**
+     *  Destructor.
+     */
+    virtual ~GcraTable();
+
+    /**
+     *  Returns the number of flows.
+     *
+     *  @return the number of flows.
+     */
+    size_t size() const;
+
+    /**
+     *  Sets the traffic contract of a flow and resets it.
+     *
+     *  @param  flow        is the flow number.
+     *
+     *  @param  increment   is the GCRA increment or I in throttle ticks.
+     *
+     *  @param  limit       is the GCRA limit or L in throttle ticks.
+     *
+     *  @param  ticks       is the current time in throttle ticks.
+     */
+    void configure(size_t flow, ticks_t increment, ticks_t limit, ticks_t ticks);
+
+    /**
+     *  Resets a flow to its just-configured state, in which an event is
+     *  immediately admissible.
+     *
+     *  @param  flow        is the flow number.
+     *
+     *  @param  ticks       is the current time in throttle ticks.
+     */
+    void reset(size_t flow, ticks_t ticks);
+
+    /**
+     *  Returns the number of ticks that an event on a flow must be delayed
+     *  to be admissible at the specified time, without admitting it.
+     *
+     *  @param  flow        is the flow number.
+     *
+     *  @param  ticks       is the current time in throttle ticks.
+     *
+     *  @return the delay in ticks, or zero if admissible.
+     */
+    ticks_t admissible(size_t flow, ticks_t ticks) const;
+
+    /**
+     *  Admits the specified number of events on a flow at the specified
+     *  time if they are admissible.
+     *
+     *  @param  flow        is the flow number.
+     *
+     *  @param  n           is the number of events.
+     *
+     *  @param  ticks       is the current time in throttle ticks.
+     *
+     *  @return true if admitted, false otherwise.
+     */
+    bool admit(size_t flow, size_t n, ticks_t ticks);
+
+    /**
+     *  Decides a batch of events, all at the same time, in order. Event k
+     *  is sizes[k] events on flow which[k], and its verdict is stored in
+     *  verdicts[k].
+     *
+     *  @param  which       points to an array of flow numbers.
+     *
+     *  @param  sizes       points to an array of event counts.
+     *
+     *  @param  count       is the number of elements in each array.
+     *
+     *  @param  ticks       is the current time in throttle ticks.
+     *
+     *  @param  verdicts    points to an array into which true is stored for
+     *                      each admitted event and false for each refused.
+     *
+     *  @return the number of events admitted.
+     */
+    size_t admit(const size_t which[], const size_t sizes[], size_t count, ticks_t ticks, bool verdicts[]);
+
+    /**
+     *  Returns the GCRA increment of a flow.
+     *
+     *  @param  flow        is the flow number.
+     *
+     *  @return the GCRA increment in throttle ticks.
+     */
+    ticks_t getIncrement(size_t flow) const;
+
+    /**
+     *  Returns the GCRA limit of a flow.
+     *
+     *  @param  flow        is the flow number.
+     *
+     *  @return the GCRA limit in throttle ticks.
+     */
+    ticks_t getLimit(size_t flow) const;
+
+    /**
+     *  Returns true if the event stream on a flow is sufficiently out of
+     *  specification such that its throttle is now only approximate. This
+     *  occurs because of integer overflow in the theoretical arrival time.
+     *
+     *  @param  flow        is the flow number.
+     *
+     *  @return true if the throttle is approximate, false otherwise.
+     */
+    bool isApproximate(size_t flow) const;
+
+    /**
+     *  Displays internal information about this object to the specified
+     *  output object. Useful for debugging and troubleshooting.
+     *
+     *  @param  level   sets the verbosity of the output. What this means
+     *                  is object dependent. However, the level is passed
+     *                  from outer to inner objects this object calls the
+     *                  show methods of its inherited or composited objects.
+     *
+     *  @param display  points to the output object to which output is
+     *                  sent. If null (zero), the default platform output
+     *                  object is used as the effective output object. The
+     *                  effective output object is passed from outer to
+     *                  inner objects as this object calls the show methods
+     *                  of its inherited and composited objects.
+     *
+     *  @param  indent  specifies the level of indentation. One more than
+     *                  this value is passed from outer to inner objects
+     *                  as this object calls the show methods of its
+     *                  inherited and composited objects.
+     */
+    virtual void show(int level = 0, Output* display = 0, int indent = 0) const;
+
+private:
+
+    /**
+     *  Number of flows.
+     */
+    size_t flows;
+
+    /**
+     *  Theoretical arrival time of the next event on each flow.
+     */
+    ticks_t* tat;
+
+    /**
+     *  Virtual scheduler increment of each flow.
+     */
+    ticks_t* i;
+
+    /**
+     *  Virtual scheduler limit of each flow.
+     */
+    ticks_t* l;
+
+    /**
+     *  Maximum possible number of events of each flow.
+     */
+    ticks_t* max;
+
+    /**
+     *  If true then the throttle of the flow is approximate.
+     */
+    bool* approximate;
+
+    /**
+     *  Copy constructor.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    GcraTable(const GcraTable& that);
+
+    /**
+     *  Assignment operator.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    GcraTable& operator=(const GcraTable& that);
+
+};
+
+
+//
+//  Return the number of flows.
+//
+inline size_t GcraTable::size() const {
+    return this->flows;
+}
+
+
+//
+//  Return the delay until admissible.
+//
+inline ticks_t GcraTable::admissible(size_t flow, ticks_t ticks) const {
+    return Tat::delay(this->tat[flow], this->l[flow], ticks);
+}
+
+
+//
+//  Admit the events if admissible, using selections rather than branches.
+//
+inline bool GcraTable::admit(size_t flow, size_t n, ticks_t ticks) {
+    ticks_t expected = this->tat[flow];
+    bool admitted = (Tat::delay(expected, this->l[flow], ticks) == 0);
+    bool saturated;
+    ticks_t desired = Tat::advance(expected, n, this->i[flow], this->max[flow], ticks, saturated);
+    this->tat[flow] = admitted ? desired : expected;
+    this->approximate[flow] = this->approximate[flow] || (admitted && saturated);
+    return admitted;
+}
+
+
+//
+//  Return the increment.
+//
+inline ticks_t GcraTable::getIncrement(size_t flow) const {
+    return this->i[flow];
+}
+
+
+//
+//  Return the limit.
+//
+inline ticks_t GcraTable::getLimit(size_t flow) const {
+    return this->l[flow];
+}
+
+
+//
+//  Return the approximation state.
+//
+inline bool GcraTable::isApproximate(size_t flow) const {
+    return this->approximate[flow];
+}
+
+} } }
+
+
+#if defined(GRANDOTE_HAS_UNITTESTS)
+#include "com/diag/grandote/cxxcapi.h"
+/**
+ *  Run the GcraTable unit test.
+ *
+ *  @return the number of errors detected.
+ */
+CXXCAPI int unittestGcraTable(void);
+#endif
+
+
+#endif
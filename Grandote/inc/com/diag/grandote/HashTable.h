@@ -0,0 +1,824 @@
+#ifndef _COM_DIAG_GRANDOTE_HASHTABLE_H_
+#define _COM_DIAG_GRANDOTE_HASHTABLE_H_
+
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Declares the HashTable, HashNode and HashFunction templates.
+ *
+ *  @see    HashTable
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/target.h"
+#include "com/diag/grandote/LinkType.h"
+#include "com/diag/grandote/Chain.h"
+#include "com/diag/grandote/Print.h"
+#include "com/diag/grandote/Platform.h"
+
+
+namespace com { namespace diag { namespace grandote {
+
+/**
+ *  Implements the default hash functor for integral keys. The key is run
+ *  through the finalizer of MurmurHash3 so that keys that differ only in
+ *  their high order bits, or that are all multiples of some power of two,
+ *  still spread across a table whose size is a power of two.
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+template <typename _KEY_>
+struct HashFunction {
+
+    /**
+     *  Returns the hash of a key.
+     *
+     *  @param  key     refers to the key.
+     *
+     *  @return the hash of the key.
+     */
+    size_t operator()(const _KEY_& key) const {
+        uint64_t value = static_cast<uint64_t>(key);
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdULL;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ULL;
+        value ^= value >> 33;
+        return static_cast<size_t>(value);
+    }
+
+};
+
+/**
+ *  Implements the default hash functor for pointer keys.
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+template <typename _KEY_>
+struct HashFunction<_KEY_*> {
+
+    /**
+     *  Returns the hash of a key.
+     *
+     *  @param  key     refers to the key.
+     *
+     *  @return the hash of the key.
+     */
+    size_t operator()(_KEY_* const & key) const {
+        return HashFunction<uintptr_t>()(reinterpret_cast<uintptr_t>(key));
+    }
+
+};
+
+/**
+ *  Implements a node in an intrusive HashTable. Like LinkType, of which it
+ *  is a kind, the node is embedded in (or otherwise owned by) the payload
+ *  object that it points to. The node carries the key of its payload and,
+ *  once it is on a table, the hash of that key, so that neither is
+ *  recomputed when the table is searched or rehashed.
+ *
+ *  The key must not be changed while the node is on a table.
+ *
+ *  @see    HashTable
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+template <typename _KEY_, typename _TYPE_>
+class HashNode : public LinkType<_TYPE_> {
+
+    template <typename _ANYKEY_, typename _ANYTYPE_, typename _ANYHASH_> friend class HashTable;
+
+public:
+
+    /**
+     *  Constructor. A newly constructed node is on no table.
+     *
+     *  @param  object      points to the payload of this node.
+     *
+     *  @param  value       refers to the key of this node.
+     */
+    explicit HashNode(_TYPE_* object = 0, const _KEY_& value = _KEY_());
+
+    /**
+     *  Destructor. A node must be removed from its table before it is
+     *  destroyed, since it cannot correct the count of a table it is
+     *  still on. Destroying a chained node is fatal.
+     */
+    ~HashNode();
+
+    /**
+     *  Gets the key of this node.
+     *
+     *  @return the key of this node.
+     */
+    const _KEY_& getKey() const;
+
+    /**
+     *  Sets the key of this node.
+     *
+     *  @param  value       refers to the new key of this node.
+     *
+     *  @return true if successful, false if this node is on a table.
+     */
+    bool setKey(const _KEY_& value);
+
+    /**
+     *  Displays internal information about this object to the specified
+     *  output object. Useful for debugging and troubleshooting.
+     *
+     *  @param  level   sets the verbosity of the output. What this means
+     *                  is object dependent. However, the level is passed
+     *                  from outer to inner objects this object calls the
+     *                  show methods of its inherited or composited objects.
+     *
+     *  @param display  points to the output object to which output is
+     *                  sent. If null (zero), the default platform output
+     *                  object is used as the effective output object. The
+     *                  effective output object is passed from outer to
+     *                  inner objects as this object calls the show methods
+     *                  of its inherited and composited objects.
+     *
+     *  @param  indent  specifies the level of indentation. One more than
+     *                  this value is passed from outer to inner objects
+     *                  as this object calls the show methods of its
+     *                  inherited and composited objects.
+     */
+    void show(int level = 0, Output* display = 0, int indent = 0) const;
+
+private:
+
+    /**
+     *  This is the key.
+     */
+    _KEY_ key;
+
+    /**
+     *  This is the hash of the key, valid while the node is on a table.
+     */
+    size_t hash;
+
+    /**
+     *  Copy constructor.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    HashNode(const HashNode<_KEY_, _TYPE_>& that);
+
+    /**
+     *  Assignment operator.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    HashNode<_KEY_, _TYPE_>& operator=(const HashNode<_KEY_, _TYPE_>& that);
+
+};
+
+
+//
+//  Constructor.
+//
+template <typename _KEY_, typename _TYPE_>
+inline HashNode<_KEY_, _TYPE_>::HashNode(_TYPE_* object, const _KEY_& value) :
+    LinkType<_TYPE_>(object),
+    key(value),
+    hash(0)
+{
+}
+
+
+//
+//  Destructor.
+//
+template <typename _KEY_, typename _TYPE_>
+inline HashNode<_KEY_, _TYPE_>::~HashNode() {
+    if (this->isChained()) {
+        Platform::instance().fatal("HashNode destroyed while in a table", 0, __FILE__, __LINE__, __func__);
+    }
+}
+
+
+//
+//  Return the key.
+//
+template <typename _KEY_, typename _TYPE_>
+inline const _KEY_& HashNode<_KEY_, _TYPE_>::getKey() const {
+    return this->key;
+}
+
+
+//
+//  Set the key if not on a table.
+//
+template <typename _KEY_, typename _TYPE_>
+inline bool HashNode<_KEY_, _TYPE_>::setKey(const _KEY_& value) {
+    if (this->isChained()) {
+        return false;
+    }
+    this->key = value;
+    return true;
+}
+
+
+//
+//  Show this object on the output object.
+//
+template <typename _KEY_, typename _TYPE_>
+void HashNode<_KEY_, _TYPE_>::show(int level, Output* display, int indent) const {
+    Platform& pl = Platform::instance();
+    Print printf(display);
+    const char* sp = printf.output().indentation(indent);
+    char component[sizeof(__FILE__)];
+    printf("%s%s(%p)[%lu]:\n",
+        sp, pl.component(__FILE__, component, sizeof(component)),
+        this, sizeof(*this));
+    printf("%s hash=0x%lx\n", sp, this->hash);
+    this->LinkType<_TYPE_>::show(level, display, indent + 1);
+}
+
+
+/**
+ *  Implements an intrusive hash table of HashNode objects, each bucket of
+ *  which is a Chain. The number of buckets is a power of two. When the
+ *  number of nodes exceeds the number of buckets times the load factor,
+ *  the table allocates a bucket array twice as large, but rather than
+ *  moving every node at once, which would stall the one unlucky insert
+ *  that triggered it, it moves the contents of a couple of the old buckets
+ *  on each subsequent insert or remove. Until the move is complete, a
+ *  search looks in whichever of the two arrays holds the bucket for the
+ *  key. So no single operation costs more than a small constant number of
+ *  bucket moves, apart from the allocation of the new array itself.
+ *
+ *  Keys are compared using the equality operator of the key type, and
+ *  hashed by the hash functor, which defaults to HashFunction. Keys are
+ *  unique: a node whose key is already on the table is not inserted.
+ *
+ *  Putting a node on the table, or taking it off, allocates no memory.
+ *  Removing a node by its handle is O(1).
+ *
+ *  This class is not thread-safe. Serialization is the responsibility
+ *  of the caller.
+ *
+ *  @see    HashNode
+ *
+ *  @see    Chain
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+template <typename _KEY_, typename _TYPE_, typename _HASH_ = HashFunction<_KEY_> >
+class HashTable {
+
+public:
+
+    /**
+     *  This is the type of node on this table.
+     */
+    typedef HashNode<_KEY_, _TYPE_> Node;
+
+    /**
+     *  This is the number of old buckets moved to the new bucket array on
+     *  every insert or remove while the table is being rehashed. Since the
+     *  table doubles when the count of nodes reaches the number of old
+     *  buckets times the load factor, any value greater than one
+     *  guarantees that the move completes before the table must grow
+     *  again.
+     */
+    static const size_t MIGRATE = 2;
+
+    /**
+     *  Constructor.
+     *
+     *  @param  buckets     is the initial number of buckets, rounded up to
+     *                      a power of two.
+     *
+     *  @param  factor      is the average number of nodes per bucket above
+     *                      which the table grows. Zero means never grow.
+     *
+     *  @param  hasher      refers to the hash functor.
+     */
+    explicit HashTable(size_t buckets = 16, size_t factor = 2, const _HASH_& hasher = _HASH_());
+
+    /**
+     *  Destructor. Any nodes still on this table are left in the state
+     *  of being on no table.
+     */
+    ~HashTable();
+
+    /**
+     *  Returns the number of nodes on this table.
+     *
+     *  @return the number of nodes on this table.
+     */
+    size_t size() const;
+
+    /**
+     *  Returns true if this table is empty.
+     *
+     *  @return true if this table is empty.
+     */
+    bool empty() const;
+
+    /**
+     *  Returns the number of buckets in the current bucket array.
+     *
+     *  @return the number of buckets.
+     */
+    size_t buckets() const;
+
+    /**
+     *  Returns true if nodes are still being moved from the old bucket
+     *  array to the current one.
+     *
+     *  @return true if rehashing.
+     */
+    bool isRehashing() const;
+
+    /**
+     *  Inserts a node onto this table.
+     *
+     *  @param  node        refers to the node.
+     *
+     *  @return true if successful, false if the node is already on a table
+     *          or a node with the same key is already on this table.
+     */
+    bool insert(Node& node);
+
+    /**
+     *  Finds the node with a key.
+     *
+     *  @param  key         refers to the key.
+     *
+     *  @return a pointer to the node or null (0) if none.
+     */
+    Node* find(const _KEY_& key) const;
+
+    /**
+     *  Removes the node with a key.
+     *
+     *  @param  key         refers to the key.
+     *
+     *  @return a pointer to the node or null (0) if none.
+     */
+    Node* remove(const _KEY_& key);
+
+    /**
+     *  Removes a node by its handle.
+     *
+     *  @param  node        refers to the node.
+     *
+     *  @return a pointer to the node or null (0) if it is not on this
+     *          table.
+     */
+    Node* remove(Node& node);
+
+    /**
+     *  Removes all nodes from this table, leaving each in the state of
+     *  being on no table. The bucket arrays are kept.
+     */
+    void clear();
+
+    /**
+     *  Displays internal information about this object to the specified
+     *  output object. Useful for debugging and troubleshooting.
+     *
+     *  @param  level   sets the verbosity of the output. What this means
+     *                  is object dependent. However, the level is passed
+     *                  from outer to inner objects this object calls the
+     *                  show methods of its inherited or composited objects.
+     *
+     *  @param display  points to the output object to which output is
+     *                  sent. If null (zero), the default platform output
+     *                  object is used as the effective output object. The
+     *                  effective output object is passed from outer to
+     *                  inner objects as this object calls the show methods
+     *                  of its inherited and composited objects.
+     *
+     *  @param  indent  specifies the level of indentation. One more than
+     *                  this value is passed from outer to inner objects
+     *                  as this object calls the show methods of its
+     *                  inherited and composited objects.
+     */
+    void show(int level = 0, Output* display = 0, int indent = 0) const;
+
+private:
+
+    /**
+     *  Returns the bucket in which a hash is found.
+     *
+     *  @param  hash        is the hash.
+     *
+     *  @return a reference to the bucket.
+     */
+    Chain& bucket(size_t hash) const;
+
+    /**
+     *  Searches a bucket for a key.
+     *
+     *  @param  chain       refers to the bucket.
+     *
+     *  @param  hash        is the hash of the key.
+     *
+     *  @param  key         refers to the key.
+     *
+     *  @return a pointer to the node or null (0) if none.
+     */
+    static Node* search(const Chain& chain, size_t hash, const _KEY_& key);
+
+    /**
+     *  Allocates a bucket array twice as large and starts rehashing.
+     */
+    void grow();
+
+    /**
+     *  Moves the contents of up to the specified number of old buckets.
+     *
+     *  @param  limit       is the maximum number of buckets to move.
+     */
+    void migrate(size_t limit);
+
+    /**
+     *  Points to the current bucket array.
+     */
+    Chain* table;
+
+    /**
+     *  Is the number of buckets in the current array less one.
+     */
+    size_t mask;
+
+    /**
+     *  Points to the old bucket array while rehashing, else null.
+     */
+    Chain* old;
+
+    /**
+     *  Is the number of buckets in the old array less one.
+     */
+    size_t oldmask;
+
+    /**
+     *  Is the index of the next old bucket to be moved. All old buckets
+     *  before it are empty.
+     */
+    size_t cursor;
+
+    /**
+     *  Is the number of nodes on this table.
+     */
+    size_t count;
+
+    /**
+     *  Is the load factor.
+     */
+    size_t load;
+
+    /**
+     *  Is the hash functor.
+     */
+    _HASH_ function;
+
+    /**
+     *  Copy constructor.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    HashTable(const HashTable<_KEY_, _TYPE_, _HASH_>& that);
+
+    /**
+     *  Assignment operator.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    HashTable<_KEY_, _TYPE_, _HASH_>& operator=(const HashTable<_KEY_, _TYPE_, _HASH_>& that);
+
+};
+
+
+//
+//  Constructor.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+HashTable<_KEY_, _TYPE_, _HASH_>::HashTable(size_t buckets, size_t factor, const _HASH_& hasher) :
+    table(0),
+    mask(0),
+    old(0),
+    oldmask(0),
+    cursor(0),
+    count(0),
+    load(factor),
+    function(hasher)
+{
+    size_t size = 1;
+    while (size < buckets) {
+        size <<= 1;
+    }
+    this->table = new Chain[size];
+    this->mask = size - 1;
+}
+
+
+//
+//  Destructor. Destroying the chains unchains their links.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+HashTable<_KEY_, _TYPE_, _HASH_>::~HashTable() {
+    delete [] this->old;
+    delete [] this->table;
+}
+
+
+//
+//  Return the number of nodes.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+inline size_t HashTable<_KEY_, _TYPE_, _HASH_>::size() const {
+    return this->count;
+}
+
+
+//
+//  Return true if empty.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+inline bool HashTable<_KEY_, _TYPE_, _HASH_>::empty() const {
+    return this->count == 0;
+}
+
+
+//
+//  Return the number of buckets.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+inline size_t HashTable<_KEY_, _TYPE_, _HASH_>::buckets() const {
+    return this->mask + 1;
+}
+
+
+//
+//  Return true if rehashing.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+inline bool HashTable<_KEY_, _TYPE_, _HASH_>::isRehashing() const {
+    return this->old != 0;
+}
+
+
+//
+//  Return the bucket for a hash: the old one if it has yet to be moved.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+inline Chain& HashTable<_KEY_, _TYPE_, _HASH_>::bucket(size_t hash) const {
+    if (this->old != 0) {
+        size_t index = hash & this->oldmask;
+        if (index >= this->cursor) {
+            return this->old[index];
+        }
+    }
+    return this->table[hash & this->mask];
+}
+
+
+//
+//  Search a bucket. The links are walked directly rather than through
+//  the virtual peek methods of Chain.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+inline typename HashTable<_KEY_, _TYPE_, _HASH_>::Node* HashTable<_KEY_, _TYPE_, _HASH_>::search(const Chain& chain, size_t hash, const _KEY_& key) {
+    for (Link* link = chain.getNext(); link != &chain; link = link->getNext()) {
+        Node* node = static_cast<Node*>(link);
+        if ((node->hash == hash) && (node->key == key)) {
+            return node;
+        }
+    }
+    return 0;
+}
+
+
+//
+//  Start rehashing into an array twice as large. Any rehash still in
+//  progress is finished first.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+void HashTable<_KEY_, _TYPE_, _HASH_>::grow() {
+    if (this->old != 0) {
+        this->migrate(this->oldmask + 1);
+    }
+    this->old = this->table;
+    this->oldmask = this->mask;
+    this->cursor = 0;
+    this->table = new Chain[(this->mask + 1) * 2];
+    this->mask = (this->mask * 2) + 1;
+}
+
+
+//
+//  Move the contents of some old buckets into the current array.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+void HashTable<_KEY_, _TYPE_, _HASH_>::migrate(size_t limit) {
+    if (this->old == 0) {
+        return;
+    }
+    while ((limit > 0) && (this->cursor <= this->oldmask)) {
+        Chain& chain = this->old[this->cursor];
+        Link* link;
+        while ((link = chain.removeFirst()) != 0) {
+            Node* node = static_cast<Node*>(link);
+            this->table[node->hash & this->mask].insertFirst(node);
+        }
+        ++this->cursor;
+        --limit;
+    }
+    if (this->cursor > this->oldmask) {
+        delete [] this->old;
+        this->old = 0;
+        this->oldmask = 0;
+        this->cursor = 0;
+    }
+}
+
+
+//
+//  Insert a node.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+bool HashTable<_KEY_, _TYPE_, _HASH_>::insert(Node& node) {
+    if (node.isChained()) {
+        return false;
+    }
+    this->migrate(MIGRATE);
+    size_t hash = this->function(node.key);
+    if (search(this->bucket(hash), hash, node.key) != 0) {
+        return false;
+    }
+    if ((this->load > 0) && (this->count >= ((this->mask + 1) * this->load))) {
+        this->grow();
+    }
+    node.hash = hash;
+    this->bucket(hash).insertFirst(&node);
+    ++this->count;
+    return true;
+}
+
+
+//
+//  Find a node by key.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+typename HashTable<_KEY_, _TYPE_, _HASH_>::Node* HashTable<_KEY_, _TYPE_, _HASH_>::find(const _KEY_& key) const {
+    size_t hash = this->function(key);
+    return search(this->bucket(hash), hash, key);
+}
+
+
+//
+//  Remove a node by key.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+typename HashTable<_KEY_, _TYPE_, _HASH_>::Node* HashTable<_KEY_, _TYPE_, _HASH_>::remove(const _KEY_& key) {
+    Node* node = this->find(key);
+    if (node != 0) {
+        node->remove();
+        --this->count;
+        this->migrate(MIGRATE);
+    }
+    return node;
+}
+
+
+//
+//  Remove a node by handle.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+typename HashTable<_KEY_, _TYPE_, _HASH_>::Node* HashTable<_KEY_, _TYPE_, _HASH_>::remove(Node& node) {
+    if (!node.isChained() || !this->bucket(node.hash).isMember(&node)) {
+        return 0;
+    }
+    node.remove();
+    --this->count;
+    this->migrate(MIGRATE);
+    return &node;
+}
+
+
+//
+//  Remove all nodes.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+void HashTable<_KEY_, _TYPE_, _HASH_>::clear() {
+    if (this->old != 0) {
+        for (size_t index = 0; index <= this->oldmask; ++index) {
+            while (this->old[index].removeFirst() != 0) {
+            }
+        }
+        delete [] this->old;
+        this->old = 0;
+        this->oldmask = 0;
+        this->cursor = 0;
+    }
+    for (size_t index = 0; index <= this->mask; ++index) {
+        while (this->table[index].removeFirst() != 0) {
+        }
+    }
+    this->count = 0;
+}
+
+
+//
+//  Show this object on the output object.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+void HashTable<_KEY_, _TYPE_, _HASH_>::show(int level, Output* display, int indent) const {
+    Platform& pl = Platform::instance();
+    Print printf(display);
+    const char* sp = printf.output().indentation(indent);
+    char component[sizeof(__FILE__)];
+    printf("%s%s(%p)[%lu]:\n",
+        sp, pl.component(__FILE__, component, sizeof(component)),
+        this, sizeof(*this));
+    printf("%s count=%lu\n", sp, this->count);
+    printf("%s load=%lu\n", sp, this->load);
+    printf("%s buckets=%lu\n", sp, this->mask + 1);
+    printf("%s old=%p\n", sp, this->old);
+    printf("%s oldbuckets=%lu\n", sp, (this->old != 0) ? this->oldmask + 1 : 0);
+    printf("%s cursor=%lu\n", sp, this->cursor);
+    if (level > 0) {
+        size_t longest = 0;
+        size_t empty = 0;
+        for (size_t index = 0; index <= this->mask; ++index) {
+            size_t length = 0;
+            const Chain& chain = this->table[index];
+            for (Link* link = chain.getNext(); link != &chain; link = link->getNext()) {
+                ++length;
+            }
+            if (length == 0) {
+                ++empty;
+            } else if (length > longest) {
+                longest = length;
+            }
+        }
+        printf("%s empty=%lu\n", sp, empty);
+        printf("%s longest=%lu\n", sp, longest);
+    }
+}
+
+} } }
+
+
+#if defined(GRANDOTE_HAS_UNITTESTS)
+#include "com/diag/grandote/cxxcapi.h"
+/**
+ *  Run the HashTable unit test.
+ *
+ *  @return the number of errors detected.
+ */
+CXXCAPI int unittestHashTable(void);
+#endif
+
+
+#endif
@@ -69,6 +69,8 @@
 
 namespace com { namespace diag { namespace grandote {
 
+class BaseWell;
+
 /**
  *  Implement the interfaces to the C standard library malloc(3), free(3),
  *  realloc(3) and calloc(3) functions but using the C++ new and delete
@@ -84,6 +86,20 @@ namespace com { namespace diag { namespace grandote {
  *  2.2.93. Of particular interest is the different behavior of the
  *  allocation functions when a size of zero is specified.
  *
+ *  An application may turn on size class segregation, in which small
+ *  blocks are allocated from segregated free lists, one per size class,
+ *  each backed by an elastic Well that grows by slabs as needed. Blocks
+ *  too large for any size class still fall back to the C++ new and delete
+ *  operators. Every block records which way it was allocated, so
+ *  segregation can be turned on or off at any time.
+ *
+ *  Segregation is off by default because the size class wells are not
+ *  thread-safe, while the C++ new and delete operators are: the platform
+ *  heap, which every thread reaches through the grandote_malloc and
+ *  grandote_free macros, may be shared by threads only with segregation
+ *  off, and even then its instrumentation counters are not exact. With
+ *  segregation on, serialization is the responsibility of the application.
+ *
  *  If included from a C translation unit, defines a C-callable API.
  *
  *  @see    malloc(3)
@@ -118,7 +134,10 @@ public:
     explicit Heap(Output& ro);
 
     /**
-     *  Destructor.
+     *  Destructor. The well of a size class from which blocks are still
+     *  allocated is not destroyed with the heap: each block finds its own
+     *  well when it is freed, by this or any other heap, and the well is
+     *  destroyed when its last block is freed.
      */
     virtual ~Heap();
 
@@ -259,6 +278,21 @@ public:
      */
     virtual size_t size(void* ptr);
 
+    /**
+     *  Turn size class segregation on or off. If segregation is on, small
+     *  blocks are allocated from per size class wells, otherwise all blocks
+     *  are allocated using the C++ new operator. Blocks allocated either
+     *  way may be freed or reallocated either way. Segregation is off by
+     *  default; it must not be turned on for a heap shared by threads
+     *  unless the application serializes its use.
+     *
+     *  @param  on          if true turns segregation on, otherwise
+     *                      segregation is turned off.
+     *
+     *  @return             the prior state of segregation.
+     */
+    bool segregate(bool on = true);
+
     /**
      *  Turn tracing on or off. If tracing is on, each call to a memory
      *  allocation or free method will result in at least one line of
@@ -294,12 +328,7 @@ public:
      */
     virtual void show(int level = 0, Output* display = 0, int indent = 0) const;
 
-private:
-
-    /**
-     *  Pointer to object used for tracing.
-     */
-    Output* ou;
+protected:
 
     /**
      *  Tracing on or off.
@@ -336,9 +365,71 @@ private:
      */
     size_t nulls;
 
+private:
+
+    /**
+     *  This is the number of size classes.
+     */
+    enum { CLASSES = 14 };
+
+    /**
+     *  This is the well from which blocks of one size class are allocated.
+     */
+    class SizeClass;
+
+    /**
+     *  Returns the size class, if any, for a block of the specified size.
+     *
+     *  @param  size        is the size of the requested memory block in
+     *                      bytes.
+     *
+     *  @return the size class starting at one, or zero if the block is
+     *          too large for any size class.
+     */
+    unsigned int classify(size_t size) const;
+
+    /**
+     *  Pointer to object used for tracing.
+     */
+    Output* ou;
+
+    /**
+     *  Size class segregation on or off.
+     */
+    bool segregating;
+
+    /**
+     *  Lazily allocated well for each size class.
+     */
+    SizeClass* classes[CLASSES];
+
+    /**
+     *  Copy constructor.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    Heap(const Heap& that);
+
+    /**
+     *  Assignment operator.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    Heap& operator=(const Heap& that);
+
 };
 
 
+//
+//  Set segregation on or off.
+//
+inline bool Heap::segregate(bool on) {
+    bool was = this->segregating;
+    this->segregating = on;
+    return was;
+}
+
+
 //
 //  Set tracing on or off.
 //
@@ -388,6 +479,14 @@ inline size_t Heap::getFrees() const {
     return this->frees;
 }
 
+
+//
+//  Return the number of frees with null pointers.
+//
+inline size_t Heap::getNulls() const {
+    return this->nulls;
+}
+
 } } }
 
 
@@ -512,7 +512,8 @@ inline Link* Link::insert(Link* that) {
         this->next = that->next;
         this->previous = that;
         this->root = that->root;
-        that->next->previous = that->next = this;
+        that->next->previous = this;
+        that->next = this;
         return this;
     }
     return 0;
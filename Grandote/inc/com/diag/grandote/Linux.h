@@ -81,7 +81,35 @@ class Linux : public Platform {
 public:
 
     /**
-     *  Constructor.
+     *  These are the clocks from which Linux ticks may be taken.
+     *
+     *  REALTIME is the time of day from gettimeofday(2) in microsecond
+     *  ticks. It jumps whenever the system clock is stepped, for example
+     *  by NTP or by an administrator.
+     *
+     *  MONOTONIC is CLOCK_MONOTONIC from clock_gettime(2) in nanosecond
+     *  ticks. It never jumps, and it is read through the vDSO on most
+     *  architectures without entering the kernel.
+     *
+     *  COARSE is CLOCK_MONOTONIC_COARSE in nanosecond ticks. It is
+     *  cheaper still, but it only advances once per kernel tick, typically
+     *  every one to four milliseconds, so it suits hot paths that can
+     *  tolerate that jitter. Where it is not available, it is the same
+     *  as MONOTONIC.
+     *
+     *  The monotonic clocks are anchored to the time of day when they are
+     *  selected, so that time() is still ticks since the epoch and may be
+     *  converted to a date, but thereafter they drift from the time of
+     *  day as the system clock is slewed or stepped.
+     */
+    enum Clock {
+        REALTIME    = 0,
+        MONOTONIC   = 1,
+        COARSE      = 2
+    };
+
+    /**
+     *  Constructor. The clock is REALTIME.
      */
     explicit Linux();
 
@@ -138,6 +166,23 @@ public:
      */
     virtual ticks_t yield(ticks_t ticks = 0, bool premature = true);
 
+    /**
+     *  Selects the clock from which Linux ticks are taken. This changes
+     *  the frequency, so it should be done before any object that keeps
+     *  ticks or caches the frequency, for example a throttle, is
+     *  constructed. The elapsed time continues across the change.
+     *
+     *  @param  clock       is the clock.
+     */
+    void setClock(Clock clock);
+
+    /**
+     *  Returns the clock from which Linux ticks are taken.
+     *
+     *  @return the clock.
+     */
+    Clock getClock() const;
+
     /**
      *  Returns the identity of the caller. Since Grandote requires
      *  a POSIX interface including POSIX Threads, this is typically
@@ -358,6 +403,17 @@ private:
      */
     ticks_t birthdate;
 
+    /**
+     *  This is the clock from which ticks are taken.
+     */
+    Clock clock;
+
+    /**
+     *  This is the offset in ticks from a monotonic clock to the time
+     *  of day when the clock was selected.
+     */
+    ticks_t offset;
+
     /**
      *  This is the platform standard input object.
      */
@@ -400,6 +456,14 @@ private:
 
 };
 
+
+//
+//  Return the clock.
+//
+inline Linux::Clock Linux::getClock() const {
+    return this->clock;
+}
+
 } } }
 
 
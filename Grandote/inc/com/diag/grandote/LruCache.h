@@ -0,0 +1,939 @@
+#ifndef _COM_DIAG_GRANDOTE_LRUCACHE_H_
+#define _COM_DIAG_GRANDOTE_LRUCACHE_H_
+
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Declares the LruCache and LruNode templates.
+ *
+ *  @see    LruCache
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/target.h"
+#include "com/diag/grandote/LinkType.h"
+#include "com/diag/grandote/Chain.h"
+#include "com/diag/grandote/HashTable.h"
+#include "com/diag/grandote/CountersType.h"
+#include "com/diag/grandote/Print.h"
+#include "com/diag/grandote/Platform.h"
+
+
+namespace com { namespace diag { namespace grandote {
+
+template <typename _KEY_, typename _TYPE_, typename _HASH_> class LruCache;
+
+/**
+ *  Implements a node in an intrusive LruCache. The node is embedded in (or
+ *  otherwise owned by) the payload object that it points to, and carries
+ *  the key of the object and the number of bytes the object is charged
+ *  against the capacity of the cache. The node is at once a HashNode in the
+ *  index of the cache and a LinkType on its chain of nodes in order of
+ *  recent use, both of which point back to the node itself.
+ *
+ *  The key and size must not be changed while the node is in a cache. A
+ *  node must be removed from its cache before it is destroyed.
+ *
+ *  @see    LruCache
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+template <typename _KEY_, typename _TYPE_>
+class LruNode {
+
+    template <typename _ANYKEY_, typename _ANYTYPE_, typename _ANYHASH_> friend class LruCache;
+
+public:
+
+    /**
+     *  Constructor. A newly constructed node is in no cache.
+     *
+     *  @param  object      points to the payload of this node.
+     *
+     *  @param  value       refers to the key of this node.
+     *
+     *  @param  size        is the number of bytes charged for this node.
+     */
+    explicit LruNode(_TYPE_* object = 0, const _KEY_& value = _KEY_(), size_t size = 0);
+
+    /**
+     *  Destructor. A node must be removed from its cache before it is
+     *  destroyed, since it cannot correct the count and the bytes of a
+     *  cache it is still in. Destroying a cached node is fatal.
+     */
+    ~LruNode();
+
+    /**
+     *  Gets the pointer to the payload of this node.
+     *
+     *  @return the pointer to the payload of this node.
+     */
+    _TYPE_* getPayload() const;
+
+    /**
+     *  Stores a pointer to the payload of this node.
+     *
+     *  @param  object      points to the payload of this node.
+     *
+     *  @return the pointer now stored in the payload of this node.
+     */
+    _TYPE_* setPayload(_TYPE_* object);
+
+    /**
+     *  Gets the key of this node.
+     *
+     *  @return the key of this node.
+     */
+    const _KEY_& getKey() const;
+
+    /**
+     *  Sets the key of this node.
+     *
+     *  @param  value       refers to the new key of this node.
+     *
+     *  @return true if successful, false if this node is in a cache.
+     */
+    bool setKey(const _KEY_& value);
+
+    /**
+     *  Gets the number of bytes charged for this node.
+     *
+     *  @return the number of bytes charged for this node.
+     */
+    size_t getSize() const;
+
+    /**
+     *  Sets the number of bytes charged for this node.
+     *
+     *  @param  size        is the number of bytes.
+     *
+     *  @return true if successful, false if this node is in a cache.
+     */
+    bool setSize(size_t size);
+
+    /**
+     *  Returns true if this node is in a cache.
+     *
+     *  @return true if this node is in a cache.
+     */
+    bool isCached() const;
+
+    /**
+     *  Displays internal information about this object to the specified
+     *  output object. Useful for debugging and troubleshooting.
+     *
+     *  @param  level   sets the verbosity of the output. What this means
+     *                  is object dependent. However, the level is passed
+     *                  from outer to inner objects this object calls the
+     *                  show methods of its inherited or composited objects.
+     *
+     *  @param display  points to the output object to which output is
+     *                  sent. If null (zero), the default platform output
+     *                  object is used as the effective output object. The
+     *                  effective output object is passed from outer to
+     *                  inner objects as this object calls the show methods
+     *                  of its inherited and composited objects.
+     *
+     *  @param  indent  specifies the level of indentation. One more than
+     *                  this value is passed from outer to inner objects
+     *                  as this object calls the show methods of its
+     *                  inherited and composited objects.
+     */
+    void show(int level = 0, Output* display = 0, int indent = 0) const;
+
+private:
+
+    /**
+     *  This is the node in the index.
+     */
+    HashNode<_KEY_, LruNode<_KEY_, _TYPE_> > index;
+
+    /**
+     *  This is the link in the chain in order of use.
+     */
+    LinkType<LruNode<_KEY_, _TYPE_> > recency;
+
+    /**
+     *  Points to the payload.
+     */
+    _TYPE_* payload;
+
+    /**
+     *  This is the number of bytes charged for this node.
+     */
+    size_t bytes;
+
+    /**
+     *  Copy constructor.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    LruNode(const LruNode<_KEY_, _TYPE_>& that);
+
+    /**
+     *  Assignment operator.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    LruNode<_KEY_, _TYPE_>& operator=(const LruNode<_KEY_, _TYPE_>& that);
+
+};
+
+
+//
+//  Constructor.
+//
+template <typename _KEY_, typename _TYPE_>
+inline LruNode<_KEY_, _TYPE_>::LruNode(_TYPE_* object, const _KEY_& value, size_t size) :
+    index(this, value),
+    recency(this),
+    payload(object),
+    bytes(size)
+{
+}
+
+
+//
+//  Destructor.
+//
+template <typename _KEY_, typename _TYPE_>
+inline LruNode<_KEY_, _TYPE_>::~LruNode() {
+    if (this->isCached()) {
+        Platform::instance().fatal("LruNode destroyed while cached", 0, __FILE__, __LINE__, __func__);
+    }
+}
+
+
+//
+//  Return the payload.
+//
+template <typename _KEY_, typename _TYPE_>
+inline _TYPE_* LruNode<_KEY_, _TYPE_>::getPayload() const {
+    return this->payload;
+}
+
+
+//
+//  Set the payload.
+//
+template <typename _KEY_, typename _TYPE_>
+inline _TYPE_* LruNode<_KEY_, _TYPE_>::setPayload(_TYPE_* object) {
+    return this->payload = object;
+}
+
+
+//
+//  Return the key.
+//
+template <typename _KEY_, typename _TYPE_>
+inline const _KEY_& LruNode<_KEY_, _TYPE_>::getKey() const {
+    return this->index.getKey();
+}
+
+
+//
+//  Set the key if not in a cache.
+//
+template <typename _KEY_, typename _TYPE_>
+inline bool LruNode<_KEY_, _TYPE_>::setKey(const _KEY_& value) {
+    return this->index.setKey(value);
+}
+
+
+//
+//  Return the size.
+//
+template <typename _KEY_, typename _TYPE_>
+inline size_t LruNode<_KEY_, _TYPE_>::getSize() const {
+    return this->bytes;
+}
+
+
+//
+//  Set the size if not in a cache.
+//
+template <typename _KEY_, typename _TYPE_>
+inline bool LruNode<_KEY_, _TYPE_>::setSize(size_t size) {
+    if (this->isCached()) {
+        return false;
+    }
+    this->bytes = size;
+    return true;
+}
+
+
+//
+//  Return true if in a cache.
+//
+template <typename _KEY_, typename _TYPE_>
+inline bool LruNode<_KEY_, _TYPE_>::isCached() const {
+    return this->index.isChained();
+}
+
+
+//
+//  Show this object on the output object.
+//
+template <typename _KEY_, typename _TYPE_>
+void LruNode<_KEY_, _TYPE_>::show(int level, Output* display, int indent) const {
+    Platform& pl = Platform::instance();
+    Print printf(display);
+    const char* sp = printf.output().indentation(indent);
+    char component[sizeof(__FILE__)];
+    printf("%s%s(%p)[%lu]:\n",
+        sp, pl.component(__FILE__, component, sizeof(component)),
+        this, sizeof(*this));
+    printf("%s payload=%p\n", sp, this->payload);
+    printf("%s bytes=%lu\n", sp, this->bytes);
+    this->index.show(level, display, indent + 1);
+    this->recency.show(level, display, indent + 1);
+}
+
+
+/**
+ *  Implements an intrusive cache of LruNode objects, indexed by key in a
+ *  HashTable, that evicts the least recently used node whenever adding a
+ *  node would exceed either of its capacities: the number of nodes, or the
+ *  total number of bytes charged for the nodes. A capacity of zero is
+ *  unlimited. Finding a node makes it the most recently used.
+ *
+ *  Since the cache does not own its nodes, an application that needs to
+ *  know when a node has been evicted, for example to free its payload,
+ *  provides a Functor that is called with each evicted node after the node
+ *  has been removed from the cache. The functor may do anything with the
+ *  node except insert it back into the cache that is in the middle of
+ *  evicting it.
+ *
+ *  The cache keeps counts of hits, misses, insertions, evictions and
+ *  removals in a Counters object, so that they may be exported along with
+ *  the other counters of the application.
+ *
+ *  This class is not thread-safe. Serialization is the responsibility
+ *  of the caller.
+ *
+ *  @see    LruNode
+ *
+ *  @see    HashTable
+ *
+ *  @see    Counters
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+template <typename _KEY_, typename _TYPE_, typename _HASH_ = HashFunction<_KEY_> >
+class LruCache {
+
+public:
+
+    /**
+     *  This is the type of node in this cache.
+     */
+    typedef LruNode<_KEY_, _TYPE_> Node;
+
+    /**
+     *  These are the identifiers of the counters kept by the cache.
+     */
+    enum Counter {
+        HITS,
+        MISSES,
+        INSERTS,
+        EVICTIONS,
+        REMOVALS,
+        COUNTERS
+    };
+
+    /**
+     *  Defines an interface to a functor (an object that can
+     *  be called like a function) that is called for a node that has
+     *  been evicted from a cache.
+     */
+    class Functor {
+
+    public:
+
+        /**
+         *  Dtor.
+         */
+        virtual ~Functor();
+
+        /**
+         *  Perform an application-defined operation on an evicted node.
+         *
+         *  @param  cache       refers to the cache.
+         *
+         *  @param  node        refers to the node, which is no longer in
+         *                      the cache.
+         */
+        virtual void operator() (LruCache<_KEY_, _TYPE_, _HASH_>& cache, Node& node) = 0;
+
+    };
+
+    /**
+     *  Constructor.
+     *
+     *  @param  entries     is the maximum number of nodes, or zero for
+     *                      unlimited.
+     *
+     *  @param  total       is the maximum total number of bytes charged
+     *                      for the nodes, or zero for unlimited.
+     *
+     *  @param  functor     points to the functor called for each evicted
+     *                      node, or null if none.
+     *
+     *  @param  buckets     is the initial number of buckets in the index.
+     */
+    explicit LruCache(size_t entries = 0, size_t total = 0, Functor* functor = 0, size_t buckets = 16);
+
+    /**
+     *  Destructor. Any nodes still in this cache are left in the state
+     *  of being in no cache; the functor is not called for them.
+     */
+    ~LruCache();
+
+    /**
+     *  Returns the number of nodes in this cache.
+     *
+     *  @return the number of nodes in this cache.
+     */
+    size_t size() const;
+
+    /**
+     *  Returns the total number of bytes charged for the nodes in this
+     *  cache.
+     *
+     *  @return the number of bytes.
+     */
+    size_t bytes() const;
+
+    /**
+     *  Returns true if this cache is empty.
+     *
+     *  @return true if this cache is empty.
+     */
+    bool empty() const;
+
+    /**
+     *  Gets the maximum number of nodes.
+     *
+     *  @return the maximum number of nodes, or zero if unlimited.
+     */
+    size_t getEntryCapacity() const;
+
+    /**
+     *  Gets the maximum total number of bytes.
+     *
+     *  @return the maximum number of bytes, or zero if unlimited.
+     */
+    size_t getByteCapacity() const;
+
+    /**
+     *  Changes both capacities, evicting nodes as necessary to meet them.
+     *
+     *  @param  entries     is the maximum number of nodes, or zero for
+     *                      unlimited.
+     *
+     *  @param  total       is the maximum total number of bytes, or zero
+     *                      for unlimited.
+     *
+     *  @return the number of nodes evicted.
+     */
+    size_t setCapacity(size_t entries, size_t total);
+
+    /**
+     *  Finds the node with a key and makes it the most recently used.
+     *  Counts a hit or a miss.
+     *
+     *  @param  key         refers to the key.
+     *
+     *  @return a pointer to the node or null (0) if none.
+     */
+    Node* find(const _KEY_& key);
+
+    /**
+     *  Finds the node with a key without changing its recency or the
+     *  counters.
+     *
+     *  @param  key         refers to the key.
+     *
+     *  @return a pointer to the node or null (0) if none.
+     */
+    Node* peek(const _KEY_& key) const;
+
+    /**
+     *  Returns the least recently used node, the next to be evicted,
+     *  without changing its recency.
+     *
+     *  @return a pointer to the node or null (0) if empty.
+     */
+    Node* oldest() const;
+
+    /**
+     *  Inserts a node as the most recently used, then evicts least
+     *  recently used nodes until this cache is within its capacities.
+     *
+     *  @param  node        refers to the node.
+     *
+     *  @return true if successful, false if the node is already in a
+     *          cache, a node with the same key is in this cache, or the
+     *          node alone is larger than the byte capacity.
+     */
+    bool insert(Node& node);
+
+    /**
+     *  Removes the node with a key without calling the functor.
+     *
+     *  @param  key         refers to the key.
+     *
+     *  @return a pointer to the node or null (0) if none.
+     */
+    Node* remove(const _KEY_& key);
+
+    /**
+     *  Removes a node by its handle without calling the functor.
+     *
+     *  @param  node        refers to the node.
+     *
+     *  @return a pointer to the node or null (0) if it is not in this
+     *          cache.
+     */
+    Node* remove(Node& node);
+
+    /**
+     *  Removes all nodes from this cache without calling the functor.
+     */
+    void clear();
+
+    /**
+     *  Returns the counters of this cache, indexed by Counter.
+     *
+     *  @return a reference to the counters.
+     */
+    Counters& getCounters();
+
+    /**
+     *  Displays internal information about this object to the specified
+     *  output object. Useful for debugging and troubleshooting.
+     *
+     *  @param  level   sets the verbosity of the output. What this means
+     *                  is object dependent. However, the level is passed
+     *                  from outer to inner objects this object calls the
+     *                  show methods of its inherited or composited objects.
+     *
+     *  @param display  points to the output object to which output is
+     *                  sent. If null (zero), the default platform output
+     *                  object is used as the effective output object. The
+     *                  effective output object is passed from outer to
+     *                  inner objects as this object calls the show methods
+     *                  of its inherited and composited objects.
+     *
+     *  @param  indent  specifies the level of indentation. One more than
+     *                  this value is passed from outer to inner objects
+     *                  as this object calls the show methods of its
+     *                  inherited and composited objects.
+     */
+    void show(int level = 0, Output* display = 0, int indent = 0) const;
+
+private:
+
+    /**
+     *  Evicts least recently used nodes until this cache is within its
+     *  capacities.
+     *
+     *  @return the number of nodes evicted.
+     */
+    size_t evict();
+
+    /**
+     *  Unlinks a node from the index and the chain.
+     *
+     *  @param  node        refers to the node.
+     */
+    void unlink(Node& node);
+
+    /**
+     *  These are the labels of the counters.
+     */
+    static const char* labels[COUNTERS];
+
+    /**
+     *  This is the index.
+     */
+    HashTable<_KEY_, Node, _HASH_> index;
+
+    /**
+     *  This is the chain of nodes from most to least recently used.
+     */
+    Chain recency;
+
+    /**
+     *  These are the counters.
+     */
+    CountersType<COUNTERS> counters;
+
+    /**
+     *  Points to the eviction functor or is null.
+     */
+    Functor* evicted;
+
+    /**
+     *  Is the maximum number of nodes or zero.
+     */
+    size_t entrycapacity;
+
+    /**
+     *  Is the maximum number of bytes or zero.
+     */
+    size_t bytecapacity;
+
+    /**
+     *  Is the number of bytes charged for the nodes.
+     */
+    size_t octets;
+
+    /**
+     *  Copy constructor.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    LruCache(const LruCache<_KEY_, _TYPE_, _HASH_>& that);
+
+    /**
+     *  Assignment operator.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    LruCache<_KEY_, _TYPE_, _HASH_>& operator=(const LruCache<_KEY_, _TYPE_, _HASH_>& that);
+
+};
+
+
+//
+//  Counter labels.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+const char* LruCache<_KEY_, _TYPE_, _HASH_>::labels[COUNTERS] = {
+    "hits",
+    "misses",
+    "inserts",
+    "evictions",
+    "removals",
+};
+
+
+//
+//  Constructor.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+LruCache<_KEY_, _TYPE_, _HASH_>::LruCache(size_t entries, size_t total, Functor* functor, size_t buckets) :
+    index(buckets),
+    recency(),
+    counters(labels),
+    evicted(functor),
+    entrycapacity(entries),
+    bytecapacity(total),
+    octets(0)
+{
+    this->counters.reset();
+}
+
+
+//
+//  Destructor.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+LruCache<_KEY_, _TYPE_, _HASH_>::~LruCache() {
+    this->clear();
+}
+
+
+//
+//  Return the number of nodes.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+inline size_t LruCache<_KEY_, _TYPE_, _HASH_>::size() const {
+    return this->index.size();
+}
+
+
+//
+//  Return the number of bytes.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+inline size_t LruCache<_KEY_, _TYPE_, _HASH_>::bytes() const {
+    return this->octets;
+}
+
+
+//
+//  Return true if empty.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+inline bool LruCache<_KEY_, _TYPE_, _HASH_>::empty() const {
+    return this->index.empty();
+}
+
+
+//
+//  Return the entry capacity.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+inline size_t LruCache<_KEY_, _TYPE_, _HASH_>::getEntryCapacity() const {
+    return this->entrycapacity;
+}
+
+
+//
+//  Return the byte capacity.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+inline size_t LruCache<_KEY_, _TYPE_, _HASH_>::getByteCapacity() const {
+    return this->bytecapacity;
+}
+
+
+//
+//  Return the counters.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+inline Counters& LruCache<_KEY_, _TYPE_, _HASH_>::getCounters() {
+    return this->counters;
+}
+
+
+//
+//  Unlink a node.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+inline void LruCache<_KEY_, _TYPE_, _HASH_>::unlink(Node& node) {
+    this->index.remove(node.index);
+    node.recency.remove();
+    this->octets -= node.bytes;
+}
+
+
+//
+//  Evict until within capacity.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+size_t LruCache<_KEY_, _TYPE_, _HASH_>::evict() {
+    size_t count = 0;
+    while (((this->entrycapacity > 0) && (this->index.size() > this->entrycapacity)) ||
+           ((this->bytecapacity > 0) && (this->octets > this->bytecapacity))) {
+        Node* node = this->oldest();
+        if (node == 0) {
+            break;
+        }
+        this->unlink(*node);
+        this->counters.increment(EVICTIONS);
+        ++count;
+        if (this->evicted != 0) {
+            (*this->evicted)(*this, *node);
+        }
+    }
+    return count;
+}
+
+
+//
+//  Change the capacities.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+size_t LruCache<_KEY_, _TYPE_, _HASH_>::setCapacity(size_t entries, size_t total) {
+    this->entrycapacity = entries;
+    this->bytecapacity = total;
+    return this->evict();
+}
+
+
+//
+//  Find a node and make it the most recent.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+typename LruCache<_KEY_, _TYPE_, _HASH_>::Node* LruCache<_KEY_, _TYPE_, _HASH_>::find(const _KEY_& key) {
+    HashNode<_KEY_, Node>* found = this->index.find(key);
+    if (found == 0) {
+        this->counters.increment(MISSES);
+        return 0;
+    }
+    this->counters.increment(HITS);
+    Node* node = found->getPayload();
+    if (this->recency.getNext() != &node->recency) {
+        node->recency.remove();
+        this->recency.insertFirst(&node->recency);
+    }
+    return node;
+}
+
+
+//
+//  Find a node without side effects.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+typename LruCache<_KEY_, _TYPE_, _HASH_>::Node* LruCache<_KEY_, _TYPE_, _HASH_>::peek(const _KEY_& key) const {
+    HashNode<_KEY_, Node>* found = this->index.find(key);
+    return (found != 0) ? found->getPayload() : 0;
+}
+
+
+//
+//  Return the least recently used node.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+inline typename LruCache<_KEY_, _TYPE_, _HASH_>::Node* LruCache<_KEY_, _TYPE_, _HASH_>::oldest() const {
+    Link* link = this->recency.getPrevious();
+    return (link != &this->recency) ? static_cast<LinkType<Node>*>(link)->getPayload() : 0;
+}
+
+
+//
+//  Insert a node as the most recent and evict as necessary.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+bool LruCache<_KEY_, _TYPE_, _HASH_>::insert(Node& node) {
+    if (node.isCached()) {
+        return false;
+    }
+    if ((this->bytecapacity > 0) && (node.bytes > this->bytecapacity)) {
+        return false;
+    }
+    if (!this->index.insert(node.index)) {
+        return false;
+    }
+    this->recency.insertFirst(&node.recency);
+    this->octets += node.bytes;
+    this->counters.increment(INSERTS);
+    this->evict();
+    return true;
+}
+
+
+//
+//  Remove a node by key.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+typename LruCache<_KEY_, _TYPE_, _HASH_>::Node* LruCache<_KEY_, _TYPE_, _HASH_>::remove(const _KEY_& key) {
+    HashNode<_KEY_, Node>* found = this->index.find(key);
+    if (found == 0) {
+        return 0;
+    }
+    Node* node = found->getPayload();
+    this->unlink(*node);
+    this->counters.increment(REMOVALS);
+    return node;
+}
+
+
+//
+//  Remove a node by handle.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+typename LruCache<_KEY_, _TYPE_, _HASH_>::Node* LruCache<_KEY_, _TYPE_, _HASH_>::remove(Node& node) {
+    if (!this->recency.isMember(&node.recency)) {
+        return 0;
+    }
+    this->unlink(node);
+    this->counters.increment(REMOVALS);
+    return &node;
+}
+
+
+//
+//  Remove all nodes.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+void LruCache<_KEY_, _TYPE_, _HASH_>::clear() {
+    Node* node;
+    while ((node = this->oldest()) != 0) {
+        this->unlink(*node);
+    }
+}
+
+
+//
+//  Show this object on the output object.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+void LruCache<_KEY_, _TYPE_, _HASH_>::show(int level, Output* display, int indent) const {
+    Platform& pl = Platform::instance();
+    Print printf(display);
+    const char* sp = printf.output().indentation(indent);
+    char component[sizeof(__FILE__)];
+    printf("%s%s(%p)[%lu]:\n",
+        sp, pl.component(__FILE__, component, sizeof(component)),
+        this, sizeof(*this));
+    printf("%s entrycapacity=%lu\n", sp, this->entrycapacity);
+    printf("%s bytecapacity=%lu\n", sp, this->bytecapacity);
+    printf("%s octets=%lu\n", sp, this->octets);
+    printf("%s evicted=%p\n", sp, this->evicted);
+    this->index.show(level, display, indent + 1);
+    this->counters.show(level, display, indent + 1);
+}
+
+
+//
+//  Virtual destructor for Functor.
+//
+template <typename _KEY_, typename _TYPE_, typename _HASH_>
+LruCache<_KEY_, _TYPE_, _HASH_>::Functor::~Functor() {
+}
+
+} } }
+
+
+#if defined(GRANDOTE_HAS_UNITTESTS)
+#include "com/diag/grandote/cxxcapi.h"
+/**
+ *  Run the LruCache unit test.
+ *
+ *  @return the number of errors detected.
+ */
+CXXCAPI int unittestLruCache(void);
+#endif
+
+
+#endif
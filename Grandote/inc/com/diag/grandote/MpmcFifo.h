@@ -0,0 +1,519 @@
+#ifndef _COM_DIAG_GRANDOTE_MPMCFIFO_H_
+#define _COM_DIAG_GRANDOTE_MPMCFIFO_H_
+
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+/**
+ *  @file
+ *
+ *  Declares the MpmcFifo class.
+ *
+ *  @see    MpmcFifo
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/target.h"
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/Object.h"
+#include "com/diag/grandote/NewFifo.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/Print.h"
+
+
+namespace com { namespace diag { namespace grandote {
+
+/**
+ *  Generates a bounded circular buffer that may be shared without any
+ *  locking among any number of threads of control that insert objects
+ *  and any number that remove them. Its methods have the same names and
+ *  meanings as those of Fifo, so code written against Fifo can use it
+ *  unchanged once it is no longer guarded by a Mutex.
+ *
+ *  Each position in the queue carries a sequence number that says whether
+ *  it is ready to be filled or ready to be emptied, and for which pass
+ *  around the queue. A producer claims a position by advancing the head
+ *  with a compare and swap, copies its object in, and then publishes it
+ *  by advancing the sequence number of the position. A consumer does the
+ *  same with the tail. Producers contend only with each other over the
+ *  head, and consumers only with each other over the tail, which are kept
+ *  on separate cache lines.
+ *
+ *  The queue is allocated by the object, since each position carries its
+ *  sequence number alongside the object. Its size is the smallest power
+ *  of two greater than or equal to that requested, as with NewFifo, but
+ *  is never less than two.
+ *
+ *  The values returned by used() and free() are snapshots that may be
+ *  stale by the time they are returned. The reset() method is not safe
+ *  while any other thread of control is using the object.
+ *
+ *  @see    Fifo
+ *
+ *  @see    D. Vyukov, "Bounded MPMC queue", 1024cores.net
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+template <typename _TYPE_>
+class MpmcFifo : public Object {
+
+public:
+
+    /**
+     *  This is the size in bytes of the cache line assumed when separating
+     *  the head and the tail.
+     */
+    static const size_t LINESIZE = 64;
+
+    /**
+     *  Constructor.
+     *
+     *  @param  cof         is the countof of the queue to be allocated
+     *                      in number of objects of the specified type.
+     *                      The actual queue size will be the smallest
+     *                      power of two greater than or equal to this
+     *                      value, but no less than two, unless this
+     *                      value is zero.
+     */
+    explicit MpmcFifo(size_t cof = 0);
+
+    /**
+     *  Destructor.
+     */
+    virtual ~MpmcFifo();
+
+    /**
+     *  Returns the number of used entries in the queue. This includes
+     *  entries being inserted or removed at the time of the call.
+     *
+     *  @return the number of used entries.
+     */
+    size_t used() const;
+
+    /**
+     *  Returns the number of free entries in the queue.
+     *
+     *  @return the number of free entries.
+     */
+    size_t free() const;
+
+    /**
+     *  Returns the total number of entries in the queue.
+     *
+     *  @return the number of free entries.
+     */
+    size_t total() const;
+
+    /**
+     *  Returns the queue to its empty state. No other thread of control
+     *  may be using the queue when this is called.
+     */
+    void reset();
+
+    /**
+     *  Inserts an object into the queue. The object is copied into
+     *  an empty position in the queue. The object type must permit
+     *  assignment semantics.
+     *
+     *  @param  entry   refers to the object from which a copy is
+     *                  made into the next unused object in the queue.
+     *
+     *  @return true if successful, false if the queue is full.
+     */
+    bool insert(const _TYPE_& entry);
+
+    /**
+     *  Makes a copy of the first item on the queue, but does not
+     *  remove it from the queue. If another thread of control removes the
+     *  item while it is being copied, the copy is discarded and the next
+     *  first item is tried instead. Because the copy may be made while the
+     *  item is being overwritten, the object type should be one for which
+     *  such a torn copy is harmless, such as a plain old data type.
+     *
+     *  @param  result  refers to the object into which the next used
+     *                  object is copied.
+     *
+     *  @return true if successful, false if the queue is empty.
+     */
+    bool peek(_TYPE_& result) const;
+
+    /**
+     *  Makes a copy of the first item on the queue, and removes it
+     *  from the queue.
+     *
+     *  @param  result  refers to the object into which the next used
+     *                  object is copied.
+     *
+     *  @return true if successful, false if the queue is empty.
+     */
+    bool remove(_TYPE_& result);
+
+    /**
+     *  Displays internal information about this object to the specified
+     *  output object. Useful for debugging and troubleshooting.
+     *
+     *  @param  level   sets the verbosity of the output. What this means
+     *                  is object dependent. However, the level is passed
+     *                  from outer to inner objects this object calls the
+     *                  show methods of its inherited or composited objects.
+     *
+     *  @param display  points to the output object to which output is
+     *                  sent. If null (zero), the default platform output
+     *                  object is used as the effective output object. The
+     *                  effective output object is passed from outer to
+     *                  inner objects as this object calls the show methods
+     *                  of its inherited and composited objects.
+     *
+     *  @param  indent  specifies the level of indentation. One more than
+     *                  this value is passed from outer to inner objects
+     *                  as this object calls the show methods of its
+     *                  inherited and composited objects.
+     */
+    virtual void show(int level = 0, Output* display = 0, int indent = 0) const;
+
+private:
+
+    /**
+     *  This is a position in the queue. The sequence number is equal to
+     *  the index of the pass around the queue at which the position may
+     *  next be filled, and one more than that at which it may next be
+     *  emptied.
+     */
+    struct Cell {
+        size_t sequence;
+        _TYPE_ data;
+    };
+
+    /**
+     *  Computes the size of the queue.
+     *
+     *  @param  cof     is the minimum size of of the queue specified
+     *                  by the application.
+     *
+     *  @return the actual size of the queue.
+     */
+    static size_t size(size_t cof);
+
+    /**
+     *  This refers to the queue array.
+     */
+    Cell* queue;
+
+    /**
+     *  This is the countof the number of objects that can be in the queue.
+     */
+    size_t count;
+
+    /**
+     *  This is one less than the number of possible objects in the queue.
+     */
+    size_t mask;
+
+    /**
+     *  This keeps the head off the cache line of the fields above, and
+     *  of whatever precedes this object.
+     */
+    char pad1[LINESIZE];
+
+    /**
+     *  This indexes the next unused object in the queue.
+     */
+    size_t head;
+
+    /**
+     *  This keeps the head and the tail on different cache lines.
+     */
+    char pad2[LINESIZE - sizeof(size_t)];
+
+    /**
+     *  This indexes the next used object in the queue.
+     */
+    size_t tail;
+
+    /**
+     *  This keeps the tail off the cache line of whatever follows this
+     *  object.
+     */
+    char pad3[LINESIZE - sizeof(size_t)];
+
+    /**
+     *  Copy constructor.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    MpmcFifo(const MpmcFifo& that);
+
+    /**
+     *  Assignment operator.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    MpmcFifo& operator=(const MpmcFifo& that);
+
+};
+
+
+//
+//  Compute the actual queue size. A single position would be filled
+//  again before it was emptied, so the minimum is two.
+//
+template <typename _TYPE_>
+size_t MpmcFifo<_TYPE_>::size(size_t cof) {
+    size_t cc = NewFifo<_TYPE_>::power(cof);
+    return (1 == cc) ? 2 : cc;
+}
+
+
+//
+// Constructor
+//
+template <typename _TYPE_>
+MpmcFifo<_TYPE_>::MpmcFifo(size_t cof) :
+    queue(0),
+    count(MpmcFifo<_TYPE_>::size(cof)),
+    mask(0),
+    head(0),
+    tail(0)
+{
+    if (0 < this->count) {
+        this->queue = new Cell[this->count];
+        this->mask = this->count - 1;
+    }
+    this->reset();
+}
+
+
+//
+//  Destructor.
+//
+template <typename _TYPE_>
+MpmcFifo<_TYPE_>::~MpmcFifo() {
+    delete [] this->queue;
+}
+
+
+//
+//  Reset to empty state.
+//
+template <typename _TYPE_>
+void MpmcFifo<_TYPE_>::reset() {
+    for (size_t ii = 0; this->count > ii; ++ii) {
+        this->queue[ii].sequence = ii;
+    }
+    this->head = 0;
+    this->tail = 0;
+    __sync_synchronize();
+}
+
+
+//
+//  Return the number of used entries. The tail is loaded before the
+//  head so that the head is never behind it, but the tail may have moved
+//  on by the time the head is loaded.
+//
+template <typename _TYPE_>
+inline size_t MpmcFifo<_TYPE_>::used() const {
+    size_t tt = __atomic_load_n(&(this->tail), __ATOMIC_ACQUIRE);
+    size_t hh = __atomic_load_n(&(this->head), __ATOMIC_ACQUIRE);
+    size_t uu = hh - tt;
+    return (uu > this->count) ? this->count : uu;
+}
+
+
+//
+//  Return the total number of entries.
+//
+template <typename _TYPE_>
+inline size_t MpmcFifo<_TYPE_>::total() const {
+    return this->count;
+}
+
+
+//
+//  Return the number of free entries.
+//
+template <typename _TYPE_>
+inline size_t MpmcFifo<_TYPE_>::free() const {
+    return this->count - this->used();
+}
+
+
+//
+//  Insert new entry into queue. The position is ready to be filled when
+//  its sequence number equals the head; if it is less, the position
+//  still holds an entry from the prior pass and the queue is full.
+//
+template <typename _TYPE_>
+bool MpmcFifo<_TYPE_>::insert(const _TYPE_& entry) {
+    if (0 == this->count) {
+        return false;
+    }
+    Cell* cell;
+    size_t hh = __atomic_load_n(&(this->head), __ATOMIC_RELAXED);
+    while (true) {
+        cell = &(this->queue[hh & this->mask]);
+        size_t ss = __atomic_load_n(&(cell->sequence), __ATOMIC_ACQUIRE);
+        intptr_t dd = static_cast<intptr_t>(ss) - static_cast<intptr_t>(hh);
+        if (0 == dd) {
+            if (__atomic_compare_exchange_n(&(this->head), &hh, hh + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (0 > dd) {
+            return false;
+        } else {
+            hh = __atomic_load_n(&(this->head), __ATOMIC_RELAXED);
+        }
+    }
+    cell->data = entry;
+    __atomic_store_n(&(cell->sequence), hh + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+
+//
+//  Peek at oldest used entry in queue. The copy is good only if the
+//  position was not reclaimed while it was being made.
+//
+template <typename _TYPE_>
+bool MpmcFifo<_TYPE_>::peek(_TYPE_& result) const {
+    if (0 == this->count) {
+        return false;
+    }
+    size_t tt = __atomic_load_n(&(this->tail), __ATOMIC_RELAXED);
+    while (true) {
+        const Cell* cell = &(this->queue[tt & this->mask]);
+        size_t ss = __atomic_load_n(&(cell->sequence), __ATOMIC_ACQUIRE);
+        intptr_t dd = static_cast<intptr_t>(ss) - static_cast<intptr_t>(tt + 1);
+        if (0 == dd) {
+            result = cell->data;
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            if (__atomic_load_n(&(cell->sequence), __ATOMIC_RELAXED) == ss) {
+                return true;
+            }
+        } else if (0 > dd) {
+            return false;
+        }
+        tt = __atomic_load_n(&(this->tail), __ATOMIC_RELAXED);
+    }
+}
+
+
+//
+//  Remove oldest used entry in queue. The position is ready to be emptied
+//  when its sequence number is one more than the tail; if it is less, the
+//  position has not been filled on this pass and the queue is empty. The
+//  position is then made ready to be filled on the next pass.
+//
+template <typename _TYPE_>
+bool MpmcFifo<_TYPE_>::remove(_TYPE_& result) {
+    if (0 == this->count) {
+        return false;
+    }
+    Cell* cell;
+    size_t tt = __atomic_load_n(&(this->tail), __ATOMIC_RELAXED);
+    while (true) {
+        cell = &(this->queue[tt & this->mask]);
+        size_t ss = __atomic_load_n(&(cell->sequence), __ATOMIC_ACQUIRE);
+        intptr_t dd = static_cast<intptr_t>(ss) - static_cast<intptr_t>(tt + 1);
+        if (0 == dd) {
+            if (__atomic_compare_exchange_n(&(this->tail), &tt, tt + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (0 > dd) {
+            return false;
+        } else {
+            tt = __atomic_load_n(&(this->tail), __ATOMIC_RELAXED);
+        }
+    }
+    result = cell->data;
+    __atomic_store_n(&(cell->sequence), tt + this->count, __ATOMIC_RELEASE);
+    return true;
+}
+
+
+//
+//  Show this object on the output object.
+//
+template <typename _TYPE_>
+void MpmcFifo<_TYPE_>::show(int level, Output* display, int indent) const {
+    Platform& pl = Platform::instance();
+    Print printf(display);
+    const char* sp = printf.output().indentation(indent);
+    char component[sizeof(__FILE__)];
+    printf("%s%s(%p)[%lu]:\n",
+        sp, pl.component(__FILE__, component, sizeof(component)),
+        this, sizeof(*this));
+    printf("%s widthof=%u\n", sp, widthof(_TYPE_));
+    printf("%s count=%u\n", sp, this->count);
+    printf("%s mask=0x%x\n", sp, this->mask);
+    printf("%s head=%u:%u\n", sp, this->head, this->head & this->mask);
+    printf("%s tail=%u:%u\n", sp, this->tail, this->tail & this->mask);
+    printf("%s used()=%u\n", sp, this->used());
+    printf("%s free()=%u\n", sp, this->free());
+    printf("%s total()=%u\n", sp, this->total());
+    printf("%s queue=%p\n", sp, this->queue);
+    if (0 < level) {
+        for (size_t ii = 0; this->count > ii; ++ii) {
+            printf("%s queue[%u].sequence=%u\n",
+                sp, ii, this->queue[ii].sequence);
+        }
+    }
+}
+
+} } }
+
+
+#if defined(GRANDOTE_HAS_UNITTESTS)
+#include "com/diag/grandote/cxxcapi.h"
+/**
+ *  Run the MpmcFifo unit test.
+ *  
+ *  @return the number of errors detected by the unit test.
+ */
+CXXCAPI int unittestMpmcFifo(void);
+#endif
+
+
+#endif
@@ -113,11 +113,10 @@ public:
      */
     virtual void show(int level = 0, Output* display = 0, int indent = 0) const;
 
-private:
-
     /**
      *  Computes the smallest power of two greater than or equal to
-     *  its argument.
+     *  its argument. This is also used by the other queues that size
+     *  themselves the same way.
      *
      *  @param  cof     is the minimum size of of the queue specified
      *                  by the application.
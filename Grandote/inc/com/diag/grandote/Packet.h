@@ -20,6 +20,8 @@ namespace com {
 namespace diag {
 namespace grandote {
 
+class PacketDataShared;
+
 /**
  * PacketData is an object that can be appended or prepended to a Packet.
  * It contains a pointer to a user provided data structure that it does not
@@ -67,14 +69,17 @@ public:
 	 * @param ve is the size of the user data object in octets.
 	 * @param vf specifies how the user data object is to be initialized:
 	 *        for append, prepend, or either.
+	 * @param vr if true makes the object read-only, so that it never has
+	 *        prefix or suffix space into which data may be written.
 	 */
-	explicit PacketData(void * dp /* UNTAKEN */, size_t ve, size_t vf = EITHER)
+	explicit PacketData(void * dp /* UNTAKEN */, size_t ve, size_t vf = EITHER, bool vr = false)
 	: next(0)
 	, payload(static_cast<Datum*>(dp))
 	, head(payload)
 	, tail(payload + ve)
 	, extent(ve)
 	, fraction(vf)
+	, readonly(vr)
 	{}
 
 	/**
@@ -154,6 +159,13 @@ private:
 	 */
 	const size_t fraction;
 
+	/**
+	 * If true, the object never reports prefix or suffix space, so nothing
+	 * is ever prepended, appended, or committed into its buffer.
+	 * Never altered after construction.
+	 */
+	const bool readonly;
+
 	/**
 	 * Points to the first used octet in the buffer.
 	 * (head==0): the buffer is empty; otherwise
@@ -182,8 +194,8 @@ public:
 	bool empty() const { return (head == 0); }
 
 	/**
-	 * Return the total extent of the object in octets. This is always equal to
-	 * prefix() plus length() plus suffix().
+	 * Return the total extent of the object in octets. Unless the object is
+	 * read-only, this is always equal to prefix() plus length() plus suffix().
 	 *
 	 * @return the total length of the data storage in octets.
 	 */
@@ -205,24 +217,53 @@ public:
 	size_t length() const { return tail - head; }
 
 	/**
-	 * Return the number of octets available to be prepended.
+	 * Return the number of octets available to be prepended. This is zero
+	 * if the object is read-only.
 	 *
 	 * @return the number of octets available to be prepended.
 	 */
-	size_t prefix() const { return (head == 0) ? extent : head - payload; }
+	size_t prefix() const { return readonly ? 0 : (head == 0) ? extent : head - payload; }
 
 	/**
-	 * Return the number of octets available to be appended.
+	 * Return the number of octets available to be appended. This is zero
+	 * if the object is read-only.
 	 *
 	 * @return the number of octets available to be eppended.
 	 */
-	size_t suffix() const { return (tail == 0) ? extent : payload + extent - tail; }
+	size_t suffix() const { return readonly ? 0 : (tail == 0) ? extent : payload + extent - tail; }
 
 	/**
 	 * Return the object to the empty state.
 	 */
 	void clear() { head = 0; tail = 0; }
 
+	/**
+	 * Return a pointer to the space into which up to suffix() octets may be
+	 * placed directly, without copying them through append(), and then
+	 * claimed by commit(). If the object is empty, this space begins at the
+	 * start of the buffer regardless of the fraction.
+	 *
+	 * @return a pointer to the space following the user data in the object.
+	 */
+	void * reserve() { return (tail == 0) ? payload : tail; }
+
+	/**
+	 * Claim as user data no more than the specified length of data that has
+	 * been placed directly into the space returned by reserve().
+	 *
+	 * @param length is the length of the data to claim in octets.
+	 * @return the actual number of octets claimed.
+	 */
+	size_t commit(size_t length);
+
+	/**
+	 * Return a pointer to this object as a PacketDataShared if it is one, so
+	 * that it can be shared again without being wrapped, or NULL otherwise.
+	 *
+	 * @return a pointer to this object as a PacketDataShared or NULL.
+	 */
+	virtual PacketDataShared * shared() { return 0; }
+
 private:
 
     /**
@@ -348,8 +389,348 @@ public:
 
 };
 
+/**
+ * PacketDataShared is a PacketData that is one of possibly many views of the
+ * data of another PacketData, which it takes. The views share a reference
+ * count, maintained atomically, and the last view to be deleted deletes the
+ * PacketData, on whichever thread that happens. Packets in different threads
+ * can therefore share heap allocated data, but not data in a
+ * PacketBufferPooled, since deleting it returns it to a PacketPool, which is
+ * not thread safe, unless the application serializes all use of that pool.
+ * Each view has
+ * its own head and tail so that it can be consumed independently of the
+ * others. Each view is read-only: it reports no prefix or suffix space, even
+ * after some of its data has been consumed, so nothing is ever prepended,
+ * appended, or committed into the shared data through it. A Packet instead
+ * prepends or appends new data to a newly allocated buffer, in effect copying
+ * on write.
+ * @author coverclock@diag.com (Chip Overclock)
+ */
+class PacketDataShared : public PacketData {
+
+public:
+
+	/**
+	 * Ctor.
+	 *
+	 * @param rd refers to the PacketData (or derivative) whose data is to be
+	 *        shared, which this object takes.
+	 */
+	explicit PacketDataShared(PacketData & rd /* TAKEN */);
+
+	/**
+	 * Dtor. If this is the last view, the shared PacketData is deleted.
+	 */
+	virtual ~PacketDataShared();
+
+	/**
+	 * Return a new view of the data of this view that has not yet been
+	 * consumed.
+	 *
+	 * @return a pointer to the new view.
+	 */
+	PacketDataShared * share() const;
+
+	/**
+	 * Return the number of views sharing the data.
+	 *
+	 * @return the number of views sharing the data.
+	 */
+	int getReferences() const { return reference->count; }
+
+	/**
+	 * Return a pointer to this object.
+	 *
+	 * @return a pointer to this object.
+	 */
+	virtual PacketDataShared * shared() { return this; }
+
+private:
+
+	/**
+	 * This is shared by all of the views of the same data.
+	 */
+	struct Reference {
+		PacketData * data;
+		volatile int count;
+	};
+
+	/**
+	 * Ctor.
+	 *
+	 * @param rp points to the shared reference.
+	 * @param dp points to the data.
+	 * @param ve is the length of the data in octets.
+	 */
+	PacketDataShared(Reference * rp, const void * dp, size_t ve);
+
+	/**
+	 * Points to the shared reference.
+	 */
+	Reference * const reference;
+
+};
+
+class PacketPool;
+
+/**
+ * PacketBufferPooled is a PacketBuffer whose header and data array are a
+ * single block of storage recycled by a PacketPool. It can only be allocated
+ * by a PacketPool. Deleting it, as a Packet does when its data have all been
+ * consumed, returns its storage to the PacketPool from which it came instead
+ * of to the heap, so it can be mixed with any other kind of PacketData.
+ * @author coverclock@diag.com (Chip Overclock)
+ */
+class PacketBufferPooled : public PacketBuffer {
+
+public:
+
+	/**
+	 * Dtor.
+	 */
+	virtual ~PacketBufferPooled() {}
+
+	/**
+	 * Return the storage of a deleted object to its PacketPool.
+	 *
+	 * @param ptr points to the storage of the deleted object.
+	 */
+	static void operator delete(void * ptr);
+
+private:
+
+	friend class PacketPool;
+
+	/**
+	 * Ctor.
+	 *
+	 * @param bp points to the buffer array that follows the object.
+	 * @param ve is the size of the buffer array in octets.
+	 * @param vf specifies how the buffer array is to be initialized: for
+	 *        append, prepend, or either.
+	 */
+	explicit PacketBufferPooled(Datum * bp /* UNTAKEN */, size_t ve, size_t vf)
+	: PacketBuffer(bp, ve, vf)
+	{}
+
+	/**
+	 * Construct the object in storage provided by a PacketPool.
+	 *
+	 * @param size is the size of the object in octets.
+	 * @param ptr points to the storage.
+	 * @return a pointer to the storage.
+	 */
+	static void * operator new(size_t /* size */, void * ptr) { return ptr; }
+
+	/**
+	 * Called only if the ctor throws during construction in storage provided
+	 * by a PacketPool, which it does not.
+	 *
+	 * @param ptr points to the storage.
+	 * @param where points to the storage.
+	 */
+	static void operator delete(void * /* ptr */, void * /* where */) {}
+
+};
+
+/**
+ * PacketPool recycles the storage of the PacketBufferPooled objects that a
+ * Packet allocates as it needs buffer space, so that a Packet under steady
+ * load does not go to the heap for every buffer. Each object and its data
+ * array share one block of storage. Released storage is kept on a free list
+ * for reuse, up to a limit, beyond which it is returned to the heap. A pool
+ * can be shared by many Packets, but, like Packet, it is not thread safe.
+ * The pool must outlive every object allocated from it.
+ * @author coverclock@diag.com (Chip Overclock)
+ */
+class PacketPool {
+
+public:
+
+	/**
+	 * Specifies the default allocation size in octets of each buffer array.
+	 */
+	static const size_t ALLOCATION = 4096;
+
+	/**
+	 * Specifies the default maximum number of unused buffers kept for reuse.
+	 */
+	static const size_t LIMIT = 64;
+
+	/**
+	 * Ctor.
+	 *
+	 * @param va is the allocation size of each buffer array in octets.
+	 * @param vl is the maximum number of unused buffers kept for reuse.
+	 */
+	explicit PacketPool(size_t va = ALLOCATION, size_t vl = LIMIT)
+	: allocation(va)
+	, limit(vl)
+	, cache(0)
+	, cached(0)
+	, hits(0)
+	, misses(0)
+	, recycles(0)
+	, releases(0)
+	{}
+
+	/**
+	 * Dtor. Unused buffers kept for reuse are returned to the heap.
+	 */
+	virtual ~PacketPool();
+
+	/**
+	 * Allocate a PacketBufferPooled in the empty state, reusing the storage
+	 * of a released one if any is available.
+	 *
+	 * @param vf specifies how the buffer array is to be initialized: for
+	 *        append, prepend, or either.
+	 * @return a pointer to the object.
+	 */
+	PacketBufferPooled * get(size_t vf = PacketBuffer::EITHER);
+
+	/**
+	 * Return the allocation size of each buffer array in octets.
+	 *
+	 * @return the allocation size of each buffer array in octets.
+	 */
+	size_t size() const { return allocation; }
+
+	/**
+	 * Return the number of allocations satisfied by reusing storage.
+	 *
+	 * @return the number of allocations satisfied by reusing storage.
+	 */
+	size_t getHits() const { return hits; }
+
+	/**
+	 * Return the number of allocations that went to the heap.
+	 *
+	 * @return the number of allocations that went to the heap.
+	 */
+	size_t getMisses() const { return misses; }
+
+	/**
+	 * Return the number of releases whose storage was kept for reuse.
+	 *
+	 * @return the number of releases whose storage was kept for reuse.
+	 */
+	size_t getRecycles() const { return recycles; }
+
+	/**
+	 * Return the number of releases whose storage was returned to the heap
+	 * because the limit of unused buffers had been reached.
+	 *
+	 * @return the number of releases whose storage was returned to the heap.
+	 */
+	size_t getReleases() const { return releases; }
+
+	/**
+	 * Return the number of unused buffers currently kept for reuse.
+	 *
+	 * @return the number of unused buffers currently kept for reuse.
+	 */
+	size_t getCached() const { return cached; }
+
+    /**
+     * Displays internal information about this object to the specified
+     * output object. Useful for debugging and troubleshooting.
+     *
+     * @param level sets the verbosity of the output. What this means
+     *        is object dependent. However, the level is passed from outer to
+     *        inner objects this object calls the show methods of its inherited
+     *        or composited objects.
+     * @param display points to the output object to which output is sent. If
+     *        null (zero), the default platform output object is used as the
+     *        effective output object. The effective output object is passed
+     *        from outer to inner objects as this object calls the show methods
+     *        of its inherited and composited objects.
+     * @param indent specifies the level of indentation. One more than this
+     *        value is passed from outer to inner objects as this object calls
+     *        the show methods of its inherited and composited objects.
+     */
+    virtual void show(int level = 0, Output * display = 0, int indent = 0) const;
+
+private:
+
+	friend class PacketBufferPooled;
+
+	/**
+	 * This header precedes each object in its block of storage.
+	 */
+	struct Node {
+		PacketPool * pool;
+		Node * next;
+	};
+
+	/**
+	 * Keep the storage of a deleted object for reuse, or return it to the
+	 * heap if the limit of unused buffers has been reached.
+	 *
+	 * @param np points to the header of the storage.
+	 */
+	void put(Node * np);
+
+	/**
+	 * This is the allocation size of each buffer array in octets.
+	 */
+	const size_t allocation;
+
+	/**
+	 * This is the maximum number of unused buffers kept for reuse.
+	 */
+	const size_t limit;
+
+	/**
+	 * Points to the first unused block of storage or NULL if none.
+	 */
+	Node * cache;
+
+	/**
+	 * This is the number of unused blocks of storage.
+	 */
+	size_t cached;
+
+	/**
+	 * This is the number of allocations satisfied by reusing storage.
+	 */
+	size_t hits;
+
+	/**
+	 * This is the number of allocations that went to the heap.
+	 */
+	size_t misses;
+
+	/**
+	 * This is the number of releases whose storage was kept for reuse.
+	 */
+	size_t recycles;
+
+	/**
+	 * This is the number of releases whose storage was returned to the heap.
+	 */
+	size_t releases;
+
+    /**
+     *  Copy ctor.
+     *
+     *  @param that refers to an R-value object of this type.
+     */
+    PacketPool(const PacketPool & that);
+
+    /**
+     *  Assignment operator.
+     *
+     *  @param that refers to an R-value object of this type.
+     */
+    PacketPool& operator=(const PacketPool & that);
+
+};
+
 class Packet;
 
+class PacketCursor;
+
 /**
  * PacketInput implements an Input functor for a Packet.
  * @author coverclock@diag.com (Chip Overclock)
@@ -607,6 +988,12 @@ public:
 	 */
 	static const size_t APPEND = PacketBufferDynamic::APPEND;
 
+	/**
+	 * Specifies the number of buffers allocated ahead of each scatter read
+	 * when sourcing from a file descriptor.
+	 */
+	static const size_t SCATTER = 8;
+
     /**
      *  Ctor.
      *
@@ -616,8 +1003,33 @@ public:
     explicit Packet(size_t va = ALLOCATION, size_t vf = APPEND)
     : allocation(va)
     , fraction(vf)
+    , pool(0)
+    , head(0)
+    , tail(0)
+    , octets(0)
+    , count(0)
+    , exact(true)
+    , in(*this)
+    , out(*this)
+    {}
+
+    /**
+     *  Ctor. Buffer space is allocated from the specified pool, whose
+     *  allocation size becomes the allocation size of the object. The pool
+     *  must outlive the object.
+     *
+     *  @param rp refers to the pool.
+     *  @param vf is the fraction of the very first allocation.
+     */
+    explicit Packet(PacketPool & rp /* UNTAKEN */, size_t vf = APPEND)
+    : allocation(rp.size())
+    , fraction(vf)
+    , pool(&rp)
     , head(0)
     , tail(0)
+    , octets(0)
+    , count(0)
+    , exact(true)
     , in(*this)
     , out(*this)
     {}
@@ -671,7 +1083,8 @@ public:
 
 	/**
 	 * Append the data by copying it, allocating new PacketBufferDynamic objects
-	 * and appended them as needed. Data is copied from front to back.
+	 * (or PacketBufferPooled objects if the object has a pool) and appended
+	 * them as needed. Data is copied from front to back.
 	 *
 	 * @param data points to the data.
 	 * @param length is the length of the data to append in octets.
@@ -681,7 +1094,8 @@ public:
 
 	/**
 	 * Prepend the data by copying it, allocating new PacketBufferDynamic
-	 * objects and prepending them as needed. Data is copied from back to front.
+	 * objects (or PacketBufferPooled objects if the object has a pool) and
+	 * prepending them as needed. Data is copied from back to front.
 	 *
 	 * @param data points to the data.
 	 * @param length is the length of the data to prepend in octets.
@@ -708,6 +1122,60 @@ public:
 	 */
 	size_t consume(size_t length) { return consume(0, length); }
 
+	/**
+	 * Consume no more than the specified length of data if it is available,
+	 * stopping after the first occurrence of the delimiter, which is also
+	 * consumed. Each object in the linked list is scanned in place and data
+	 * is copied a run at a time rather than an octet at a time.
+	 *
+	 * @param buffer points to the buffer, or NULL if the data is discarded.
+	 * @param length is the length of the data to consume in octets.
+	 * @param delimiter is the octet at which to stop, for example a newline.
+	 * @return the number of octets consumed including any delimiter.
+	 */
+	size_t consume(void * buffer, size_t length, int delimiter);
+
+	/**
+	 * Return a pointer to the data at the front of this object, without
+	 * copying or consuming it, provided that the data up to and including the
+	 * first occurrence of the delimiter lies entirely within one object in
+	 * the linked list. This is typically used to examine a line in place and
+	 * then discard it with consume(length).
+	 *
+	 * @param delimiter is the octet at which to stop, for example a newline.
+	 * @param length is set to the number of octets up to and including the
+	 *        delimiter, or to zero if NULL is returned.
+	 * @return a pointer to the data or NULL if the delimiter is not found in
+	 *         the first object that is not empty.
+	 */
+	const void * peek(int delimiter, size_t & length) const;
+
+	/**
+	 * Append the data of this object to the specified Packet without copying
+	 * it. Each object in the linked list of this object that is not already
+	 * a PacketDataShared is replaced by one that takes it, and a new view of
+	 * each is appended to the specified Packet. Either Packet may then
+	 * consume its data independently of the other, or prepend or append new
+	 * data, for example a header specific to one destination, without
+	 * affecting the other. Packets that share the data of PacketBufferPooled
+	 * objects may only be used in different threads if the application
+	 * serializes all use of their PacketPool.
+	 *
+	 * @param that refers to the Packet to which the data is appended.
+	 * @return the number of octets shared.
+	 */
+	size_t share(Packet & that);
+
+	/**
+	 * Allocate a new Packet with the same allocation, fraction, and pool, if
+	 * any, as this object, and share the data of this object with it. If
+	 * the object has a pool, the clone and this object may only be used in
+	 * different threads if the application serializes all use of the pool.
+	 *
+	 * @return a pointer to the new Packet, which the caller must delete.
+	 */
+	Packet * clone();
+
 	/**
 	 * Tranfers the contents of an input functor into this object using an
 	 * algorithm that minimizes memory to memory copying until the input is
@@ -729,14 +1197,90 @@ public:
 	size_t sink(Output& to);
 
 	/**
-	 * Return the number of octets available to be consumed. This is done at
-	 * every call by traversing the entire linked list and summing the length
-	 * of each individual PacketData.
+	 * Transfers the contents of a file descriptor into this object until
+	 * end of file or an error occurs, including would-block on a
+	 * non-blocking descriptor. Each readv(2) scatters data into whatever
+	 * space remains at the end of the last object in the linked list plus
+	 * SCATTER buffers. Buffers left unused by one readv(2) are reused by the
+	 * next, so only those that received data are replaced, and any still
+	 * unused at the end are released.
+	 *
+	 * @param fd is the file descriptor.
+	 * @return the number of octets transferred.
+	 */
+	size_t source(int fd);
+
+	/**
+	 * Transfers the contents of this object into a file descriptor, gathering
+	 * up to IOV_MAX objects from the linked list into each writev(2), until
+	 * the object is empty or an error occurs, including would-block on a
+	 * non-blocking descriptor. Unlike sink(Output&), data that could not be
+	 * transferred remains in the object.
+	 *
+	 * @param fd is the file descriptor.
+	 * @return the number of octets transferred.
+	 */
+	size_t sink(int fd);
+
+	/**
+	 * Return a pointer to the space at the end of this object into which
+	 * data may be placed directly, without copying it through append(), and
+	 * then claimed by commit(). A new buffer is appended if the last object in
+	 * the linked list has no such space.
+	 *
+	 * @param length is set to the size of the space in octets.
+	 * @return a pointer to the space.
+	 */
+	void * reserve(size_t & length);
+
+	/**
+	 * Claim as data no more than the specified length of data that has been
+	 * placed directly into the space returned by reserve().
+	 *
+	 * @param length is the length of the data to claim in octets.
+	 * @return the actual number of octets claimed.
+	 */
+	size_t commit(size_t length);
+
+	/**
+	 * Reduce the number of objects in the linked list by discarding empty
+	 * objects and merging each under-filled object with the one that follows
+	 * it, either in the space at its end, or, if the two together fit within
+	 * the allocation size, in a newly allocated buffer.
+	 *
+	 * @return the number of objects removed from the linked list.
+	 */
+	size_t compact();
+
+	/**
+	 * Make the data of this object contiguous, moving it if necessary into a
+	 * single newly allocated buffer, and return a pointer to it. The data is
+	 * not consumed.
+	 *
+	 * @return a pointer to the data or NULL if the object is empty.
+	 */
+	const void * linearize();
+
+	/**
+	 * Return the number of octets available to be consumed. This is kept as
+	 * data is appended, prepended, and consumed through this object, so it
+	 * takes constant time. If a PacketData (or derivative) has been appended
+	 * or prepended by the application, which might change it directly, the
+	 * length is computed instead by traversing the entire linked list and
+	 * summing the length of each individual PacketData, until this object is
+	 * next empty.
 	 *
 	 * @return the number of octets available to be consumed.
 	 */
 	size_t length() const;
 
+	/**
+	 * Return the number of objects in the linked list.
+	 *
+	 * @return the number of objects in the linked list.
+	 */
+	size_t segments() const { return count; }
+
     /**
      * Displays internal information about this object to the specified
      * output object. Useful for debugging and troubleshooting.
@@ -770,6 +1314,12 @@ private:
      */
 	const size_t fraction;
 
+	/**
+	 * Points to the pool from which buffer space is allocated, or NULL if
+	 * it is allocated from the heap.
+	 */
+	PacketPool * const pool;
+
 	/**
 	 * Points to the first object on the linked list or NULL if empty.
 	 */
@@ -780,6 +1330,22 @@ private:
 	 */
     PacketData * tail;
 
+    /**
+     * This is the number of octets available to be consumed.
+     */
+    size_t octets;
+
+    /**
+     * This is the number of objects on the linked list.
+     */
+    size_t count;
+
+    /**
+     * This is true if octets is known to be accurate, which it is as long
+     * as the application has not appended or prepended its own PacketData.
+     */
+    bool exact;
+
     /**
      *  This is the Input functor to the Packet.
      */
@@ -790,6 +1356,31 @@ private:
      */
     PacketOutput out;
 
+    friend class PacketCursor;
+
+    /**
+     * Link a PacketData (or derivative) onto the linked list.
+     *
+     * @param rd refers to a PacketData (or derivative).
+     * @param front if true prepends the object, otherwise appends it.
+     */
+    void link(PacketData & rd /* TAKEN */, bool front);
+
+    /**
+     * Unlink the first object from the linked list and delete it.
+     */
+    void drop();
+
+    /**
+     * Allocate a buffer, from the pool if there is one, otherwise from the
+     * heap.
+     *
+     * @param vf specifies how the buffer is to be initialized: for append,
+     *        prepend, or either.
+     * @return a reference to the buffer.
+     */
+    PacketBuffer & buffer(size_t vf);
+
 private:
 
     /**
@@ -808,6 +1399,155 @@ private:
 
 };
 
+/**
+ * PacketCursor is a read-only position within the data of a Packet. It can
+ * expose the data as a series of contiguous spans, each a pointer and a
+ * length within one object in the linked list, copy data out without
+ * consuming it, and move forward, or to any offset, without copying. A
+ * decoder can use it to parse a header in place and then, once it has
+ * committed to the parse, consume exactly tell() octets from the Packet.
+ * A cursor may be copied to remember a position. Any change to the Packet
+ * invalidates the cursor until it is rewound.
+ * @author coverclock@diag.com (Chip Overclock)
+ */
+class PacketCursor {
+
+public:
+
+	/**
+	 * Ctor. The cursor is positioned at the beginning of the data.
+	 *
+	 * @param rp refers to the Packet.
+	 */
+	explicit PacketCursor(const Packet & rp /* UNTAKEN */)
+	: packet(&rp)
+	, here(0)
+	, offset(0)
+	, position(0)
+	{ rewind(); }
+
+	/**
+	 * Dtor.
+	 */
+	virtual ~PacketCursor() {}
+
+	/**
+	 * Position the cursor at the beginning of the data.
+	 */
+	void rewind();
+
+	/**
+	 * Return true if the cursor is at the end of the data, false otherwise.
+	 *
+	 * @return true if the cursor is at the end of the data, false otherwise.
+	 */
+	bool end() const { return (here == 0); }
+
+	/**
+	 * Return the offset of the cursor from the beginning of the data.
+	 *
+	 * @return the offset of the cursor in octets.
+	 */
+	size_t tell() const { return position; }
+
+	/**
+	 * Return the contiguous span of data from the cursor to the end of the
+	 * object in the linked list in which the cursor lies, without moving.
+	 *
+	 * @param length is set to the length of the span in octets, which is
+	 *        zero only at the end of the data.
+	 * @return a pointer to the span or NULL at the end of the data.
+	 */
+	const void * span(size_t & length) const;
+
+	/**
+	 * Move the cursor forward no more than the specified length without
+	 * copying any data.
+	 *
+	 * @param length is the distance to move in octets.
+	 * @return the actual distance moved in octets.
+	 */
+	size_t advance(size_t length);
+
+	/**
+	 * Move the cursor to the specified offset from the beginning of the data,
+	 * or to the end of the data if the offset is beyond it.
+	 *
+	 * @param where is the offset in octets.
+	 * @return the resulting offset in octets.
+	 */
+	size_t seek(size_t where);
+
+	/**
+	 * Copy no more than the specified length of data from the cursor into the
+	 * buffer without moving.
+	 *
+	 * @param buffer points to the buffer.
+	 * @param length is the length of the data to copy in octets.
+	 * @return the actual number of octets copied.
+	 */
+	size_t peek(void * buffer, size_t length) const;
+
+	/**
+	 * Copy no more than the specified length of data from the cursor into the
+	 * buffer and move past it.
+	 *
+	 * @param buffer points to the buffer.
+	 * @param length is the length of the data to copy in octets.
+	 * @return the actual number of octets copied.
+	 */
+	size_t read(void * buffer, size_t length);
+
+    /**
+     * Displays internal information about this object to the specified
+     * output object. Useful for debugging and troubleshooting.
+     *
+     * @param level sets the verbosity of the output. What this means
+     *        is object dependent. However, the level is passed from outer to
+     *        inner objects this object calls the show methods of its inherited
+     *        or composited objects.
+     * @param display points to the output object to which output is sent. If
+     *        null (zero), the default platform output object is used as the
+     *        effective output object. The effective output object is passed
+     *        from outer to inner objects as this object calls the show methods
+     *        of its inherited and composited objects.
+     * @param indent specifies the level of indentation. One more than this
+     *        value is passed from outer to inner objects as this object calls
+     *        the show methods of its inherited and composited objects.
+     */
+    virtual void show(int level = 0, Output * display = 0, int indent = 0) const;
+
+private:
+
+	/**
+	 * Move past any objects in the linked list that have no data left at or
+	 * beyond the cursor.
+	 */
+	void skip();
+
+	/**
+	 * Points to the Packet.
+	 */
+	const Packet * packet;
+
+	/**
+	 * Points to the object in the linked list in which the cursor lies, or
+	 * NULL at the end of the data.
+	 */
+	const PacketData * here;
+
+	/**
+	 * This is the offset of the cursor within the data of that object.
+	 */
+	size_t offset;
+
+	/**
+	 * This is the offset of the cursor from the beginning of the data.
+	 */
+	size_t position;
+
+};
+
 // This is here because the type of packet isn't fully defined during the
 // class declaration.
 inline size_t PacketInput::getLength() const { return packet.length(); }
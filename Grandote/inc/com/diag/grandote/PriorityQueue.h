@@ -0,0 +1,732 @@
+#ifndef _COM_DIAG_GRANDOTE_PRIORITYQUEUE_H_
+#define _COM_DIAG_GRANDOTE_PRIORITYQUEUE_H_
+
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Declares the PriorityQueue and PriorityNode templates.
+ *
+ *  @see    PriorityQueue
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include <functional>
+#include "com/diag/grandote/Print.h"
+#include "com/diag/grandote/Platform.h"
+
+
+namespace com { namespace diag { namespace grandote {
+
+template <typename _TYPE_, typename _LESS_> class PriorityQueue;
+
+/**
+ *  Implements a node in an intrusive PriorityQueue. Like LinkType, the
+ *  node is embedded in (or otherwise owned by) the payload object that it
+ *  points to, so putting an object on a queue allocates no memory. The
+ *  node itself is the handle by which an application finds its object on
+ *  the queue again to remove it or to change its priority.
+ *
+ *  A node may be on at most one queue at a time. A node must be removed
+ *  from its queue before it is destroyed.
+ *
+ *  @see    PriorityQueue
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+template <typename _TYPE_>
+class PriorityNode {
+
+    template <typename _ANYTYPE_, typename _ANYLESS_> friend class PriorityQueue;
+
+public:
+
+    /**
+     *  Constructor. A newly constructed node is on no queue.
+     *
+     *  @param  object      points to the payload of this node.
+     */
+    explicit PriorityNode(_TYPE_* object = 0);
+
+    /**
+     *  Destructor.
+     */
+    ~PriorityNode();
+
+    /**
+     *  Gets the pointer to the payload of this node.
+     *
+     *  @return the pointer to the payload of this node.
+     */
+    _TYPE_* getPayload() const;
+
+    /**
+     *  Stores a pointer to the payload of this node.
+     *
+     *  @param  object      points to the payload of this node.
+     *
+     *  @return the pointer now stored in the payload of this node.
+     */
+    _TYPE_* setPayload(_TYPE_* object);
+
+    /**
+     *  Returns true if this node is on a queue.
+     *
+     *  @return true if this node is on a queue.
+     */
+    bool isQueued() const;
+
+    /**
+     *  Displays internal information about this object to the specified
+     *  output object. Useful for debugging and troubleshooting.
+     *
+     *  @param  level   sets the verbosity of the output. What this means
+     *                  is object dependent. However, the level is passed
+     *                  from outer to inner objects this object calls the
+     *                  show methods of its inherited or composited objects.
+     *
+     *  @param display  points to the output object to which output is
+     *                  sent. If null (zero), the default platform output
+     *                  object is used as the effective output object. The
+     *                  effective output object is passed from outer to
+     *                  inner objects as this object calls the show methods
+     *                  of its inherited and composited objects.
+     *
+     *  @param  indent  specifies the level of indentation. One more than
+     *                  this value is passed from outer to inner objects
+     *                  as this object calls the show methods of its
+     *                  inherited and composited objects.
+     */
+    void show(int level = 0, Output* display = 0, int indent = 0) const;
+
+private:
+
+    /**
+     *  Returns this node to the state of being on no queue.
+     */
+    void reset();
+
+    /**
+     *  Points to the leftmost child of this node, or null if none.
+     */
+    PriorityNode<_TYPE_>* child;
+
+    /**
+     *  Points to the next sibling to the right of this node, or null if
+     *  none.
+     */
+    PriorityNode<_TYPE_>* sibling;
+
+    /**
+     *  Points to the sibling to the left of this node, or to the parent
+     *  of this node if it is the leftmost child, or null if this node is
+     *  the root of a queue, or to this node if it is on no queue.
+     */
+    PriorityNode<_TYPE_>* previous;
+
+    /**
+     *  Points to the payload.
+     */
+    _TYPE_* payload;
+
+    /**
+     *  Copy constructor.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    PriorityNode(const PriorityNode<_TYPE_>& that);
+
+    /**
+     *  Assignment operator.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    PriorityNode<_TYPE_>& operator=(const PriorityNode<_TYPE_>& that);
+
+};
+
+
+//
+//  Constructor.
+//
+template <typename _TYPE_>
+inline PriorityNode<_TYPE_>::PriorityNode(_TYPE_* object) :
+    child(0),
+    sibling(0),
+    previous(this),
+    payload(object)
+{
+}
+
+
+//
+//  Destructor.
+//
+template <typename _TYPE_>
+inline PriorityNode<_TYPE_>::~PriorityNode() {
+}
+
+
+//
+//  Return the payload.
+//
+template <typename _TYPE_>
+inline _TYPE_* PriorityNode<_TYPE_>::getPayload() const {
+    return this->payload;
+}
+
+
+//
+//  Set the payload.
+//
+template <typename _TYPE_>
+inline _TYPE_* PriorityNode<_TYPE_>::setPayload(_TYPE_* object) {
+    return this->payload = object;
+}
+
+
+//
+//  Return true if this node is on a queue.
+//
+template <typename _TYPE_>
+inline bool PriorityNode<_TYPE_>::isQueued() const {
+    return this->previous != this;
+}
+
+
+//
+//  Reset this node to being on no queue.
+//
+template <typename _TYPE_>
+inline void PriorityNode<_TYPE_>::reset() {
+    this->child = 0;
+    this->sibling = 0;
+    this->previous = this;
+}
+
+
+//
+//  Show this object on the output object.
+//
+template <typename _TYPE_>
+void PriorityNode<_TYPE_>::show(int /* level */, Output* display, int indent) const {
+    Platform& pl = Platform::instance();
+    Print printf(display);
+    const char* sp = printf.output().indentation(indent);
+    char component[sizeof(__FILE__)];
+    printf("%s%s(%p)[%lu]:\n",
+        sp, pl.component(__FILE__, component, sizeof(component)),
+        this, sizeof(*this));
+    printf("%s child=%p\n", sp, this->child);
+    printf("%s sibling=%p\n", sp, this->sibling);
+    printf("%s previous=%p\n", sp, this->previous);
+    printf("%s payload=%p\n", sp, this->payload);
+}
+
+
+/**
+ *  Implements an intrusive priority queue of PriorityNode objects whose
+ *  payloads are ordered by a comparison functor, by default the less than
+ *  operator of the payload type. The node at the head of the queue is the
+ *  one whose payload compares least; nodes with equal payloads come off
+ *  the queue in no particular order. The queue is a pairing heap: insert
+ *  and peek are O(1), remove of the head is amortized O(log n), and a node
+ *  is unlinked from anywhere in the queue by its handle in O(1), after
+ *  which its children are merged back in amortized O(log n). A node whose
+ *  payload has become less (for example, an earlier deadline) is moved
+ *  forward by decrease in O(1); a payload that may have changed in either
+ *  direction is repositioned by update.
+ *
+ *  It is an error to remove, decrease or update a node that is on some
+ *  other queue. The caller must not change the ordering of a payload on
+ *  the queue except as described above.
+ *
+ *  This class is not thread-safe. Serialization is the responsibility
+ *  of the caller.
+ *
+ *  @see    M. Fredman, R. Sedgewick, D. Sleator, R. Tarjan, "The Pairing
+ *          Heap: A New Form of Self-Adjusting Heap", Algorithmica, 1,
+ *          1986, pp. 111-129
+ *
+ *  @see    PriorityNode
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+template <typename _TYPE_, typename _LESS_ = std::less<_TYPE_> >
+class PriorityQueue {
+
+public:
+
+    /**
+     *  Constructor. This queue will be empty.
+     *
+     *  @param  comparator  refers to the functor that returns true if its
+     *                      first payload argument is ordered before its
+     *                      second.
+     */
+    explicit PriorityQueue(const _LESS_& comparator = _LESS_());
+
+    /**
+     *  Destructor. Any nodes still on this queue are left in the state
+     *  of being on no queue.
+     */
+    ~PriorityQueue();
+
+    /**
+     *  Returns the number of nodes on this queue.
+     *
+     *  @return the number of nodes on this queue.
+     */
+    size_t size() const;
+
+    /**
+     *  Returns true if this queue is empty.
+     *
+     *  @return true if this queue is empty.
+     */
+    bool empty() const;
+
+    /**
+     *  Inserts a node onto this queue in order of its payload.
+     *
+     *  @param  node        refers to the node.
+     *
+     *  @return true if successful, false if the node is already on a queue.
+     */
+    bool insert(PriorityNode<_TYPE_>& node);
+
+    /**
+     *  Returns a pointer to the node at the head of this queue without
+     *  removing it.
+     *
+     *  @return a pointer to the head node or null (0) if empty.
+     */
+    PriorityNode<_TYPE_>* peek() const;
+
+    /**
+     *  Removes the node at the head of this queue.
+     *
+     *  @return a pointer to the former head node or null (0) if empty.
+     */
+    PriorityNode<_TYPE_>* remove();
+
+    /**
+     *  Removes a node from anywhere on this queue.
+     *
+     *  @param  node        refers to the node.
+     *
+     *  @return a pointer to the node or null (0) if it was on no queue.
+     */
+    PriorityNode<_TYPE_>* remove(PriorityNode<_TYPE_>& node);
+
+    /**
+     *  Moves a node on this queue towards the head after the application
+     *  has changed its payload so that it compares the same or less than
+     *  it did before.
+     *
+     *  @param  node        refers to the node.
+     *
+     *  @return true if successful, false if the node is on no queue.
+     */
+    bool decrease(PriorityNode<_TYPE_>& node);
+
+    /**
+     *  Repositions a node on this queue after the application has changed
+     *  its payload in either direction.
+     *
+     *  @param  node        refers to the node.
+     *
+     *  @return true if successful, false if the node is on no queue.
+     */
+    bool update(PriorityNode<_TYPE_>& node);
+
+    /**
+     *  Removes all nodes from this queue, leaving each in the state of
+     *  being on no queue.
+     */
+    void clear();
+
+    /**
+     *  Displays internal information about this object to the specified
+     *  output object. Useful for debugging and troubleshooting.
+     *
+     *  @param  level   sets the verbosity of the output. What this means
+     *                  is object dependent. However, the level is passed
+     *                  from outer to inner objects this object calls the
+     *                  show methods of its inherited or composited objects.
+     *
+     *  @param display  points to the output object to which output is
+     *                  sent. If null (zero), the default platform output
+     *                  object is used as the effective output object. The
+     *                  effective output object is passed from outer to
+     *                  inner objects as this object calls the show methods
+     *                  of its inherited and composited objects.
+     *
+     *  @param  indent  specifies the level of indentation. One more than
+     *                  this value is passed from outer to inner objects
+     *                  as this object calls the show methods of its
+     *                  inherited and composited objects.
+     */
+    void show(int level = 0, Output* display = 0, int indent = 0) const;
+
+private:
+
+    /**
+     *  Makes the root that compares greater the leftmost child of the other.
+     *
+     *  @param  one         points to a root.
+     *
+     *  @param  two         points to another root.
+     *
+     *  @return a pointer to the surviving root.
+     */
+    PriorityNode<_TYPE_>* meld(PriorityNode<_TYPE_>* one, PriorityNode<_TYPE_>* two);
+
+    /**
+     *  Merges a list of siblings into one tree using the two pass pairing
+     *  of the standard pairing heap.
+     *
+     *  @param  first       points to the leftmost sibling or null.
+     *
+     *  @return a pointer to the root of the merged tree or null.
+     */
+    PriorityNode<_TYPE_>* combine(PriorityNode<_TYPE_>* first);
+
+    /**
+     *  Unlinks a node that is not the root, with its subtree, from its
+     *  parent and siblings.
+     *
+     *  @param  node        points to the node.
+     */
+    void detach(PriorityNode<_TYPE_>* node);
+
+    /**
+     *  Points to the root node or null if empty.
+     */
+    PriorityNode<_TYPE_>* root;
+
+    /**
+     *  This is the number of nodes on this queue.
+     */
+    size_t count;
+
+    /**
+     *  This is the comparison functor.
+     */
+    _LESS_ less;
+
+    /**
+     *  Copy constructor.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    PriorityQueue(const PriorityQueue<_TYPE_, _LESS_>& that);
+
+    /**
+     *  Assignment operator.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    PriorityQueue<_TYPE_, _LESS_>& operator=(const PriorityQueue<_TYPE_, _LESS_>& that);
+
+};
+
+
+//
+//  Constructor.
+//
+template <typename _TYPE_, typename _LESS_>
+inline PriorityQueue<_TYPE_, _LESS_>::PriorityQueue(const _LESS_& comparator) :
+    root(0),
+    count(0),
+    less(comparator)
+{
+}
+
+
+//
+//  Destructor.
+//
+template <typename _TYPE_, typename _LESS_>
+inline PriorityQueue<_TYPE_, _LESS_>::~PriorityQueue() {
+    this->clear();
+}
+
+
+//
+//  Return the number of nodes.
+//
+template <typename _TYPE_, typename _LESS_>
+inline size_t PriorityQueue<_TYPE_, _LESS_>::size() const {
+    return this->count;
+}
+
+
+//
+//  Return true if empty.
+//
+template <typename _TYPE_, typename _LESS_>
+inline bool PriorityQueue<_TYPE_, _LESS_>::empty() const {
+    return this->root == 0;
+}
+
+
+//
+//  Return the head node.
+//
+template <typename _TYPE_, typename _LESS_>
+inline PriorityNode<_TYPE_>* PriorityQueue<_TYPE_, _LESS_>::peek() const {
+    return this->root;
+}
+
+
+//
+//  Meld two roots.
+//
+template <typename _TYPE_, typename _LESS_>
+inline PriorityNode<_TYPE_>* PriorityQueue<_TYPE_, _LESS_>::meld(PriorityNode<_TYPE_>* one, PriorityNode<_TYPE_>* two) {
+    if (this->less(*two->payload, *one->payload)) {
+        PriorityNode<_TYPE_>* temporary = one;
+        one = two;
+        two = temporary;
+    }
+    two->sibling = one->child;
+    if (one->child != 0) {
+        one->child->previous = two;
+    }
+    two->previous = one;
+    one->child = two;
+    one->sibling = 0;
+    one->previous = 0;
+    return one;
+}
+
+
+//
+//  Merge a list of siblings pairwise left to right, then fold the
+//  pairs into one tree right to left.
+//
+template <typename _TYPE_, typename _LESS_>
+PriorityNode<_TYPE_>* PriorityQueue<_TYPE_, _LESS_>::combine(PriorityNode<_TYPE_>* first) {
+    PriorityNode<_TYPE_>* pairs = 0;
+    PriorityNode<_TYPE_>* one;
+    PriorityNode<_TYPE_>* two;
+    PriorityNode<_TYPE_>* next;
+    while (first != 0) {
+        one = first;
+        two = one->sibling;
+        if (two == 0) {
+            one->previous = 0;
+            one->sibling = pairs;
+            pairs = one;
+            break;
+        }
+        first = two->sibling;
+        one = this->meld(one, two);
+        one->sibling = pairs;
+        pairs = one;
+    }
+    if (pairs == 0) {
+        return 0;
+    }
+    one = pairs;
+    pairs = pairs->sibling;
+    one->sibling = 0;
+    while (pairs != 0) {
+        next = pairs->sibling;
+        one = this->meld(one, pairs);
+        pairs = next;
+    }
+    return one;
+}
+
+
+//
+//  Unlink a non-root node and its subtree.
+//
+template <typename _TYPE_, typename _LESS_>
+inline void PriorityQueue<_TYPE_, _LESS_>::detach(PriorityNode<_TYPE_>* node) {
+    if (node->previous->child == node) {
+        node->previous->child = node->sibling;
+    } else {
+        node->previous->sibling = node->sibling;
+    }
+    if (node->sibling != 0) {
+        node->sibling->previous = node->previous;
+    }
+    node->sibling = 0;
+    node->previous = 0;
+}
+
+
+//
+//  Insert a node.
+//
+template <typename _TYPE_, typename _LESS_>
+bool PriorityQueue<_TYPE_, _LESS_>::insert(PriorityNode<_TYPE_>& node) {
+    if (node.isQueued()) {
+        return false;
+    }
+    node.child = 0;
+    node.sibling = 0;
+    node.previous = 0;
+    this->root = (this->root == 0) ? &node : this->meld(this->root, &node);
+    ++this->count;
+    return true;
+}
+
+
+//
+//  Remove the head node.
+//
+template <typename _TYPE_, typename _LESS_>
+PriorityNode<_TYPE_>* PriorityQueue<_TYPE_, _LESS_>::remove() {
+    PriorityNode<_TYPE_>* node = this->root;
+    if (node != 0) {
+        this->root = this->combine(node->child);
+        node->reset();
+        --this->count;
+    }
+    return node;
+}
+
+
+//
+//  Remove a node from anywhere on the queue.
+//
+template <typename _TYPE_, typename _LESS_>
+PriorityNode<_TYPE_>* PriorityQueue<_TYPE_, _LESS_>::remove(PriorityNode<_TYPE_>& node) {
+    if (!node.isQueued()) {
+        return 0;
+    }
+    if (&node == this->root) {
+        return this->remove();
+    }
+    this->detach(&node);
+    PriorityNode<_TYPE_>* subtree = this->combine(node.child);
+    if (subtree != 0) {
+        this->root = this->meld(this->root, subtree);
+    }
+    node.reset();
+    --this->count;
+    return &node;
+}
+
+
+//
+//  Move a node whose payload has decreased towards the head.
+//
+template <typename _TYPE_, typename _LESS_>
+bool PriorityQueue<_TYPE_, _LESS_>::decrease(PriorityNode<_TYPE_>& node) {
+    if (!node.isQueued()) {
+        return false;
+    }
+    if (&node != this->root) {
+        this->detach(&node);
+        this->root = this->meld(this->root, &node);
+    }
+    return true;
+}
+
+
+//
+//  Reposition a node whose payload has changed.
+//
+template <typename _TYPE_, typename _LESS_>
+bool PriorityQueue<_TYPE_, _LESS_>::update(PriorityNode<_TYPE_>& node) {
+    if (this->remove(node) == 0) {
+        return false;
+    }
+    return this->insert(node);
+}
+
+
+//
+//  Remove all nodes.
+//
+template <typename _TYPE_, typename _LESS_>
+void PriorityQueue<_TYPE_, _LESS_>::clear() {
+    while (this->remove() != 0) {
+    }
+}
+
+
+//
+//  Show this object on the output object.
+//
+template <typename _TYPE_, typename _LESS_>
+void PriorityQueue<_TYPE_, _LESS_>::show(int level, Output* display, int indent) const {
+    Platform& pl = Platform::instance();
+    Print printf(display);
+    const char* sp = printf.output().indentation(indent);
+    char component[sizeof(__FILE__)];
+    printf("%s%s(%p)[%lu]:\n",
+        sp, pl.component(__FILE__, component, sizeof(component)),
+        this, sizeof(*this));
+    printf("%s count=%lu\n", sp, this->count);
+    printf("%s root=%p\n", sp, this->root);
+    if (this->root != 0) {
+        this->root->show(level, display, indent + 1);
+    }
+}
+
+} } }
+
+
+#if defined(GRANDOTE_HAS_UNITTESTS)
+#include "com/diag/grandote/cxxcapi.h"
+/**
+ *  Run the PriorityQueue unit test.
+ *
+ *  @return the number of errors detected.
+ */
+CXXCAPI int unittestPriorityQueue(void);
+#endif
+
+
+#endif
@@ -0,0 +1,496 @@
+#ifndef _COM_DIAG_GRANDOTE_SHAPEDOUTPUT_H_
+#define _COM_DIAG_GRANDOTE_SHAPEDOUTPUT_H_
+
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Declares the ShapedOutput class.
+ *
+ *  @see    ShapedOutput
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/target.h"
+#include "com/diag/grandote/Output.h"
+#include "com/diag/grandote/Throttle.h"
+#include "com/diag/grandote/ThrottleWaiter.h"
+#include "com/diag/grandote/Packet.h"
+
+
+namespace com { namespace diag { namespace grandote {
+
+/**
+ *  Implements an output functor that shapes its output stream to a traffic
+ *  contract before passing it along to another output functor, typically a
+ *  DescriptorOutput or the output functor of a StreamSocket.
+ *
+ *  Data is emitted in chunks of no more than a burst size. Before each
+ *  chunk the octet throttle and the write throttle are consulted. The
+ *  octet throttle is committed with the size of the chunk in octets, so
+ *  that for example a BandwidthThrottle limits the byte rate. The write
+ *  throttle is committed with one event per chunk, so that for example a
+ *  CellRateThrottle or a Gcra limits the packet rate. Either may be
+ *  omitted, in which case it is promiscuous.
+ *
+ *  In blocking mode, the functor sleeps on a ThrottleWaiter until each
+ *  chunk is admissible, so every write completes on the schedule of the
+ *  throttles. In non-blocking mode, chunks that are admissible now are
+ *  emitted, the excess is queued in a Packet up to a capacity, and
+ *  anything beyond the capacity is dropped and counted. The queue is
+ *  drained as it becomes admissible by later writes or by flushing the
+ *  functor, and the timer descriptor of the waiter, which is armed for the
+ *  next admissible chunk, may be polled to learn when to flush.
+ *
+ *  This class is not thread-safe. Serialization is the responsibility
+ *  of the application.
+ *
+ *  @see    Throttle
+ *
+ *  @see    ThrottleWaiter
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+class ShapedOutput : public Output {
+
+public:
+
+    /**
+     *  This is the default burst size in octets.
+     */
+    static const size_t default_burst = 1024;
+
+    /**
+     *  This is the default capacity of the queue in octets.
+     */
+    static const size_t default_capacity = 65536;
+
+    /**
+     *  Constructor. Only the octet rate is shaped.
+     *
+     *  @param  ro          refers to an output functor.
+     *
+     *  @param  rt          refers to the octet throttle.
+     *
+     *  @param  vburst      is the burst size in octets.
+     *
+     *  @param  vblocking   if true causes writes to block until all of
+     *                      their data has been emitted.
+     *
+     *  @param  vcapacity   is the capacity of the queue in octets.
+     */
+    explicit ShapedOutput(
+        Output& ro,
+        Throttle& rt,
+        size_t vburst = default_burst,
+        bool vblocking = true,
+        size_t vcapacity = default_capacity
+    );
+
+    /**
+     *  Constructor. Both the octet rate and the write rate are shaped.
+     *
+     *  @param  ro          refers to an output functor.
+     *
+     *  @param  rt          refers to the octet throttle.
+     *
+     *  @param  rw          refers to the write throttle.
+     *
+     *  @param  vburst      is the burst size in octets.
+     *
+     *  @param  vblocking   if true causes writes to block until all of
+     *                      their data has been emitted.
+     *
+     *  @param  vcapacity   is the capacity of the queue in octets.
+     */
+    explicit ShapedOutput(
+        Output& ro,
+        Throttle& rt,
+        Throttle& rw,
+        size_t vburst = default_burst,
+        bool vblocking = true,
+        size_t vcapacity = default_capacity
+    );
+
+    /**
+     *  Destructor. Data that is still queued is discarded.
+     */
+    virtual ~ShapedOutput();
+
+    /**
+     *  Returns a reference to the output object.
+     *
+     *  @return a reference to the output object.
+     */
+    virtual Output& output() const;
+
+    /**
+     *  Returns the file descriptor associated with the output object.
+     *
+     *  @return the associated file descriptor.
+     */
+    virtual int getDescriptor() const;
+
+    /**
+     *  Returns the timer descriptor of the waiter, which becomes readable
+     *  when the next queued chunk is admissible.
+     *
+     *  @return the timer descriptor.
+     */
+    int getTimer() const;
+
+    /**
+     *  Returns the number of octets queued.
+     *
+     *  @return the number of octets queued.
+     */
+    size_t getPending() const;
+
+    /**
+     *  Returns the number of octets emitted.
+     *
+     *  @return the number of octets emitted.
+     */
+    uint64_t getSent() const;
+
+    /**
+     *  Returns the number of chunks emitted.
+     *
+     *  @return the number of chunks emitted.
+     */
+    uint64_t getChunks() const;
+
+    /**
+     *  Returns the number of times a chunk was held back because a
+     *  throttle was not admissible.
+     *
+     *  @return the number of delays.
+     */
+    uint64_t getDelayed() const;
+
+    /**
+     *  Returns the number of octets dropped because the queue was full.
+     *
+     *  @return the number of octets dropped.
+     */
+    uint64_t getDropped() const;
+
+    /**
+     *  Shapes a character in integer form.
+     *
+     *  @param  c           is a character in integer form.
+     *
+     *  @return the output character if successful, EOF otherwise.
+     */
+    virtual int operator() (int c);
+
+    /**
+     *  Shapes a string of no more than the specified length not
+     *  including its terminating NUL.
+     *
+     *  @param  s           points to a constant NUL-terminated string.
+     *
+     *  @param  size        is the size of the string in octets.
+     *
+     *  @return the number of octets output if successful (which
+     *          may be zero), EOF otherwise.
+     */
+    virtual ssize_t operator() (
+        const char* s,
+        size_t size = maximum_string_length
+    );
+
+    /**
+     *  Format a variable length argument list and shape the result.
+     *
+     *  @param  format      is a NUL-terminated string containing a
+     *                      printf-style format statement.
+     *
+     *  @param  ap          is a variable length argument object.
+     *
+     *  @return a non-negative number if successful, EOF otherwise.
+     */
+    virtual ssize_t operator() (const char* format, va_list ap);
+
+    /**
+     *  Shapes binary data from a buffer. The minimum number of requested
+     *  octets are accepted, unless in non-blocking mode some of them are
+     *  dropped because the queue is full. Octets that are queued count as
+     *  output.
+     *
+     *  @param  buffer  points to the buffer.
+     *
+     *  @param  minimum is the minimum number of octets to output.
+     *
+     *  @param  maximum is the maximum number of octets to output.
+     *
+     *  @return the number of octets output (which may be any number less
+     *          than maximum including zero) if successful, EOF otherwise.
+     */
+    virtual ssize_t operator() (
+        const void* buffer,
+        size_t minimum,
+        size_t maximum
+    );
+
+    /**
+     *  Emits as much of the queue as the throttles admit, or all of it
+     *  in blocking mode, then flushes the output object.
+     *
+     *  @return a non-negative number if successful, EOF otherwise.
+     */
+    virtual int operator() ();
+
+    /**
+     *  Displays internal information about this object to the specified
+     *  output object. Useful for debugging and troubleshooting.
+     *
+     *  @param  level   sets the verbosity of the output. What this means
+     *                  is object dependent. However, the level is passed
+     *                  from outer to inner objects this object calls the
+     *                  show methods of its inherited or composited objects.
+     *
+     *  @param display  points to the output object to which output is
+     *                  sent. If null (zero), the default platform output
+     *                  object is used as the effective output object. The
+     *                  effective output object is passed from outer to
+     *                  inner objects as this object calls the show methods
+     *                  of its inherited and composited objects.
+     *
+     *  @param  indent  specifies the level of indentation. One more than
+     *                  this value is passed from outer to inner objects
+     *                  as this object calls the show methods of its
+     *                  inherited and composited objects.
+     */
+    virtual void show(int level = 0, Output* display = 0, int indent = 0) const;
+
+private:
+
+    /**
+     *  Evaluates both throttles for the next chunk. If either is not
+     *  admissible, both are rolled back and the waiter is armed.
+     *
+     *  @return true if the chunk may be emitted now, false otherwise.
+     */
+    bool ready();
+
+    /**
+     *  Emits a chunk and commits both throttles.
+     *
+     *  @param  data        points to the chunk.
+     *
+     *  @param  size        is the size of the chunk in octets.
+     *
+     *  @return the number of octets emitted, or EOF.
+     */
+    ssize_t emit(const char* data, size_t size);
+
+    /**
+     *  Emits chunks from the queue while they are admissible, or until
+     *  the queue is empty in blocking mode. Draining stops early if the
+     *  output functor accepts only part of a chunk, in which case the
+     *  remainder stays at the front of the queue.
+     *
+     *  @return a non-negative number if successful, EOF if the output
+     *          functor failed.
+     */
+    ssize_t drain();
+
+    /**
+     *  Points to the output functor.
+     */
+    Output* ou;
+
+    /**
+     *  Points to the throttle committed with octets.
+     */
+    Throttle* octets;
+
+    /**
+     *  Points to the throttle committed with chunks.
+     */
+    Throttle* writes;
+
+    /**
+     *  This is the burst size in octets.
+     */
+    size_t burst;
+
+    /**
+     *  This is the capacity of the queue in octets.
+     */
+    size_t capacity;
+
+    /**
+     *  If true, writes block until their data has been emitted.
+     */
+    bool blocking;
+
+    /**
+     *  Points to a buffer of the burst size into which queued data is
+     *  consumed to be emitted.
+     */
+    char* chunk;
+
+    /**
+     *  This is the queue of data not yet emitted.
+     */
+    Packet queue;
+
+    /**
+     *  This is the waiter on whose timer the functor sleeps.
+     */
+    ThrottleWaiter waiter;
+
+    /**
+     *  This is the number of octets emitted.
+     */
+    uint64_t sent;
+
+    /**
+     *  This is the number of chunks emitted.
+     */
+    uint64_t chunks;
+
+    /**
+     *  This is the number of times a chunk was held back.
+     */
+    uint64_t delayed;
+
+    /**
+     *  This is the number of octets dropped.
+     */
+    uint64_t dropped;
+
+    /**
+     *  Copy constructor.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    ShapedOutput(const ShapedOutput& that);
+
+    /**
+     *  Assignment operator.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    ShapedOutput& operator=(const ShapedOutput& that);
+
+};
+
+
+//
+//  Return the output object.
+//
+inline Output& ShapedOutput::output() const {
+    return *this->ou;
+}
+
+
+//
+//  Return the timer descriptor.
+//
+inline int ShapedOutput::getTimer() const {
+    return this->waiter.getDescriptor();
+}
+
+
+//
+//  Return the number of octets queued.
+//
+inline size_t ShapedOutput::getPending() const {
+    return this->queue.length();
+}
+
+
+//
+//  Return the number of octets emitted.
+//
+inline uint64_t ShapedOutput::getSent() const {
+    return this->sent;
+}
+
+
+//
+//  Return the number of chunks emitted.
+//
+inline uint64_t ShapedOutput::getChunks() const {
+    return this->chunks;
+}
+
+
+//
+//  Return the number of delays.
+//
+inline uint64_t ShapedOutput::getDelayed() const {
+    return this->delayed;
+}
+
+
+//
+//  Return the number of octets dropped.
+//
+inline uint64_t ShapedOutput::getDropped() const {
+    return this->dropped;
+}
+
+} } }
+
+
+#if defined(GRANDOTE_HAS_UNITTESTS)
+#include "com/diag/grandote/cxxcapi.h"
+/**
+ *  Run the ShapedOutput unit test.
+ *
+ *  @return the number of errors detected.
+ */
+CXXCAPI int unittestShapedOutput(void);
+#endif
+
+
+#endif
@@ -0,0 +1,927 @@
+#ifndef _COM_DIAG_GRANDOTE_SHAPER_H_
+#define _COM_DIAG_GRANDOTE_SHAPER_H_
+
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Declares the ShaperPacket, ShaperClass, and Shaper classes.
+ *
+ *  @see    Shaper
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/target.h"
+#include "com/diag/grandote/types.h"
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/Throttle.h"
+#include "com/diag/grandote/LinkType.h"
+#include "com/diag/grandote/FastChain.h"
+#include "com/diag/grandote/PriorityQueue.h"
+#include "com/diag/grandote/Output.h"
+
+
+namespace com { namespace diag { namespace grandote {
+
+class ShaperClass;
+class Shaper;
+
+/**
+ *  Implements a packet that can be queued on a leaf ShaperClass. The
+ *  packet is intrusive: it is embedded in (or otherwise owned by) the
+ *  buffer it describes, and carries its size in bytes and a pointer to
+ *  that buffer, so queueing it allocates no memory. A packet may be on at
+ *  most one queue at a time.
+ *
+ *  @see    Shaper
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+class ShaperPacket {
+
+    friend class ShaperClass;
+    friend class Shaper;
+
+public:
+
+    /**
+     *  Constructor.
+     *
+     *  @param  object      points to the buffer described by this packet.
+     *
+     *  @param  size        is the size of the packet in bytes.
+     */
+    explicit ShaperPacket(void* object = 0, size_t size = 0);
+
+    /**
+     *  Destructor. If this packet is queued, it is removed from its queue.
+     */
+    ~ShaperPacket();
+
+    /**
+     *  Gets the pointer to the buffer described by this packet.
+     *
+     *  @return the pointer to the buffer.
+     */
+    void* getPayload() const;
+
+    /**
+     *  Stores a pointer to the buffer described by this packet.
+     *
+     *  @param  object      points to the buffer.
+     */
+    void setPayload(void* object);
+
+    /**
+     *  Gets the size of this packet in bytes.
+     *
+     *  @return the size in bytes.
+     */
+    size_t getSize() const;
+
+    /**
+     *  Sets the size of this packet in bytes. The size of a queued packet
+     *  cannot be changed.
+     *
+     *  @param  size        is the size in bytes.
+     *
+     *  @return true if successful, false if the packet is queued.
+     */
+    bool setSize(size_t size);
+
+    /**
+     *  Returns true if this packet is queued.
+     *
+     *  @return true if this packet is queued.
+     */
+    bool isQueued() const;
+
+    /**
+     *  Displays internal information about this object to the specified
+     *  output object. Useful for debugging and troubleshooting.
+     *
+     *  @param  level   sets the verbosity of the output. What this means
+     *                  is object dependent. However, the level is passed
+     *                  from outer to inner objects this object calls the
+     *                  show methods of its inherited or composited objects.
+     *
+     *  @param display  points to the output object to which output is
+     *                  sent. If null (zero), the default platform output
+     *                  object is used as the effective output object. The
+     *                  effective output object is passed from outer to
+     *                  inner objects as this object calls the show methods
+     *                  of its inherited and composited objects.
+     *
+     *  @param  indent  specifies the level of indentation. One more than
+     *                  this value is passed from outer to inner objects
+     *                  as this object calls the show methods of its
+     *                  inherited and composited objects.
+     */
+    void show(int level = 0, Output* display = 0, int indent = 0) const;
+
+private:
+
+    /**
+     *  This is the link on the queue of the class.
+     */
+    LinkType<ShaperPacket> link;
+
+    /**
+     *  This points to the buffer described by this packet.
+     */
+    void* payload;
+
+    /**
+     *  This is the size of this packet in bytes.
+     */
+    size_t bytes;
+
+    /**
+     *  Copy constructor.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    ShaperPacket(const ShaperPacket& that);
+
+    /**
+     *  Assignment operator.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    ShaperPacket& operator=(const ShaperPacket& that);
+
+};
+
+
+/**
+ *  Implements a traffic class in the tree of classes of a Shaper. Every
+ *  class is guarded by a rate throttle, for example a BandwidthThrottle
+ *  with peak, sustained, and burst parameters, that expresses the
+ *  bandwidth the class is assured of, and optionally by a ceiling
+ *  throttle that bounds the bandwidth the class may use in total when it
+ *  borrows bandwidth its ancestors are not using. A class without a
+ *  ceiling may borrow without limit. Packets are queued only on leaf
+ *  classes, those with no children; interior classes only lend.
+ *
+ *  The throttles are not owned by the class and must outlive it. Each
+ *  throttle must guard only one class, and the rate and ceiling of a
+ *  class must be different throttles, since every throttle on the path
+ *  from a leaf to the root is evaluated, and committed or rolled back,
+ *  once per packet. The rates of the children of a class should sum to
+ *  no more than the rate of the class, as in any hierarchical token
+ *  bucket. A class must be used with only one Shaper.
+ *
+ *  @see    Shaper
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+class ShaperClass {
+
+    friend class Shaper;
+
+public:
+
+    /**
+     *  These are the modes of a class, determined by its throttles.
+     */
+    enum Mode {
+        CAN_SEND,   /**< The rate and ceiling admit; the class may lend.  */
+        MAY_BORROW, /**< Only the ceiling admits; the class may borrow.   */
+        CANT_SEND   /**< The ceiling does not admit.                       */
+    };
+
+    /**
+     *  Defines the ordering of classes waiting on their throttles, earliest
+     *  first.
+     */
+    class Earlier {
+
+    public:
+
+        /**
+         *  Returns true if one class changes mode before another.
+         *
+         *  @param  one         refers to one class.
+         *
+         *  @param  two         refers to another class.
+         *
+         *  @return true if one changes mode before two.
+         */
+        bool operator()(const ShaperClass& one, const ShaperClass& two) const {
+            return one.eligible < two.eligible;
+        }
+
+    };
+
+    /**
+     *  Constructor for a class that may borrow without limit.
+     *
+     *  @param  parent      points to the parent of this class, or is null
+     *                      (zero) for the root.
+     *
+     *  @param  rate        refers to the throttle of the assured rate.
+     *
+     *  @param  quantum     is the number of bytes this class is credited
+     *                      with each deficit round robin round. For the
+     *                      round robin to be fair in O(1), this should be
+     *                      at least the size of the largest packet.
+     */
+    explicit ShaperClass(ShaperClass* parent, Throttle& rate, size_t quantum);
+
+    /**
+     *  Constructor.
+     *
+     *  @param  parent      points to the parent of this class, or is null
+     *                      (zero) for the root.
+     *
+     *  @param  rate        refers to the throttle of the assured rate.
+     *
+     *  @param  ceiling     refers to the throttle of the ceiling rate.
+     *
+     *  @param  quantum     is the number of bytes this class is credited
+     *                      with each deficit round robin round. For the
+     *                      round robin to be fair in O(1), this should be
+     *                      at least the size of the largest packet.
+     */
+    explicit ShaperClass(ShaperClass* parent, Throttle& rate, Throttle& ceiling, size_t quantum);
+
+    /**
+     *  Destructor. A class must be idle when it is destroyed: it must
+     *  have no children and no queued packets, and it must be on no ring
+     *  and no waiting queue of a Shaper, which has no way to remove it.
+     *  Destroying a class that is not idle is fatal.
+     */
+    ~ShaperClass();
+
+    /**
+     *  Returns a pointer to the parent of this class.
+     *
+     *  @return a pointer to the parent, or null (zero) for the root.
+     */
+    ShaperClass* getParent() const;
+
+    /**
+     *  Returns true if this class has no children.
+     *
+     *  @return true if this class is a leaf.
+     */
+    bool isLeaf() const;
+
+    /**
+     *  Returns true if this class has packets to send, either queued on
+     *  it if it is a leaf, or queued on descendants that are borrowing
+     *  from it if it is not.
+     *
+     *  @return true if this class is active.
+     */
+    bool isActive() const;
+
+    /**
+     *  Returns the mode of this class as of the last time its throttles
+     *  were evaluated. The mode is current only while the class is active.
+     *
+     *  @return the mode.
+     */
+    Mode getMode() const;
+
+    /**
+     *  Returns the deficit round robin quantum of this class.
+     *
+     *  @return the quantum in bytes.
+     */
+    size_t getQuantum() const;
+
+    /**
+     *  Returns the current deficit round robin credit of this class.
+     *
+     *  @return the credit in bytes.
+     */
+    size_t getDeficit() const;
+
+    /**
+     *  Returns the number of packets queued on this class.
+     *
+     *  @return the number of packets.
+     */
+    size_t getPackets() const;
+
+    /**
+     *  Returns the number of bytes queued on this class.
+     *
+     *  @return the number of bytes.
+     */
+    size_t getBytes() const;
+
+    /**
+     *  Returns the number of packets this class has sent.
+     *
+     *  @return the number of packets sent.
+     */
+    uint64_t getSent() const;
+
+    /**
+     *  Returns the number of packets this class has sent using bandwidth
+     *  borrowed from an ancestor because its own rate was exhausted.
+     *
+     *  @return the number of packets borrowed.
+     */
+    uint64_t getBorrowed() const;
+
+    /**
+     *  Displays internal information about this object to the specified
+     *  output object. Useful for debugging and troubleshooting.
+     *
+     *  @param  level   sets the verbosity of the output. What this means
+     *                  is object dependent. However, the level is passed
+     *                  from outer to inner objects this object calls the
+     *                  show methods of its inherited or composited objects.
+     *
+     *  @param display  points to the output object to which output is
+     *                  sent. If null (zero), the default platform output
+     *                  object is used as the effective output object. The
+     *                  effective output object is passed from outer to
+     *                  inner objects as this object calls the show methods
+     *                  of its inherited and composited objects.
+     *
+     *  @param  indent  specifies the level of indentation. One more than
+     *                  this value is passed from outer to inner objects
+     *                  as this object calls the show methods of its
+     *                  inherited and composited objects.
+     */
+    void show(int level = 0, Output* display = 0, int indent = 0) const;
+
+private:
+
+    /**
+     *  This points to the parent class or is null for the root.
+     */
+    ShaperClass* parent;
+
+    /**
+     *  This points to the throttle of the assured rate.
+     */
+    Throttle* rate;
+
+    /**
+     *  This points to the throttle of the ceiling rate.
+     */
+    Throttle* ceiling;
+
+    /**
+     *  This is the number of children of this class.
+     */
+    size_t children;
+
+    /**
+     *  This is the deficit round robin quantum in bytes.
+     */
+    size_t quantum;
+
+    /**
+     *  This is the deficit round robin credit in bytes.
+     */
+    size_t deficit;
+
+    /**
+     *  This is the number of packets queued.
+     */
+    size_t packets;
+
+    /**
+     *  This is the number of bytes queued.
+     */
+    size_t bytes;
+
+    /**
+     *  This is the number of packets sent.
+     */
+    uint64_t sent;
+
+    /**
+     *  This is the number of packets sent on borrowed bandwidth.
+     */
+    uint64_t borrowed;
+
+    /**
+     *  This is the mode of the class.
+     */
+    Mode mode;
+
+    /**
+     *  This is the time at which a class not in CAN_SEND mode may next
+     *  change mode.
+     */
+    ticks_t eligible;
+
+    /**
+     *  This is the queue of packets of a leaf.
+     */
+    FastChain queue;
+
+    /**
+     *  This is the round robin ring of the active children of an interior
+     *  class that are borrowing from it.
+     */
+    FastChain feed;
+
+    /**
+     *  This is the link on the round robin ring of the Shaper, if the class
+     *  is in CAN_SEND mode, or on the feed of its parent, if the class is
+     *  in MAY_BORROW mode.
+     */
+    LinkType<ShaperClass> ring;
+
+    /**
+     *  This is the node on the queue of classes waiting for a mode change.
+     */
+    PriorityNode<ShaperClass> node;
+
+    /**
+     *  Copy constructor.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    ShaperClass(const ShaperClass& that);
+
+    /**
+     *  Assignment operator.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    ShaperClass& operator=(const ShaperClass& that);
+
+};
+
+
+/**
+ *  Implements a hierarchical traffic shaper over a tree of ShaperClass
+ *  objects, after the fashion of the hierarchical token bucket (HTB), but
+ *  with throttles in place of token buckets. Packets are enqueued on leaf
+ *  classes, and each dequeue picks the next packet to send at the
+ *  specified time.
+ *
+ *  Every active class has a mode determined by its own throttles. A
+ *  class in CAN_SEND mode is on the round robin ring of the shaper: it
+ *  can send on its own rate, if it is a leaf, or lend its unused rate to
+ *  its borrowing descendants, if it is not. A class in MAY_BORROW mode
+ *  is on the round robin ring, or feed, of its parent, which is then
+ *  active too. A class in CANT_SEND mode is on neither. A class that is
+ *  not in CAN_SEND mode also waits on a priority queue for the time at
+ *  which its throttles will change its mode.
+ *
+ *  A dequeue first applies the mode changes that are due, then takes the
+ *  class at the head of the ring of the shaper, the lender, and follows
+ *  the heads of the feeds down to a leaf. It uses deficit round robin
+ *  (DRR) at every ring along the way: a class whose credit does not cover
+ *  the packet is credited with its quantum and moved to the tail of its
+ *  ring. The packet is charged to the ceiling throttles of every class
+ *  from the leaf to the root, and to the rate throttles of the lender and
+ *  its ancestors, so that the bandwidth children use is no longer
+ *  available for lending while a class that borrows does not fall into
+ *  debt on its own assured rate. Then the modes of the charged classes
+ *  are brought up to date.
+ *
+ *  Each packet therefore costs a walk of the path from the leaf to the
+ *  root, O(log classes) in a balanced tree, and a priority queue
+ *  operation, also O(log classes), for each class on the path that
+ *  changes mode; the round robin itself is O(1) when the quanta are at
+ *  least the largest packet size. Unlike HTB there is only one ring of
+ *  classes that can send, rather than one per level of the tree; lenders
+ *  high in the tree take turns with leaves sending on their own rates.
+ *
+ *  This class is not thread-safe. Serialization is the responsibility
+ *  of the application.
+ *
+ *  @see    ShaperClass
+ *
+ *  @see    ShaperPacket
+ *
+ *  @see    BandwidthThrottle
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+class Shaper {
+
+public:
+
+    /**
+     *  Constructor.
+     */
+    explicit Shaper();
+
+    /**
+     *  Destructor. Every class is removed from the rings and the waiting
+     *  queue, including the feeds of the classes it borrows from, so a
+     *  class with no queued packets is idle afterwards. Any queued packets
+     *  remain queued on their classes, but the classes may not be used with
+     *  another shaper.
+     */
+    virtual ~Shaper();
+
+    /**
+     *  Returns the number of packets queued on all classes.
+     *
+     *  @return the number of packets.
+     */
+    size_t size() const;
+
+    /**
+     *  Returns true if no packets are queued.
+     *
+     *  @return true if empty.
+     */
+    bool empty() const;
+
+    /**
+     *  Appends a packet to the queue of a leaf class at the current
+     *  platform time.
+     *
+     *  @param  leaf        refers to the leaf class.
+     *
+     *  @param  packet      refers to the packet.
+     *
+     *  @return true if successful, false if the class is not a leaf or the
+     *          packet is already queued.
+     */
+    bool enqueue(ShaperClass& leaf, ShaperPacket& packet);
+
+    /**
+     *  Appends a packet to the queue of a leaf class at the specified time.
+     *
+     *  @param  leaf        refers to the leaf class.
+     *
+     *  @param  packet      refers to the packet.
+     *
+     *  @param  now         is the current time in throttle ticks.
+     *
+     *  @return true if successful, false if the class is not a leaf or the
+     *          packet is already queued.
+     */
+    bool enqueue(ShaperClass& leaf, ShaperPacket& packet, ticks_t now);
+
+    /**
+     *  Removes and returns the next packet to send at the current platform
+     *  time.
+     *
+     *  @return a pointer to the packet, or null (zero) if none is eligible.
+     */
+    ShaperPacket* dequeue();
+
+    /**
+     *  Removes and returns the next packet to send at the specified time.
+     *  Times presented to successive calls should not go backwards.
+     *
+     *  @param  now         is the current time in throttle ticks.
+     *
+     *  @return a pointer to the packet, or null (zero) if none is eligible.
+     */
+    ShaperPacket* dequeue(ticks_t now);
+
+    /**
+     *  Returns how long from the specified time until a packet may next be
+     *  eligible. This is zero if some class can send, and the maximum ticks
+     *  value if no class is waiting for a mode change.
+     *
+     *  @param  now         is the current time in throttle ticks.
+     *
+     *  @return the delay in ticks.
+     */
+    ticks_t delay(ticks_t now) const;
+
+    /**
+     *  Displays internal information about this object to the specified
+     *  output object. Useful for debugging and troubleshooting.
+     *
+     *  @param  level   sets the verbosity of the output. What this means
+     *                  is object dependent. However, the level is passed
+     *                  from outer to inner objects this object calls the
+     *                  show methods of its inherited or composited objects.
+     *
+     *  @param display  points to the output object to which output is
+     *                  sent. If null (zero), the default platform output
+     *                  object is used as the effective output object. The
+     *                  effective output object is passed from outer to
+     *                  inner objects as this object calls the show methods
+     *                  of its inherited and composited objects.
+     *
+     *  @param  indent  specifies the level of indentation. One more than
+     *                  this value is passed from outer to inner objects
+     *                  as this object calls the show methods of its
+     *                  inherited and composited objects.
+     */
+    virtual void show(int level = 0, Output* display = 0, int indent = 0) const;
+
+private:
+
+    /**
+     *  This is the number of packets queued.
+     */
+    size_t count;
+
+    /**
+     *  This is the round robin ring of active classes in CAN_SEND mode.
+     */
+    FastChain row;
+
+    /**
+     *  This is the queue of active classes waiting for a mode change.
+     */
+    PriorityQueue<ShaperClass, ShaperClass::Earlier> waiting;
+
+    /**
+     *  Evaluates the throttles of a class without charging them.
+     *
+     *  @param  that        refers to the class.
+     *
+     *  @param  now         is the current time in throttle ticks.
+     *
+     *  @param  when        refers to where the time of the next mode
+     *                      change is stored if the mode is not CAN_SEND.
+     *
+     *  @return the mode.
+     */
+    ShaperClass::Mode evaluate(ShaperClass& that, ticks_t now, ticks_t& when);
+
+    /**
+     *  Puts an active class that is on no ring and no queue where its mode
+     *  says it belongs, activating its parent if it is the first child to
+     *  borrow from it.
+     *
+     *  @param  that        refers to the class.
+     *
+     *  @param  mode        is the mode of the class.
+     *
+     *  @param  when        is the time of the next mode change.
+     *
+     *  @param  now         is the current time in throttle ticks.
+     */
+    void place(ShaperClass& that, ShaperClass::Mode mode, ticks_t when, ticks_t now);
+
+    /**
+     *  Takes a class off its ring and queue, deactivating its parent if it
+     *  was the last child to borrow from it.
+     *
+     *  @param  that        refers to the class.
+     */
+    void unplace(ShaperClass& that);
+
+    /**
+     *  Activates a class.
+     *
+     *  @param  that        refers to the class.
+     *
+     *  @param  now         is the current time in throttle ticks.
+     */
+    void activate(ShaperClass& that, ticks_t now);
+
+    /**
+     *  Deactivates a class.
+     *
+     *  @param  that        refers to the class.
+     */
+    void deactivate(ShaperClass& that);
+
+    /**
+     *  Re-evaluates the mode of an active class and moves it if the mode
+     *  or the time of its next mode change has changed.
+     *
+     *  @param  that        refers to the class.
+     *
+     *  @param  now         is the current time in throttle ticks.
+     */
+    void refresh(ShaperClass& that, ticks_t now);
+
+    /**
+     *  Evaluates the throttles on the path from a leaf to the root and
+     *  either charges them with a packet sent on the bandwidth of the
+     *  lender, counting the packet as sent and perhaps as borrowed, or, if
+     *  the lender cannot lend to the leaf after all, rolls them back.
+     *
+     *  @param  leaf        refers to the leaf class.
+     *
+     *  @param  lender      refers to the lending class.
+     *
+     *  @param  n           is the size of the packet in bytes.
+     *
+     *  @param  now         is the current time in throttle ticks.
+     *
+     *  @return true if the packet was charged, false otherwise.
+     */
+    bool charge(ShaperClass& leaf, ShaperClass& lender, size_t n, ticks_t now);
+
+    /**
+     *  Copy constructor.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    Shaper(const Shaper& that);
+
+    /**
+     *  Assignment operator.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    Shaper& operator=(const Shaper& that);
+
+};
+
+
+//
+//  Return the payload.
+//
+inline void* ShaperPacket::getPayload() const {
+    return this->payload;
+}
+
+
+//
+//  Set the payload.
+//
+inline void ShaperPacket::setPayload(void* object) {
+    this->payload = object;
+}
+
+
+//
+//  Return the size.
+//
+inline size_t ShaperPacket::getSize() const {
+    return this->bytes;
+}
+
+
+//
+//  Set the size.
+//
+inline bool ShaperPacket::setSize(size_t size) {
+    if (this->link.isChained()) {
+        return false;
+    }
+    this->bytes = size;
+    return true;
+}
+
+
+//
+//  Return true if queued.
+//
+inline bool ShaperPacket::isQueued() const {
+    return this->link.isChained();
+}
+
+
+//
+//  Return the parent.
+//
+inline ShaperClass* ShaperClass::getParent() const {
+    return this->parent;
+}
+
+
+//
+//  Return true if a leaf.
+//
+inline bool ShaperClass::isLeaf() const {
+    return (this->children == 0);
+}
+
+
+//
+//  Return true if active.
+//
+inline bool ShaperClass::isActive() const {
+    return (this->children == 0) ? !this->queue.isEmpty() : !this->feed.isEmpty();
+}
+
+
+//
+//  Return the mode.
+//
+inline ShaperClass::Mode ShaperClass::getMode() const {
+    return this->mode;
+}
+
+
+//
+//  Return the quantum.
+//
+inline size_t ShaperClass::getQuantum() const {
+    return this->quantum;
+}
+
+
+//
+//  Return the deficit.
+//
+inline size_t ShaperClass::getDeficit() const {
+    return this->deficit;
+}
+
+
+//
+//  Return the queued packets.
+//
+inline size_t ShaperClass::getPackets() const {
+    return this->packets;
+}
+
+
+//
+//  Return the queued bytes.
+//
+inline size_t ShaperClass::getBytes() const {
+    return this->bytes;
+}
+
+
+//
+//  Return the packets sent.
+//
+inline uint64_t ShaperClass::getSent() const {
+    return this->sent;
+}
+
+
+//
+//  Return the packets sent on borrowed bandwidth.
+//
+inline uint64_t ShaperClass::getBorrowed() const {
+    return this->borrowed;
+}
+
+
+//
+//  Return the number of queued packets.
+//
+inline size_t Shaper::size() const {
+    return this->count;
+}
+
+
+//
+//  Return true if empty.
+//
+inline bool Shaper::empty() const {
+    return (this->count == 0);
+}
+
+} } }
+
+
+#if defined(GRANDOTE_HAS_UNITTESTS)
+#include "com/diag/grandote/cxxcapi.h"
+/**
+ *  Run the Shaper unit test.
+ *
+ *  @return the number of errors detected.
+ */
+CXXCAPI int unittestShaper(void);
+#endif
+
+
+#endif
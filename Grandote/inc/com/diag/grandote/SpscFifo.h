@@ -0,0 +1,468 @@
+#ifndef _COM_DIAG_GRANDOTE_SPSCFIFO_H_
+#define _COM_DIAG_GRANDOTE_SPSCFIFO_H_
+
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+/**
+ *  @file
+ *
+ *  Declares the SpscFifo class.
+ *
+ *  @see    SpscFifo
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/target.h"
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/Object.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/Print.h"
+#include "com/diag/grandote/Dump.h"
+
+
+namespace com { namespace diag { namespace grandote {
+
+/**
+ *  Generates a circular buffer like Fifo that may be shared without any
+ *  locking between exactly one thread of control that inserts objects and
+ *  exactly one thread of control that peeks at and removes them. The
+ *  memory for the queue is provided by the application, and its size,
+ *  measured in objects, is limited to a power of two, just as with Fifo.
+ *
+ *  The head index is written only by the producer and the tail index only
+ *  by the consumer. Each is published to the other side with a release
+ *  store and read by it with an acquire load, so an object copied into
+ *  the queue is visible to the consumer before the index that covers it.
+ *  The indices are kept on separate cache lines so that the two threads do
+ *  not contend for the same line. Each side also keeps its own copy of
+ *  the index of the other side, and only reloads it when the copy says the
+ *  queue is full (for the producer) or empty (for the consumer), so most
+ *  operations touch no cache line written by the other thread except the
+ *  one holding the object itself.
+ *
+ *  The values returned by used() and free() are snapshots that may be
+ *  stale by the time they are returned. The reset() method is not safe
+ *  while either thread of control is using the object.
+ *
+ *  Only the destructor and the show method are virtual. All other methods
+ *  are inline.
+ *
+ *  @see    Fifo
+ *
+ *  @see    D. Vyukov, "Single-Producer/Single-Consumer Queue",
+ *          1024cores.net
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+template <typename _TYPE_>
+class SpscFifo : public Object {
+
+public:
+
+    /**
+     *  This is the size in bytes of the cache line assumed when separating
+     *  the producer and consumer indices. It is big enough for the
+     *  common targets; a larger line merely wastes a little space.
+     */
+    static const size_t LINESIZE = 64;
+
+    /**
+     *  Constructor.
+     *
+     *  @param  qq          points the the start of an array of objects
+     *                      used as the queue.
+     *
+     *  @param  cc          is the countof of the number of objects in
+     *                      the array used as the queue.
+     */
+    explicit SpscFifo(_TYPE_* qq = 0, size_t cc = 0);
+
+    /**
+     *  Destructor.
+     */
+    virtual ~SpscFifo();
+
+    /**
+     *  Returns the number of used entries in the queue.
+     *
+     *  @return the number of used entries.
+     */
+    size_t used() const;
+
+    /**
+     *  Returns the number of free entries in the queue.
+     *
+     *  @return the number of free entries.
+     */
+    size_t free() const;
+
+    /**
+     *  Returns the total number of entries in the queue.
+     *
+     *  @return the number of free entries.
+     */
+    size_t total() const;
+
+    /**
+     *  Returns the queue to its empty state. Neither the producer nor
+     *  the consumer may be using the queue when this is called.
+     */
+    void reset();
+
+    /**
+     *  Inserts an object into the queue. The object is copied into
+     *  an empty position in the queue. The object type must permit
+     *  assignment semantics. This may only be called by the producer.
+     *
+     *  @param  entry   refers to the object from which a copy is
+     *                  made into the next unused object in the queue.
+     *
+     *  @return true if successful, false if the queue is full.
+     */
+    bool insert(const _TYPE_& entry);
+
+    /**
+     *  Makes a copy of the first item on the queue, but does not
+     *  remove it from the queue. This may only be called by the consumer.
+     *
+     *  @param  result  refers to the object into which the next used
+     *                  object is copied.
+     *
+     *  @return true if successful, false if the queue is empty.
+     */
+    bool peek(_TYPE_& result);
+
+    /**
+     *  Makes a copy of the first item on the queue, and removes it
+     *  from the queue. This may only be called by the consumer.
+     *
+     *  @param  result  refers to the object into which the next used
+     *                  object is copied.
+     *
+     *  @return true if successful, false if the queue is empty.
+     */
+    bool remove(_TYPE_& result);
+
+    /**
+     *  Displays internal information about this object to the specified
+     *  output object. Useful for debugging and troubleshooting.
+     *
+     *  @param  level   sets the verbosity of the output. What this means
+     *                  is object dependent. However, the level is passed
+     *                  from outer to inner objects this object calls the
+     *                  show methods of its inherited or composited objects.
+     *
+     *  @param display  points to the output object to which output is
+     *                  sent. If null (zero), the default platform output
+     *                  object is used as the effective output object. The
+     *                  effective output object is passed from outer to
+     *                  inner objects as this object calls the show methods
+     *                  of its inherited and composited objects.
+     *
+     *  @param  indent  specifies the level of indentation. One more than
+     *                  this value is passed from outer to inner objects
+     *                  as this object calls the show methods of its
+     *                  inherited and composited objects.
+     */
+    virtual void show(int level = 0, Output* display = 0, int indent = 0) const;
+
+protected:
+
+    /**
+     *  This refers to the queue array provided by the application.
+     */
+    _TYPE_* queue;
+
+private:
+
+    /**
+     *  This is the countof the number of objects that can be in the queue.
+     */
+    size_t count;
+
+    /**
+     *  This is one less than the number of possible objects in the queue.
+     */
+    size_t mask;
+
+    /**
+     *  This keeps the producer fields off the cache line of the fields
+     *  above, and of whatever precedes this object.
+     */
+    char pad1[LINESIZE];
+
+    /**
+     *  This indexes the next unused object in the queue. It is written
+     *  only by the producer.
+     */
+    size_t head;
+
+    /**
+     *  This is the copy of the tail kept by the producer.
+     */
+    size_t tailcache;
+
+    /**
+     *  This keeps the producer fields and the consumer fields on different
+     *  cache lines.
+     */
+    char pad2[LINESIZE - (2 * sizeof(size_t))];
+
+    /**
+     *  This indexes the next used object in the queue. It is written
+     *  only by the consumer.
+     */
+    size_t tail;
+
+    /**
+     *  This is the copy of the head kept by the consumer.
+     */
+    size_t headcache;
+
+    /**
+     *  This keeps the consumer fields off the cache line of whatever
+     *  follows this object.
+     */
+    char pad3[LINESIZE - (2 * sizeof(size_t))];
+
+    /**
+     *  Copy constructor.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    SpscFifo(const SpscFifo& that);
+
+    /**
+     *  Assignment operator.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    SpscFifo& operator=(const SpscFifo& that);
+
+};
+
+
+//
+// Constructor
+//
+template <typename _TYPE_>
+SpscFifo<_TYPE_>::SpscFifo(_TYPE_* qq, size_t cc) :
+    queue(qq),
+    count(0),
+    mask(0),
+    head(0),
+    tailcache(0),
+    tail(0),
+    headcache(0)
+{
+    if (0 != qq) {
+        for (size_t bit = 1; ((0 < bit) && (bit <= cc)); bit <<= 1) {
+            this->count = bit;
+        }
+        if (0 < this->count) {
+            this->mask = this->count - 1;
+        }
+    }
+}
+
+
+//
+//  Destructor.
+//
+template <typename _TYPE_>
+SpscFifo<_TYPE_>::~SpscFifo() {
+}
+
+
+//
+//  Reset to empty state.
+//
+template <typename _TYPE_>
+inline void SpscFifo<_TYPE_>::reset() {
+    this->head = 0;
+    this->tailcache = 0;
+    this->tail = 0;
+    this->headcache = 0;
+    __sync_synchronize();
+}
+
+
+//
+//  Return the number of used entries. The tail is loaded before the head
+//  so that the head is never behind it.
+//
+template <typename _TYPE_>
+inline size_t SpscFifo<_TYPE_>::used() const {
+    size_t tt = __atomic_load_n(&(this->tail), __ATOMIC_ACQUIRE);
+    size_t hh = __atomic_load_n(&(this->head), __ATOMIC_ACQUIRE);
+    return hh - tt;
+}
+
+
+//
+//  Return the total number of entries.
+//
+template <typename _TYPE_>
+inline size_t SpscFifo<_TYPE_>::total() const {
+    return this->count;
+}
+
+
+//
+//  Return the number of free entries.
+//
+template <typename _TYPE_>
+inline size_t SpscFifo<_TYPE_>::free() const {
+    return this->count - this->used();
+}
+
+
+//
+//  Insert new entry into queue. Only the producer writes the head, so it
+//  can read it without ordering.
+//
+template <typename _TYPE_>
+inline bool SpscFifo<_TYPE_>::insert(const _TYPE_& entry) {
+    size_t hh = this->head;
+    if ((hh - this->tailcache) >= this->count) {
+        this->tailcache = __atomic_load_n(&(this->tail), __ATOMIC_ACQUIRE);
+        if ((hh - this->tailcache) >= this->count) {
+            return false;
+        }
+    }
+    this->queue[hh & this->mask] = entry;
+    __atomic_store_n(&(this->head), hh + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+
+//
+//  Peek at oldest used entry in queue.
+//
+template <typename _TYPE_>
+inline bool SpscFifo<_TYPE_>::peek(_TYPE_& result) {
+    size_t tt = this->tail;
+    if (tt == this->headcache) {
+        this->headcache = __atomic_load_n(&(this->head), __ATOMIC_ACQUIRE);
+        if (tt == this->headcache) {
+            return false;
+        }
+    }
+    result = this->queue[tt & this->mask];
+    return true;
+}
+
+
+//
+//  Remove oldest used entry in queue. Only the consumer writes the tail,
+//  so it can read it without ordering.
+//
+template <typename _TYPE_>
+inline bool SpscFifo<_TYPE_>::remove(_TYPE_& result) {
+    size_t tt = this->tail;
+    if (tt == this->headcache) {
+        this->headcache = __atomic_load_n(&(this->head), __ATOMIC_ACQUIRE);
+        if (tt == this->headcache) {
+            return false;
+        }
+    }
+    result = this->queue[tt & this->mask];
+    __atomic_store_n(&(this->tail), tt + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+
+//
+//  Show this object on the output object.
+//
+template <typename _TYPE_>
+void SpscFifo<_TYPE_>::show(int level, Output* display, int indent) const {
+    Platform& pl = Platform::instance();
+    Print printf(display);
+    const char* sp = printf.output().indentation(indent);
+    char component[sizeof(__FILE__)];
+    printf("%s%s(%p)[%lu]:\n",
+        sp, pl.component(__FILE__, component, sizeof(component)),
+        this, sizeof(*this));
+    printf("%s widthof=%u\n", sp, widthof(_TYPE_));
+    printf("%s count=%u\n", sp, this->count);
+    printf("%s mask=0x%x\n", sp, this->mask);
+    size_t ii = this->head & this->mask;
+    printf("%s head=%u:%u:%p\n",
+        sp, this->head, ii, &(this->queue[ii]));
+    printf("%s tailcache=%u\n", sp, this->tailcache);
+    ii = this->tail & this->mask;
+    printf("%s tail=%u:%u:%p\n",
+        sp, this->tail, ii, &(this->queue[ii]));
+    printf("%s headcache=%u\n", sp, this->headcache);
+    printf("%s used()=%u\n", sp, this->used());
+    printf("%s free()=%u\n", sp, this->free());
+    printf("%s total()=%u\n", sp, this->total());
+    if ((0 == level) || (0 == this->mask)) {
+        printf("%s queue=%p\n", sp, this->queue);
+    } else  {
+        printf("%s queue:\n", sp);
+        Dump dump;
+        dump.bytes(this->queue, this->count * sizeof(_TYPE_), false, 0,
+            indent + 2);
+    }
+}
+
+} } }
+
+
+#if defined(GRANDOTE_HAS_UNITTESTS)
+#include "com/diag/grandote/cxxcapi.h"
+/**
+ *  Run the SpscFifo unit test.
+ *  
+ *  @return the number of errors detected by the unit test.
+ */
+CXXCAPI int unittestSpscFifo(void);
+#endif
+
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef _COM_DIAG_GRANDOTE_TAT_H_
+#define _COM_DIAG_GRANDOTE_TAT_H_
+
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+/**
+ *  @file
+ *
+ *  Declares the Tat class.
+ *
+ *  @see    Tat
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/target.h"
+#include "com/diag/grandote/types.h"
+#include "com/diag/grandote/generics.h"
+
+
+namespace com { namespace diag { namespace grandote {
+
+/**
+ *  Implements the Generic Cell Rate Algorithm (GCRA) arithmetic of Gcra
+ *  on a single theoretical arrival time (TAT) of the next event, which is
+ *  then plus x in the terminology of Gcra. Keeping the state in a single
+ *  word is what lets AtomicGcra install it with one compare-and-swap and
+ *  lets GcraTable keep it in one array; both use these methods so that
+ *  they make the same decisions. The arithmetic is that of
+ *  Gcra::admissible and Gcra::commit, saturating rather than overflowing,
+ *  and is written as selections rather than branches so that the compiler
+ *  can use conditional moves.
+ *
+ *  @see    Gcra
+ *
+ *  @see    AtomicGcra
+ *
+ *  @see    GcraTable
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+class Tat {
+
+public:
+
+    /**
+     *  Returns the TAT of a throttle just reset, in which an event is
+     *  immediately admissible. Gcra sets then to one increment before now
+     *  and x to zero; a TAT of now is equivalent and cannot underflow.
+     *
+     *  @param  ticks       is the current time in throttle ticks.
+     *
+     *  @return the TAT.
+     */
+    static ticks_t reset(ticks_t ticks);
+
+    /**
+     *  Returns the number of ticks that an event must be delayed to be
+     *  admissible at the specified time.
+     *
+     *  @param  tat         is the TAT.
+     *
+     *  @param  limit       is the GCRA limit or L in throttle ticks.
+     *
+     *  @param  ticks       is the current time in throttle ticks.
+     *
+     *  @return the delay in ticks, or zero if admissible.
+     */
+    static ticks_t delay(ticks_t tat, ticks_t limit, ticks_t ticks);
+
+    /**
+     *  Returns the TAT after the specified number of events are admitted at
+     *  the specified time, saturating at the maximum tick value.
+     *
+     *  @param  tat         is the TAT.
+     *
+     *  @param  n           is the number of events.
+     *
+     *  @param  increment   is the GCRA increment or I in throttle ticks.
+     *
+     *  @param  maximum     is the largest number of events whose increments
+     *                      do not overflow.
+     *
+     *  @param  ticks       is the current time in throttle ticks.
+     *
+     *  @param  saturated   refers to a variable into which true is stored
+     *                      if the TAT saturated, making the throttle only
+     *                      approximate, and false otherwise.
+     *
+     *  @return the new TAT.
+     */
+    static ticks_t advance(ticks_t tat, size_t n, ticks_t increment, ticks_t maximum, ticks_t ticks, bool& saturated);
+
+private:
+
+    /**
+     *  Constructor.
+     */
+    Tat();
+
+};
+
+
+//
+//  Return the TAT of a reset throttle.
+//
+inline ticks_t Tat::reset(ticks_t ticks) {
+    return ticks;
+}
+
+
+//
+//  Return the delay until admissible.
+//
+inline ticks_t Tat::delay(ticks_t tat, ticks_t limit, ticks_t ticks) {
+    ticks_t x1 = (tat > ticks) ? (tat - ticks) : 0;
+    return (x1 > limit) ? (x1 - limit) : 0;
+}
+
+
+//
+//  Return the TAT after admitting the events.
+//
+inline ticks_t Tat::advance(ticks_t tat, size_t n, ticks_t increment, ticks_t maximum, ticks_t ticks, bool& saturated) {
+    ticks_t x1 = (tat > ticks) ? (tat - ticks) : 0;
+    ticks_t charge = n * increment;
+    bool full = (n > maximum) || (x1 > (intmaxof(ticks_t) - charge));
+    ticks_t x = full ? intmaxof(ticks_t) : (x1 + charge);
+    bool overflowed = (x > (intmaxof(ticks_t) - ticks));
+    saturated = full || overflowed;
+    return overflowed ? intmaxof(ticks_t) : (ticks + x);
+}
+
+} } }
+
+
+#endif
@@ -63,6 +63,8 @@
 
 namespace com { namespace diag { namespace grandote {
 
+class ThrottleWaiter;
+
 /**
  *  Implements a generic interface to a throttle, an object which
  *  maintains state to control the rate at which some event is allowed
@@ -84,10 +86,27 @@ public:
     explicit Throttle();
 
     /**
-     *  Destructor.
+     *  Destructor. Destroys the waiter, if await() created one.
      */
     virtual ~Throttle();
 
+    /**
+     *  Copy constructor. The copy does not share the waiter of the
+     *  original; it creates its own if it has to wait.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    Throttle(const Throttle& that);
+
+    /**
+     *  Assignment operator. This throttle keeps its own waiter.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     *
+     *  @return a reference to this object.
+     */
+    Throttle& operator=(const Throttle& that);
+
     /**
      *  Resets the throttle to its just-constructed state. This may
      *  allow traffic contract violations to occur since subsequent
@@ -168,6 +187,38 @@ public:
      */
     virtual bool rollback();
 
+    /**
+     *  Blocks the calling thread until the event is admissible, then
+     *  commits the specified number of events. The thread sleeps on a
+     *  ThrottleWaiter, which wakes it when the delay returned by
+     *  admissible() has passed without spinning, and the throttle is
+     *  evaluated again, so that a premature wakeup costs only another
+     *  sleep. If the event is immediately admissible no system call is
+     *  made. The throttle creates its waiter the first time it has to
+     *  wait and keeps it until it is destroyed.
+     *
+     *  @see    ThrottleWaiter
+     *
+     *  @param n            is the number of events being emitted.
+     *
+     *  @return true if the throttle is not alarmed, false otherwise.
+     */
+    virtual bool await(size_t n = 1);
+
+    /**
+     *  Blocks the calling thread until the event is admissible, then
+     *  commits the specified number of events, sleeping on a waiter
+     *  provided by the caller, who may share one waiter among all of the
+     *  throttles that a thread paces.
+     *
+     *  @param waiter       refers to the waiter.
+     *
+     *  @param n            is the number of events being emitted.
+     *
+     *  @return true if the throttle is not alarmed, false otherwise.
+     */
+    virtual bool await(ThrottleWaiter& waiter, size_t n = 1);
+
     /**
      *  Returns the current time in the units of ticks indicated
      *  by the throttle frequency. If the throttle is not a
@@ -229,6 +280,13 @@ public:
      */
     virtual void show(int level = 0, Output* display = 0, int indent = 0) const;
 
+private:
+
+    /**
+     *  This is the waiter created by await(), or null (zero).
+     */
+    ThrottleWaiter* waiter;
+
 };
 
 } } }
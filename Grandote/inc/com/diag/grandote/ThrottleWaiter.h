@@ -0,0 +1,260 @@
+#ifndef _COM_DIAG_GRANDOTE_THROTTLEWAITER_H_
+#define _COM_DIAG_GRANDOTE_THROTTLEWAITER_H_
+
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Declares the ThrottleWaiter class.
+ *
+ *  @see    ThrottleWaiter
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/target.h"
+#include "com/diag/grandote/types.h"
+#include "com/diag/grandote/Throttle.h"
+#include "com/diag/grandote/Output.h"
+
+
+namespace com { namespace diag { namespace grandote {
+
+/**
+ *  Waits for the earliest of many throttles to become admissible using a
+ *  single Linux timerfd. The timer is armed with the smallest delay any of
+ *  the throttles returns from admissible(), relative to the monotonic
+ *  clock, so the wait is as precise as the kernel timer and ends without
+ *  the sched_yield() loop of Platform::yield(). Because the timer is a file
+ *  descriptor, a thread that paces many throttled senders can also arm it
+ *  and include it in its own poll(2) or select(2) set alongside its
+ *  sockets, then call wait() when it is readable.
+ *
+ *  The throttles are only evaluated, never committed: every admissible()
+ *  is followed by a rollback(), and it is up to the caller to commit the
+ *  throttle it chooses to emit on. Throttles that are not time-based,
+ *  which have a frequency of zero, are treated as always admissible.
+ *
+ *  The timerfd is used only on the Linux-based platforms. On any other
+ *  platform, or if the timerfd cannot be created, the descriptor is
+ *  negative and the waiter falls back to Platform::yield().
+ *
+ *  This class is not thread-safe. Serialization is the responsibility
+ *  of the application.
+ *
+ *  @see    Throttle::await
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+class ThrottleWaiter {
+
+public:
+
+    /**
+     *  Constructor. Creates the timerfd, disarmed, if the platform has
+     *  one.
+     */
+    explicit ThrottleWaiter();
+
+    /**
+     *  Destructor. Closes the timerfd, if there is one.
+     */
+    virtual ~ThrottleWaiter();
+
+    /**
+     *  Returns the timerfd, which becomes readable when the armed timer
+     *  expires.
+     *
+     *  @return the file descriptor, or a negative number if the timerfd
+     *          could not be created.
+     */
+    int getDescriptor() const;
+
+    /**
+     *  Evaluates the throttles, starting after the one last found
+     *  admissible so that no throttle is starved, and arms the timer for
+     *  the earliest of them if none is admissible now.
+     *
+     *  @param  throttles   is an array of pointers to throttles.
+     *
+     *  @param  count       is the number of throttles in the array.
+     *
+     *  @param  index       refers to where the index of the earliest
+     *                      throttle is stored.
+     *
+     *  @return the delay in ticks of the earliest throttle, in units of
+     *          its frequency, zero if it is admissible now (in which case
+     *          the timer is disarmed), or the maximum ticks value if there
+     *          are no throttles.
+     */
+    ticks_t arm(Throttle* throttles[], size_t count, size_t& index);
+
+    /**
+     *  Arms the timer to expire after a delay.
+     *
+     *  @param  ticks       is the delay in ticks.
+     *
+     *  @param  frequency   is the frequency of the ticks in ticks per
+     *                      second.
+     *
+     *  @return the file descriptor, or a negative number if the timer
+     *          could not be armed.
+     */
+    int arm(ticks_t ticks, ticks_t frequency);
+
+    /**
+     *  Disarms the timer.
+     *
+     *  @return the file descriptor, or a negative number if the timer
+     *          could not be disarmed.
+     */
+    int disarm();
+
+    /**
+     *  Blocks until the armed timer expires, or returns at once if it has
+     *  already expired, and clears the expiration. Must not be called if
+     *  the timer is disarmed.
+     *
+     *  @return the number of expirations, which is one if the waiter had
+     *          to fall back to Platform::yield().
+     */
+    int wait();
+
+    /**
+     *  Blocks until one of the throttles is admissible. When this returns,
+     *  admissible() on the chosen throttle will return zero until some
+     *  event is committed on it.
+     *
+     *  @param  throttles   is an array of pointers to throttles.
+     *
+     *  @param  count       is the number of throttles in the array.
+     *
+     *  @return the index of an admissible throttle, or count if there are
+     *          no throttles.
+     */
+    size_t await(Throttle* throttles[], size_t count);
+
+    /**
+     *  Displays internal information about this object to the specified
+     *  output object. Useful for debugging and troubleshooting.
+     *
+     *  @param  level   sets the verbosity of the output. What this means
+     *                  is object dependent. However, the level is passed
+     *                  from outer to inner objects this object calls the
+     *                  show methods of its inherited or composited objects.
+     *
+     *  @param display  points to the output object to which output is
+     *                  sent. If null (zero), the default platform output
+     *                  object is used as the effective output object. The
+     *                  effective output object is passed from outer to
+     *                  inner objects as this object calls the show methods
+     *                  of its inherited and composited objects.
+     *
+     *  @param  indent  specifies the level of indentation. One more than
+     *                  this value is passed from outer to inner objects
+     *                  as this object calls the show methods of its
+     *                  inherited and composited objects.
+     */
+    virtual void show(int level = 0, Output* display = 0, int indent = 0) const;
+
+private:
+
+    /**
+     *  This is the timerfd.
+     */
+    int fd;
+
+    /**
+     *  This is the index after which the next evaluation starts.
+     */
+    size_t next;
+
+    /**
+     *  This is the delay of the armed timer in nanoseconds if the waiter
+     *  has to fall back to Platform::yield().
+     */
+    ticks_t nanoseconds;
+
+    /**
+     *  Copy constructor.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    ThrottleWaiter(const ThrottleWaiter& that);
+
+    /**
+     *  Assignment operator.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    ThrottleWaiter& operator=(const ThrottleWaiter& that);
+
+};
+
+
+//
+//  Return the file descriptor.
+//
+inline int ThrottleWaiter::getDescriptor() const {
+    return this->fd;
+}
+
+} } }
+
+
+#if defined(GRANDOTE_HAS_UNITTESTS)
+#include "com/diag/grandote/cxxcapi.h"
+/**
+ *  Run the ThrottleWaiter unit test.
+ *
+ *  @return the number of errors detected.
+ */
+CXXCAPI int unittestThrottleWaiter(void);
+#endif
+
+
+#endif
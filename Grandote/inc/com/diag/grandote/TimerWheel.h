@@ -0,0 +1,487 @@
+#ifndef _COM_DIAG_GRANDOTE_TIMERWHEEL_H_
+#define _COM_DIAG_GRANDOTE_TIMERWHEEL_H_
+
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+/**
+ *  @file
+ *
+ *  Declares the TimerWheel and Timer classes.
+ *
+ *  @see    TimerWheel
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/target.h"
+#include "com/diag/grandote/types.h"
+#include "com/diag/grandote/Object.h"
+#include "com/diag/grandote/Link.h"
+#include "com/diag/grandote/Chain.h"
+#include "com/diag/grandote/Output.h"
+
+
+namespace com { namespace diag { namespace grandote {
+
+class TimerWheel;
+
+/**
+ *  Implements a timer that can be armed on a TimerWheel. The application
+ *  derives from this class and overrides the expire method, which the
+ *  TimerWheel calls once the deadline of the timer has passed. The timer
+ *  contains the chain link by which it is placed on the wheel, so arming
+ *  and cancelling it allocate nothing, and destroying it cancels it.
+ *
+ *  @see    TimerWheel
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+class Timer {
+
+    friend class TimerWheel;
+
+public:
+
+    /**
+     *  Constructor.
+     */
+    explicit Timer();
+
+    /**
+     *  Destructor. If the timer is armed, it is cancelled.
+     */
+    virtual ~Timer();
+
+    /**
+     *  Returns true if the timer is armed, false otherwise.
+     *
+     *  @return true if the timer is armed, false otherwise.
+     */
+    bool isArmed() const;
+
+    /**
+     *  Returns the absolute deadline in platform ticks with which the timer
+     *  was most recently armed.
+     *
+     *  @return the deadline in platform ticks.
+     */
+    ticks_t getDeadline() const;
+
+    /**
+     *  Cancels the timer if it is armed.
+     *
+     *  @return true if the timer was armed, false otherwise.
+     */
+    bool cancel();
+
+    /**
+     *  This is called by the TimerWheel when the timer expires. The timer
+     *  is no longer armed when this is called, and may be armed again,
+     *  on this or any other TimerWheel, from within it.
+     *
+     *  @param  wheel   refers to the TimerWheel on which the timer expired.
+     *
+     *  @param  now     is the time in platform ticks passed to the
+     *                  TimerWheel advance method that expired the timer.
+     */
+    virtual void expire(TimerWheel& wheel, ticks_t now) = 0;
+
+    /**
+     *  Displays internal information about this object to the specified
+     *  output object. Useful for debugging and troubleshooting.
+     *
+     *  @param  level   sets the verbosity of the output. What this means
+     *                  is object dependent. However, the level is passed
+     *                  from outer to inner objects this object calls the
+     *                  show methods of its inherited or composited objects.
+     *
+     *  @param display  points to the output object to which output is
+     *                  sent. If null (zero), the default platform output
+     *                  object is used as the effective output object. The
+     *                  effective output object is passed from outer to
+     *                  inner objects as this object calls the show methods
+     *                  of its inherited and composited objects.
+     *
+     *  @param  indent  specifies the level of indentation. One more than
+     *                  this value is passed from outer to inner objects
+     *                  as this object calls the show methods of its
+     *                  inherited and composited objects.
+     */
+    virtual void show(int level = 0, Output* display = 0, int indent = 0) const;
+
+private:
+
+    /**
+     *  This is the link by which the timer is placed on a slot of the wheel.
+     *  Its payload points to this timer.
+     */
+    Link link;
+
+    /**
+     *  This is the deadline of the timer in platform ticks.
+     */
+    ticks_t deadline;
+
+    /**
+     *  This is the deadline of the timer in units of the granularity of
+     *  the wheel, rounded up so that the timer never expires early.
+     */
+    ticks_t expiration;
+
+    /**
+     *  Copy constructor.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    Timer(const Timer& that);
+
+    /**
+     *  Assignment operator.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    Timer& operator=(const Timer& that);
+
+};
+
+
+/**
+ *  Implements a hashed hierarchical timing wheel on which large numbers of
+ *  Timers can be armed, cancelled, and expired, each in constant time.
+ *
+ *  Time is divided into granules of a fixed number of platform ticks. The
+ *  root level of the wheel has one slot for each of the next ROOT granules.
+ *  Each of the LEVELS levels above it has LEVEL slots, each slot of which
+ *  covers as many granules as the entire level below it. A timer is placed
+ *  on the lowest level with room for its deadline, in the slot covering
+ *  its deadline. Each slot is a Chain, so placing a timer on a slot, or
+ *  removing it, is a constant time operation on the Link inside the timer.
+ *
+ *  As the wheel is advanced a granule at a time, the timers on the current
+ *  root slot are expired. Whenever the root level wraps around, the timers
+ *  on the next slot of the level above are cascaded down, each onto the
+ *  lowest level that now has room for it, and likewise up the hierarchy.
+ *  Each timer is hence moved no more than once per level before it
+ *  expires. Timers whose deadlines lie beyond the last slot of the top
+ *  level are placed on that slot, and are moved down when it is cascaded.
+ *
+ *  The wheel is driven by the application calling the advance method with
+ *  the current time, typically from Platform::time(), for example each
+ *  time through an event loop, and does nothing on its own. Timers expire
+ *  no earlier than their deadlines, and no later than the first advance
+ *  that covers the end of the granule containing their deadlines.
+ *
+ *  No implicit synchronization or critical section is implemented. This
+ *  is the responsibility of the application.
+ *
+ *  @see    G. Varghese, A. Lauck, "Hashed and Hierarchical Timing Wheels:
+ *          Efficient Data Structures for Implementing a Timer Facility",
+ *          <I>IEEE/ACM Transactions on Networking</I>, 5.6, December 1997
+ *
+ *  @author coverclock@diag.com (Chip Overclock)
+ */
+class TimerWheel : public Object {
+
+public:
+
+    /**
+     *  This is the number of bits of the granule indexing the root level.
+     */
+    static const unsigned int ROOTBITS = 8;
+
+    /**
+     *  This is the number of bits of the granule indexing each upper level.
+     */
+    static const unsigned int LEVELBITS = 6;
+
+    /**
+     *  This is the number of slots in the root level.
+     */
+    static const size_t ROOT = 1 << ROOTBITS;
+
+    /**
+     *  This is the number of slots in each upper level.
+     */
+    static const size_t LEVEL = 1 << LEVELBITS;
+
+    /**
+     *  This is the number of upper levels.
+     */
+    static const size_t LEVELS = 4;
+
+    /**
+     *  Constructor.
+     *
+     *  @param  granularity is the number of platform ticks in each granule,
+     *                      the resolution of the wheel. Zero is treated as
+     *                      one.
+     *
+     *  @param  now         is the current time in platform ticks.
+     */
+    explicit TimerWheel(ticks_t granularity = 1, ticks_t now = 0);
+
+    /**
+     *  Destructor. Any timers still armed on the wheel are cancelled, but
+     *  not expired.
+     */
+    virtual ~TimerWheel();
+
+    /**
+     *  Returns the number of platform ticks in each granule.
+     *
+     *  @return the number of platform ticks in each granule.
+     */
+    ticks_t getGranularity() const;
+
+    /**
+     *  Returns the time in platform ticks up to which the wheel has been
+     *  advanced, which is the start of the next granule to be processed.
+     *
+     *  @return the time in platform ticks of the wheel.
+     */
+    ticks_t getTime() const;
+
+    /**
+     *  Arms a timer to expire at an absolute deadline. A timer whose
+     *  deadline lies in a granule the wheel has already processed expires
+     *  on the next advance, whatever time it is given.
+     *
+     *  @param  timer       refers to the timer.
+     *
+     *  @param  deadline    is the absolute deadline in platform ticks.
+     *
+     *  @return true if successful, false if the timer was already armed.
+     */
+    bool insert(Timer& timer, ticks_t deadline);
+
+    /**
+     *  Cancels a timer. This is the same as calling the timer cancel
+     *  method.
+     *
+     *  @param  timer       refers to the timer.
+     *
+     *  @return true if the timer was armed, false otherwise.
+     */
+    bool cancel(Timer& timer);
+
+    /**
+     *  Advances the wheel to the specified time, expiring, in order of
+     *  their granules, all timers whose granules have ended by then. The
+     *  timers of each granule are removed from the wheel before any of
+     *  them are expired, so a timer may cancel or rearm any timer,
+     *  including itself, from its expire method.
+     *
+     *  @param  now     is the current time in platform ticks.
+     *
+     *  @return the number of timers expired.
+     */
+    size_t advance(ticks_t now);
+
+    /**
+     *  Advances the wheel to the current time returned by Platform::time().
+     *
+     *  @return the number of timers expired.
+     */
+    size_t advance();
+
+    /**
+     *  Displays internal information about this object to the specified
+     *  output object. Useful for debugging and troubleshooting.
+     *
+     *  @param  level   sets the verbosity of the output. What this means
+     *                  is object dependent. However, the level is passed
+     *                  from outer to inner objects this object calls the
+     *                  show methods of its inherited or composited objects.
+     *
+     *  @param display  points to the output object to which output is
+     *                  sent. If null (zero), the default platform output
+     *                  object is used as the effective output object. The
+     *                  effective output object is passed from outer to
+     *                  inner objects as this object calls the show methods
+     *                  of its inherited and composited objects.
+     *
+     *  @param  indent  specifies the level of indentation. One more than
+     *                  this value is passed from outer to inner objects
+     *                  as this object calls the show methods of its
+     *                  inherited and composited objects.
+     */
+    virtual void show(int level = 0, Output* display = 0, int indent = 0) const;
+
+private:
+
+    /**
+     *  Places a timer on the slot for its expiration relative to the
+     *  current granule.
+     *
+     *  @param  timer       refers to the timer.
+     */
+    void place(Timer& timer);
+
+    /**
+     *  Moves all of the timers on a slot of an upper level down onto
+     *  lower levels.
+     *
+     *  @param  level       is the upper level, starting at zero.
+     *
+     *  @param  index       is the slot in the level.
+     *
+     *  @return the slot in the level, which if zero means that the level
+     *          has wrapped around and the level above must be cascaded too.
+     */
+    size_t cascade(size_t level, size_t index);
+
+    /**
+     *  Finds the next granule at which a slot of an upper level that has
+     *  timers on it will be cascaded.
+     *
+     *  @return the granule, or all ones if the upper levels are empty.
+     */
+    ticks_t next() const;
+
+    /**
+     *  This is the number of platform ticks in each granule.
+     */
+    ticks_t granularity;
+
+    /**
+     *  This is the next granule to be processed.
+     */
+    ticks_t current;
+
+    /**
+     *  These are the timers armed with deadlines in granules that had
+     *  already been processed, to be expired on the next advance.
+     */
+    Chain overdue;
+
+    /**
+     *  These are the slots of the root level.
+     */
+    Chain root[ROOT];
+
+    /**
+     *  These are the slots of the upper levels.
+     */
+    Chain levels[LEVELS][LEVEL];
+
+    /**
+     *  Copy constructor.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    TimerWheel(const TimerWheel& that);
+
+    /**
+     *  Assignment operator.
+     *
+     *  @param  that    refers to an R-value object of this type.
+     */
+    TimerWheel& operator=(const TimerWheel& that);
+
+};
+
+
+//
+//  Return true if the timer is on a slot.
+//
+inline bool Timer::isArmed() const {
+    return this->link.isChained();
+}
+
+
+//
+//  Return the deadline.
+//
+inline ticks_t Timer::getDeadline() const {
+    return this->deadline;
+}
+
+
+//
+//  Cancel the timer.
+//
+inline bool Timer::cancel() {
+    return (0 != this->link.remove());
+}
+
+
+//
+//  Return the granularity.
+//
+inline ticks_t TimerWheel::getGranularity() const {
+    return this->granularity;
+}
+
+
+//
+//  Return the time up to which the wheel has been advanced.
+//
+inline ticks_t TimerWheel::getTime() const {
+    return this->current * this->granularity;
+}
+
+
+//
+//  Cancel the timer.
+//
+inline bool TimerWheel::cancel(Timer& timer) {
+    return timer.cancel();
+}
+
+} } }
+
+
+#if defined(GRANDOTE_HAS_UNITTESTS)
+#include "com/diag/grandote/cxxcapi.h"
+/**
+ *  Run the TimerWheel unit test.
+ *  
+ *  @return the number of errors detected by the unit test.
+ */
+CXXCAPI int unittestTimerWheel(void);
+#endif
+
+
+#endif
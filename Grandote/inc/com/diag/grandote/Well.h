@@ -68,11 +68,31 @@ public:
 
 	/**
 	 * Return true if the well is empty, that is, the next new operator
-	 * will return a null pointer.
+	 * will return a null pointer. An elastic well is never empty, since
+	 * it grows another slab instead.
 	 * @return true if the well is empty, false otherwise.
 	 */
 	bool isEmpty() const;
 
+	/**
+	 * Return true if the well is elastic.
+	 * @return true if the well is elastic, false otherwise.
+	 */
+	bool isElastic() const { return (increment > 0); }
+
+	/**
+	 * Return the number of slabs in an elastic well.
+	 * @return the number of slabs, or zero if the well is fixed.
+	 */
+	size_t getSlabs() const { return slabs; }
+
+	/**
+	 * Return the number of slabs in an elastic well none of whose objects
+	 * are allocated.
+	 * @return the number of idle slabs, or zero if the well is fixed.
+	 */
+	size_t getIdle() const { return idle; }
+
 protected:
 
 	/**
@@ -90,14 +110,23 @@ protected:
 	 * calls.
 	 * [3] If cardinality is greater than zero and preallocation is enabled,
 	 * memory for the well is allocated at the time of well construction.
+	 * [4] If the increment is greater than zero, the well is elastic: it is
+	 * built from page-aligned slabs of at least increment objects each, and
+	 * when it runs dry another slab is chained onto it instead of the
+	 * allocation failing. The cardinality is then just the number of objects
+	 * for which slabs are allocated up front. Slabs that become completely
+	 * free are released back to the system once there are more than the
+	 * high-water mark of them.
 	 * @param ss is the size of objects in the well in bytes.
 	 * @param cc is the fixed number of objects in the well.
 	 * @param mm if true causes memory to be allocated during construction.
 	 * @param aa is the alignment of objects in the well.
 	 * @param pp is the virtual page size of the underlying platform or zero.
 	 * @param ll is the cache line size of the underlying target or zero.
+	 * @param ee is the minimum number of objects per slab or zero if fixed.
+	 * @param hh is the number of free slabs kept or zero for the default.
 	 */
-	explicit BaseWell(size_t ss, size_t cc, bool mm, size_t aa, size_t pp = 0, size_t ll = 0);
+	explicit BaseWell(size_t ss, size_t cc, bool mm, size_t aa, size_t pp = 0, size_t ll = 0, size_t ee = 0, size_t hh = 0);
 
 	/**
 	 * Allocate memory for the well.
@@ -116,8 +145,9 @@ protected:
 	void * alloc();
 
 	/**
-	 * Free memory for an object of type _TYPE_ back to the well.
-	 * @param pointer points to the memory to be freed.
+	 * Free memory for an object of type _TYPE_ back to the well. Freeing a
+	 * null pointer does nothing, as the delete operator requires.
+	 * @param pointer points to the memory to be freed, or is null.
 	 */
 	void free(void * pointer);
 
@@ -158,6 +188,96 @@ protected:
 	 */
 	diminuto_well_t * wellp;
 
+	/**
+	 * This is the header at the start of each slab of an elastic well. Each
+	 * slab is aligned on a multiple of its own extent, so the slab to which
+	 * an object belongs, and from it the well, is found by masking the
+	 * object's address.
+	 */
+	struct Slab {
+		BaseWell * well;
+		Slab * next;
+		Slab * previous;
+		void * free;
+		char * fresh;
+		size_t used;
+		bool listed;
+	};
+
+	/**
+	 * Compute the slab geometry of an elastic well.
+	 */
+	void geometry();
+
+	/**
+	 * Allocate a new slab for an elastic well and put it on the list of
+	 * slabs that have free objects.
+	 * @return a pointer to the slab or null if none could be allocated.
+	 */
+	Slab * slab();
+
+	/**
+	 * Remove a slab from the list of slabs that have free objects.
+	 * @param sp points to the slab.
+	 */
+	void unlink(Slab * sp);
+
+	/**
+	 * Put a slab on the list of slabs that have free objects.
+	 * @param sp points to the slab.
+	 * @param end if true appends the slab, else prepends it.
+	 */
+	void link(Slab * sp, bool end);
+
+	/**
+	 * This is the minimum number of objects in each slab of an elastic well,
+	 * or zero if the well is fixed.
+	 */
+	size_t increment;
+
+	/**
+	 * This is the number of completely free slabs that an elastic well keeps
+	 * before it starts releasing them.
+	 */
+	size_t highwater;
+
+	/**
+	 * This is the size and alignment of each slab in bytes, a power of two.
+	 */
+	size_t extent;
+
+	/**
+	 * This is the offset of the first object from the start of a slab.
+	 */
+	size_t offset;
+
+	/**
+	 * This is the distance between adjacent objects in a slab.
+	 */
+	size_t stride;
+
+	/**
+	 * This is the number of slabs in an elastic well.
+	 */
+	size_t slabs;
+
+	/**
+	 * This is the number of slabs in an elastic well none of whose objects
+	 * are allocated.
+	 */
+	size_t idle;
+
+	/**
+	 * This is the first slab that has free objects. Partially used slabs
+	 * are kept at the front and completely free slabs at the back.
+	 */
+	Slab * head;
+
+	/**
+	 * This is the last slab that has free objects.
+	 */
+	Slab * tail;
+
 };
 
 /**
@@ -210,8 +330,10 @@ protected:
 	 * @param aa is the alignment of objects in the well.
 	 * @param pp is the virtual page size of the underlying platform or zero.
 	 * @param ll is the cache line size of the underlying target or zero.
+	 * @param ee is the minimum number of objects per slab or zero if fixed.
+	 * @param hh is the number of free slabs kept or zero for the default.
 	 */
-	explicit SafeBaseWell(size_t ss, size_t cc, bool mm, size_t aa, size_t pp = 0, size_t ll = 0);
+	explicit SafeBaseWell(size_t ss, size_t cc, bool mm, size_t aa, size_t pp = 0, size_t ll = 0, size_t ee = 0, size_t hh = 0);
 
 	/**
 	 * Allocate memory for the well.
@@ -243,6 +365,177 @@ protected:
 
 };
 
+/**
+ * This is the thread-safe base Well class with a per-thread cache of
+ * magazines in front of it. Each thread allocates from and frees to a pair
+ * of small stacks of objects, called magazines, without taking the mutex.
+ * Only when both of its magazines are empty (on allocation) or full (on
+ * free) does a thread take the mutex, and then only to trade a whole
+ * magazine with a depot shared by all threads, or to fill a magazine from
+ * the well in a single batch. Objects sitting in a magazine count as
+ * allocated as far as isFull() and isEmpty() are concerned. The well keeps
+ * a list of the caches of all threads, and when it is destroyed it takes
+ * back every one of them, including those of threads that are still running.
+ * Those threads must not be using the well while it is destroyed, nor use it
+ * afterwards.
+ *
+ * @see J. Bonwick et al., "Magazines and Vmem: Extending the Slab Allocator
+ * to Many CPUs and Arbitrary Resources", USENIX 2001
+ */
+class CachedSafeBaseWell : public SafeBaseWell {
+
+public:
+
+	/**
+	 * This is the default number of objects in each magazine.
+	 */
+	enum { ROUNDS = 16 };
+
+	/**
+	 * Destructor.
+	 * The magazines of every thread, not just the calling one, and of the
+	 * depot are returned to the well before it is freed.
+	 */
+	virtual ~CachedSafeBaseWell();
+
+	/**
+	 * Return any objects cached by the calling thread, and any objects in
+	 * the depot, to the well, then deallocate memory for the well if and
+	 * only if there are no objects of type _TYPE_ allocated from the well.
+	 */
+	void fini();
+
+	/**
+	 * Return any objects cached by the calling thread to the well. This is
+	 * done automatically when the thread exits.
+	 */
+	void flush();
+
+protected:
+
+	/**
+	 * This is a magazine: a stack of pointers to free objects.
+	 */
+	struct Magazine {
+		Magazine * next;
+		size_t rounds;
+		void ** round;
+	};
+
+	/**
+	 * This is the per-thread cache: a loaded magazine from which objects are
+	 * allocated and freed, and a previous magazine that is swapped with the
+	 * loaded one before going to the depot. Every cache is also on the list
+	 * of caches of its well.
+	 */
+	struct Cache {
+		CachedSafeBaseWell * well;
+		Magazine * loaded;
+		Magazine * previous;
+		Cache * after;
+		Cache * before;
+	};
+
+	/**
+	 * Constructor.
+	 * @param ss is the size of objects in the well in bytes.
+	 * @param cc is the fixed number of objects in the well.
+	 * @param mm if true causes memory to be allocated during construction.
+	 * @param aa is the alignment of objects in the well.
+	 * @param pp is the virtual page size of the underlying platform or zero.
+	 * @param ll is the cache line size of the underlying target or zero.
+	 * @param rr is the number of objects in each magazine or zero.
+	 * @param ee is the minimum number of objects per slab or zero if fixed.
+	 * @param hh is the number of free slabs kept or zero for the default.
+	 */
+	explicit CachedSafeBaseWell(size_t ss, size_t cc, bool mm, size_t aa, size_t pp = 0, size_t ll = 0, size_t rr = 0, size_t ee = 0, size_t hh = 0);
+
+	/**
+	 * Allocate memory for an object of type _TYPE_ from the calling thread's
+	 * cache, refilling the cache from the depot or the well if necessary.
+	 * @return a pointer to the memory allocated from the well.
+	 */
+	void * alloc();
+
+	/**
+	 * Free memory for an object of type _TYPE_ back to the calling thread's
+	 * cache, spilling a full magazine to the depot if necessary. Freeing
+	 * a null pointer does nothing.
+	 * @param pointer points to the memory to be freed.
+	 */
+	void free(void * pointer);
+
+	/**
+	 * Allocate an empty magazine.
+	 * @return a pointer to the magazine or null if none could be allocated.
+	 */
+	Magazine * magazine();
+
+	/**
+	 * Return the calling thread's cache, creating it if necessary.
+	 * @return a pointer to the cache or null if none could be created.
+	 */
+	Cache * cache();
+
+	/**
+	 * Return all objects in a cache to the well and free the cache.
+	 * @param cp points to the cache.
+	 */
+	void drain(Cache * cp);
+
+	/**
+	 * Return all objects in a cache to the well and take the cache off the
+	 * list of caches. The mutex must be held.
+	 * @param cp points to the cache.
+	 */
+	void release(Cache * cp);
+
+	/**
+	 * Free a cache and its magazines.
+	 * @param cp points to the cache.
+	 */
+	static void discard(Cache * cp);
+
+	/**
+	 * This is called by the POSIX thread library when a thread that has a
+	 * cache exits.
+	 * @param pointer points to the cache.
+	 */
+	static void destructor(void * pointer);
+
+	/**
+	 * This is the number of objects in each magazine.
+	 */
+	size_t capacity;
+
+	/**
+	 * This is the list of full magazines in the depot.
+	 */
+	Magazine * full;
+
+	/**
+	 * This is the list of empty magazines in the depot.
+	 */
+	Magazine * empty;
+
+	/**
+	 * This is the list of the caches of all threads.
+	 */
+	Cache * caches;
+
+	/**
+	 * This is the POSIX thread specific data key of the per-thread cache.
+	 */
+	pthread_key_t key;
+
+	/**
+	 * This is true if the key was successfully created. If not, every
+	 * operation goes straight to the mutex-protected well.
+	 */
+	bool keyed;
+
+};
+
 template <class _TYPE_, size_t _ALIGNMENT_ = sizeof(uint64_t)>
 /**
  * This is a templated Well class for objects of type _TYPE_. When a new()
@@ -272,14 +565,18 @@ public:
 	 * calls.
 	 * [3] If cardinality is greater than zero and preallocation is enabled,
 	 * memory for the well is allocated at the time of well construction.
+	 * [4] If the increment is greater than zero, the well is elastic and
+	 * grows by another slab of objects instead of running dry.
 	 * @param cc is the fixed number of items of type _TYPE_ in the well.
 	 * @param mm if true causes memory to be allocated during construction.
 	 * @param aa is the alignment of objects in the well.
 	 * @param pp is the virtual page size of the underlying platform or zero.
 	 * @param ll is the cache line size of the underlying target or zero.
+	 * @param ee is the minimum number of objects per slab or zero if fixed.
+	 * @param hh is the number of free slabs kept or zero for the default.
 	 */
-	explicit Well(size_t cc = 0, bool mm = true, size_t aa = _ALIGNMENT_, size_t pp = 0, size_t ll = 0)
-	: BaseWell(sizeof(_TYPE_), cc, mm, aa, pp, ll)
+	explicit Well(size_t cc = 0, bool mm = true, size_t aa = _ALIGNMENT_, size_t pp = 0, size_t ll = 0, size_t ee = 0, size_t hh = 0)
+	: BaseWell(sizeof(_TYPE_), cc, mm, aa, pp, ll, ee, hh)
 	{}
 
 	/**
@@ -344,14 +641,18 @@ public:
 	 * calls.
 	 * [3] If cardinality is greater than zero and preallocation is enabled,
 	 * memory for the well is allocated at the time of well construction.
+	 * [4] If the increment is greater than zero, the well is elastic and
+	 * grows by another slab of objects instead of running dry.
 	 * @param cc is the fixed number of items of type _TYPE_ in the well.
 	 * @param mm if true causes memory to be allocated during construction.
 	 * @param aa is the alignment of objects of type _TYPE_ in the well.
 	 * @param pp is the virtual page size of the underlying platform or zero.
 	 * @param ll is the cache line size of the underlying target or zero.
+	 * @param ee is the minimum number of objects per slab or zero if fixed.
+	 * @param hh is the number of free slabs kept or zero for the default.
 	 */
-	explicit SafeWell(size_t cc = 0, bool mm = true, size_t aa = _ALIGNMENT_, size_t pp = 0, size_t ll = 0)
-	: SafeBaseWell(sizeof(_TYPE_), cc, pp, aa, pp, ll)
+	explicit SafeWell(size_t cc = 0, bool mm = true, size_t aa = _ALIGNMENT_, size_t pp = 0, size_t ll = 0, size_t ee = 0, size_t hh = 0)
+	: SafeBaseWell(sizeof(_TYPE_), cc, mm, aa, pp, ll, ee, hh)
 	{}
 
 	/**
@@ -377,7 +678,7 @@ public:
 	 * Allocate memory for an object of type _TYPE_ from the well.
 	 * @return a pointer to the memory allocated from the well.
 	 */
-	_TYPE_ * alloc() { return static_cast<_TYPE_ *>(BaseWell::alloc()); }
+	_TYPE_ * alloc() { return static_cast<_TYPE_ *>(SafeBaseWell::alloc()); }
 
 	/**
 	 * Free memory for an object of type _TYPE_ back to the well.
@@ -385,6 +686,64 @@ public:
 	 */
 	void free(_TYPE_ * pointer) { SafeBaseWell::free(pointer); }
 
+};
+
+template <class _TYPE_, size_t _ALIGNMENT_ = sizeof(uint64_t)>
+/**
+ * This is a templated Well class for objects of type _TYPE_ that is
+ * thread-safe and in which each thread allocates from and frees to its own
+ * cache of magazines, only taking the mutex of the underlying well to trade
+ * whole magazines. It is otherwise used exactly like SafeWell.
+ */
+class CachedSafeWell : public CachedSafeBaseWell {
+
+public:
+
+	/**
+	 * Constructor.
+	 * See the SafeWell constructor for the meaning of the first five
+	 * parameters.
+	 * @param cc is the fixed number of items of type _TYPE_ in the well.
+	 * @param mm if true causes memory to be allocated during construction.
+	 * @param aa is the alignment of objects of type _TYPE_ in the well.
+	 * @param pp is the virtual page size of the underlying platform or zero.
+	 * @param ll is the cache line size of the underlying target or zero.
+	 * @param rr is the number of objects in each magazine or zero.
+	 * @param ee is the minimum number of objects per slab or zero if fixed.
+	 * @param hh is the number of free slabs kept or zero for the default.
+	 */
+	explicit CachedSafeWell(size_t cc = 0, bool mm = true, size_t aa = _ALIGNMENT_, size_t pp = 0, size_t ll = 0, size_t rr = 0, size_t ee = 0, size_t hh = 0)
+	: CachedSafeBaseWell(sizeof(_TYPE_), cc, mm, aa, pp, ll, rr, ee, hh)
+	{}
+
+	/**
+	 * Destructor.
+	 */
+	virtual ~CachedSafeWell() {}
+
+	using CachedSafeBaseWell::init;
+
+	/**
+	 * Allocate memory for the well.
+	 * @param cc is the count of objects of type _TYPE_ in the well.
+	 * @param aa is the alignment of objects of type _TYPE_ in the well.
+	 * @param pp is the virtual page size of the underlying platform or zero.
+	 * @param ll is the cache line size of the underlying target or zero.
+	 */
+	void init(size_t cc, size_t aa = _ALIGNMENT_, size_t pp = 0, size_t ll = 0) { CachedSafeBaseWell::init(sizeof(_TYPE_), cc, aa, pp, ll); }
+
+	/**
+	 * Allocate memory for an object of type _TYPE_ from the well.
+	 * @return a pointer to the memory allocated from the well.
+	 */
+	_TYPE_ * alloc() { return static_cast<_TYPE_ *>(CachedSafeBaseWell::alloc()); }
+
+	/**
+	 * Free memory for an object of type _TYPE_ back to the well.
+	 * @param pointer points to the memory to be freed.
+	 */
+	void free(_TYPE_ * pointer) { CachedSafeBaseWell::free(pointer); }
+
 };
 
   }
@@ -488,5 +847,52 @@ public:
  #define GRANDOTE_SAFEWELL_DEFINITION(_TYPE_, _CARDINALITY_) \
  	com::diag::grandote::SafeWell<_TYPE_> _TYPE_::com_diag_diminuto_well(_CARDINALITY_); \
  	GRANDOTE_WELL_OPERATOR_DEFINITIONS(_TYPE_)
+ 
+ /**
+  * @def GRANDOTE_ELASTICWELL_DEFINITION
+  * Intended to be used in the translation unit that defines the class @a _TYPE_
+  * and its well of initially @a _CARDINALITY_ objects of type _TYPE_, which
+  * grows by slabs of at least @a _INCREMENT_ objects when it runs dry. The
+  * class declaration uses GRANDOTE_WELL_DECLARATION. This form of well is NOT
+  * thread-safe.
+  */
+ #define GRANDOTE_ELASTICWELL_DEFINITION(_TYPE_, _CARDINALITY_, _INCREMENT_) \
+ 	com::diag::grandote::Well<_TYPE_> _TYPE_::com_diag_diminuto_well(_CARDINALITY_, true, sizeof(uint64_t), 0, 0, _INCREMENT_); \
+ 	GRANDOTE_WELL_OPERATOR_DEFINITIONS(_TYPE_)
+
+ /**
+  * @def GRANDOTE_ELASTICSAFEWELL_DEFINITION
+  * Intended to be used in the translation unit that defines the class @a _TYPE_
+  * and its well of initially @a _CARDINALITY_ objects of type _TYPE_, which
+  * grows by slabs of at least @a _INCREMENT_ objects when it runs dry. The
+  * class declaration uses GRANDOTE_SAFEWELL_DECLARATION. This form of well is
+  * thread-safe.
+  */
+ #define GRANDOTE_ELASTICSAFEWELL_DEFINITION(_TYPE_, _CARDINALITY_, _INCREMENT_) \
+ 	com::diag::grandote::SafeWell<_TYPE_> _TYPE_::com_diag_diminuto_well(_CARDINALITY_, true, sizeof(uint64_t), 0, 0, _INCREMENT_); \
+ 	GRANDOTE_WELL_OPERATOR_DEFINITIONS(_TYPE_)
+
+ /**
+  * @def GRANDOTE_CACHEDSAFEWELL_DECLARACTION
+  * Intended to be used inside the class declaration for the class @a _TYPE_.
+  * This is the same as GRANDOTE_SAFEWELL_DECLARATION except that each thread
+  * allocates from and frees to its own cache of magazines in front of the
+  * well. This form of well is thread-safe.
+  */
+ #define GRANDOTE_CACHEDSAFEWELL_DECLARATION(_TYPE_) \
+ 	static com::diag::grandote::CachedSafeWell<_TYPE_> com_diag_diminuto_well; \
+ 	GRANDOTE_WELL_OPERATOR_DECLARATIONS(_TYPE_)
+
+ /**
+  * @def GRANDOTE_CACHEDSAFEWELL_DEFINITION
+  * Intended to be used in the translation unit that defines the class @a _TYPE_
+  * and its well of @a _CARDINALITY_ objects of type _TYPE_. This is the same
+  * as GRANDOTE_SAFEWELL_DEFINITION except that each thread allocates from and
+  * frees to its own cache of magazines in front of the well. This form of
+  * well is thread-safe.
+  */
+ #define GRANDOTE_CACHEDSAFEWELL_DEFINITION(_TYPE_, _CARDINALITY_) \
+ 	com::diag::grandote::CachedSafeWell<_TYPE_> _TYPE_::com_diag_diminuto_well(_CARDINALITY_); \
+ 	GRANDOTE_WELL_OPERATOR_DEFINITIONS(_TYPE_)
 
 #endif
@@ -0,0 +1,424 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Implements the ArenaHeap class.
+ *
+ *  @see    ArenaHeap
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/errno.h"
+#include "com/diag/grandote/target.h"
+#include "com/diag/grandote/string.h"
+#include "com/diag/grandote/ArenaHeap.h"
+#include "com/diag/grandote/Print.h"
+#include "com/diag/grandote/Platform.h"
+
+
+namespace com { namespace diag { namespace grandote {
+
+
+//
+//  This is the size of the header at the front of each chunk in units
+//  of the alignment type.
+//
+static const size_t HEADER =
+    (sizeof(ArenaHeap::Alignment) + sizeof(void*) + sizeof(size_t) - 1) /
+    sizeof(ArenaHeap::Alignment);
+
+
+//
+//  This is the largest block that will even be attempted. It keeps the
+//  arithmetic on block and chunk sizes from overflowing.
+//
+static const size_t LARGEST = ~static_cast<size_t>(0) / 2;
+
+
+//
+//  Return the size of a block, including its header word, in units of
+//  the alignment type.
+//
+static inline size_t blockwords(size_t bytes) {
+    return ((bytes + sizeof(ArenaHeap::Alignment) - 1) /
+            sizeof(ArenaHeap::Alignment)) + 1;
+}
+
+
+//
+//  Return the size in bytes of the specified number of units of the
+//  alignment type.
+//
+static inline size_t blockbytes(size_t words) {
+    return words * sizeof(ArenaHeap::Alignment);
+}
+
+
+//
+//  Constructor.
+//
+ArenaHeap::ArenaHeap(size_t chunk, Output* po) :
+    Heap(po),
+    granularity((chunk + sizeof(Alignment) - 1) / sizeof(Alignment)),
+    chunks(0),
+    count(0),
+    cursor(0),
+    limit(0),
+    last(0)
+{
+}
+
+
+//
+//  Constructor.
+//
+ArenaHeap::ArenaHeap(size_t chunk, Output& ro) :
+    Heap(ro),
+    granularity((chunk + sizeof(Alignment) - 1) / sizeof(Alignment)),
+    chunks(0),
+    count(0),
+    cursor(0),
+    limit(0),
+    last(0)
+{
+}
+
+
+//
+//  Destructor.
+//
+ArenaHeap::~ArenaHeap() {
+    this->release();
+}
+
+
+//
+//  Allocate a chunk.
+//
+ArenaHeap::Chunk* ArenaHeap::allocate(size_t words) {
+    Chunk* cp;
+    try {
+        cp = reinterpret_cast<Chunk*>(new Alignment [HEADER + words]);
+    } catch (...) {
+        cp = 0;
+    }
+    if (0 != cp) {
+        cp->next = 0;
+        cp->words = words;
+        ++this->count;
+    }
+    return cp;
+}
+
+
+//
+//  Allocate a block of memory.
+//
+void* ArenaHeap::malloc(size_t size) {
+    if (this->tracing) {
+        Print tracef(this->output());
+        tracef("ArenaHeap[%p]::malloc(%lu)\n", this, size);
+    }
+
+    Alignment* nptr = 0;
+    size_t dimension = (LARGEST < size) ? 0 : blockwords(size);
+
+    if (0 == dimension) {
+        nptr = 0;
+    } else if (dimension <= static_cast<size_t>(this->limit - this->cursor)) {
+        nptr = this->cursor;
+        this->cursor += dimension;
+        this->last = nptr;
+    } else if (this->granularity < dimension) {
+        //  The block gets a chunk of its own. It goes behind the current
+        //  chunk so that what remains of the current chunk is still used.
+        Chunk* cp = this->allocate(dimension);
+        if (0 == cp) {
+            nptr = 0;
+        } else if (0 == this->chunks) {
+            this->chunks = cp;
+            nptr = reinterpret_cast<Alignment*>(cp) + HEADER;
+            this->cursor = nptr + dimension;
+            this->limit = this->cursor;
+            this->last = nptr;
+        } else {
+            cp->next = this->chunks->next;
+            this->chunks->next = cp;
+            nptr = reinterpret_cast<Alignment*>(cp) + HEADER;
+        }
+    } else {
+        Chunk* cp = this->allocate(this->granularity);
+        if (0 != cp) {
+            cp->next = this->chunks;
+            this->chunks = cp;
+            nptr = reinterpret_cast<Alignment*>(cp) + HEADER;
+            this->cursor = nptr + dimension;
+            this->limit = nptr + this->granularity;
+            this->last = nptr;
+        }
+    }
+
+    if (0 != nptr) {
+        *(nptr++) = size;
+        this->total += blockbytes(dimension);
+        this->current += blockbytes(dimension);
+        ++this->successes;
+    } else {
+        ++this->failures;
+    }
+
+    if (this->tracing) {
+        Print tracef(this->output());
+        tracef("ArenaHeap[%p]::malloc(%lu)=%p\n", this, size, nptr);
+    }
+
+    if (0 == nptr) {
+        errno = ENOMEM;
+    }
+
+    return nptr;
+}
+
+
+//
+//  Free a block of memory. Only the most recently allocated block
+//  is actually given back.
+//
+void ArenaHeap::free(void* ptr) {
+    if (this->tracing) {
+        Print tracef(this->output());
+        tracef("ArenaHeap[%p]::free(%p)\n", this, ptr);
+    }
+
+    Alignment* optr = static_cast<Alignment*>(ptr);
+
+    if (0 != optr) {
+        --optr;
+        this->current -= blockbytes(blockwords(*optr));
+        if (optr == this->last) {
+            this->cursor = optr;
+            this->last = 0;
+        }
+        ++this->frees;
+    } else {
+        ++this->nulls;
+    }
+
+}
+
+
+//
+//  Reallocate a block of memory.
+//
+//  We follow the same convention as Heap when both ptr is null and
+//  size is zero.
+//
+void* ArenaHeap::realloc(void* ptr, size_t size) {
+    if (this->tracing) {
+        Print tracef(this->output());
+        tracef("ArenaHeap[%p]::realloc(%p,%lu)\n", this, ptr, size);
+    }
+
+    void* nptr = 0;
+
+    if (0 == ptr) {
+        nptr = this->malloc(size);
+    } else if (0 == size) {
+        this->free(ptr);
+    } else if (LARGEST < size) {
+        nptr = 0;
+    } else {
+        Alignment* optr = static_cast<Alignment*>(ptr) - 1;
+        size_t osize = *optr;
+        size_t odimension = blockwords(osize);
+        size_t ndimension = blockwords(size);
+        if (ndimension <= odimension) {
+            //  The block shrinks in place.
+            *optr = size;
+            if (optr == this->last) {
+                this->cursor = optr + ndimension;
+            }
+            this->current -= blockbytes(odimension - ndimension);
+            nptr = ptr;
+        } else if ((optr == this->last) &&
+                   (ndimension <= static_cast<size_t>(this->limit - optr))) {
+            //  The block is the last in the current chunk and there is
+            //  room for it to grow in place.
+            *optr = size;
+            this->cursor = optr + ndimension;
+            this->total += blockbytes(ndimension - odimension);
+            this->current += blockbytes(ndimension - odimension);
+            nptr = ptr;
+        } else {
+            nptr = this->malloc(size);
+            if (0 != nptr) {
+                std::memcpy(nptr, ptr, (osize < size) ? osize : size);
+                this->free(ptr);
+            }
+        }
+    }
+
+    if (this->tracing) {
+        Print tracef(this->output());
+        tracef("ArenaHeap[%p]::realloc(%p,%lu)=%p\n", this, ptr, size, nptr);
+    }
+
+    if ((0 != size) && (0 == nptr)) {
+        errno = ENOMEM;
+    }
+
+    return nptr;
+}
+
+
+//
+//  Return the size of a previously allocated memory block.
+//
+size_t ArenaHeap::size(void* ptr) {
+    Alignment* optr = static_cast<Alignment*>(ptr);
+    size_t osize = 0;
+
+    if (0 != optr) {
+        osize = *(optr - 1);
+    }
+
+    if (this->tracing) {
+        Print tracef(this->output());
+        tracef("ArenaHeap[%p]::size(%p)=%lu\n", this, ptr, osize);
+    }
+
+    return osize;
+}
+
+
+//
+//  Drop all blocks, keeping one chunk of the default size.
+//
+void ArenaHeap::reset() {
+    if (this->tracing) {
+        Print tracef(this->output());
+        tracef("ArenaHeap[%p]::reset()\n", this);
+    }
+
+    Chunk* kept = 0;
+    Chunk* cp = this->chunks;
+
+    while (0 != cp) {
+        Chunk* np = cp->next;
+        if ((0 == kept) && (cp->words == this->granularity)) {
+            kept = cp;
+        } else {
+            delete [] reinterpret_cast<Alignment*>(cp);
+            --this->count;
+        }
+        cp = np;
+    }
+
+    if (0 != kept) {
+        kept->next = 0;
+        this->cursor = reinterpret_cast<Alignment*>(kept) + HEADER;
+        this->limit = this->cursor + this->granularity;
+    } else {
+        this->cursor = 0;
+        this->limit = 0;
+    }
+
+    this->chunks = kept;
+    this->last = 0;
+    this->current = 0;
+}
+
+
+//
+//  Drop all blocks and all chunks.
+//
+void ArenaHeap::release() {
+    if (this->tracing) {
+        Print tracef(this->output());
+        tracef("ArenaHeap[%p]::release()\n", this);
+    }
+
+    Chunk* cp = this->chunks;
+
+    while (0 != cp) {
+        Chunk* np = cp->next;
+        delete [] reinterpret_cast<Alignment*>(cp);
+        cp = np;
+    }
+
+    this->chunks = 0;
+    this->count = 0;
+    this->cursor = 0;
+    this->limit = 0;
+    this->last = 0;
+    this->current = 0;
+}
+
+
+//
+//  Show this object on the output object.
+//
+void ArenaHeap::show(int level, Output* display, int indent) const {
+    Platform& pl = Platform::instance();
+    Print printf(display);
+    const char* sp = printf.output().indentation(indent);
+    char component[sizeof(__FILE__)];
+    printf("%s%s(%p)[%lu]:\n",
+        sp, pl.component(__FILE__, component, sizeof(component)),
+        this, sizeof(*this));
+    this->Heap::show(level, display, indent + 1);
+    printf("%s granularity=%lu\n", sp, this->granularity);
+    printf("%s chunks=%p\n", sp, this->chunks);
+    printf("%s count=%lu\n", sp, this->count);
+    printf("%s cursor=%p\n", sp, this->cursor);
+    printf("%s limit=%p\n", sp, this->limit);
+    printf("%s last=%p\n", sp, this->last);
+}
+
+
+} } }
@@ -0,0 +1,153 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Implements the AtomicGcra class.
+ *
+ *  @see    AtomicGcra
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/AtomicGcra.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/Print.h"
+
+
+namespace com { namespace diag { namespace grandote {
+
+
+//
+//  Constructor.
+//
+AtomicGcra::AtomicGcra(ticks_t increment, ticks_t limit) :
+    tat(0),
+    i(increment),
+    l(limit),
+    max((increment == 0) ? intmaxof(ticks_t) : (intmaxof(ticks_t) / increment)),
+    approximate(false)
+{
+    this->reset(Platform::instance().time());
+}
+
+
+//
+//  Constructor.
+//
+AtomicGcra::AtomicGcra(ticks_t increment, ticks_t limit, ticks_t ticks) :
+    tat(0),
+    i(increment),
+    l(limit),
+    max((increment == 0) ? intmaxof(ticks_t) : (intmaxof(ticks_t) / increment)),
+    approximate(false)
+{
+    this->reset(ticks);
+}
+
+
+//
+//  Destructor.
+//
+AtomicGcra::~AtomicGcra() {
+}
+
+
+//
+//  Reset to the current time.
+//
+void AtomicGcra::reset() {
+    this->reset(this->time());
+}
+
+
+//
+//  Reset this throttle to its just constructed state, in which a request
+//  is immediately admissible.
+//
+void AtomicGcra::reset(ticks_t ticks) {
+    __atomic_store_n(&this->tat, Tat::reset(ticks), __ATOMIC_RELEASE);
+    __atomic_store_n(&this->approximate, false, __ATOMIC_RELAXED);
+}
+
+
+//
+//  Return the time.
+//
+ticks_t AtomicGcra::time() const {
+    return Platform::instance().time();
+}
+
+
+//
+//  Return the frequency.
+//
+ticks_t AtomicGcra::frequency() const {
+    return Platform::instance().frequency();
+}
+
+
+//
+//  Show this object on the output object.
+//
+void AtomicGcra::show(int /* level */, Output* display, int indent) const {
+    Platform& pl = Platform::instance();
+    Print printf(display);
+    const char* sp = printf.output().indentation(indent);
+    char component[sizeof(__FILE__)];
+    printf("%s%s(%p)[%lu]:\n",
+        sp, pl.component(__FILE__, component, sizeof(component)),
+        this, sizeof(*this));
+    printf("%s tat=%llu\n", sp, __atomic_load_n(&this->tat, __ATOMIC_ACQUIRE));
+    printf("%s i=%llu\n", sp, this->i);
+    printf("%s l=%llu\n", sp, this->l);
+    printf("%s max=%llu\n", sp, this->max);
+    printf("%s approximate=%d\n", sp, this->isApproximate());
+}
+
+
+} } }
@@ -0,0 +1,157 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Implements the GcraTable class.
+ *
+ *  @see    GcraTable
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/GcraTable.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/Print.h"
+
+
+namespace com { namespace diag { namespace grandote {
+
+
+//
+//  Constructor. Every flow starts with the contract of Gcra's default
+//  constructor.
+//
+GcraTable::GcraTable(size_t count) :
+    flows(count),
+    tat(new ticks_t[count]),
+    i(new ticks_t[count]),
+    l(new ticks_t[count]),
+    max(new ticks_t[count]),
+    approximate(new bool[count])
+{
+    for (size_t flow = 0; flow < this->flows; ++flow) {
+        this->i[flow] = 0;
+        this->l[flow] = intmaxof(ticks_t);
+        this->max[flow] = intmaxof(ticks_t);
+        this->reset(flow, 0);
+    }
+}
+
+
+//
+//  Destructor.
+//
+GcraTable::~GcraTable() {
+    delete [] this->approximate;
+    delete [] this->max;
+    delete [] this->l;
+    delete [] this->i;
+    delete [] this->tat;
+}
+
+
+//
+//  Configure a flow.
+//
+void GcraTable::configure(size_t flow, ticks_t increment, ticks_t limit, ticks_t ticks) {
+    this->i[flow] = increment;
+    this->l[flow] = limit;
+    if (increment == 0) {
+        this->max[flow] = intmaxof(ticks_t);
+    } else {
+        this->max[flow] = intmaxof(ticks_t) / increment;
+    }
+    this->reset(flow, ticks);
+}
+
+
+//
+//  Reset a flow.
+//
+void GcraTable::reset(size_t flow, ticks_t ticks) {
+    this->tat[flow] = Tat::reset(ticks);
+    this->approximate[flow] = false;
+}
+
+
+//
+//  Decide a batch of events in order.
+//
+size_t GcraTable::admit(const size_t which[], const size_t sizes[], size_t count, ticks_t ticks, bool verdicts[]) {
+    size_t admitted = 0;
+    for (size_t ii = 0; ii < count; ++ii) {
+        verdicts[ii] = this->admit(which[ii], sizes[ii], ticks);
+        admitted += verdicts[ii];
+    }
+    return admitted;
+}
+
+
+//
+//  Show this object on the output object.
+//
+void GcraTable::show(int level, Output* display, int indent) const {
+    Platform& pl = Platform::instance();
+    Print printf(display);
+    const char* sp = printf.output().indentation(indent);
+    char component[sizeof(__FILE__)];
+    printf("%s%s(%p)[%lu]:\n",
+        sp, pl.component(__FILE__, component, sizeof(component)),
+        this, sizeof(*this));
+    printf("%s flows=%zu\n", sp, this->flows);
+    if (level > 0) {
+        for (size_t flow = 0; flow < this->flows; ++flow) {
+            printf("%s  [%zu] tat=%llu i=%llu l=%llu max=%llu approximate=%d\n",
+                sp, flow, this->tat[flow], this->i[flow], this->l[flow],
+                this->max[flow], this->approximate[flow]);
+        }
+    }
+}
+
+
+} } }
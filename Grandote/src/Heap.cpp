@@ -54,12 +54,15 @@
 
 
 #include "com/diag/grandote/errno.h"
+#include "com/diag/grandote/generics.h"
 #include "com/diag/grandote/target.h"
 #include "com/diag/grandote/string.h"
 #include "com/diag/grandote/exceptions.h"
 #include "com/diag/grandote/Heap.h"
 #include "com/diag/grandote/Print.h"
 #include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/Well.h"
+#include <new>
 
 
 namespace com { namespace diag { namespace grandote {
@@ -76,19 +79,113 @@ inline size_t bytes(size_t words) {
 }
 
 
+//
+//  The header word in front of each block holds the size requested by
+//  the application in its low order bits and the size class from which
+//  the block was allocated, or zero if it was allocated with the new
+//  operator, in its high order byte.
+//
+static const unsigned int SHIFT = (sizeof(Heap::Alignment) - 1) * 8;
+
+static const Heap::Alignment MASK =
+    (static_cast<Heap::Alignment>(1) << SHIFT) - 1;
+
+
+//
+//  These are the sizes in bytes, including the header word, of the blocks
+//  in each size class. Each is a multiple of the quantum, and the last is
+//  the largest block allocated from a size class.
+//
+static const size_t QUANTUM = 16;
+
+static const size_t SLOTS[] = {
+    16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048
+};
+
+static const size_t LARGEST = 2048;
+
+
+//
+//  This maps a block size in quanta onto its size class (starting at one).
+//
+static unsigned char classifications[(LARGEST / QUANTUM) + 1];
+
+static bool classified = false;
+
+static void classification() {
+    size_t jj = 0;
+    for (size_t ii = 0; countof(classifications) > ii; ++ii) {
+        while (SLOTS[jj] < (ii * QUANTUM)) {
+            ++jj;
+        }
+        classifications[ii] = jj + 1;
+    }
+    classified = true;
+}
+
+
+//
+//  This is about how many bytes each slab of a size class well holds, and
+//  how many completely free slabs each size class keeps before releasing
+//  them. Keeping too few makes a size class thrash when a burst of blocks
+//  is allocated and then all freed. Every slab of every size class is
+//  exactly EXTENT bytes, which holds SLAB bytes of blocks plus the slab
+//  header, so the size class of a block is found from its address alone.
+//
+static const size_t SLAB = 16384;
+
+static const size_t EXTENT = SLAB * 2;
+
+static const size_t IDLE = 16;
+
+
+//
+//  A size class is an elastic well of blocks all of one size. A size class
+//  that still has blocks allocated when its heap is destroyed is orphaned,
+//  and is destroyed when the last of those blocks is freed.
+//
+class Heap::SizeClass : public BaseWell {
+
+public:
+
+    explicit SizeClass(size_t ss)
+    : BaseWell(ss, 0, false, sizeof(Heap::Alignment), EXTENT, 0, SLAB / ss, IDLE)
+    , orphaned(false)
+    {}
+
+    virtual ~SizeClass() {}
+
+    static SizeClass* owner(void* pointer) {
+        Slab* sp = reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(pointer) & ~static_cast<uintptr_t>(EXTENT - 1));
+        return static_cast<SizeClass*>(sp->well);
+    }
+
+    using BaseWell::alloc;
+
+    using BaseWell::free;
+
+    bool orphaned;
+
+};
+
+
 //
 //  Constructor.
 //
 Heap::Heap(Output* po) :
-    ou(po),
     tracing(false),
     total(0),
     current(0),
     successes(0),
     failures(0),
     frees(0),
-    nulls(0)
+    nulls(0),
+    ou(po),
+    segregating(false)
 {
+    for (size_t ii = 0; countof(this->classes) > ii; ++ii) {
+        this->classes[ii] = 0;
+    }
 }
 
 
@@ -96,22 +193,54 @@ Heap::Heap(Output* po) :
 //  Constructor.
 //
 Heap::Heap(Output& ro) :
-    ou(&ro),
     tracing(false),
     total(0),
     current(0),
     successes(0),
     failures(0),
     frees(0),
-    nulls(0)
+    nulls(0),
+    ou(&ro),
+    segregating(false)
 {
+    for (size_t ii = 0; countof(this->classes) > ii; ++ii) {
+        this->classes[ii] = 0;
+    }
 }
 
 
 //
-//  Destructor.
+//  Destructor. A size class with blocks still allocated is left alive.
 //
 Heap::~Heap() {
+    for (size_t ii = 0; countof(this->classes) > ii; ++ii) {
+        SizeClass* wp = this->classes[ii];
+        if (0 == wp) {
+            continue;
+        } else if (wp->isFull()) {
+            delete wp;
+        } else {
+            wp->orphaned = true;
+        }
+    }
+}
+
+
+//
+//  Return the size class of a block.
+//
+unsigned int Heap::classify(size_t size) const {
+    if (LARGEST < size) {
+        return 0;
+    }
+    size_t nsize = bytes(words(size));
+    if (LARGEST < nsize) {
+        return 0;
+    }
+    if (!classified) {
+        classification();
+    }
+    return classifications[(nsize + QUANTUM - 1) / QUANTUM];
 }
 
 
@@ -127,24 +256,38 @@ Output& Heap::output() const {
 //  Allocate a block of memory.
 //
 void* Heap::malloc(size_t size) {
-    Print tracef(this->output());
-
     if (this->tracing) {
+        Print tracef(this->output());
         tracef("Heap[%p]::malloc(%lu)\n", this, size);
     }
 
-    Alignment* nptr;
+    Alignment* nptr = 0;
     size_t dimension = words(size);
-
-    try {
-        nptr = new Alignment [dimension];
-    } catch (...) {
+    size_t nsize = bytes(dimension);
+    unsigned int nclass = this->segregating ? this->classify(size) : 0;
+
+    if (0 < nclass) {
+        SizeClass* wp = this->classes[nclass - 1];
+        if (0 == wp) {
+            wp = new(std::nothrow) SizeClass(SLOTS[nclass - 1]);
+            this->classes[nclass - 1] = wp;
+        }
+        if (0 != wp) {
+            nptr = static_cast<Alignment*>(wp->alloc());
+            nsize = SLOTS[nclass - 1];
+        }
+    } else if (MASK < size) {
         nptr = 0;
+    } else {
+        try {
+            nptr = new Alignment [dimension];
+        } catch (...) {
+            nptr = 0;
+        }
     }
 
     if (0 != nptr) {
-        *(nptr++) = size;
-        size_t nsize = bytes(dimension);
+        *(nptr++) = size | (static_cast<Alignment>(nclass) << SHIFT);
         this->total += nsize;
         this->current += nsize;
         ++this->successes;
@@ -153,6 +296,7 @@ void* Heap::malloc(size_t size) {
     }
 
     if (this->tracing) {
+        Print tracef(this->output());
         tracef("Heap[%p]::malloc(%lu)=%p\n", this, size, nptr);
     }
 
@@ -168,19 +312,27 @@ void* Heap::malloc(size_t size) {
 //  Free a block of memory.
 //
 void Heap::free(void* ptr) {
-    Print tracef(this->output());
-
     if (this->tracing) {
+        Print tracef(this->output());
         tracef("Heap[%p]::free(%p)\n", this, ptr);
     }
 
     Alignment* optr = static_cast<Alignment*>(ptr);
 
     if (0 != optr) {
-        size_t osize = *(--optr);
-        size_t nsize = bytes(words(osize));
-        this->current -= nsize;
-        delete [] optr;
+        Alignment header = *(--optr);
+        unsigned int oclass = header >> SHIFT;
+        if (0 < oclass) {
+            this->current -= SLOTS[oclass - 1];
+            SizeClass* wp = SizeClass::owner(optr);
+            wp->free(optr);
+            if (wp->orphaned && wp->isFull()) {
+                delete wp;
+            }
+        } else {
+            this->current -= bytes(words(header & MASK));
+            delete [] optr;
+        }
         ++this->frees;
     } else {
         ++this->nulls;
@@ -197,9 +349,8 @@ void Heap::free(void* ptr) {
 //  to act as if ptr is null and size is not zero.
 //
 void* Heap::realloc(void* ptr, size_t size) {
-    Print tracef(this->output());
-
     if (this->tracing) {
+        Print tracef(this->output());
         tracef("Heap[%p]::realloc(%p,%lu)\n", this, ptr, size);
     }
 
@@ -210,19 +361,27 @@ void* Heap::realloc(void* ptr, size_t size) {
     } else if (0 == size) {
         this->free(ptr);
     } else {
-        size_t osize = this->size(ptr);
-        if (osize != size) {
+        Alignment* optr = static_cast<Alignment*>(ptr) - 1;
+        size_t osize = *optr & MASK;
+        unsigned int oclass = *optr >> SHIFT;
+        if (osize == size) {
+            nptr = ptr;
+        } else if ((0 < oclass) && this->segregating &&
+                   (this->classify(size) == oclass)) {
+            //  The block's size class has room: resize it in place.
+            *optr = size | (static_cast<Alignment>(oclass) << SHIFT);
+            nptr = ptr;
+        } else {
             nptr = this->malloc(size);
             if (0 != nptr) {
                 std::memcpy(nptr, ptr, (osize < size) ? osize : size);
                 this->free(ptr);
             }
-        } else {
-            nptr = ptr;
         }
    }
 
     if (this->tracing) {
+        Print tracef(this->output());
         tracef("Heap[%p]::realloc(%p,%lu)=%p\n", this, ptr, size, nptr);
     }
 
@@ -238,9 +397,8 @@ void* Heap::realloc(void* ptr, size_t size) {
 //  Allocate an array and zero it out.
 //
 void* Heap::calloc(size_t nmemb, size_t size) {
-    Print tracef(this->output());
-
     if (this->tracing) {
+        Print tracef(this->output());
         tracef("Heap[%p]::calloc(%lu,%lu)\n", this, nmemb, size);
     }
 
@@ -252,6 +410,7 @@ void* Heap::calloc(size_t nmemb, size_t size) {
     }
 
     if (this->tracing) {
+        Print tracef(this->output());
         tracef("Heap[%p]::calloc(%lu,%lu)=%zx\n", this, nmemb, size, nptr);
     }
 
@@ -267,9 +426,8 @@ void* Heap::calloc(size_t nmemb, size_t size) {
 //  Return the size of a previously allocated memory block.
 //
 size_t Heap::size(void* ptr) {
-    Print tracef(this->output());
-
     if (this->tracing) {
+        Print tracef(this->output());
         tracef("Heap[%o]::size(%p)\n", this, ptr);
     }
 
@@ -277,10 +435,11 @@ size_t Heap::size(void* ptr) {
     size_t osize = 0;
 
     if (0 != optr) {
-        osize = *(optr - 1);
+        osize = *(optr - 1) & MASK;
     }
 
     if (this->tracing) {
+        Print tracef(this->output());
         tracef("Heap[%p]::size(%p)=%lu\n", this, ptr, osize);
     }
 
@@ -304,6 +463,13 @@ void Heap::show(int level, Output* display, int indent) const {
         this->ou->show(level, display, indent + 2);
     }
     printf("%s tracing=%d\n", sp, this->tracing);
+    printf("%s segregating=%d\n", sp, this->segregating);
+    for (size_t ii = 0; countof(this->classes) > ii; ++ii) {
+        if (0 != this->classes[ii]) {
+            printf("%s classes[%u]=%p[%u]\n",
+                sp, ii, this->classes[ii], SLOTS[ii]);
+        }
+    }
     printf("%s total=%u\n", sp, this->total);
     printf("%s current=%u\n", sp, this->current);
     printf("%s successes=%u\n", sp, this->successes);
@@ -95,6 +95,19 @@ static LeapSeconds leapsecondsrule;     // Used as the leap second rule.
 static char hostnamebuffer[64];     	// Used for gethostname().
 
 
+//
+//  Return the clock_gettime(2) clock for a monotonic Linux clock.
+//
+static clockid_t monotonic(Linux::Clock clock) {
+#if defined(CLOCK_MONOTONIC_COARSE)
+    if (clock == Linux::COARSE) {
+        return CLOCK_MONOTONIC_COARSE;
+    }
+#endif
+    return CLOCK_MONOTONIC;
+}
+
+
 static char* hostname() {
     int rc = ::gethostname(hostnamebuffer, sizeof(hostnamebuffer));
     if (0 != rc) {
@@ -114,6 +127,8 @@ static char* hostname() {
 //
 Linux::Linux() :
     Platform(),
+    clock(REALTIME),
+    offset(0),
     inputs(stdin),
     outputs(stdout),
     errors(stderr),
@@ -211,28 +226,70 @@ const char* Linux::host() {
 //  Return the resolution of the Linux clock in ticks per second as a ratio.
 //
 void Linux::frequency(ticks_t& numerator, ticks_t& denominator) {
-    numerator = Constant::us_per_s;
+    numerator = (this->clock == REALTIME) ? Constant::us_per_s : Constant::ns_per_s;
     denominator = 1;
 }
 
 
 //
-//  Return the time of day in ticks since the epoch.
+//  Return the time of day in ticks since the epoch. The monotonic clocks
+//  are always in nanosecond ticks, so they need not consult the frequency.
 //
 ticks_t Linux::time() {
-    const ticks_t ticks_per_s = this->frequency();
-    struct timeval time;
     ticks_t ticks = 0;
 
-    if (0 <= ::gettimeofday(&time, 0)) {
-        ticks = time.tv_sec * ticks_per_s;
-        ticks += (time.tv_usec * ticks_per_s) / Constant::us_per_s;
+    if (this->clock == REALTIME) {
+        const ticks_t ticks_per_s = this->frequency();
+        struct timeval time;
+        if (0 <= ::gettimeofday(&time, 0)) {
+            ticks = time.tv_sec * ticks_per_s;
+            ticks += (time.tv_usec * ticks_per_s) / Constant::us_per_s;
+        }
+    } else {
+        struct timespec time;
+        if (0 <= ::clock_gettime(monotonic(this->clock), &time)) {
+            ticks = time.tv_sec;
+            ticks *= Constant::ns_per_s;
+            ticks += time.tv_nsec;
+            ticks += this->offset;
+        }
     }
 
     return ticks;
 }
 
 
+//
+//  Select the clock. A monotonic clock is anchored to the time of day
+//  by reading both as close together as possible. The birthdate is moved
+//  so that the elapsed time, converted to the new frequency, continues.
+//
+void Linux::setClock(Clock clock) {
+    const ticks_t was = this->frequency();
+    const ticks_t elapsed = this->elapsed();
+
+    this->clock = clock;
+    this->offset = 0;
+
+    if (this->clock != REALTIME) {
+        struct timespec realtime;
+        struct timespec time;
+        if ((0 <= ::clock_gettime(CLOCK_REALTIME, &realtime)) && (0 <= ::clock_gettime(monotonic(this->clock), &time))) {
+            ticks_t then = realtime.tv_sec;
+            then *= Constant::ns_per_s;
+            then += realtime.tv_nsec;
+            ticks_t now = time.tv_sec;
+            now *= Constant::ns_per_s;
+            now += time.tv_nsec;
+            this->offset = then - now;
+        }
+    }
+
+    const ticks_t hz = this->frequency();
+    this->birthdate = this->time() - (((elapsed / was) * hz) + (((elapsed % was) * hz) / was));
+}
+
+
 //
 //  Return the elapsed time in ticks since construction.
 //
@@ -531,6 +588,8 @@ void Linux::show(int level, Output* display, int indent) const {
         this, sizeof(*this));
     this->Platform::show(level, display, indent + 1);
     printf("%s birthdate=%llu\n", sp, this->birthdate);
+    printf("%s clock=%d\n", sp, this->clock);
+    printf("%s offset=%llu\n", sp, this->offset);
     printf("%s inputs:\n", sp);
     this->inputs.show(level, display, indent + 2);
     printf("%s outputs:\n", sp);
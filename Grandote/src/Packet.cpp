@@ -10,6 +10,8 @@
 #include <new>
 #include <cstdio>
 #include <cstring>
+#include <limits.h>
+#include <sys/uio.h>
 #include "com/diag/grandote/Packet.h"
 #include "com/diag/grandote/Platform.h"
 #include "com/diag/grandote/Print.h"
@@ -20,12 +22,18 @@ namespace com {
 namespace diag {
 namespace grandote {
 
+#if defined(IOV_MAX)
+static const size_t GATHER = IOV_MAX;
+#else
+static const size_t GATHER = 16; // _XOPEN_IOV_MAX
+#endif
+
 /*******************************************************************************
  * PacketData
  ******************************************************************************/
 
 size_t PacketData::append(const void * data, size_t length) {
-	size_t available = (tail == 0) ? extent : payload + extent - tail;
+	size_t available = suffix();
 	size_t actual = (available > length) ? length : available;
 	if (actual > 0) {
 		Datum * pointer;
@@ -43,7 +51,7 @@ size_t PacketData::append(const void * data, size_t length) {
 }
 
 size_t PacketData::prepend(const void * data, size_t length) {
-	size_t available = (head == 0) ? extent : head - payload;
+	size_t available = prefix();
 	size_t actual = (available > length) ? length : available;
 	if (actual > 0) {
 		Datum * pointer;
@@ -78,48 +86,187 @@ size_t PacketData::consume(void * buffer, size_t length) {
 	return actual;
 }
 
+size_t PacketData::commit(size_t length) {
+	size_t available = suffix();
+	size_t actual = (available > length) ? length : available;
+	if (actual > 0) {
+		if (tail == 0) {
+			head = payload;
+			tail = payload;
+		}
+		tail += actual;
+	}
+	return actual;
+}
+
+/*******************************************************************************
+ * PacketDataShared
+ ******************************************************************************/
+
+PacketDataShared::PacketDataShared(PacketData & rd)
+: PacketData(const_cast<void *>(rd.buffer()), rd.length(), APPEND, true)
+, reference(new Reference)
+{
+	reference->data = &rd;
+	reference->count = 1;
+}
+
+PacketDataShared::PacketDataShared(Reference * rp, const void * dp, size_t ve)
+: PacketData(const_cast<void *>(dp), ve, APPEND, true)
+, reference(rp)
+{}
+
+PacketDataShared::~PacketDataShared() {
+	if (__sync_sub_and_fetch(&(reference->count), 1) == 0) {
+		delete reference->data;
+		delete reference;
+	}
+}
+
+PacketDataShared * PacketDataShared::share() const {
+	__sync_add_and_fetch(&(reference->count), 1);
+	return new PacketDataShared(reference, buffer(), length());
+}
+
+/*******************************************************************************
+ * PacketBufferPooled
+ ******************************************************************************/
+
+void PacketBufferPooled::operator delete(void * ptr) {
+	PacketPool::Node * np = static_cast<PacketPool::Node*>(ptr) - 1;
+	np->pool->put(np);
+}
+
+/*******************************************************************************
+ * PacketPool
+ ******************************************************************************/
+
+PacketPool::~PacketPool() {
+	Node * here;
+	while (cache != 0) {
+		here = cache;
+		cache = here->next;
+		::operator delete(here);
+	}
+	cached = 0;
+}
+
+PacketBufferPooled * PacketPool::get(size_t vf) {
+	Node * np;
+	if (cache != 0) {
+		np = cache;
+		cache = np->next;
+		--cached;
+		++hits;
+	} else {
+		np = static_cast<Node*>(::operator new(sizeof(Node) + sizeof(PacketBufferPooled) + allocation));
+		np->pool = this;
+		++misses;
+	}
+	np->next = 0;
+	void * here = np + 1;
+	PacketBufferPooled::Datum * data = static_cast<PacketBufferPooled::Datum*>(here) + sizeof(PacketBufferPooled);
+	return new (here) PacketBufferPooled(data, allocation, vf);
+}
+
+void PacketPool::put(Node * np) {
+	if (cached < limit) {
+		np->next = cache;
+		cache = np;
+		++cached;
+		++recycles;
+	} else {
+		::operator delete(np);
+		++releases;
+	}
+}
+
+void PacketPool::show(int /* level */, Output * display, int indent) const {
+    Platform& pl = Platform::instance();
+    Print printf(display);
+    const char* sp = printf.output().indentation(indent);
+    char component[sizeof(__FILE__)];
+    printf("%s%s(%p)[%lu]:\n",
+        sp, pl.component(__FILE__, component, sizeof(component)),
+        this, sizeof(*this));
+    printf("%s allocation=%zu\n", sp, allocation);
+    printf("%s limit=%zu\n", sp, limit);
+    printf("%s cache=%p\n", sp, cache);
+    printf("%s cached=%zu\n", sp, cached);
+    printf("%s hits=%zu\n", sp, hits);
+    printf("%s misses=%zu\n", sp, misses);
+    printf("%s recycles=%zu\n", sp, recycles);
+    printf("%s releases=%zu\n", sp, releases);
+}
+
 /*******************************************************************************
  * Packet
  ******************************************************************************/
 
-void Packet::clear() {
-	PacketData * here;
-	while (head != 0) {
-		here = head;
-		head = here->next;
-		delete here;
+PacketBuffer & Packet::buffer(size_t vf) {
+	if (pool != 0) {
+		return *(pool->get(vf));
+	} else {
+		return *(new PacketBufferDynamic(allocation, vf));
 	}
-	tail = 0;
 }
 
-void Packet::append(PacketData & rd) {
-	rd.next = 0;
-	if (tail == 0) {
+void Packet::link(PacketData & rd, bool front) {
+	if (front) {
+		rd.next = head;
+		if (head == 0) {
+			tail = &rd;
+		}
 		head = &rd;
-		tail = &rd;
 	} else {
-		tail->next = &rd;
+		rd.next = 0;
+		if (tail == 0) {
+			head = &rd;
+		} else {
+			tail->next = &rd;
+		}
 		tail = &rd;
 	}
+	octets += rd.length();
+	++count;
 }
 
-void Packet::prepend(PacketData & rd) {
-	rd.next = head;
+void Packet::drop() {
+	PacketData * here = head;
+	head = here->next;
+	octets -= here->length();
+	--count;
+	delete here;
 	if (head == 0) {
-		head = &rd;
-		tail = &rd;
-	} else {
-		head = &rd;
+		tail = 0;
+		octets = 0;
+		exact = true;
+	}
+}
+
+void Packet::clear() {
+	while (head != 0) {
+		drop();
 	}
 }
 
+void Packet::append(PacketData & rd) {
+	link(rd, false);
+	exact = false;
+}
+
+void Packet::prepend(PacketData & rd) {
+	link(rd, true);
+	exact = false;
+}
+
 size_t Packet::append(const void * data, size_t length) {
 	size_t total = 0;
 	size_t appended;
 	if (tail == 0) {
-		append(*(new PacketBufferDynamic(allocation, fraction)));
+		link(buffer(fraction), false);
 	} else if (tail->suffix() == 0) {
-		append(*(new PacketBufferDynamic(allocation, PacketBufferDynamic::APPEND)));
+		link(buffer(PacketBufferDynamic::APPEND), false);
 	}
 	const PacketData::Datum * datap = static_cast<const PacketData::Datum*>(data);
 	while (length > 0) {
@@ -130,9 +277,10 @@ size_t Packet::append(const void * data, size_t length) {
 			length -= appended;
 		}
 		if (length > 0) {
-			append(*(new PacketBufferDynamic(allocation, PacketBufferDynamic::APPEND)));
+			link(buffer(PacketBufferDynamic::APPEND), false);
 		}
 	}
+	octets += total;
 	return total;
 }
 
@@ -142,9 +290,9 @@ size_t Packet::prepend(const void * data, size_t length) {
 	size_t prefix;
 	size_t actual;
 	if (head == 0) {
-		prepend(*(new PacketBufferDynamic(allocation, fraction)));
+		link(buffer(fraction), true);
 	} else if (head->prefix() <= 0) {
-		prepend(*(new PacketBufferDynamic(allocation, PacketBufferDynamic::PREPEND)));
+		link(buffer(PacketBufferDynamic::PREPEND), true);
 	}
 	// Complicated by the fact that we have to work backwards.
 	const PacketData::Datum * datap = static_cast<const PacketData::Datum*>(data) + length;
@@ -160,16 +308,16 @@ size_t Packet::prepend(const void * data, size_t length) {
 			length -= prepended;
 		}
 		if (length > 0) {
-			prepend(*(new PacketBufferDynamic(allocation, PacketBufferDynamic::PREPEND)));
+			link(buffer(PacketBufferDynamic::PREPEND), true);
 		}
 	}
+	octets += total;
 	return total;
 }
 
 size_t Packet::consume(void * buffer, size_t length) {
 	size_t total = 0;
 	size_t consumed;
-	PacketData * here;
 	PacketData::Datum * bufferp = static_cast<PacketData::Datum*>(buffer);
 	while ((head != 0) && (length > 0)) {
 		consumed = head->consume(bufferp, length);
@@ -178,24 +326,136 @@ size_t Packet::consume(void * buffer, size_t length) {
 			total += consumed;
 			length -= consumed;
 		}
+		octets -= consumed;
 		if ((consumed <= 0) || head->empty()) {
-			here = head;
-			head = here->next;
-			delete here;
-			if (head == 0) {
-				tail = 0;
+			drop();
+		}
+	}
+	return total;
+}
+
+size_t Packet::consume(void * buffer, size_t length, int delimiter) {
+	size_t total = 0;
+	size_t available;
+	size_t consumed;
+	const PacketData::Datum * data;
+	const void * found;
+	PacketData::Datum * bufferp = static_cast<PacketData::Datum*>(buffer);
+	while ((head != 0) && (length > 0)) {
+		found = 0;
+		available = head->length();
+		if (available > length) {
+			available = length;
+		}
+		data = static_cast<const PacketData::Datum*>(head->buffer());
+		if (available > 0) {
+			found = std::memchr(data, delimiter, available);
+			if (found != 0) {
+				available = static_cast<const PacketData::Datum*>(found) - data + 1;
+			}
+		}
+		consumed = head->consume(bufferp, available);
+		if (consumed > 0) {
+			if (bufferp != 0) { bufferp += consumed; }
+			total += consumed;
+			length -= consumed;
+		}
+		octets -= consumed;
+		if ((consumed <= 0) || head->empty()) {
+			drop();
+		}
+		if (found != 0) {
+			break;
+		}
+	}
+	return total;
+}
+
+const void * Packet::peek(int delimiter, size_t & length) const {
+	const void * data = 0;
+	const void * found;
+	length = 0;
+	for (PacketData * here = head; here != 0; here = here->next) {
+		if (here->length() > 0) {
+			found = std::memchr(here->buffer(), delimiter, here->length());
+			if (found != 0) {
+				data = here->buffer();
+				length = static_cast<const PacketData::Datum*>(found) - static_cast<const PacketData::Datum*>(data) + 1;
+			}
+			break;
+		}
+	}
+	return data;
+}
+
+size_t Packet::share(Packet & that) {
+	size_t total = 0;
+	PacketData * prior = 0;
+	PacketData * here = head;
+	PacketDataShared * view;
+	if (&that == this) {
+		return total;
+	}
+	while (here != 0) {
+		if (here->length() > 0) {
+			view = here->shared();
+			if (view == 0) {
+				view = new PacketDataShared(*here);
+				view->next = here->next;
+				if (prior == 0) {
+					head = view;
+				} else {
+					prior->next = view;
+				}
+				if (tail == here) {
+					tail = view;
+				}
+				here->next = 0;
+				here = view;
 			}
+			that.link(*(view->share()), false);
+			total += view->length();
 		}
+		prior = here;
+		here = here->next;
 	}
 	return total;
 }
 
+Packet * Packet::clone() {
+	Packet * packet = (pool != 0) ? new Packet(*pool, fraction) : new Packet(allocation, fraction);
+	share(*packet);
+	return packet;
+}
+
 size_t Packet::source(Input& from) {
 	size_t total = 0;
 	size_t subtotal;
 	ssize_t produced;
 	PacketData::Datum * data;
 	PacketDataDynamic * pbd;
+	if (pool != 0) {
+		// Read directly into pooled buffers so their storage is recycled.
+		PacketBufferPooled * pbp;
+		do {
+			pbp = pool->get(PacketBufferPooled::APPEND);
+			subtotal = 0;
+			do {
+				produced = from(pbp->reserve(), 1, pbp->suffix());
+				if (produced <= 0) {
+					break;
+				}
+				subtotal += pbp->commit(produced);
+			} while (pbp->suffix() > 0);
+			if (subtotal > 0) {
+				link(*pbp, false);
+				total += subtotal;
+			} else {
+				delete pbp;
+			}
+		} while (produced > 0);
+		return total;
+	}
 	do {
 		data = new PacketData::Datum [allocation];
 		subtotal = 0;
@@ -208,10 +468,10 @@ size_t Packet::source(Input& from) {
 		} while (subtotal < allocation);
 		if (subtotal > 0) {
 			pbd = new PacketDataDynamic(data, subtotal, PacketDataDynamic::APPEND);
-			append(*pbd);
+			link(*pbd, false);
 			total += subtotal;
 		} else {
-			delete data;
+			delete [] data;
 		}
 	} while (produced > 0);
 	return total;
@@ -223,7 +483,6 @@ size_t Packet::sink(Output& to) {
 	ssize_t consumed;
 	size_t produced;
 	const PacketData::Datum * data;
-	PacketData * here;
 	while (head != 0) {
 		data = static_cast<const PacketData::Datum*>(head->buffer());
 		produced = head->length();
@@ -236,17 +495,185 @@ size_t Packet::sink(Output& to) {
 			subtotal += consumed;
 		}
 		total += subtotal;
-		here = head;
-		head = here->next;
-		delete here;
-		if (head == 0) {
-			tail = 0;
+		drop();
+	}
+	return total;
+}
+
+size_t Packet::source(int fd) {
+	size_t total = 0;
+	struct iovec vector[SCATTER + 1];
+	PacketBuffer * reserved[SCATTER];
+	size_t spare = 0;
+	PacketData * last;
+	ssize_t produced;
+	size_t slots;
+	size_t used;
+	size_t remaining;
+	size_t committed;
+	do {
+		slots = 0;
+		last = ((tail != 0) && (tail->suffix() > 0)) ? tail : 0;
+		if (last != 0) {
+			vector[slots].iov_base = last->reserve();
+			vector[slots].iov_len = last->suffix();
+			++slots;
+		}
+		for (; spare < SCATTER; ++spare) {
+			reserved[spare] = &buffer(PacketBuffer::APPEND);
+		}
+		for (size_t ii = 0; ii < SCATTER; ++ii) {
+			vector[slots].iov_base = reserved[ii]->reserve();
+			vector[slots].iov_len = reserved[ii]->suffix();
+			++slots;
+		}
+		do {
+			produced = ::readv(fd, vector, slots);
+		} while ((produced < 0) && (errno == EINTR));
+		remaining = (produced > 0) ? produced : 0;
+		total += remaining;
+		if (last != 0) {
+			committed = last->commit(remaining);
+			octets += committed;
+			remaining -= committed;
+		}
+		// Buffers are filled in order, so the unused ones carried into the
+		// next pass are those after the last one that received data.
+		for (used = 0; (used < SCATTER) && (remaining > 0); ++used) {
+			remaining -= reserved[used]->commit(remaining);
+			link(*reserved[used], false);
+		}
+		for (size_t ii = used; ii < SCATTER; ++ii) {
+			reserved[ii - used] = reserved[ii];
+		}
+		spare = SCATTER - used;
+	} while (produced > 0);
+	for (size_t ii = 0; ii < spare; ++ii) {
+		delete reserved[ii];
+	}
+	return total;
+}
+
+size_t Packet::sink(int fd) {
+	size_t total = 0;
+	struct iovec vector[GATHER];
+	ssize_t consumed;
+	size_t slots;
+	size_t length;
+	while (head != 0) {
+		slots = 0;
+		for (PacketData * here = head; (here != 0) && (slots < countof(vector)); here = here->next) {
+			length = here->length();
+			if (length > 0) {
+				vector[slots].iov_base = const_cast<void *>(here->buffer());
+				vector[slots].iov_len = length;
+				++slots;
+			}
+		}
+		if (slots == 0) {
+			clear();
+			break;
+		}
+		consumed = ::writev(fd, vector, slots);
+		if (consumed > 0) {
+			total += consume(consumed);
+		} else if ((consumed < 0) && (errno == EINTR)) {
+			continue;
+		} else {
+			break;
 		}
 	}
 	return total;
 }
 
+void * Packet::reserve(size_t & length) {
+	if ((tail == 0) || (tail->suffix() == 0)) {
+		link(buffer((tail == 0) ? fraction : PacketBuffer::APPEND), false);
+	}
+	length = tail->suffix();
+	return tail->reserve();
+}
+
+size_t Packet::commit(size_t length) {
+	size_t committed = 0;
+	if (tail != 0) {
+		committed = tail->commit(length);
+		octets += committed;
+	}
+	return committed;
+}
+
+size_t Packet::compact() {
+	size_t merged = 0;
+	PacketData * prior = 0;
+	PacketData * here = head;
+	PacketData * next;
+	while (here != 0) {
+		next = here->next;
+		if (here->length() == 0) {
+			// Discard an empty object.
+			if (prior == 0) {
+				head = next;
+			} else {
+				prior->next = next;
+			}
+			if (tail == here) {
+				tail = prior;
+			}
+			--count;
+			delete here;
+			++merged;
+			here = next;
+		} else if (next == 0) {
+			break;
+		} else if (next->length() <= here->suffix()) {
+			// Merge the next object into the space at the end of this one.
+			here->append(next->buffer(), next->length());
+			here->next = next->next;
+			if (tail == next) {
+				tail = here;
+			}
+			--count;
+			delete next;
+			++merged;
+		} else if ((here->length() + next->length()) <= allocation) {
+			// Copy this object into a new buffer with room for the next one.
+			PacketBuffer & rb = buffer(PacketBuffer::APPEND);
+			rb.append(here->buffer(), here->length());
+			rb.next = next;
+			if (prior == 0) {
+				head = &rb;
+			} else {
+				prior->next = &rb;
+			}
+			delete here;
+			here = &rb;
+		} else {
+			prior = here;
+			here = next;
+		}
+	}
+	return merged;
+}
+
+const void * Packet::linearize() {
+	if (head == 0) {
+		return 0;
+	}
+	if (head == tail) {
+		return head->buffer();
+	}
+	size_t total = length();
+	PacketBuffer & rb = (total <= allocation) ? buffer(PacketBuffer::APPEND) : *(new PacketBufferDynamic(total, PacketBuffer::APPEND));
+	rb.commit(consume(rb.reserve(), total));
+	link(rb, false);
+	return rb.buffer();
+}
+
 size_t Packet::length() const {
+	if (exact) {
+		return octets;
+	}
 	size_t total = 0;
 	for (PacketData * here = head; here != 0; here = here->next) {
 		total += here->length();
@@ -265,7 +692,14 @@ void Packet::show(int level, Output * display, int indent) const {
         this, sizeof(*this));
     com::diag::grandote::InputOutput::show(level, display, indent + 1);
     printf("%s allocation=%zu\n", sp, allocation);
+    printf("%s pool=%p\n", sp, pool);
+    if (pool != 0) {
+        pool->show(level, display, indent + 2);
+    }
     printf("%s head=%p\n", sp, head);
+    printf("%s octets=%zu\n", sp, octets);
+    printf("%s count=%zu\n", sp, count);
+    printf("%s exact=%d\n", sp, exact);
     if (0 < level) {
 		for (PacketData * here = head; here != 0; here = here->next) {
 			size_t size = here->size();
@@ -285,6 +719,100 @@ void Packet::show(int level, Output * display, int indent) const {
 	out.show(level, display, indent + 2);
 }
 
+/*******************************************************************************
+ * PacketCursor
+ ******************************************************************************/
+
+void PacketCursor::skip() {
+	while ((here != 0) && (offset >= here->length())) {
+		here = here->next;
+		offset = 0;
+	}
+}
+
+void PacketCursor::rewind() {
+	here = packet->head;
+	offset = 0;
+	position = 0;
+	skip();
+}
+
+const void * PacketCursor::span(size_t & length) const {
+	if (here == 0) {
+		length = 0;
+		return 0;
+	} else {
+		length = here->length() - offset;
+		return static_cast<const PacketData::Datum*>(here->buffer()) + offset;
+	}
+}
+
+size_t PacketCursor::advance(size_t length) {
+	size_t total = 0;
+	size_t available;
+	while ((here != 0) && (length > 0)) {
+		available = here->length() - offset;
+		if (length < available) {
+			available = length;
+		}
+		offset += available;
+		total += available;
+		length -= available;
+		skip();
+	}
+	position += total;
+	return total;
+}
+
+size_t PacketCursor::seek(size_t where) {
+	if (where < position) {
+		rewind();
+	}
+	advance(where - position);
+	return position;
+}
+
+size_t PacketCursor::peek(void * buffer, size_t length) const {
+	PacketCursor cursor(*this);
+	return cursor.read(buffer, length);
+}
+
+size_t PacketCursor::read(void * buffer, size_t length) {
+	size_t total = 0;
+	size_t available;
+	const void * data;
+	PacketData::Datum * bufferp = static_cast<PacketData::Datum*>(buffer);
+	while (length > 0) {
+		data = span(available);
+		if (data == 0) {
+			break;
+		}
+		if (length < available) {
+			available = length;
+		}
+		std::memcpy(bufferp, data, available);
+		bufferp += available;
+		total += available;
+		length -= available;
+		advance(available);
+	}
+	return total;
+}
+
+void PacketCursor::show(int /* level */, Output * display, int indent) const {
+    Platform& pl = Platform::instance();
+    Print printf(display);
+    const char* sp = printf.output().indentation(indent);
+    char component[sizeof(__FILE__)];
+    printf("%s%s(%p)[%lu]:\n",
+        sp, pl.component(__FILE__, component, sizeof(component)),
+        this, sizeof(*this));
+    printf("%s packet=%p\n", sp, packet);
+    printf("%s here=%p\n", sp, here);
+    printf("%s offset=%zu\n", sp, offset);
+    printf("%s position=%zu\n", sp, position);
+}
+
 /*******************************************************************************
  * PacketInput
  ******************************************************************************/
@@ -312,22 +840,13 @@ ssize_t PacketInput::operator() (char * buffer, size_t size) {
 	} else if (size == 0) {
 		// Do nothing.
 	} else {
-		size_t length;
-		while (size > 1) {
-			length = packet.consume(buffer, sizeof(*buffer));
-			if (length > 0) {
-				size -= length;
-				total += length;
-				buffer += length;
-				if (*(buffer - 1) == '\n') {
-					break;
-				}
+		if (size > 1) {
+			total = packet.consume(buffer, size - 1, '\n');
+			if (total > 0) {
+				buffer += total;
 			} else {
-				if (total <= 0) {
-					total = EOF;
-					errno = 0;
-				}
-				break;
+				total = EOF;
+				errno = 0;
 			}
 		}
 		if (total != EOF) {
@@ -384,6 +903,14 @@ ssize_t PacketOutput::operator() (const char * s, size_t size) {
 }
 
 ssize_t PacketOutput::operator() (const char * format, va_list ap) {
+	size_t room;
+	char * space = static_cast<char *>(packet.reserve(room));
+	if (room > Output::minimum_buffer_size) {
+		// Format directly into the Packet instead of copying from the stack.
+		::vsnprintf(space, Output::minimum_buffer_size + 1, format, ap);
+		size_t length = ::strnlen(space, Output::minimum_buffer_size + 1);
+		return packet.commit(length);
+	}
 	char buffer[Output::minimum_buffer_size + 1];
     ::vsnprintf(buffer, sizeof(buffer), format, ap);
     size_t length = ::strnlen(buffer, sizeof(buffer));
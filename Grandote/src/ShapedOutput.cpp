@@ -0,0 +1,345 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Implements the ShapedOutput class.
+ *
+ *  @see    ShapedOutput
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/stdio.h"
+#include "com/diag/grandote/ShapedOutput.h"
+#include "com/diag/grandote/string.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/Print.h"
+
+
+namespace com { namespace diag { namespace grandote {
+
+
+static Throttle promiscuous;
+
+
+//
+//  Constructor.
+//
+ShapedOutput::ShapedOutput(
+    Output& ro,
+    Throttle& rt,
+    size_t vburst,
+    bool vblocking,
+    size_t vcapacity
+) :
+    ou(&ro),
+    octets(&rt),
+    writes(&promiscuous),
+    burst((vburst > 0) ? vburst : 1),
+    capacity(vcapacity),
+    blocking(vblocking),
+    chunk(new char[burst]),
+    sent(0),
+    chunks(0),
+    delayed(0),
+    dropped(0)
+{
+}
+
+
+//
+//  Constructor.
+//
+ShapedOutput::ShapedOutput(
+    Output& ro,
+    Throttle& rt,
+    Throttle& rw,
+    size_t vburst,
+    bool vblocking,
+    size_t vcapacity
+) :
+    ou(&ro),
+    octets(&rt),
+    writes(&rw),
+    burst((vburst > 0) ? vburst : 1),
+    capacity(vcapacity),
+    blocking(vblocking),
+    chunk(new char[burst]),
+    sent(0),
+    chunks(0),
+    delayed(0),
+    dropped(0)
+{
+}
+
+
+//
+//  Destructor.
+//
+ShapedOutput::~ShapedOutput() {
+    delete [] this->chunk;
+}
+
+
+//
+//  Return the file descriptor of the output object.
+//
+int ShapedOutput::getDescriptor() const {
+    return this->ou->getDescriptor();
+}
+
+
+//
+//  Evaluate both throttles. Neither is committed unless both admit the
+//  chunk. The timer is armed for the first throttle that does not, and
+//  the next evaluation picks up any remaining delay of the other.
+//
+bool ShapedOutput::ready() {
+    ticks_t delay = this->octets->admissible();
+    Throttle* throttle = this->octets;
+    if (delay == 0) {
+        delay = this->writes->admissible();
+        throttle = this->writes;
+        if (delay == 0) {
+            return true;
+        }
+    }
+    this->octets->rollback();
+    this->writes->rollback();
+    this->waiter.arm(delay, throttle->frequency());
+    ++this->delayed;
+    return false;
+}
+
+
+//
+//  Emit a chunk. The throttles are charged for what was actually emitted.
+//
+ssize_t ShapedOutput::emit(const char* data, size_t size) {
+    ssize_t rc = (*this->ou)(data, size, size);
+    if (rc <= 0) {
+        this->octets->rollback();
+        this->writes->rollback();
+        return (rc < 0) ? EOF : 0;
+    }
+    this->octets->commit(rc);
+    this->writes->commit();
+    this->sent += rc;
+    ++this->chunks;
+    return rc;
+}
+
+
+//
+//  Drain the queue. Whatever part of a chunk could not be emitted goes
+//  back on the front of the queue. A short write stops the draining but
+//  is not an error, so that new data is queued behind what is pending.
+//
+ssize_t ShapedOutput::drain() {
+    while (!this->queue.empty()) {
+        if (!this->ready()) {
+            if (!this->blocking) {
+                break;
+            }
+            this->waiter.wait();
+            continue;
+        }
+        size_t size = this->queue.consume(this->chunk, this->burst);
+        if (size == 0) {
+            this->octets->rollback();
+            this->writes->rollback();
+            this->queue.clear();
+            break;
+        }
+        ssize_t rc = this->emit(this->chunk, size);
+        if (rc < static_cast<ssize_t>(size)) {
+            size_t emitted = (rc > 0) ? rc : 0;
+            this->queue.prepend(this->chunk + emitted, size - emitted);
+            if (rc < 0) {
+                return EOF;
+            }
+            break;
+        }
+    }
+    return 0;
+}
+
+
+//
+//  Return character.
+//
+int ShapedOutput::operator() (int c) {
+    char ch = c;
+    ssize_t rc = (*this)(&ch, 1, 1);
+    return (rc == 1) ? c : EOF;
+}
+
+
+//
+//  Format a variable length argument list and return success.
+//
+ssize_t ShapedOutput::operator() (const char* format, va_list ap) {
+    char buffer[this->minimum_buffer_size + 1];
+    ssize_t fc = ::vsnprintf(buffer, sizeof(buffer), format, ap);
+    if (fc < 0) {
+        return EOF;
+    }
+    size_t size = fc;
+    if (size >= sizeof(buffer)) {
+        size = sizeof(buffer) - 1;
+    }
+    return (*this)(buffer, size, size);
+}
+
+
+//
+//  Return success.
+//
+ssize_t ShapedOutput::operator() (const char* s, size_t size) {
+    size_t sz = ::strnlen(s, size);
+    return (*this)(s, sz, sz);
+}
+
+
+//
+//  Emit what is admissible, blocking for the rest if so configured, and
+//  queue the remainder otherwise. New data may bypass the queue only when
+//  it is empty, so the stream is never reordered.
+//
+ssize_t ShapedOutput::operator() (
+    const void* buffer,
+    size_t minimum,
+    size_t /* maximum */
+) {
+    if (this->drain() < 0) {
+        return EOF;
+    }
+
+    const char* data = static_cast<const char*>(buffer);
+    size_t offset = 0;
+
+    if (this->queue.empty()) {
+        while (offset < minimum) {
+            if (!this->ready()) {
+                if (!this->blocking) {
+                    break;
+                }
+                this->waiter.wait();
+                continue;
+            }
+            size_t size = minimum - offset;
+            if (size > this->burst) {
+                size = this->burst;
+            }
+            ssize_t rc = this->emit(data + offset, size);
+            if (rc < 0) {
+                return (offset > 0) ? static_cast<ssize_t>(offset) : EOF;
+            }
+            offset += rc;
+            if (rc < static_cast<ssize_t>(size)) {
+                return offset;
+            }
+        }
+    }
+
+    if (offset < minimum) {
+        size_t remaining = minimum - offset;
+        size_t pending = this->queue.length();
+        size_t room = (this->capacity > pending) ? this->capacity - pending : 0;
+        size_t size = (remaining < room) ? remaining : room;
+        if (size > 0) {
+            size = this->queue.append(data + offset, size);
+        }
+        this->dropped += remaining - size;
+        offset += size;
+    }
+
+    return offset;
+}
+
+
+//
+//  Return success.
+//
+int ShapedOutput::operator() () {
+    if (this->drain() < 0) {
+        return EOF;
+    }
+    return (*this->ou)();
+}
+
+
+//
+//  Show this object on the output object.
+//
+void ShapedOutput::show(int level, Output* display, int indent) const {
+    Platform& pl = Platform::instance();
+    Print printf(display);
+    const char* sp = printf.output().indentation(indent);
+    char component[sizeof(__FILE__)];
+    printf("%s%s(%p)[%lu]\n",
+        sp, pl.component(__FILE__, component, sizeof(component)),
+        this, sizeof(*this));
+    this->Output::show(level, display, indent + 1);
+    printf("%s ou=%p\n", sp, this->ou);
+    printf("%s octets=%p\n", sp, this->octets);
+    this->octets->show(level, display, indent + 2);
+    printf("%s writes=%p\n", sp, this->writes);
+    this->writes->show(level, display, indent + 2);
+    printf("%s burst=%zu\n", sp, this->burst);
+    printf("%s capacity=%zu\n", sp, this->capacity);
+    printf("%s blocking=%d\n", sp, this->blocking);
+    printf("%s pending=%zu\n", sp, this->queue.length());
+    printf("%s sent=%llu\n", sp, this->sent);
+    printf("%s chunks=%llu\n", sp, this->chunks);
+    printf("%s delayed=%llu\n", sp, this->delayed);
+    printf("%s dropped=%llu\n", sp, this->dropped);
+    this->waiter.show(level, display, indent + 1);
+}
+
+
+} } }
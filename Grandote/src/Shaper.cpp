@@ -0,0 +1,522 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Implements the ShaperPacket, ShaperClass, and Shaper classes.
+ *
+ *  @see    Shaper
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/Shaper.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/Print.h"
+
+
+namespace com { namespace diag { namespace grandote {
+
+
+static Throttle promiscuous;
+
+
+//
+//  Constructor.
+//
+ShaperPacket::ShaperPacket(void* object, size_t size) :
+    link(this),
+    payload(object),
+    bytes(size)
+{
+}
+
+
+//
+//  Destructor.
+//
+ShaperPacket::~ShaperPacket() {
+}
+
+
+//
+//  Show this object on the output object.
+//
+void ShaperPacket::show(int level, Output* display, int indent) const {
+    Platform& pl = Platform::instance();
+    Print printf(display);
+    const char* sp = printf.output().indentation(indent);
+    char component[sizeof(__FILE__)];
+    printf("%s%s(%p)[%lu]:\n",
+        sp, pl.component(__FILE__, component, sizeof(component)),
+        this, sizeof(*this));
+    this->link.show(level, display, indent + 1);
+    printf("%s payload=%p\n", sp, this->payload);
+    printf("%s bytes=%zu\n", sp, this->bytes);
+}
+
+
+//
+//  Constructor.
+//
+ShaperClass::ShaperClass(ShaperClass* pp, Throttle& rr, size_t qq) :
+    parent(pp),
+    rate(&rr),
+    ceiling(&promiscuous),
+    children(0),
+    quantum((qq > 0) ? qq : 1),
+    deficit(0),
+    packets(0),
+    bytes(0),
+    sent(0),
+    borrowed(0),
+    mode(CAN_SEND),
+    eligible(0),
+    queue(),
+    feed(),
+    ring(this),
+    node(this)
+{
+    if (this->parent != 0) {
+        ++this->parent->children;
+    }
+}
+
+
+//
+//  Constructor.
+//
+ShaperClass::ShaperClass(ShaperClass* pp, Throttle& rr, Throttle& cc, size_t qq) :
+    parent(pp),
+    rate(&rr),
+    ceiling(&cc),
+    children(0),
+    quantum((qq > 0) ? qq : 1),
+    deficit(0),
+    packets(0),
+    bytes(0),
+    sent(0),
+    borrowed(0),
+    mode(CAN_SEND),
+    eligible(0),
+    queue(),
+    feed(),
+    ring(this),
+    node(this)
+{
+    if (this->parent != 0) {
+        ++this->parent->children;
+    }
+}
+
+
+//
+//  Destructor.
+//
+ShaperClass::~ShaperClass() {
+    if ((this->children != 0) || (!this->queue.isEmpty()) || this->ring.isChained() || this->node.isQueued()) {
+        Platform::instance().fatal("ShaperClass destroyed while not idle", 0, __FILE__, __LINE__, __func__);
+    }
+    if (this->parent != 0) {
+        --this->parent->children;
+    }
+}
+
+
+//
+//  Show this object on the output object.
+//
+void ShaperClass::show(int level, Output* display, int indent) const {
+    Platform& pl = Platform::instance();
+    Print printf(display);
+    const char* sp = printf.output().indentation(indent);
+    char component[sizeof(__FILE__)];
+    printf("%s%s(%p)[%lu]:\n",
+        sp, pl.component(__FILE__, component, sizeof(component)),
+        this, sizeof(*this));
+    printf("%s parent=%p\n", sp, this->parent);
+    printf("%s children=%zu\n", sp, this->children);
+    printf("%s quantum=%zu\n", sp, this->quantum);
+    printf("%s deficit=%zu\n", sp, this->deficit);
+    printf("%s packets=%zu\n", sp, this->packets);
+    printf("%s bytes=%zu\n", sp, this->bytes);
+    printf("%s sent=%llu\n", sp, this->sent);
+    printf("%s borrowed=%llu\n", sp, this->borrowed);
+    printf("%s mode=%d\n", sp, this->mode);
+    printf("%s eligible=%llu\n", sp, this->eligible);
+    if (level > 0) {
+        printf("%s rate:\n", sp);
+        this->rate->show(level, display, indent + 2);
+        printf("%s ceiling:\n", sp);
+        this->ceiling->show(level, display, indent + 2);
+    }
+}
+
+
+//
+//  Constructor.
+//
+Shaper::Shaper() :
+    count(0),
+    row(),
+    waiting()
+{
+}
+
+
+//
+//  Destructor.
+//
+Shaper::~Shaper() {
+    while (this->row.removeFirst() != 0) {
+    }
+    PriorityNode<ShaperClass>* node;
+    while ((node = this->waiting.remove()) != 0) {
+        node->getPayload()->ring.remove();
+    }
+}
+
+
+//
+//  Enqueue at the current time.
+//
+bool Shaper::enqueue(ShaperClass& leaf, ShaperPacket& packet) {
+    return this->enqueue(leaf, packet, Platform::instance().time());
+}
+
+
+//
+//  Append a packet to a leaf, activating the leaf if it was idle.
+//
+bool Shaper::enqueue(ShaperClass& leaf, ShaperPacket& packet, ticks_t now) {
+    if (!leaf.isLeaf()) {
+        return false;
+    }
+    if (packet.link.isChained()) {
+        return false;
+    }
+    bool idle = leaf.queue.isEmpty();
+    leaf.queue.insertLast(&packet.link);
+    ++leaf.packets;
+    leaf.bytes += packet.bytes;
+    ++this->count;
+    if (idle) {
+        this->activate(leaf, now);
+    }
+    return true;
+}
+
+
+//
+//  Dequeue at the current time.
+//
+ShaperPacket* Shaper::dequeue() {
+    return this->dequeue(Platform::instance().time());
+}
+
+
+//
+//  Apply the mode changes that are due, then serve the head of the ring
+//  through the heads of the feeds below it. Each ring on the way is a
+//  deficit round robin: if its head cannot cover the packet, the head is
+//  credited and moved to the tail, and the search starts over.
+//
+ShaperPacket* Shaper::dequeue(ticks_t now) {
+    PriorityNode<ShaperClass>* node;
+    while (((node = this->waiting.peek()) != 0) && (node->getPayload()->eligible <= now)) {
+        this->refresh(*node->getPayload(), now);
+    }
+
+    Link* link;
+    while ((link = this->row.peekFirst()) != 0) {
+        ShaperClass* lender = static_cast<LinkType<ShaperClass>*>(link)->getPayload();
+        ShaperClass* leaf = lender;
+        while (!leaf->isLeaf()) {
+            leaf = static_cast<LinkType<ShaperClass>*>(leaf->feed.peekFirst())->getPayload();
+        }
+        ShaperPacket* packet = static_cast<LinkType<ShaperPacket>*>(leaf->queue.peekFirst())->getPayload();
+        size_t n = packet->bytes;
+
+        FastChain* ring = &this->row;
+        ShaperClass* cc = lender;
+        while (cc->deficit >= n) {
+            if (cc == leaf) {
+                break;
+            }
+            ring = &cc->feed;
+            cc = static_cast<LinkType<ShaperClass>*>(ring->peekFirst())->getPayload();
+        }
+        if (cc->deficit < n) {
+            cc->deficit += cc->quantum;
+            cc->ring.remove();
+            ring->insertLast(&cc->ring);
+            continue;
+        }
+
+        if (!this->charge(*leaf, *lender, n, now)) {
+            for (cc = leaf; cc != lender; cc = cc->parent) {
+                this->refresh(*cc, now);
+            }
+            this->refresh(*lender, now);
+            continue;
+        }
+
+        packet->link.remove();
+        --leaf->packets;
+        leaf->bytes -= n;
+        --this->count;
+        for (cc = leaf; cc != lender; cc = cc->parent) {
+            cc->deficit -= n;
+        }
+        lender->deficit -= n;
+        if (leaf->queue.isEmpty()) {
+            this->deactivate(*leaf);
+        }
+        for (cc = leaf; cc != 0; cc = cc->parent) {
+            this->refresh(*cc, now);
+        }
+        return packet;
+    }
+
+    return 0;
+}
+
+
+//
+//  Return the delay until some class may be able to send.
+//
+ticks_t Shaper::delay(ticks_t now) const {
+    if (!this->row.isEmpty()) {
+        return 0;
+    }
+    PriorityNode<ShaperClass>* node = this->waiting.peek();
+    if (node == 0) {
+        return intmaxof(ticks_t);
+    }
+    ticks_t eligible = node->getPayload()->eligible;
+    return (eligible > now) ? (eligible - now) : 0;
+}
+
+
+//
+//  A class whose ceiling does not admit cannot send at all, one whose rate
+//  does not admit can only borrow, and the root, having no one to borrow
+//  from, cannot send until both admit.
+//
+ShaperClass::Mode Shaper::evaluate(ShaperClass& that, ticks_t now, ticks_t& when) {
+    ticks_t ceiling = that.ceiling->admissible(now);
+    that.ceiling->rollback();
+    ticks_t rate = that.rate->admissible(now);
+    that.rate->rollback();
+    ShaperClass::Mode mode;
+    ticks_t delay;
+    if (ceiling > 0) {
+        mode = ShaperClass::CANT_SEND;
+        delay = ceiling;
+    } else if (rate == 0) {
+        mode = ShaperClass::CAN_SEND;
+        delay = 0;
+    } else if (that.parent != 0) {
+        mode = ShaperClass::MAY_BORROW;
+        delay = rate;
+    } else {
+        mode = ShaperClass::CANT_SEND;
+        delay = rate;
+    }
+    when = (delay > (intmaxof(ticks_t) - now)) ? intmaxof(ticks_t) : (now + delay);
+    return mode;
+}
+
+
+//
+//  Put the class on the ring or feed its mode calls for, and on the
+//  waiting queue if its mode can change.
+//
+void Shaper::place(ShaperClass& that, ShaperClass::Mode mode, ticks_t when, ticks_t now) {
+    that.mode = mode;
+    that.eligible = when;
+    if (mode == ShaperClass::CAN_SEND) {
+        this->row.insertLast(&that.ring);
+        return;
+    }
+    this->waiting.insert(that.node);
+    if (mode == ShaperClass::MAY_BORROW) {
+        ShaperClass& parent = *that.parent;
+        bool idle = parent.feed.isEmpty();
+        parent.feed.insertLast(&that.ring);
+        if (idle) {
+            this->activate(parent, now);
+        }
+    }
+}
+
+
+//
+//  Take the class off wherever it is.
+//
+void Shaper::unplace(ShaperClass& that) {
+    if (that.node.isQueued()) {
+        this->waiting.remove(that.node);
+    }
+    if (that.ring.isChained()) {
+        that.ring.remove();
+        if ((that.mode == ShaperClass::MAY_BORROW) && that.parent->feed.isEmpty()) {
+            this->deactivate(*that.parent);
+        }
+    }
+}
+
+
+//
+//  Activate a class.
+//
+void Shaper::activate(ShaperClass& that, ticks_t now) {
+    ticks_t when;
+    ShaperClass::Mode mode = this->evaluate(that, now, when);
+    this->place(that, mode, when, now);
+}
+
+
+//
+//  Deactivate a class.
+//
+void Shaper::deactivate(ShaperClass& that) {
+    this->unplace(that);
+    that.deficit = 0;
+}
+
+
+//
+//  Bring the mode of an active class up to date.
+//
+void Shaper::refresh(ShaperClass& that, ticks_t now) {
+    if (!that.isActive()) {
+        return;
+    }
+    ticks_t when;
+    ShaperClass::Mode mode = this->evaluate(that, now, when);
+    if (mode != that.mode) {
+        this->unplace(that);
+        this->place(that, mode, when, now);
+    } else if ((mode != ShaperClass::CAN_SEND) && (when != that.eligible)) {
+        this->waiting.remove(that.node);
+        that.eligible = when;
+        this->waiting.insert(that.node);
+    }
+}
+
+
+//
+//  The leaf can send on the bandwidth of the lender if every ceiling up
+//  to and including the lender admits it, and the rate of the lender
+//  admits it. Every throttle on the path has been asked, so every throttle
+//  must be committed or rolled back. As in HTB, the ceilings of the whole
+//  path are charged, but the rates only from the lender up.
+//
+bool Shaper::charge(ShaperClass& leaf, ShaperClass& lender, size_t n, ticks_t now) {
+    bool admissible = true;
+    bool below = true;
+    ShaperClass* cc;
+
+    for (cc = &leaf; cc != 0; cc = cc->parent) {
+        ticks_t ceiling = cc->ceiling->admissible(now);
+        ticks_t rate = cc->rate->admissible(now);
+        if (below && (ceiling > 0)) {
+            admissible = false;
+        }
+        if (cc == &lender) {
+            if (rate > 0) {
+                admissible = false;
+            }
+            below = false;
+        }
+    }
+
+    if (!admissible) {
+        for (cc = &leaf; cc != 0; cc = cc->parent) {
+            cc->ceiling->rollback();
+            cc->rate->rollback();
+        }
+        return false;
+    }
+
+    for (cc = &leaf; cc != &lender; cc = cc->parent) {
+        cc->ceiling->commit(n);
+        cc->rate->rollback();
+    }
+    for (; cc != 0; cc = cc->parent) {
+        cc->ceiling->commit(n);
+        cc->rate->commit(n);
+    }
+    ++leaf.sent;
+    if (&lender != &leaf) {
+        ++leaf.borrowed;
+    }
+    return true;
+}
+
+
+//
+//  Show this object on the output object.
+//
+void Shaper::show(int level, Output* display, int indent) const {
+    Platform& pl = Platform::instance();
+    Print printf(display);
+    const char* sp = printf.output().indentation(indent);
+    char component[sizeof(__FILE__)];
+    printf("%s%s(%p)[%lu]:\n",
+        sp, pl.component(__FILE__, component, sizeof(component)),
+        this, sizeof(*this));
+    printf("%s count=%zu\n", sp, this->count);
+    printf("%s row:\n", sp);
+    this->row.show(level, display, indent + 2);
+    printf("%s waiting:\n", sp);
+    this->waiting.show(level, display, indent + 2);
+}
+
+
+} } }
@@ -54,7 +54,9 @@
 
 
 #include "com/diag/grandote/target.h"
+#include "com/diag/grandote/generics.h"
 #include "com/diag/grandote/Throttle.h"
+#include "com/diag/grandote/ThrottleWaiter.h"
 #include "com/diag/grandote/Print.h"
 #include "com/diag/grandote/Platform.h"
 
@@ -65,7 +67,9 @@ namespace com { namespace diag { namespace grandote {
 //
 //  Constructor.
 //
-Throttle::Throttle() {
+Throttle::Throttle() :
+    waiter(0)
+{
 }
 
 
@@ -73,6 +77,26 @@ Throttle::Throttle() {
 //  Destructor.
 //
 Throttle::~Throttle() {
+    delete this->waiter;
+}
+
+
+//
+//  Copy constructor.
+//
+Throttle::Throttle(const Throttle& that) :
+    Object(that),
+    waiter(0)
+{
+}
+
+
+//
+//  Assignment operator.
+//
+Throttle& Throttle::operator=(const Throttle& that) {
+    Object::operator=(that);
+    return *this;
 }
 
 
@@ -131,6 +155,36 @@ bool Throttle::rollback() {
 }
 
 
+//
+//  Wait until admissible and commit. The waiter, and its timer, are
+//  created only the first time the throttle says to wait.
+//
+bool Throttle::await(size_t n) {
+    if (this->admissible() > 0) {
+        this->rollback();
+        if (this->waiter == 0) {
+            this->waiter = new ThrottleWaiter;
+        }
+        return this->await(*this->waiter, n);
+    }
+    return this->commit(n);
+}
+
+
+//
+//  Wait on the caller's waiter until admissible and commit.
+//
+bool Throttle::await(ThrottleWaiter& waiter, size_t n) {
+    if (this->admissible() > 0) {
+        this->rollback();
+        Throttle* throttles[] = { this };
+        waiter.await(throttles, countof(throttles));
+        this->admissible();
+    }
+    return this->commit(n);
+}
+
+
 //
 //  Get the current time in ticks.
 //
@@ -171,9 +225,10 @@ void Throttle::show(int /* level */, Output* display, int indent) const {
     Print printf(display);
     const char* sp = printf.output().indentation(indent);
     char component[sizeof(__FILE__)];
-    printf("%s%s(%p)[%lu]\n",
+    printf("%s%s(%p)[%lu]:\n",
         sp, pl.component(__FILE__, component, sizeof(component)),
         this, sizeof(*this));
+    printf("%s waiter=%p\n", sp, this->waiter);
 }
 
 
@@ -0,0 +1,262 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Implements the ThrottleWaiter class.
+ *
+ *  @see    ThrottleWaiter
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "platform.h"
+#if defined(GRANDOTE_PLATFORM_IS_Linux) || defined(GRANDOTE_PLATFORM_IS_Diminuto) || defined(GRANDOTE_PLATFORM_IS_Arroyo)
+#   define GRANDOTE_THROTTLEWAITER_HAS_TIMERFD
+#   include <sys/timerfd.h>
+#endif
+#include <unistd.h>
+#include "com/diag/grandote/errno.h"
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/ThrottleWaiter.h"
+#include "com/diag/grandote/Constant.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/Print.h"
+
+
+namespace com { namespace diag { namespace grandote {
+
+
+//
+//  Convert ticks at a frequency to nanoseconds, saturating rather than
+//  overflowing.
+//
+static ticks_t nanoseconds(ticks_t ticks, ticks_t frequency) {
+    ticks_t seconds = ticks / frequency;
+    if (seconds >= (intmaxof(ticks_t) / Constant::ns_per_s)) {
+        return intmaxof(ticks_t);
+    }
+    return (seconds * Constant::ns_per_s) + (((ticks % frequency) * Constant::ns_per_s) / frequency);
+}
+
+
+//
+//  Constructor. Without a timerfd the descriptor is invalid and the
+//  waiter falls back to Platform::yield().
+//
+ThrottleWaiter::ThrottleWaiter() :
+#if defined(GRANDOTE_THROTTLEWAITER_HAS_TIMERFD)
+    fd(::timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC)),
+#else
+    fd(-1),
+#endif
+    next(0),
+    nanoseconds(0)
+{
+}
+
+
+//
+//  Destructor.
+//
+ThrottleWaiter::~ThrottleWaiter() {
+    if (this->fd >= 0) {
+        ::close(this->fd);
+    }
+}
+
+
+//
+//  Find the earliest throttle, comparing delays in nanoseconds since the
+//  throttles need not share a frequency, and arm the timer for it.
+//
+ticks_t ThrottleWaiter::arm(Throttle* throttles[], size_t count, size_t& index) {
+    ticks_t earliest = intmaxof(ticks_t);
+    ticks_t shortest = intmaxof(ticks_t);
+    ticks_t hz = 0;
+
+    index = count;
+    for (size_t ii = 0; ii < count; ++ii) {
+        size_t kk = (this->next + ii) % count;
+        Throttle& throttle = *throttles[kk];
+        ticks_t frequency = throttle.frequency();
+        ticks_t delay = throttle.admissible();
+        throttle.rollback();
+        if ((delay == 0) || (frequency == 0)) {
+            index = kk;
+            earliest = 0;
+            break;
+        }
+        ticks_t duration = grandote::nanoseconds(delay, frequency);
+        if ((index == count) || (duration < shortest)) {
+            index = kk;
+            earliest = delay;
+            shortest = duration;
+            hz = frequency;
+        }
+    }
+
+    if (index == count) {
+        this->disarm();
+    } else if (earliest == 0) {
+        this->next = (index + 1) % count;
+        this->disarm();
+    } else {
+        this->arm(earliest, hz);
+    }
+
+    return earliest;
+}
+
+
+//
+//  Arm the timer relative to now. A zero it_value would disarm it, so
+//  the shortest delay is one nanosecond.
+//
+int ThrottleWaiter::arm(ticks_t ticks, ticks_t frequency) {
+    ticks_t duration = (frequency > 0) ? grandote::nanoseconds(ticks, frequency) : 0;
+    if (duration == 0) {
+        duration = 1;
+    }
+    this->nanoseconds = duration;
+    if (this->fd < 0) {
+        return this->fd;
+    }
+#if defined(GRANDOTE_THROTTLEWAITER_HAS_TIMERFD)
+    struct itimerspec its;
+    its.it_interval.tv_sec = 0;
+    its.it_interval.tv_nsec = 0;
+    ticks_t seconds = duration / Constant::ns_per_s;
+    its.it_value.tv_sec = (seconds > static_cast<ticks_t>(signedintmaxof(time_t))) ? signedintmaxof(time_t) : seconds;
+    its.it_value.tv_nsec = duration % Constant::ns_per_s;
+    int rc = ::timerfd_settime(this->fd, 0, &its, 0);
+    return (rc < 0) ? rc : this->fd;
+#else
+    return this->fd;
+#endif
+}
+
+
+//
+//  Disarm the timer.
+//
+int ThrottleWaiter::disarm() {
+    this->nanoseconds = 0;
+    if (this->fd < 0) {
+        return this->fd;
+    }
+#if defined(GRANDOTE_THROTTLEWAITER_HAS_TIMERFD)
+    struct itimerspec its;
+    its.it_interval.tv_sec = 0;
+    its.it_interval.tv_nsec = 0;
+    its.it_value.tv_sec = 0;
+    its.it_value.tv_nsec = 0;
+    int rc = ::timerfd_settime(this->fd, 0, &its, 0);
+    return (rc < 0) ? rc : this->fd;
+#else
+    return this->fd;
+#endif
+}
+
+
+//
+//  Wait for the timer to expire. Reading a timerfd blocks until it has
+//  expired at least once and returns the number of expirations.
+//
+int ThrottleWaiter::wait() {
+    if (this->fd >= 0) {
+        uint64_t expirations = 0;
+        ssize_t rc;
+        do {
+            rc = ::read(this->fd, &expirations, sizeof(expirations));
+        } while ((rc < 0) && (errno == EINTR));
+        if (rc == static_cast<ssize_t>(sizeof(expirations))) {
+            this->nanoseconds = 0;
+            return static_cast<int>(expirations);
+        }
+    }
+    if (this->nanoseconds == 0) {
+        return 0;
+    }
+    Platform& pl = Platform::instance();
+    ticks_t hz = pl.frequency();
+    ticks_t ticks = ((this->nanoseconds / Constant::ns_per_s) * hz) + (((this->nanoseconds % Constant::ns_per_s) * hz) / Constant::ns_per_s) + 1;
+    pl.yield(ticks, false);
+    this->nanoseconds = 0;
+    return 1;
+}
+
+
+//
+//  Wait until one of the throttles is admissible.
+//
+size_t ThrottleWaiter::await(Throttle* throttles[], size_t count) {
+    size_t index = count;
+    while ((this->arm(throttles, count, index) > 0) && (index < count)) {
+        this->wait();
+    }
+    return index;
+}
+
+
+//
+//  Show this object on the output object.
+//
+void ThrottleWaiter::show(int /* level */, Output* display, int indent) const {
+    Platform& pl = Platform::instance();
+    Print printf(display);
+    const char* sp = printf.output().indentation(indent);
+    char component[sizeof(__FILE__)];
+    printf("%s%s(%p)[%lu]:\n",
+        sp, pl.component(__FILE__, component, sizeof(component)),
+        this, sizeof(*this));
+    printf("%s fd=%d\n", sp, this->fd);
+    printf("%s next=%zu\n", sp, this->next);
+    printf("%s nanoseconds=%llu\n", sp, this->nanoseconds);
+}
+
+
+} } }
@@ -0,0 +1,343 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Implements the TimerWheel and Timer classes.
+ *
+ *  @see    TimerWheel
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/target.h"
+#include "com/diag/grandote/TimerWheel.h"
+#include "com/diag/grandote/Print.h"
+#include "com/diag/grandote/Platform.h"
+
+
+namespace com { namespace diag { namespace grandote {
+
+
+//
+//  Constructor. The payload of the link is this timer.
+//
+Timer::Timer() :
+    link(),
+    deadline(0),
+    expiration(0)
+{
+    this->link.setPayload(this);
+}
+
+
+//
+//  Destructor.
+//
+Timer::~Timer() {
+    this->cancel();
+}
+
+
+//
+//  Show this object on the output object.
+//
+void Timer::show(int level, Output* display, int indent) const {
+    Platform& pl = Platform::instance();
+    Print printf(display);
+    const char* sp = printf.output().indentation(indent);
+    char component[sizeof(__FILE__)];
+    printf("%s%s(%p)[%lu]:\n",
+        sp, pl.component(__FILE__, component, sizeof(component)),
+        this, sizeof(*this));
+    printf("%s deadline=%llu\n", sp, this->deadline);
+    printf("%s expiration=%llu\n", sp, this->expiration);
+    printf("%s isArmed=%d\n", sp, this->isArmed());
+    this->link.show(level, display, indent + 1);
+}
+
+
+//
+//  Constructor.
+//
+TimerWheel::TimerWheel(ticks_t gg, ticks_t now) :
+    granularity((0 < gg) ? gg : 1),
+    current(0)
+{
+    this->current = now / this->granularity;
+}
+
+
+//
+//  Destructor. The destructors of the slots remove any timers still on
+//  them.
+//
+TimerWheel::~TimerWheel() {
+}
+
+
+//
+//  Place a timer on the root slot for its expiration if it expires within
+//  the root level, otherwise on the slot of the lowest upper level which
+//  covers its expiration. Timers whose granules have already been
+//  processed go on the overdue chain.
+//
+void TimerWheel::place(Timer& timer) {
+    ticks_t expiration = timer.expiration;
+    Chain* slot;
+
+    if (expiration < this->current) {
+        slot = &(this->overdue);
+    } else if ((expiration - this->current) < ROOT) {
+        slot = &(this->root[expiration & (ROOT - 1)]);
+    } else {
+        ticks_t delta = expiration - this->current;
+        unsigned int shift = ROOTBITS;
+        size_t level = 0;
+        while (((LEVELS - 1) > level) && (delta >= (static_cast<ticks_t>(1) << (shift + LEVELBITS)))) {
+            shift += LEVELBITS;
+            ++level;
+        }
+        if (delta >= (static_cast<ticks_t>(1) << (shift + LEVELBITS))) {
+            expiration = this->current + (static_cast<ticks_t>(1) << (shift + LEVELBITS)) - 1;
+        }
+        slot = &(this->levels[level][(expiration >> shift) & (LEVEL - 1)]);
+    }
+
+    slot->insertLast(&(timer.link));
+}
+
+
+//
+//  Arm a timer.
+//
+bool TimerWheel::insert(Timer& timer, ticks_t deadline) {
+    if (timer.isArmed()) {
+        return false;
+    }
+    timer.deadline = deadline;
+    timer.expiration = (deadline / this->granularity) + (((deadline % this->granularity) != 0) ? 1 : 0);
+    this->place(timer);
+    return true;
+}
+
+
+//
+//  Move the timers on an upper slot down. They are first moved onto a
+//  chain of their own, since some of them may be placed back on the same
+//  slot.
+//
+size_t TimerWheel::cascade(size_t level, size_t index) {
+    Chain moving;
+    Link* link;
+
+    while (0 != (link = this->levels[level][index].removeFirst())) {
+        moving.insertLast(link);
+    }
+
+    while (0 != (link = moving.removeFirst())) {
+        this->place(*static_cast<Timer*>(link->getPayload()));
+    }
+
+    return index;
+}
+
+
+//
+//  Find the next granule at which a slot of an upper level that has timers
+//  on it will be cascaded. Level L is cascaded at every granule that is a
+//  multiple of the span of the levels below it, at the slot indexed by
+//  the bits of the granule above that span. This is only used when the
+//  root level is empty, so nothing can happen before then.
+//
+ticks_t TimerWheel::next() const {
+    ticks_t earliest = ~static_cast<ticks_t>(0);
+
+    for (size_t level = 0; LEVELS > level; ++level) {
+        unsigned int shift = ROOTBITS + (level * LEVELBITS);
+        ticks_t base = (this->current + (static_cast<ticks_t>(1) << shift) - 1) >> shift;
+        for (size_t index = 0; LEVEL > index; ++index) {
+            if (!this->levels[level][index].isEmpty()) {
+                ticks_t granule = (base + ((index - base) & (LEVEL - 1))) << shift;
+                if (granule < earliest) {
+                    earliest = granule;
+                }
+            }
+        }
+    }
+
+    return earliest;
+}
+
+
+//
+//  Expire any overdue timers, then advance the wheel a granule at a
+//  time, cascading the upper levels whenever the root level wraps
+//  around, and expiring the timers on each root slot. Runs of granules
+//  in which nothing can happen are skipped: up to the next root slot
+//  with timers on it, or, if the root level is empty, up to the next
+//  cascade of an upper slot with timers on it. So the cost of advancing
+//  depends on the number of timers, not on how far the wheel is advanced.
+//
+size_t TimerWheel::advance(ticks_t now) {
+    ticks_t target = now / this->granularity;
+    size_t expired = 0;
+    size_t index;
+    size_t level;
+    size_t ii;
+    ticks_t skip;
+    Link* link;
+
+    {
+        Chain due;
+        while (0 != (link = this->overdue.removeFirst())) {
+            due.insertLast(link);
+        }
+        while (0 != (link = due.removeFirst())) {
+            static_cast<Timer*>(link->getPayload())->expire(*this, now);
+            ++expired;
+        }
+    }
+
+    while (this->current <= target) {
+
+        index = this->current & (ROOT - 1);
+        if (0 == index) {
+            for (level = 0; LEVELS > level; ++level) {
+                if (0 != this->cascade(level, (this->current >> (ROOTBITS + (level * LEVELBITS))) & (LEVEL - 1))) {
+                    break;
+                }
+            }
+        }
+
+        if (this->root[index].isEmpty()) {
+            for (ii = index + 1; (ROOT > ii) && this->root[ii].isEmpty(); ++ii) {
+                continue;
+            }
+            if (ROOT > ii) {
+                skip = this->current + (ii - index);
+            } else {
+                for (ii = 0; (index > ii) && this->root[ii].isEmpty(); ++ii) {
+                    continue;
+                }
+                if (index > ii) {
+                    skip = this->current + (ROOT - index);
+                } else {
+                    skip = this->next();
+                }
+            }
+            if (skip <= this->current) {
+                skip = this->current + 1;
+            }
+            this->current = (skip <= target) ? skip : target + 1;
+            continue;
+        }
+
+        ++this->current;
+        Chain due;
+        while (0 != (link = this->root[index].removeFirst())) {
+            due.insertLast(link);
+        }
+        while (0 != (link = due.removeFirst())) {
+            static_cast<Timer*>(link->getPayload())->expire(*this, now);
+            ++expired;
+        }
+
+    }
+
+    return expired;
+}
+
+
+//
+//  Advance the wheel to the current platform time.
+//
+size_t TimerWheel::advance() {
+    return this->advance(Platform::instance().time());
+}
+
+
+//
+//  Show this object on the output object.
+//
+void TimerWheel::show(int level, Output* display, int indent) const {
+    Platform& pl = Platform::instance();
+    Print printf(display);
+    const char* sp = printf.output().indentation(indent);
+    char component[sizeof(__FILE__)];
+    printf("%s%s(%p)[%lu]:\n",
+        sp, pl.component(__FILE__, component, sizeof(component)),
+        this, sizeof(*this));
+    printf("%s granularity=%llu\n", sp, this->granularity);
+    printf("%s current=%llu\n", sp, this->current);
+    if (!this->overdue.isEmpty()) {
+        printf("%s overdue:\n", sp);
+        if (0 < level) {
+            this->overdue.show(level - 1, display, indent + 2);
+        }
+    }
+    for (size_t ii = 0; ROOT > ii; ++ii) {
+        if (!this->root[ii].isEmpty()) {
+            printf("%s root[%u]:\n", sp, ii);
+            if (0 < level) {
+                this->root[ii].show(level - 1, display, indent + 2);
+            }
+        }
+    }
+    for (size_t ll = 0; LEVELS > ll; ++ll) {
+        for (size_t ii = 0; LEVEL > ii; ++ii) {
+            if (!this->levels[ll][ii].isEmpty()) {
+                printf("%s levels[%u][%u]:\n", sp, ll, ii);
+                if (0 < level) {
+                    this->levels[ll][ii].show(level - 1, display, indent + 2);
+                }
+            }
+        }
+    }
+}
+
+
+} } }
@@ -14,6 +14,10 @@ extern "C" {
 }
 
 #include "com/diag/grandote/Well.h"
+#include <new>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
 
 namespace com {
  namespace diag {
@@ -23,13 +27,22 @@ namespace com {
  * BASE WELL
  ******************************************************************************/
 
-BaseWell::BaseWell(size_t ss, size_t cc, bool mm, size_t aa, size_t pp, size_t ll)
+BaseWell::BaseWell(size_t ss, size_t cc, bool mm, size_t aa, size_t pp, size_t ll, size_t ee, size_t hh)
 : size(ss)
 , cardinality(cc)
 , alignment(aa)
 , pagesize(pp)
 , linesize(ll)
 , wellp(static_cast<diminuto_well_t *>(0))
+, increment(ee)
+, highwater(hh)
+, extent(0)
+, offset(0)
+, stride(0)
+, slabs(0)
+, idle(0)
+, head(static_cast<Slab *>(0))
+, tail(static_cast<Slab *>(0))
 {
 	if (cc == 0) {
 		/* Do nothing. */
@@ -45,17 +58,46 @@ BaseWell::~BaseWell() {
 }
 
 void BaseWell::init(size_t ss, size_t cc, size_t aa, size_t pp, size_t ll) {
-	if (wellp == static_cast<diminuto_well_t *>(0)) {
-		wellp = diminuto_well_init(ss, cc, aa, pp, ll);
+	if (increment == 0) {
+		if (wellp == static_cast<diminuto_well_t *>(0)) {
+			wellp = diminuto_well_init(ss, cc, aa, pp, ll);
+		}
+	} else if (extent == 0) {
+		size = ss;
+		alignment = aa;
+		pagesize = pp;
+		linesize = ll;
+		geometry();
+		while ((slabs * ((extent - offset) / stride)) < cc) {
+			if (slab() == static_cast<Slab *>(0)) { break; }
+		}
+		if (highwater == 0) {
+			highwater = (slabs > 0) ? slabs : 1;
+		}
+	} else {
+		/* Do nothing. */
 	}
 }
 
 void BaseWell::init() {
-	init(size, cardinality, alignment);
+	init(size, cardinality, alignment, pagesize, linesize);
 }
 
 void BaseWell::fini() {
-	if (wellp == static_cast<diminuto_well_t *>(0)) {
+	if (increment > 0) {
+		if (idle < slabs) {
+			/* Do nothing. */
+		} else {
+			while (head != static_cast<Slab *>(0)) {
+				Slab * sp = head;
+				unlink(sp);
+				::free(sp);
+			}
+			slabs = 0;
+			idle = 0;
+			extent = 0;
+		}
+	} else if (wellp == static_cast<diminuto_well_t *>(0)) {
 		/* Do nothing. */
 	} else if (diminuto_well_isfull(wellp)) {
 		diminuto_well_fini(wellp);
@@ -68,28 +110,169 @@ void BaseWell::fini() {
 void * BaseWell::alloc() {
 	void * that;
 	init();
-	that = diminuto_well_alloc(wellp);
+	if (increment == 0) {
+		that = diminuto_well_alloc(wellp);
+	} else {
+		Slab * sp = head;
+		if (sp == static_cast<Slab *>(0)) {
+			sp = slab();
+		}
+		if (sp == static_cast<Slab *>(0)) {
+			that = static_cast<void *>(0);
+		} else {
+			if (sp->free != static_cast<void *>(0)) {
+				that = sp->free;
+				sp->free = *static_cast<void **>(that);
+			} else {
+				that = sp->fresh;
+				sp->fresh += stride;
+			}
+			if ((sp->used++) == 0) {
+				--idle;
+			}
+			if (sp->free != static_cast<void *>(0)) {
+				/* Do nothing. */
+			} else if ((sp->fresh + stride) <= (reinterpret_cast<char *>(sp) + extent)) {
+				/* Do nothing. */
+			} else {
+				unlink(sp);
+			}
+		}
+	}
 	return that;
 }
 
 void BaseWell::free(void * pointer) {
-	diminuto_well_free(wellp, pointer);
+	if (pointer == static_cast<void *>(0)) {
+		/* Do nothing. */
+	} else if (increment == 0) {
+		diminuto_well_free(wellp, pointer);
+	} else {
+		Slab * sp = reinterpret_cast<Slab *>(reinterpret_cast<uintptr_t>(pointer) & ~static_cast<uintptr_t>(extent - 1));
+		*static_cast<void **>(pointer) = sp->free;
+		sp->free = pointer;
+		if (!sp->listed) {
+			link(sp, false);
+		}
+		if ((--(sp->used)) > 0) {
+			/* Do nothing. */
+		} else if (idle >= highwater) {
+			unlink(sp);
+			::free(sp);
+			--slabs;
+		} else {
+			++idle;
+			unlink(sp);
+			link(sp, true);
+		}
+	}
 }
 
 bool BaseWell::isFull() const {
-	return (diminuto_well_isfull(wellp) != 0);
+	return (increment > 0) ? (idle == slabs) : (diminuto_well_isfull(wellp) != 0);
 }
 
 bool BaseWell::isEmpty() const {
-	return (diminuto_well_isempty(wellp) != 0);
+	return (increment > 0) ? false : (diminuto_well_isempty(wellp) != 0);
+}
+
+void BaseWell::geometry() {
+	size_t aa;
+	size_t minimum;
+	if (pagesize == 0) {
+		long value = sysconf(_SC_PAGESIZE);
+		pagesize = (value > 0) ? value : 4096;
+	}
+	if (linesize == 0) {
+#if defined(_SC_LEVEL1_DCACHE_LINESIZE)
+		long value = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+		linesize = (value > 0) ? value : sizeof(uint64_t);
+#else
+		linesize = sizeof(uint64_t);
+#endif
+	}
+	/*
+	 * Each object has to be big enough to hold the free list pointer, and
+	 * objects are laid out at the alignment; the first one starts on a
+	 * cache line (or alignment, whichever is larger) past the slab header.
+	 */
+	aa = (alignment > 0) ? alignment : sizeof(uint64_t);
+	stride = (size > sizeof(void *)) ? size : sizeof(void *);
+	stride = ((stride + aa - 1) / aa) * aa;
+	if (linesize > aa) { aa = linesize; }
+	offset = ((sizeof(Slab) + aa - 1) / aa) * aa;
+	minimum = offset + (increment * stride);
+	for (extent = pagesize; extent < minimum; extent <<= 1) {
+		/* Do nothing. */
+	}
+}
+
+BaseWell::Slab * BaseWell::slab() {
+	void * memory;
+	Slab * sp;
+	if (posix_memalign(&memory, extent, extent) != 0) {
+		sp = static_cast<Slab *>(0);
+	} else {
+		sp = static_cast<Slab *>(memory);
+		sp->well = this;
+		sp->next = static_cast<Slab *>(0);
+		sp->previous = static_cast<Slab *>(0);
+		sp->free = static_cast<void *>(0);
+		sp->fresh = static_cast<char *>(memory) + offset;
+		sp->used = 0;
+		sp->listed = false;
+		++slabs;
+		++idle;
+		link(sp, true);
+	}
+	return sp;
+}
+
+void BaseWell::unlink(Slab * sp) {
+	if (sp->previous != static_cast<Slab *>(0)) {
+		sp->previous->next = sp->next;
+	} else {
+		head = sp->next;
+	}
+	if (sp->next != static_cast<Slab *>(0)) {
+		sp->next->previous = sp->previous;
+	} else {
+		tail = sp->previous;
+	}
+	sp->next = static_cast<Slab *>(0);
+	sp->previous = static_cast<Slab *>(0);
+	sp->listed = false;
+}
+
+void BaseWell::link(Slab * sp, bool end) {
+	if (end) {
+		sp->next = static_cast<Slab *>(0);
+		sp->previous = tail;
+		if (tail != static_cast<Slab *>(0)) {
+			tail->next = sp;
+		} else {
+			head = sp;
+		}
+		tail = sp;
+	} else {
+		sp->next = head;
+		sp->previous = static_cast<Slab *>(0);
+		if (head != static_cast<Slab *>(0)) {
+			head->previous = sp;
+		} else {
+			tail = sp;
+		}
+		head = sp;
+	}
+	sp->listed = true;
 }
 
 /*******************************************************************************
  * SAFE BASE WELL
  ******************************************************************************/
 
-SafeBaseWell::SafeBaseWell(size_t ss, size_t cc, bool mm, size_t aa, size_t pp, size_t ll)
-: BaseWell(ss, cc, mm, aa, pp, ll)
+SafeBaseWell::SafeBaseWell(size_t ss, size_t cc, bool mm, size_t aa, size_t pp, size_t ll, size_t ee, size_t hh)
+: BaseWell(ss, cc, mm, aa, pp, ll, ee, hh)
 {
 	pthread_mutex_init(&mutex, (pthread_mutexattr_t *)0);
 }
@@ -130,6 +313,250 @@ void SafeBaseWell::free(void * pointer) {
 	DIMINUTO_CRITICAL_SECTION_END;
 }
 
+/*******************************************************************************
+ * CACHED SAFE BASE WELL
+ ******************************************************************************/
+
+CachedSafeBaseWell::CachedSafeBaseWell(size_t ss, size_t cc, bool mm, size_t aa, size_t pp, size_t ll, size_t rr, size_t ee, size_t hh)
+: SafeBaseWell(ss, cc, mm, aa, pp, ll, ee, hh)
+, capacity((rr > 0) ? rr : static_cast<size_t>(ROUNDS))
+, full(static_cast<Magazine *>(0))
+, empty(static_cast<Magazine *>(0))
+, caches(static_cast<Cache *>(0))
+, keyed(pthread_key_create(&key, &CachedSafeBaseWell::destructor) == 0)
+{}
+
+CachedSafeBaseWell::~CachedSafeBaseWell() {
+	Cache * cp;
+	/*
+	 * Once the key is deleted no thread exit will call the destructor, so
+	 * the caches of all threads, not just this one, can be taken back.
+	 */
+	if (keyed) {
+		pthread_key_delete(key);
+		keyed = false;
+	}
+	DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+		while (caches != static_cast<Cache *>(0)) {
+			cp = caches;
+			release(cp);
+			discard(cp);
+		}
+	DIMINUTO_CRITICAL_SECTION_END;
+	fini();
+}
+
+CachedSafeBaseWell::Magazine * CachedSafeBaseWell::magazine() {
+	Magazine * mp;
+	mp = new(std::nothrow) Magazine;
+	if (mp == static_cast<Magazine *>(0)) {
+		/* Do nothing. */
+	} else if ((mp->round = new(std::nothrow) void * [capacity]) == static_cast<void **>(0)) {
+		delete mp;
+		mp = static_cast<Magazine *>(0);
+	} else {
+		mp->next = static_cast<Magazine *>(0);
+		mp->rounds = 0;
+	}
+	return mp;
+}
+
+CachedSafeBaseWell::Cache * CachedSafeBaseWell::cache() {
+	Cache * cp = static_cast<Cache *>(0);
+	if (!keyed) {
+		/* Do nothing. */
+	} else if ((cp = static_cast<Cache *>(pthread_getspecific(key))) != static_cast<Cache *>(0)) {
+		/* Do nothing. */
+	} else if ((cp = new(std::nothrow) Cache) == static_cast<Cache *>(0)) {
+		/* Do nothing. */
+	} else {
+		cp->well = this;
+		cp->loaded = magazine();
+		cp->previous = magazine();
+		DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+			cp->before = static_cast<Cache *>(0);
+			cp->after = caches;
+			if (caches != static_cast<Cache *>(0)) {
+				caches->before = cp;
+			}
+			caches = cp;
+		DIMINUTO_CRITICAL_SECTION_END;
+		if ((cp->loaded == static_cast<Magazine *>(0)) || (cp->previous == static_cast<Magazine *>(0)) || (pthread_setspecific(key, cp) != 0)) {
+			drain(cp);
+			cp = static_cast<Cache *>(0);
+		}
+	}
+	return cp;
+}
+
+void CachedSafeBaseWell::release(Cache * cp) {
+	Magazine * mm[2] = { cp->loaded, cp->previous };
+	size_t ii;
+	for (ii = 0; ii < (sizeof(mm) / sizeof(mm[0])); ++ii) {
+		if (mm[ii] != static_cast<Magazine *>(0)) {
+			while (mm[ii]->rounds > 0) {
+				BaseWell::free(mm[ii]->round[--(mm[ii]->rounds)]);
+			}
+		}
+	}
+	if (cp->before != static_cast<Cache *>(0)) {
+		cp->before->after = cp->after;
+	} else {
+		caches = cp->after;
+	}
+	if (cp->after != static_cast<Cache *>(0)) {
+		cp->after->before = cp->before;
+	}
+}
+
+void CachedSafeBaseWell::discard(Cache * cp) {
+	Magazine * mm[2] = { cp->loaded, cp->previous };
+	size_t ii;
+	for (ii = 0; ii < (sizeof(mm) / sizeof(mm[0])); ++ii) {
+		if (mm[ii] != static_cast<Magazine *>(0)) {
+			delete [] mm[ii]->round;
+			delete mm[ii];
+		}
+	}
+	delete cp;
+}
+
+void CachedSafeBaseWell::drain(Cache * cp) {
+	DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+		release(cp);
+	DIMINUTO_CRITICAL_SECTION_END;
+	discard(cp);
+}
+
+void CachedSafeBaseWell::destructor(void * pointer) {
+	Cache * cp = static_cast<Cache *>(pointer);
+	cp->well->drain(cp);
+}
+
+void CachedSafeBaseWell::flush() {
+	Cache * cp;
+	if (!keyed) {
+		/* Do nothing. */
+	} else if ((cp = static_cast<Cache *>(pthread_getspecific(key))) == static_cast<Cache *>(0)) {
+		/* Do nothing. */
+	} else {
+		pthread_setspecific(key, static_cast<void *>(0));
+		drain(cp);
+	}
+}
+
+void CachedSafeBaseWell::fini() {
+	Magazine * mp;
+	flush();
+	DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+		while (full != static_cast<Magazine *>(0)) {
+			mp = full;
+			full = mp->next;
+			while (mp->rounds > 0) {
+				BaseWell::free(mp->round[--(mp->rounds)]);
+			}
+			mp->next = empty;
+			empty = mp;
+		}
+		while (empty != static_cast<Magazine *>(0)) {
+			mp = empty;
+			empty = mp->next;
+			delete [] mp->round;
+			delete mp;
+		}
+		BaseWell::fini();
+	DIMINUTO_CRITICAL_SECTION_END;
+}
+
+void * CachedSafeBaseWell::alloc() {
+	Cache * cp;
+	Magazine * mp;
+	if ((cp = cache()) == static_cast<Cache *>(0)) {
+		return SafeBaseWell::alloc();
+	}
+	if (cp->loaded->rounds > 0) {
+		return cp->loaded->round[--(cp->loaded->rounds)];
+	}
+	if (cp->previous->rounds > 0) {
+		mp = cp->loaded;
+		cp->loaded = cp->previous;
+		cp->previous = mp;
+		return cp->loaded->round[--(cp->loaded->rounds)];
+	}
+	/*
+	 * Both magazines are empty. Trade the previous one for a full one from
+	 * the depot if there is one, or fill the loaded one from the well in one
+	 * batch if there is not.
+	 */
+	DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+		if (full != static_cast<Magazine *>(0)) {
+			mp = full;
+			full = mp->next;
+			cp->previous->next = empty;
+			empty = cp->previous;
+			cp->previous = cp->loaded;
+			cp->loaded = mp;
+		} else {
+			while (cp->loaded->rounds < capacity) {
+				void * that = BaseWell::alloc();
+				if (that == static_cast<void *>(0)) { break; }
+				cp->loaded->round[(cp->loaded->rounds)++] = that;
+			}
+		}
+	DIMINUTO_CRITICAL_SECTION_END;
+	return (cp->loaded->rounds > 0) ? cp->loaded->round[--(cp->loaded->rounds)] : static_cast<void *>(0);
+}
+
+void CachedSafeBaseWell::free(void * pointer) {
+	Cache * cp;
+	Magazine * mp;
+	if (pointer == static_cast<void *>(0)) {
+		return;
+	}
+	if ((cp = cache()) == static_cast<Cache *>(0)) {
+		SafeBaseWell::free(pointer);
+		return;
+	}
+	if (cp->loaded->rounds < capacity) {
+		cp->loaded->round[(cp->loaded->rounds)++] = pointer;
+		return;
+	}
+	if (cp->previous->rounds == 0) {
+		mp = cp->loaded;
+		cp->loaded = cp->previous;
+		cp->previous = mp;
+		cp->loaded->round[(cp->loaded->rounds)++] = pointer;
+		return;
+	}
+	/*
+	 * Both magazines are full. Trade the previous one for an empty one from
+	 * the depot, or for a newly allocated one if the depot has none.
+	 */
+	mp = static_cast<Magazine *>(0);
+	DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+		if (empty != static_cast<Magazine *>(0)) {
+			mp = empty;
+			empty = mp->next;
+			cp->previous->next = full;
+			full = cp->previous;
+		}
+	DIMINUTO_CRITICAL_SECTION_END;
+	if (mp != static_cast<Magazine *>(0)) {
+		/* Do nothing. */
+	} else if ((mp = magazine()) == static_cast<Magazine *>(0)) {
+		SafeBaseWell::free(pointer);
+		return;
+	} else {
+		DIMINUTO_CRITICAL_SECTION_BEGIN(&mutex);
+			cp->previous->next = full;
+			full = cp->previous;
+		DIMINUTO_CRITICAL_SECTION_END;
+	}
+	cp->previous = cp->loaded;
+	cp->loaded = mp;
+	cp->loaded->round[(cp->loaded->rounds)++] = pointer;
+}
+
   }
  }
 }
@@ -0,0 +1,276 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2017 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock <coverclock@diag.com><BR>
+ * http://www.diag.com/navigation/downloads/Grandote.html<BR>
+ *
+ * Compares ways of walking a chain of links (the second argument, default
+ * one hundred thousand) and summing a value in each payload, repeated a
+ * number of times (the third argument, default one hundred): Link::apply
+ * with a virtual Functor (test 0), Chain::forEach with an inlined functor
+ * (test 1), the virtual Chain::peekFirst and peekNext (test 2), the inline
+ * FastChain::peekFirst and peekNext (test 3), and FastChain::forEach (test
+ * 4). Tests 5 and 6 remove and reinsert every other link, using a virtual
+ * Functor with Link::apply and Chain::removeNext, and Chain::removeIf. The
+ * first argument is a mask of the tests to run.
+ */
+
+extern "C" {
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_countof.h"
+#include "com/diag/diminuto/diminuto_time.h"
+#include "com/diag/diminuto/diminuto_frequency.h"
+}
+
+#include "com/diag/grandote/Chain.h"
+#include "com/diag/grandote/FastChain.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+enum {
+	LINKS = 100000,
+	REPEATS = 100,
+};
+
+using namespace com::diag::grandote;
+
+struct Item {
+	Item() : value(0), node(this) {}
+	uint64_t value;
+	Link node;
+};
+
+static uint64_t value(Link * link) {
+	return static_cast<Item *>(link->getPayload())->value;
+}
+
+/*
+ * Walks forward from the first link until it comes back to the root.
+ */
+class Applied : public Link::Functor {
+public:
+	explicit Applied(Link * r) : root(r), sum(0) {}
+	virtual ~Applied() {}
+	virtual Link * operator() (Link * link) {
+		Link * next = link->getNext();
+		sum += value(link);
+		return (next == root) ? 0 : next;
+	}
+	Link * root;
+	uint64_t sum;
+};
+
+class Summed {
+public:
+	Summed() : sum(0) {}
+	bool operator() (Link * link) {
+		sum += value(link);
+		return true;
+	}
+	uint64_t sum;
+};
+
+/*
+ * Removes every other link, starting with the first, by removing the link
+ * after the one it was passed and moving on to the one after that.
+ */
+class Remover : public Link::Functor {
+public:
+	Remover(Chain & c, Link ** v) : chain(c), removed(v), count(0) {}
+	virtual ~Remover() {}
+	virtual Link * operator() (Link * link) {
+		Link * gone = chain.removeNext(link);
+		if (gone == 0) {
+			return 0;
+		}
+		removed[count++] = gone;
+		Link * next = chain.peekNext(link);
+		return (next == 0) ? 0 : next;
+	}
+	Chain & chain;
+	Link ** removed;
+	size_t count;
+};
+
+class Odd {
+public:
+	explicit Odd(Link ** v) : removed(v), count(0), odd(false) {}
+	bool operator() (Link * link) {
+		odd = !odd;
+		if (!odd) {
+			return false;
+		}
+		removed[count++] = link;
+		return true;
+	}
+	Link ** removed;
+	size_t count;
+	bool odd;
+};
+
+static void report(int test, const char * name, diminuto_ticks_t then, diminuto_ticks_t frequency, size_t links, size_t repeats, uint64_t sum) {
+	double seconds = (double)(diminuto_time_elapsed() - then) / frequency;
+	DIMINUTO_LOG_DEBUG("TEST %d: %-24s %12.9lf seconds %8.3lf ns/link sum=%llu\n", test, name, seconds, (seconds * 1000000000.0) / (links * repeats), (unsigned long long)sum);
+}
+
+int main(int argc, char ** argv) {
+	Item * items;
+	Link ** removed;
+	Chain * chain;
+	FastChain * fastchain;
+	size_t links;
+	size_t repeats;
+	size_t ii;
+	size_t rr;
+	uint64_t sum;
+	uint64_t expected;
+	int mask;
+	int test;
+	diminuto_ticks_t time;
+	diminuto_ticks_t frequency;
+
+	SETLOGMASK();
+
+	mask = (argc < 2) ? ~0 : atoi(argv[1]);
+	links = (argc < 3) ? (size_t)LINKS : strtoul(argv[2], (char **)0, 0);
+	repeats = (argc < 4) ? (size_t)REPEATS : strtoul(argv[3], (char **)0, 0);
+	ASSERT(links > 1);
+
+	frequency = diminuto_frequency();
+
+	items = new Item[links];
+	removed = new Link * [links];
+	chain = new Chain;
+	fastchain = new FastChain;
+	expected = 0;
+	for (ii = 0; ii < links; ++ii) {
+		items[ii].value = ii;
+		expected += ii;
+		chain->insertLast(&items[ii].node);
+	}
+	expected *= repeats;
+
+	test = 0;
+	if ((mask & (1 << test)) != 0) {
+		sum = 0;
+		time = diminuto_time_elapsed();
+		for (rr = 0; rr < repeats; ++rr) {
+			Applied functor(chain);
+			chain->peekFirst()->apply(functor);
+			sum += functor.sum;
+		}
+		report(test, "Link::apply", time, frequency, links, repeats, sum);
+		ASSERT(sum == expected);
+	}
+
+	test = 1;
+	if ((mask & (1 << test)) != 0) {
+		sum = 0;
+		time = diminuto_time_elapsed();
+		for (rr = 0; rr < repeats; ++rr) {
+			Summed functor;
+			chain->forEach(functor);
+			sum += functor.sum;
+		}
+		report(test, "Chain::forEach", time, frequency, links, repeats, sum);
+		ASSERT(sum == expected);
+	}
+
+	test = 2;
+	if ((mask & (1 << test)) != 0) {
+		sum = 0;
+		time = diminuto_time_elapsed();
+		for (rr = 0; rr < repeats; ++rr) {
+			for (Link * link = chain->peekFirst(); link != 0; link = chain->peekNext(link)) {
+				sum += value(link);
+			}
+		}
+		report(test, "Chain::peekNext", time, frequency, links, repeats, sum);
+		ASSERT(sum == expected);
+	}
+
+	for (ii = 0; ii < links; ++ii) {
+		items[ii].node.remove();
+		fastchain->insertLast(&items[ii].node);
+	}
+
+	test = 3;
+	if ((mask & (1 << test)) != 0) {
+		sum = 0;
+		time = diminuto_time_elapsed();
+		for (rr = 0; rr < repeats; ++rr) {
+			for (Link * link = fastchain->peekFirst(); link != 0; link = fastchain->peekNext(link)) {
+				sum += value(link);
+			}
+		}
+		report(test, "FastChain::peekNext", time, frequency, links, repeats, sum);
+		ASSERT(sum == expected);
+	}
+
+	test = 4;
+	if ((mask & (1 << test)) != 0) {
+		sum = 0;
+		time = diminuto_time_elapsed();
+		for (rr = 0; rr < repeats; ++rr) {
+			Summed functor;
+			fastchain->forEach(functor);
+			sum += functor.sum;
+		}
+		report(test, "FastChain::forEach", time, frequency, links, repeats, sum);
+		ASSERT(sum == expected);
+	}
+
+	for (ii = 0; ii < links; ++ii) {
+		items[ii].node.remove();
+		chain->insertLast(&items[ii].node);
+	}
+
+	test = 5;
+	if ((mask & (1 << test)) != 0) {
+		sum = 0;
+		time = diminuto_time_elapsed();
+		for (rr = 0; rr < repeats; ++rr) {
+			Remover functor(*chain, removed);
+			chain->apply(functor);
+			for (ii = 0; ii < functor.count; ++ii) {
+				chain->insertLast(removed[ii]);
+			}
+			sum += functor.count;
+		}
+		report(test, "Link::apply removeNext", time, frequency, links, repeats, sum);
+		ASSERT(sum == ((links / 2) * repeats));
+	}
+
+	for (ii = 0; ii < links; ++ii) {
+		items[ii].node.remove();
+		chain->insertLast(&items[ii].node);
+	}
+
+	test = 6;
+	if ((mask & (1 << test)) != 0) {
+		sum = 0;
+		time = diminuto_time_elapsed();
+		for (rr = 0; rr < repeats; ++rr) {
+			Odd functor(removed);
+			chain->removeIf(functor);
+			for (ii = 0; ii < functor.count; ++ii) {
+				chain->insertLast(removed[ii]);
+			}
+			sum += functor.count;
+		}
+		report(test, "Chain::removeIf", time, frequency, links, repeats, sum);
+		ASSERT(sum == (((links + 1) / 2) * repeats));
+	}
+
+	delete fastchain;
+	delete chain;
+	delete [] removed;
+	delete [] items;
+
+	EXIT();
+}
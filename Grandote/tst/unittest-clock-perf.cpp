@@ -0,0 +1,155 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2017 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock <coverclock@diag.com><BR>
+ * http://www.diag.com/navigation/downloads/Grandote.html<BR>
+ *
+ * Measures the cost in nanoseconds per call of reading the time, and the
+ * smallest step between successive readings. Tests 0 through 2 call
+ * gettimeofday(2), clock_gettime(2) with CLOCK_MONOTONIC, and clock_gettime(2)
+ * with CLOCK_MONOTONIC_COARSE directly. Tests 3 through 5 call
+ * Platform::time() through a reference held by the caller with the Linux
+ * platform set to its REALTIME, MONOTONIC, and COARSE clocks; on other
+ * platforms only test 3 is run, with the clock of that platform. Test 6
+ * calls Platform::instance().time(), which also locks the singleton. The
+ * first argument is a mask of the tests to run, the second the number of
+ * calls per test (default four million).
+ */
+
+extern "C" {
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_countof.h"
+#include "com/diag/diminuto/diminuto_time.h"
+#include "com/diag/diminuto/diminuto_frequency.h"
+}
+
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/Linux.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/time.h>
+
+enum {
+	CALLS = 1 << 22,
+	TESTS = 7,
+};
+
+#if !defined(CLOCK_MONOTONIC_COARSE)
+#	define CLOCK_MONOTONIC_COARSE CLOCK_MONOTONIC
+#endif
+
+using namespace com::diag::grandote;
+
+static ticks_t gettimeofdaytime(void) {
+	struct timeval tv;
+	gettimeofday(&tv, (struct timezone *)0);
+	return ((ticks_t)tv.tv_sec * 1000000ULL) + tv.tv_usec;
+}
+
+static ticks_t monotonictime(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((ticks_t)ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+}
+
+static ticks_t coarsetime(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+	return ((ticks_t)ts.tv_sec * 1000000000ULL) + ts.tv_nsec;
+}
+
+static ticks_t platformtime(void) {
+	static Platform & platform = Platform::instance();
+	return platform.time();
+}
+
+static ticks_t instancetime(void) {
+	return Platform::instance().time();
+}
+
+int main(int argc, char ** argv) {
+	static ticks_t (* const readers[TESTS])(void) = { gettimeofdaytime, monotonictime, coarsetime, platformtime, platformtime, platformtime, instancetime };
+	static const ticks_t hertz[3] = { 1000000, 1000000000, 1000000000 };
+	static const char * const names[TESTS] = { "gettimeofday", "CLOCK_MONOTONIC", "CLOCK_MONOTONIC_COARSE", "Platform::time", "Platform::time MONOTONIC", "Platform::time COARSE", "Platform::instance().time" };
+	ticks_t (* reader)(void);
+	size_t calls;
+	size_t ii;
+	size_t steps;
+	int mask;
+	int test;
+	ticks_t hz;
+	ticks_t then;
+	ticks_t now;
+	ticks_t step;
+	ticks_t smallest;
+	diminuto_ticks_t time;
+	diminuto_ticks_t frequency;
+	double seconds;
+
+	SETLOGMASK();
+
+	mask = (argc < 2) ? ~0 : atoi(argv[1]);
+	calls = (argc < 3) ? (size_t)CALLS : strtoul(argv[2], (char **)0, 0);
+	ASSERT(calls > 0);
+
+	frequency = diminuto_frequency();
+
+	DIMINUTO_LOG_DEBUG("TEST: platform=\"%s\" frequency=%llu calls=%zu\n", Platform::instance().platform(), (unsigned long long)Platform::instance().frequency(), calls);
+
+	for (test = 0; test < TESTS; ++test) {
+
+		if ((mask & (1 << test)) == 0) {
+			continue;
+		}
+
+#if defined(GRANDOTE_PLATFORM_IS_Linux)
+		{
+			static const Linux::Clock clocks[TESTS] = { Linux::REALTIME, Linux::REALTIME, Linux::REALTIME, Linux::REALTIME, Linux::MONOTONIC, Linux::COARSE, Linux::MONOTONIC };
+			Linux & platform = static_cast<Linux &>(Platform::instance());
+			platform.setClock(clocks[test]);
+		}
+#else
+		if ((test == 4) || (test == 5)) {
+			DIMINUTO_LOG_DEBUG("TEST %d: SKIP %s\n", test, names[test]);
+			continue;
+		}
+#endif
+
+		reader = readers[test];
+		hz = (test < (int)countof(hertz)) ? hertz[test] : Platform::instance().frequency();
+
+		DIMINUTO_LOG_DEBUG("TEST %d: BEGIN %s\n", test, names[test]);
+
+		steps = 0;
+		smallest = 0;
+		then = (*reader)();
+		time = diminuto_time_elapsed();
+		for (ii = 0; ii < calls; ++ii) {
+			now = (*reader)();
+			if (now != then) {
+				step = now - then;
+				if ((smallest == 0) || (step < smallest)) {
+					smallest = step;
+				}
+				++steps;
+				then = now;
+			}
+		}
+		seconds = (double)(diminuto_time_elapsed() - time) / frequency;
+
+		DIMINUTO_LOG_DEBUG("TEST %d: END %12.9lf seconds %8.3lf ns/call steps=%zu step=%.0lfns\n", test, seconds, (seconds * 1000000000.0) / calls, steps, (smallest * 1000000000.0) / hz);
+
+	}
+
+#if defined(GRANDOTE_PLATFORM_IS_Linux)
+	static_cast<Linux &>(Platform::instance()).setClock(Linux::REALTIME);
+#endif
+
+	EXIT();
+}
@@ -0,0 +1,140 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2017 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock <coverclock@diag.com><BR>
+ * http://www.diag.com/navigation/downloads/Grandote.html<BR>
+ *
+ * Compares policing many flows with one GcraTable (test 0) against one
+ * heap allocated Gcra per flow called through its Throttle interface
+ * (test 1). Both police the same pseudo-random sequence of events, in
+ * batches that all share a timestamp, and must reach the same verdicts.
+ * The first argument is a mask of the tests to run, the second the number
+ * of flows (default one hundred thousand).
+ */
+
+extern "C" {
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_countof.h"
+#include "com/diag/diminuto/diminuto_time.h"
+#include "com/diag/diminuto/diminuto_frequency.h"
+}
+
+#include "com/diag/grandote/GcraTable.h"
+#include "com/diag/grandote/Gcra.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+enum {
+	FLOWS = 100000,
+	EVENTS = 1 << 22,
+	BATCH = 64,
+	INCREMENT = 1000,
+	LIMIT = 4000,
+	STEP = 1,
+};
+
+using namespace com::diag::grandote;
+
+static void report(int test, diminuto_ticks_t then, diminuto_ticks_t frequency, size_t events, size_t admitted) {
+	double seconds = (double)(diminuto_time_elapsed() - then) / frequency;
+	DIMINUTO_LOG_DEBUG("TEST %d: END %12.9lf seconds %8.3lf ns/event admitted=%zu\n", test, seconds, (seconds * 1000000000.0) / events, admitted);
+}
+
+int main(int argc, char ** argv) {
+	size_t * flows;
+	size_t * sizes;
+	bool * verdicts;
+	size_t * admitted;
+	size_t count;
+	size_t total;
+	size_t ii;
+	size_t jj;
+	int mask;
+	int test;
+	ticks_t now;
+	diminuto_ticks_t time;
+	diminuto_ticks_t frequency;
+
+	SETLOGMASK();
+
+	mask = (argc < 2) ? ~0 : atoi(argv[1]);
+	count = (argc < 3) ? (size_t)FLOWS : strtoul(argv[2], (char **)0, 0);
+	ASSERT(count > 0);
+
+	frequency = diminuto_frequency();
+
+	flows = new size_t[EVENTS];
+	sizes = new size_t[EVENTS];
+	verdicts = new bool[EVENTS];
+	admitted = new size_t[2];
+	srand(3);
+	for (ii = 0; ii < EVENTS; ++ii) {
+		flows[ii] = rand() % count;
+		sizes[ii] = 1 + (rand() % 3);
+	}
+
+	test = 0;
+	if ((mask & (1 << test)) != 0) {
+		GcraTable table(count);
+		for (ii = 0; ii < count; ++ii) {
+			table.configure(ii, INCREMENT + (ii % 7), LIMIT, 0);
+		}
+		DIMINUTO_LOG_DEBUG("TEST %d: BEGIN GcraTable flows=%zu events=%d batch=%d\n", test, count, EVENTS, BATCH);
+		total = 0;
+		now = 0;
+		time = diminuto_time_elapsed();
+		for (ii = 0; ii < EVENTS; ii += BATCH) {
+			total += table.admit(&flows[ii], &sizes[ii], BATCH, now, &verdicts[ii]);
+			now += STEP;
+		}
+		report(test, time, frequency, EVENTS, total);
+		admitted[test] = total;
+	}
+
+	test = 1;
+	if ((mask & (1 << test)) != 0) {
+		Throttle ** throttles = new Throttle * [count];
+		for (ii = 0; ii < count; ++ii) {
+			throttles[ii] = new Gcra(INCREMENT + (ii % 7), LIMIT);
+			throttles[ii]->reset(0);
+		}
+		DIMINUTO_LOG_DEBUG("TEST %d: BEGIN Gcra flows=%zu events=%d batch=%d\n", test, count, EVENTS, BATCH);
+		total = 0;
+		now = 0;
+		time = diminuto_time_elapsed();
+		for (ii = 0; ii < EVENTS; ii += BATCH) {
+			for (jj = ii; jj < (ii + BATCH); ++jj) {
+				Throttle & throttle = *throttles[flows[jj]];
+				if (throttle.admissible(now) == 0) {
+					throttle.commit(sizes[jj]);
+					++total;
+				} else {
+					throttle.rollback();
+				}
+			}
+			now += STEP;
+		}
+		report(test, time, frequency, EVENTS, total);
+		admitted[test] = total;
+		for (ii = 0; ii < count; ++ii) {
+			delete throttles[ii];
+		}
+		delete [] throttles;
+	}
+
+	if ((mask & 0x3) == 0x3) {
+		ASSERT(admitted[0] == admitted[1]);
+	}
+
+	delete [] admitted;
+	delete [] verdicts;
+	delete [] sizes;
+	delete [] flows;
+
+	EXIT();
+}
@@ -0,0 +1,164 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2017 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock <coverclock@diag.com><BR>
+ * http://www.diag.com/navigation/downloads/Grandote.html<BR>
+ *
+ * Compares the intrusive HashTable (test 0) against std::map (test 1) and,
+ * since this library is C++03, the TR1 std::tr1::unordered_map (test 2),
+ * each mapping an integer key to an object. Each test inserts, finds, and
+ * removes the same keys, reporting the elapsed time of each phase. The first
+ * argument is a mask of the tests to run, the second the number of keys
+ * (default one million).
+ */
+
+extern "C" {
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_countof.h"
+#include "com/diag/diminuto/diminuto_time.h"
+#include "com/diag/diminuto/diminuto_frequency.h"
+}
+
+#include "com/diag/grandote/HashTable.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <map>
+#include <tr1/unordered_map>
+
+enum {
+	KEYS = 1000000,
+};
+
+using namespace com::diag::grandote;
+
+struct Entry {
+	Entry() : node(this) {}
+	HashNode<uint64_t, Entry> node;
+};
+
+typedef HashTable<uint64_t, Entry> Table;
+
+typedef std::map<uint64_t, Entry *> Map;
+
+typedef std::tr1::unordered_map<uint64_t, Entry *> UnorderedMap;
+
+static uint64_t key(size_t index) {
+	return (index * 0x9e3779b97f4a7c15ULL) >> 20;
+}
+
+static void report(int test, const char * phase, diminuto_ticks_t then, diminuto_ticks_t frequency, size_t keys) {
+	double seconds = (double)(diminuto_time_elapsed() - then) / frequency;
+	DIMINUTO_LOG_DEBUG("TEST %d: %-6s %12.9lf seconds %8.3lf ns/op\n", test, phase, seconds, (seconds * 1000000000.0) / keys);
+}
+
+template <typename _MAP_>
+static size_t stl(int test, _MAP_ & map, Entry * objects, size_t keys, diminuto_ticks_t frequency) {
+	typename _MAP_::iterator here;
+	diminuto_ticks_t time;
+	size_t found = 0;
+	size_t ii;
+
+	time = diminuto_time_elapsed();
+	for (ii = 0; ii < keys; ++ii) {
+		map.insert(typename _MAP_::value_type(key(ii), &objects[ii]));
+	}
+	report(test, "insert", time, frequency, keys);
+
+	time = diminuto_time_elapsed();
+	for (ii = 0; ii < keys; ++ii) {
+		here = map.find(key(ii));
+		if ((here != map.end()) && (here->second == &objects[ii])) {
+			++found;
+		}
+	}
+	report(test, "find", time, frequency, keys);
+
+	time = diminuto_time_elapsed();
+	for (ii = 0; ii < keys; ++ii) {
+		map.erase(key(ii));
+	}
+	report(test, "remove", time, frequency, keys);
+
+	return found;
+}
+
+int main(int argc, char ** argv) {
+	Entry * objects;
+	size_t keys;
+	size_t found;
+	size_t ii;
+	int mask;
+	int test;
+	diminuto_ticks_t time;
+	diminuto_ticks_t frequency;
+
+	SETLOGMASK();
+
+	mask = (argc < 2) ? ~0 : atoi(argv[1]);
+	keys = (argc < 3) ? (size_t)KEYS : strtoul(argv[2], (char **)0, 0);
+	ASSERT(keys > 0);
+
+	frequency = diminuto_frequency();
+
+	objects = new Entry[keys];
+	for (ii = 0; ii < keys; ++ii) {
+		objects[ii].node.setKey(key(ii));
+	}
+
+	test = 0;
+	if ((mask & (1 << test)) != 0) {
+		Table table;
+		DIMINUTO_LOG_DEBUG("TEST %d: BEGIN HashTable keys=%zu\n", test, keys);
+		time = diminuto_time_elapsed();
+		for (ii = 0; ii < keys; ++ii) {
+			table.insert(objects[ii].node);
+		}
+		report(test, "insert", time, frequency, keys);
+		ASSERT(table.size() == keys);
+		found = 0;
+		time = diminuto_time_elapsed();
+		for (ii = 0; ii < keys; ++ii) {
+			if (table.find(key(ii)) == &objects[ii].node) {
+				++found;
+			}
+		}
+		report(test, "find", time, frequency, keys);
+		time = diminuto_time_elapsed();
+		for (ii = 0; ii < keys; ++ii) {
+			table.remove(key(ii));
+		}
+		report(test, "remove", time, frequency, keys);
+		ASSERT(found == keys);
+		ASSERT(table.empty());
+		DIMINUTO_LOG_DEBUG("TEST %d: END buckets=%zu\n", test, table.buckets());
+	}
+
+	test = 1;
+	if ((mask & (1 << test)) != 0) {
+		Map map;
+		DIMINUTO_LOG_DEBUG("TEST %d: BEGIN std::map keys=%zu\n", test, keys);
+		found = stl(test, map, objects, keys, frequency);
+		ASSERT(found == keys);
+		ASSERT(map.empty());
+		DIMINUTO_LOG_DEBUG("TEST %d: END\n", test);
+	}
+
+	test = 2;
+	if ((mask & (1 << test)) != 0) {
+		UnorderedMap map;
+		DIMINUTO_LOG_DEBUG("TEST %d: BEGIN std::tr1::unordered_map keys=%zu\n", test, keys);
+		found = stl(test, map, objects, keys, frequency);
+		ASSERT(found == keys);
+		ASSERT(map.empty());
+		DIMINUTO_LOG_DEBUG("TEST %d: END\n", test);
+	}
+
+	delete [] objects;
+
+	EXIT();
+}
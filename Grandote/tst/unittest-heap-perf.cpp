@@ -0,0 +1,118 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2013-2017 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock <coverclock@diag.com><BR>
+ * http://www.diag.com/navigation/downloads/Grandote.html<BR>
+ *
+ * Compares the Heap with size class segregation turned off (every block
+ * allocated with the C++ new operator) against the Heap with it turned on
+ * (small blocks allocated from per size class wells), for fixed size
+ * blocks, for mixed size blocks, and for a block grown by realloc. The
+ * argument is a mask of the tests to run.
+ */
+
+extern "C" {
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_countof.h"
+#include "com/diag/diminuto/diminuto_time.h"
+#include "com/diag/diminuto/diminuto_frequency.h"
+}
+
+#include "com/diag/grandote/Heap.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+enum {
+	ITERATIONS = 10000,
+	CARDINALITY = 1000,
+	BYTES = 64,
+};
+
+using namespace com::diag::grandote;
+
+int main(int argc, char ** argv) {
+	void * block[CARDINALITY];
+	size_t ii;
+	size_t jj;
+	int mask;
+	int bit;
+	bool segregating;
+	diminuto_ticks_t time;
+	diminuto_ticks_t frequency;
+
+	SETLOGMASK();
+
+	mask = (argc < 2) ? ~0 : atoi(argv[1]);
+
+	frequency = diminuto_frequency();
+
+	for (bit = 0; bit < 6; ++bit) {
+
+		if ((mask & (1 << bit)) == 0) {
+			continue;
+		}
+
+		Heap heap;
+		segregating = ((bit % 2) != 0);
+		heap.segregate(segregating);
+
+		DIMINUTO_LOG_DEBUG("TEST %d: BEGIN segregating=%d\n", bit, segregating);
+		time = diminuto_time_thread();
+
+		switch (bit / 2) {
+
+		/* Fixed size blocks. */
+
+		case 0:
+			for (ii = 0; ii < ITERATIONS; ++ii) {
+				for (jj = 0; jj < countof(block); ++jj) {
+					block[jj] = heap.malloc(BYTES);
+					ASSERT(block[jj] != (void *)0);
+				}
+				for (jj = 0; jj < countof(block); ++jj) {
+					heap.free(block[jj]);
+				}
+			}
+			break;
+
+		/* Mixed size blocks. */
+
+		case 1:
+			for (ii = 0; ii < ITERATIONS; ++ii) {
+				for (jj = 0; jj < countof(block); ++jj) {
+					block[jj] = heap.malloc(((ii + jj) * 7) % 2048);
+					ASSERT(block[jj] != (void *)0);
+				}
+				for (jj = 0; jj < countof(block); ++jj) {
+					heap.free(block[jj]);
+				}
+			}
+			break;
+
+		/* Growing a block a byte at a time. */
+
+		case 2:
+			for (ii = 0; ii < (ITERATIONS / 10); ++ii) {
+				block[0] = (void *)0;
+				for (jj = 1; jj <= 2048; ++jj) {
+					block[0] = heap.realloc(block[0], jj);
+					ASSERT(block[0] != (void *)0);
+				}
+				heap.free(block[0]);
+			}
+			break;
+
+		}
+
+		DIMINUTO_LOG_DEBUG("TEST %d: END %12.9lf seconds\n", bit, (double)(diminuto_time_thread() - time) / frequency);
+		ASSERT(heap.getCurrent() == 0);
+
+	}
+
+	EXIT();
+}
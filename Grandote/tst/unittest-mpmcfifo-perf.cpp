@@ -0,0 +1,168 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2017 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock <coverclock@diag.com><BR>
+ * http://www.diag.com/navigation/downloads/Grandote.html<BR>
+ *
+ * Compares the lock-free MpmcFifo (test 0) against a Fifo guarded by a
+ * Mutex (test 1) with the same number of producer and consumer threads,
+ * doubling from one of each up to the maximum (the second argument, default
+ * sixteen). Every producer inserts, and every consumer removes, the same
+ * number of entries, and the elapsed time to move all of them is reported.
+ * The first argument is a mask of the tests to run.
+ */
+
+extern "C" {
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_countof.h"
+#include "com/diag/diminuto/diminuto_time.h"
+#include "com/diag/diminuto/diminuto_frequency.h"
+}
+
+#include "com/diag/grandote/MpmcFifo.h"
+#include "com/diag/grandote/NewFifo.h"
+#include "com/diag/grandote/Mutex.h"
+#include "com/diag/grandote/CriticalSection.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+
+enum {
+	ENTRIES = 1 << 20,
+	CAPACITY = 1024,
+	MAXIMUM = 16,
+};
+
+using namespace com::diag::grandote;
+
+static MpmcFifo<uint64_t> mpmcfifo(CAPACITY);
+
+static NewFifo<uint64_t> fifo(CAPACITY);
+
+static Mutex mutex;
+
+static void * mpmcproducer(void * arg) {
+	size_t batch = *static_cast<size_t *>(arg);
+	size_t ii;
+
+	for (ii = 0; ii < batch; ++ii) {
+		while (!mpmcfifo.insert(ii)) {
+			sched_yield();
+		}
+	}
+
+	return (void *)0;
+}
+
+static void * mpmcconsumer(void * arg) {
+	size_t batch = *static_cast<size_t *>(arg);
+	uint64_t entry;
+	size_t ii;
+
+	for (ii = 0; ii < batch; ++ii) {
+		while (!mpmcfifo.remove(entry)) {
+			sched_yield();
+		}
+	}
+
+	return (void *)0;
+}
+
+static void * fifoproducer(void * arg) {
+	size_t batch = *static_cast<size_t *>(arg);
+	size_t ii;
+	bool success;
+
+	for (ii = 0; ii < batch; ++ii) {
+		while (true) {
+			{
+				CriticalSection guard(mutex);
+				success = fifo.insert(ii);
+			}
+			if (success) {
+				break;
+			}
+			sched_yield();
+		}
+	}
+
+	return (void *)0;
+}
+
+static void * fifoconsumer(void * arg) {
+	size_t batch = *static_cast<size_t *>(arg);
+	uint64_t entry;
+	size_t ii;
+	bool success;
+
+	for (ii = 0; ii < batch; ++ii) {
+		while (true) {
+			{
+				CriticalSection guard(mutex);
+				success = fifo.remove(entry);
+			}
+			if (success) {
+				break;
+			}
+			sched_yield();
+		}
+	}
+
+	return (void *)0;
+}
+
+int main(int argc, char ** argv) {
+	static void * (* const producers[])(void *) = { mpmcproducer, fifoproducer };
+	static void * (* const consumers[])(void *) = { mpmcconsumer, fifoconsumer };
+	pthread_t producer[MAXIMUM];
+	pthread_t consumer[MAXIMUM];
+	size_t maximum;
+	size_t threads;
+	size_t batch;
+	size_t ii;
+	int mask;
+	int bit;
+	diminuto_ticks_t time;
+	diminuto_ticks_t frequency;
+
+	SETLOGMASK();
+
+	mask = (argc < 2) ? ~0 : atoi(argv[1]);
+	maximum = (argc < 3) ? (size_t)MAXIMUM : strtoul(argv[2], (char **)0, 0);
+	ASSERT((0 < maximum) && (maximum <= MAXIMUM));
+
+	frequency = diminuto_frequency();
+
+	for (bit = 0; bit < (int)countof(producers); ++bit) {
+
+		if ((mask & (1 << bit)) == 0) {
+			continue;
+		}
+
+		for (threads = 1; threads <= maximum; threads *= 2) {
+			batch = ENTRIES / threads;
+			DIMINUTO_LOG_DEBUG("TEST %d: BEGIN threads=%zu batch=%zu\n", bit, threads, batch);
+			time = diminuto_time_elapsed();
+			for (ii = 0; ii < threads; ++ii) {
+				ASSERT(pthread_create(&consumer[ii], (pthread_attr_t *)0, consumers[bit], &batch) == 0);
+				ASSERT(pthread_create(&producer[ii], (pthread_attr_t *)0, producers[bit], &batch) == 0);
+			}
+			for (ii = 0; ii < threads; ++ii) {
+				ASSERT(pthread_join(producer[ii], (void **)0) == 0);
+				ASSERT(pthread_join(consumer[ii], (void **)0) == 0);
+			}
+			DIMINUTO_LOG_DEBUG("TEST %d: END %12.9lf seconds\n", bit, (double)(diminuto_time_elapsed() - time) / frequency);
+			ASSERT(mpmcfifo.used() == 0);
+			ASSERT(fifo.used() == 0);
+		}
+
+	}
+
+	EXIT();
+}
@@ -0,0 +1,131 @@
+/* vi: set ts=4 expandtab shiftwidth=4: */
+/**
+ * @file
+ *
+ * Copyright 2017 Digital Aggregates Corporation, Colorado, USA<BR>
+ * Licensed under the terms in LICENSE.txt<BR>
+ * Chip Overclock <coverclock@diag.com><BR>
+ * http://www.diag.com/navigation/downloads/Grandote.html<BR>
+ *
+ * Measures the cost of each Shaper decision as the number of tenants
+ * grows, doubling from sixty-four up to the maximum (the first argument,
+ * default sixteen thousand three hundred eighty-four). The tenants are
+ * leaves of a two-level tree, a root over groups of sixty-four tenants,
+ * and every class is guarded by a Gcra whose limit tolerates a burst of
+ * one time step. The assured rates of the groups, and of the tenants, sum
+ * to half the rate of the root, so that about half of the packets are
+ * sent on borrowed bandwidth. Every tenant is kept backlogged, and the
+ * time advances in steps across which the root admits thirty-two packets,
+ * so most decisions change the modes of the classes on their path.
+ */
+
+extern "C" {
+#include "com/diag/diminuto/diminuto_unittest.h"
+#include "com/diag/diminuto/diminuto_log.h"
+#include "com/diag/diminuto/diminuto_countof.h"
+#include "com/diag/diminuto/diminuto_time.h"
+#include "com/diag/diminuto/diminuto_frequency.h"
+}
+
+#include "com/diag/grandote/Shaper.h"
+#include "com/diag/grandote/Gcra.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+enum {
+	MAXIMUM = 16384,
+	GROUP = 64,
+	BYTES = 1000,
+	DECISIONS = 1 << 20,
+	ROOT = 1,
+	STEP = 32 * BYTES * ROOT,
+};
+
+using namespace com::diag::grandote;
+
+int main(int argc, char ** argv) {
+	size_t maximum;
+	size_t tenants;
+	size_t groups;
+	size_t decisions;
+	size_t borrowed;
+	size_t ii;
+	ticks_t now;
+	diminuto_ticks_t time;
+	diminuto_ticks_t frequency;
+	double seconds;
+
+	SETLOGMASK();
+
+	maximum = (argc < 2) ? (size_t)MAXIMUM : strtoul(argv[1], (char **)0, 0);
+	ASSERT(maximum >= GROUP);
+
+	frequency = diminuto_frequency();
+
+	for (tenants = GROUP; tenants <= maximum; tenants *= 2) {
+		groups = tenants / GROUP;
+
+		Gcra * rootrate = new Gcra(ROOT, STEP);
+		Gcra ** grouprate = new Gcra * [groups];
+		Gcra ** tenantrate = new Gcra * [tenants];
+		ShaperClass * root = new ShaperClass(0, *rootrate, BYTES);
+		ShaperClass ** group = new ShaperClass * [groups];
+		ShaperClass ** tenant = new ShaperClass * [tenants];
+		ShaperPacket * packet = new ShaperPacket[tenants];
+		Shaper * shaper = new Shaper;
+
+		rootrate->reset(0);
+		for (ii = 0; ii < groups; ++ii) {
+			grouprate[ii] = new Gcra(ROOT * groups * 2, STEP);
+			grouprate[ii]->reset(0);
+			group[ii] = new ShaperClass(root, *grouprate[ii], BYTES);
+		}
+		for (ii = 0; ii < tenants; ++ii) {
+			tenantrate[ii] = new Gcra(ROOT * tenants * 2, STEP);
+			tenantrate[ii]->reset(0);
+			tenant[ii] = new ShaperClass(group[ii / GROUP], *tenantrate[ii], BYTES);
+			packet[ii].setPayload(tenant[ii]);
+			packet[ii].setSize(BYTES);
+			ASSERT(shaper->enqueue(*tenant[ii], packet[ii], 0));
+		}
+
+		DIMINUTO_LOG_DEBUG("TEST: BEGIN tenants=%zu groups=%zu\n", tenants, groups);
+		decisions = 0;
+		now = 0;
+		time = diminuto_time_elapsed();
+		while (decisions < DECISIONS) {
+			ShaperPacket * sent;
+			while ((sent = shaper->dequeue(now)) != 0) {
+				ASSERT(shaper->enqueue(*static_cast<ShaperClass *>(sent->getPayload()), *sent, now));
+				++decisions;
+			}
+			now += STEP;
+		}
+		seconds = (double)(diminuto_time_elapsed() - time) / frequency;
+		borrowed = 0;
+		for (ii = 0; ii < tenants; ++ii) {
+			borrowed += tenant[ii]->getBorrowed();
+		}
+		DIMINUTO_LOG_DEBUG("TEST: END %12.9lf seconds %8.3lf ns/decision borrowed=%zu/%zu\n", seconds, (seconds * 1000000000.0) / decisions, borrowed, decisions);
+
+		delete shaper;
+		delete [] packet;
+		for (ii = 0; ii < tenants; ++ii) {
+			delete tenant[ii];
+			delete tenantrate[ii];
+		}
+		for (ii = 0; ii < groups; ++ii) {
+			delete group[ii];
+			delete grouprate[ii];
+		}
+		delete [] tenant;
+		delete [] group;
+		delete root;
+		delete [] tenantrate;
+		delete [] grouprate;
+		delete rootrate;
+	}
+
+	EXIT();
+}
@@ -28,6 +28,12 @@
  * TEST 3: END 1303391us
  * TEST 4: BEGIN
  * TEST 4: END 1300946us
+ *
+ * Tests 5 and 6 do the same for a thread-safe well with per-thread magazine
+ * caches. Tests 7 and 8 run the thread-safe well and the cached thread-safe
+ * well concurrently in a number of threads (the second argument, default
+ * four) and report elapsed rather than thread time, so that the scaling (or
+ * lack of it) under contention is measured.
  */
 
 extern "C" {
@@ -43,10 +49,13 @@ extern "C" {
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <pthread.h>
 
 enum {
 	ITERATIONS = 100000,
 	CARDINALITY = 1000,
+	THREADS = 4,
+	MAXIMUM = 16,
 };
 
 class Framistat {
@@ -111,10 +120,78 @@ public:
 
 GRANDOTE_SAFEWELL_DEFINITION(Thingamajig, CARDINALITY);
 
+class Whatchamacallit : public Framistat {
+
+public:
+
+	Whatchamacallit()
+	: Framistat()
+	{}
+
+	Whatchamacallit(int skosh)
+	: Framistat(skosh)
+	{}
+
+	virtual ~Whatchamacallit() {}
+
+	GRANDOTE_CACHEDSAFEWELL_DECLARATION(Whatchamacallit);
+
+};
+
+GRANDOTE_CACHEDSAFEWELL_DEFINITION(Whatchamacallit, CARDINALITY);
+
+/*
+ * Each thread allocates and frees a batch small enough that all of the
+ * threads together, plus whatever is sitting in their magazines and in the
+ * depot, fit in the well.
+ */
+
+static void * thingamajigs(void * arg) {
+	size_t batch = *static_cast<size_t *>(arg);
+	Thingamajig * thingamajig[CARDINALITY];
+	size_t ii;
+	size_t jj;
+
+	for (ii = 0; ii < ITERATIONS; ++ii) {
+		for (jj = 0; jj < batch; ++jj) {
+			thingamajig[jj] = new Thingamajig(jj);
+			ASSERT(thingamajig[jj] != (Thingamajig *)0);
+		}
+		for (jj = 0; jj < batch; ++jj) {
+			delete thingamajig[jj];
+		}
+	}
+
+	return (void *)0;
+}
+
+static void * whatchamacallits(void * arg) {
+	size_t batch = *static_cast<size_t *>(arg);
+	Whatchamacallit * whatchamacallit[CARDINALITY];
+	size_t ii;
+	size_t jj;
+
+	for (ii = 0; ii < ITERATIONS; ++ii) {
+		for (jj = 0; jj < batch; ++jj) {
+			whatchamacallit[jj] = new Whatchamacallit(jj);
+			ASSERT(whatchamacallit[jj] != (Whatchamacallit *)0);
+		}
+		for (jj = 0; jj < batch; ++jj) {
+			delete whatchamacallit[jj];
+		}
+	}
+
+	return (void *)0;
+}
+
 int main(int argc, char ** argv) {
 	Framistat * framistat[CARDINALITY];
 	Doohickey * doohickey[countof(framistat)];
 	Thingamajig * thingamajig[countof(framistat)];
+	Whatchamacallit * whatchamacallit[countof(framistat)];
+	pthread_t thread[MAXIMUM];
+	size_t threads;
+	size_t batch;
 	size_t ii;
 	size_t jj;
 	int mask;
@@ -125,6 +202,10 @@ int main(int argc, char ** argv) {
 	SETLOGMASK();
 
 	mask = (argc < 2) ? ~0 : atoi(argv[1]);
+	threads = (argc < 3) ? THREADS : atoi(argv[2]);
+	if (threads < 1) { threads = 1; }
+	if (threads > countof(thread)) { threads = countof(thread); }
+	batch = CARDINALITY / (4 * threads);
 
 	frequency = diminuto_frequency();
 
@@ -218,5 +299,75 @@ int main(int argc, char ** argv) {
 		DIMINUTO_LOG_DEBUG("TEST %d: END %12.9lf seconds\n", bit, (double)(diminuto_time_thread() - time) / frequency);
 	}
 
+	/* Cached thread-safe well. */
+
+	bit = 5;
+	if ((mask & (1 << bit)) != 0) {
+		DIMINUTO_LOG_DEBUG("TEST %d: BEGIN\n", bit);
+		time = diminuto_time_thread();
+		for (ii = 0; ii < ITERATIONS; ++ii) {
+			for (jj = 0; jj < countof(whatchamacallit); ++jj) {
+				whatchamacallit[jj] = new Whatchamacallit(jj);
+				ASSERT(whatchamacallit[jj] != (Whatchamacallit *)0);
+			}
+			for (jj = 0; jj < countof(whatchamacallit); ++jj) {
+				delete whatchamacallit[jj];
+			}
+		}
+		DIMINUTO_LOG_DEBUG("TEST %d: END %12.9lf seconds\n", bit, (double)(diminuto_time_thread() - time) / frequency);
+	}
+
+	/* Cached thread-safe well from base class. */
+
+	bit = 6;
+	if ((mask & (1 << bit)) != 0) {
+		DIMINUTO_LOG_DEBUG("TEST %d: BEGIN\n", bit);
+		time = diminuto_time_thread();
+		for (ii = 0; ii < ITERATIONS; ++ii) {
+			for (jj = 0; jj < countof(framistat); ++jj) {
+				framistat[jj] = new Whatchamacallit(jj);
+				ASSERT(framistat[jj] != (Framistat *)0);
+			}
+			for (jj = 0; jj < countof(framistat); ++jj) {
+				delete framistat[jj];
+			}
+		}
+		DIMINUTO_LOG_DEBUG("TEST %d: END %12.9lf seconds\n", bit, (double)(diminuto_time_thread() - time) / frequency);
+	}
+
+	/* The main thread returns its magazines so the threads can use them. */
+
+	Whatchamacallit::com_diag_diminuto_well.flush();
+
+	/* Thread-safe well in multiple threads. */
+
+	bit = 7;
+	if ((mask & (1 << bit)) != 0) {
+		DIMINUTO_LOG_DEBUG("TEST %d: BEGIN threads=%zu batch=%zu\n", bit, threads, batch);
+		time = diminuto_time_elapsed();
+		for (ii = 0; ii < threads; ++ii) {
+			ASSERT(pthread_create(&thread[ii], (pthread_attr_t *)0, thingamajigs, &batch) == 0);
+		}
+		for (ii = 0; ii < threads; ++ii) {
+			ASSERT(pthread_join(thread[ii], (void **)0) == 0);
+		}
+		DIMINUTO_LOG_DEBUG("TEST %d: END %12.9lf seconds\n", bit, (double)(diminuto_time_elapsed() - time) / frequency);
+	}
+
+	/* Cached thread-safe well in multiple threads. */
+
+	bit = 8;
+	if ((mask & (1 << bit)) != 0) {
+		DIMINUTO_LOG_DEBUG("TEST %d: BEGIN threads=%zu batch=%zu\n", bit, threads, batch);
+		time = diminuto_time_elapsed();
+		for (ii = 0; ii < threads; ++ii) {
+			ASSERT(pthread_create(&thread[ii], (pthread_attr_t *)0, whatchamacallits, &batch) == 0);
+		}
+		for (ii = 0; ii < threads; ++ii) {
+			ASSERT(pthread_join(thread[ii], (void **)0) == 0);
+		}
+		DIMINUTO_LOG_DEBUG("TEST %d: END %12.9lf seconds\n", bit, (double)(diminuto_time_elapsed() - time) / frequency);
+	}
+
 	EXIT();
 }
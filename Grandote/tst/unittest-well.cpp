@@ -20,6 +20,9 @@ extern "C" {
 #include "com/diag/grandote/Well.h"
 
 #include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <vector>
 
 enum {
 	CARDINALITY = 10,
@@ -58,8 +61,69 @@ public:
 
 GRANDOTE_WELL_DEFINITION(Framistat, CARDINALITY);
 
+class Gizmo {
+
+public:
+
+	int skoshification;
+
+	Gizmo(int skosh)
+	: skoshification(skosh)
+	{}
+
+	int discombobulate() {
+		return skoshification;
+	}
+
+	GRANDOTE_WELL_DECLARATION(Gizmo);
+
+};
+
+GRANDOTE_ELASTICWELL_DEFINITION(Gizmo, CARDINALITY, LIMIT);
+
+struct Widget {
+	int skoshification;
+};
+
+typedef com::diag::grandote::CachedSafeWell<Widget> WidgetWell;
+
+enum {
+	ROUNDS = 4,
+};
+
+struct Tinker {
+	WidgetWell * well;
+	pthread_barrier_t * barrier;
+	bool cached;
+};
+
+/*
+ * Allocates and frees few enough widgets that they all stay in the
+ * magazines of the thread, then optionally waits twice at the barrier
+ * before exiting.
+ */
+static void * tinker(void * arg) {
+	Tinker * tp = static_cast<Tinker *>(arg);
+	Widget * widget[ROUNDS];
+	size_t ii;
+	for (ii = 0; ii < countof(widget); ++ii) {
+		widget[ii] = tp->well->alloc();
+		ASSERT(widget[ii] != (Widget *)0);
+	}
+	for (ii = 0; ii < countof(widget); ++ii) {
+		tp->well->free(widget[ii]);
+	}
+	tp->cached = !tp->well->isFull();
+	if (tp->barrier != (pthread_barrier_t *)0) {
+		pthread_barrier_wait(tp->barrier);
+		pthread_barrier_wait(tp->barrier);
+	}
+	return (void *)0;
+}
+
 int main(int argc, char ** argv) {
 	Framistat * framistat[CARDINALITY];
+	Gizmo * gizmo[CARDINALITY * LIMIT];
 	Framistat * fail;
 	Framistat * array;
 	size_t ii;
@@ -116,5 +180,141 @@ int main(int argc, char ** argv) {
 	}
 	delete [] array;
 
+	ASSERT(Gizmo::com_diag_diminuto_well.isElastic());
+
+	{
+		Gizmo * null = static_cast<Gizmo *>(0);
+		size_t slabs;
+
+		ASSERT(Gizmo::com_diag_diminuto_well.isFull());
+		slabs = Gizmo::com_diag_diminuto_well.getSlabs();
+		delete null;
+		Gizmo::operator delete(null);
+		Gizmo::com_diag_diminuto_well.free(null);
+		ASSERT(Gizmo::com_diag_diminuto_well.isFull());
+		ASSERT(Gizmo::com_diag_diminuto_well.getSlabs() == slabs);
+		gizmo[0] = new Gizmo(0);
+		ASSERT(gizmo[0] != (Gizmo *)0);
+		delete gizmo[0];
+		ASSERT(Gizmo::com_diag_diminuto_well.isFull());
+	}
+
+	for (jj = 0; jj < LIMIT; ++jj) {
+
+		ASSERT(Gizmo::com_diag_diminuto_well.isFull());
+		for (ii = 0; ii < countof(gizmo); ++ii) {
+			gizmo[ii] = new Gizmo(ii);
+			ASSERT(gizmo[ii] != (Gizmo *)0);
+			ASSERT((reinterpret_cast<uintptr_t>(gizmo[ii]) % sizeof(uint64_t)) == 0);
+			ASSERT(!Gizmo::com_diag_diminuto_well.isFull());
+			ASSERT(!Gizmo::com_diag_diminuto_well.isEmpty());
+		}
+
+		for (ii = 0; ii < countof(gizmo); ++ii) {
+			ASSERT(gizmo[ii]->discombobulate() == ii);
+		}
+
+		for (ii = 0; ii < countof(gizmo); ++ii) {
+			delete gizmo[(ii * 7) % countof(gizmo)];
+		}
+		ASSERT(Gizmo::com_diag_diminuto_well.isFull());
+
+	}
+
+	{
+		size_t slabs;
+		std::vector<Gizmo *> many;
+
+		ASSERT(Gizmo::com_diag_diminuto_well.isFull());
+		slabs = Gizmo::com_diag_diminuto_well.getSlabs();
+		ASSERT(slabs > 0);
+		ASSERT(Gizmo::com_diag_diminuto_well.getIdle() == slabs);
+
+		while (Gizmo::com_diag_diminuto_well.getSlabs() < (slabs + LIMIT)) {
+			many.push_back(new Gizmo(many.size()));
+			ASSERT(many.back() != (Gizmo *)0);
+		}
+		ASSERT(Gizmo::com_diag_diminuto_well.getIdle() == 0);
+		DIMINUTO_LOG_DEBUG("slabs=%zu objects=%zu\n", Gizmo::com_diag_diminuto_well.getSlabs(), many.size());
+
+		for (ii = 0; ii < many.size(); ++ii) {
+			ASSERT(many[ii]->discombobulate() == (int)ii);
+			delete many[ii];
+		}
+		ASSERT(Gizmo::com_diag_diminuto_well.isFull());
+		ASSERT(Gizmo::com_diag_diminuto_well.getSlabs() == slabs);
+		ASSERT(Gizmo::com_diag_diminuto_well.getIdle() == slabs);
+	}
+
+	{
+		WidgetWell well(0, false, sizeof(uint64_t), 0, 0, ROUNDS, CARDINALITY);
+		Widget * widget[ROUNDS * CARDINALITY];
+
+		/* Few enough objects that they all stay in this thread's magazines. */
+
+		ASSERT(well.isFull());
+		for (ii = 0; ii < (ROUNDS * 2); ++ii) {
+			widget[ii] = well.alloc();
+			ASSERT(widget[ii] != (Widget *)0);
+		}
+		for (ii = 0; ii < (ROUNDS * 2); ++ii) {
+			well.free(widget[ii]);
+		}
+		ASSERT(!well.isFull());
+		well.free((Widget *)0);
+		well.flush();
+		ASSERT(well.isFull());
+
+		/* Many times the magazine size, trading magazines with the depot. */
+
+		for (jj = 0; jj < LIMIT; ++jj) {
+			for (ii = 0; ii < countof(widget); ++ii) {
+				widget[ii] = well.alloc();
+				ASSERT(widget[ii] != (Widget *)0);
+				widget[ii]->skoshification = ii;
+			}
+			for (ii = 0; ii < countof(widget); ++ii) {
+				ASSERT(widget[ii]->skoshification == (int)ii);
+			}
+			for (ii = 0; ii < countof(widget); ++ii) {
+				well.free(widget[(ii * 7) % countof(widget)]);
+			}
+			ASSERT(!well.isFull());
+		}
+		well.fini();
+		ASSERT(well.isFull());
+	}
+
+	{
+		WidgetWell well(0, false, sizeof(uint64_t), 0, 0, ROUNDS, CARDINALITY);
+		Tinker tinkerer = { &well, (pthread_barrier_t *)0, false };
+		pthread_t thread;
+
+		/* A thread that exits returns its magazines to the well. */
+
+		ASSERT(pthread_create(&thread, (pthread_attr_t *)0, tinker, &tinkerer) == 0);
+		ASSERT(pthread_join(thread, (void **)0) == 0);
+		ASSERT(tinkerer.cached);
+		ASSERT(well.isFull());
+	}
+
+	{
+		WidgetWell * wellp = new WidgetWell(0, false, sizeof(uint64_t), 0, 0, ROUNDS, CARDINALITY);
+		pthread_barrier_t barrier;
+		Tinker tinkerer = { wellp, &barrier, false };
+		pthread_t thread;
+
+		/* A well destroyed while another thread still has a cache. */
+
+		ASSERT(pthread_barrier_init(&barrier, (pthread_barrierattr_t *)0, 2) == 0);
+		ASSERT(pthread_create(&thread, (pthread_attr_t *)0, tinker, &tinkerer) == 0);
+		pthread_barrier_wait(&barrier);
+		ASSERT(tinkerer.cached);
+		delete wellp;
+		pthread_barrier_wait(&barrier);
+		ASSERT(pthread_join(thread, (void **)0) == 0);
+		pthread_barrier_destroy(&barrier);
+	}
+
 	EXIT();
 }
@@ -0,0 +1,63 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Implements the ShapedOutput unit test main program.
+ *
+ *  @see    ShapedOutput
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/stdlib.h"
+#include "com/diag/grandote/UnitTest.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/ShapedOutput.h"
+
+int main(int, char**) {
+    exit(unittestShapedOutput());
+}
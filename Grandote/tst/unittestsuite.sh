@@ -67,10 +67,13 @@ EOF
 
 # Errors in these commands do count.
 cat << EOF > $SCRIPT2
+unittestArenaHeap
 unittestArgument
 unittestAscii
+unittestAtomicGcra
 unittestAttribute
 unittestBandwidthThrottle
+unittestBlockingFifo
 unittestByteOrder
 unittestCellRateThrottle
 unittestChain
@@ -80,24 +83,35 @@ unittestDump
 unittestEncode
 unittestEscape
 unittestException
+unittestFastChain
 unittestFifo
+unittestGcraTable
 unittestGeometricThrottle
 unittestGrayCode
+unittestHashTable
 unittestHeap
 unittestImplementation
 unittestInputOutputStatic
 unittestIso3166
 unittestLinkType
 unittestLogger
+unittestLruCache
 unittestMeter
 unittestMinimumMaximum
+unittestMpmcFifo
 unittestMutex
 unittestNumber
 unittestPlatform
+unittestPriorityQueue
 unittestRam
 unittestService
+unittestShapedOutput
+unittestShaper
+unittestSpscFifo
 unittestStreamSocket
 unittestThrottle
+unittestThrottleWaiter
+unittestTimerWheel
 unittestVintage
 unittestWord
 unittestbarrier
@@ -0,0 +1,296 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Implements the ArenaHeap unit test.
+ *
+ *  @see    ArenaHeap
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/stdlib.h"
+#include "com/diag/grandote/string.h"
+#include "com/diag/grandote/UnitTest.h"
+#include "com/diag/grandote/ArenaHeap.h"
+#include "com/diag/grandote/Print.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/target.h"
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/Grandote.h"
+
+CXXCAPI int unittestArenaHeap(void) {
+    Print printf(Platform::instance().output());
+    Print errorf(Platform::instance().error());
+    int errors = 0;
+
+    printf("%s[%d]: begin\n", __FILE__, __LINE__);
+
+    const size_t CHUNK = 1024;
+    const size_t BYTES = 100;
+
+    ArenaHeap heap(CHUNK);
+    heap.show();
+
+    printf("%s[%d]: allocation\n", __FILE__, __LINE__);
+
+    void* block[32];
+
+    for (size_t ii = 0; countof(block) > ii; ++ii) {
+        block[ii] = heap.malloc(ii * 4);
+        if (0 == block[ii]) {
+            errorf("%s[%d]: (%p==%p[%lu])!\n",
+                __FILE__, __LINE__, 0, block[ii], ii);
+            ++errors;
+            continue;
+        }
+        uintptr_t address = reinterpret_cast<uintptr_t>(block[ii]);
+        if (0 != (address % sizeof(Heap::Alignment))) {
+            errorf("%s[%d]: (%p[%lu]%%%lu)!\n",
+                __FILE__, __LINE__, block[ii], ii, sizeof(Heap::Alignment));
+            ++errors;
+        }
+        if ((ii * 4) != heap.size(block[ii])) {
+            errorf("%s[%d]: (%lu!=%lu[%lu])!\n",
+                __FILE__, __LINE__, ii * 4, heap.size(block[ii]), ii);
+            ++errors;
+        }
+        std::memset(block[ii], ii, ii * 4);
+    }
+
+    for (size_t ii = 0; countof(block) > ii; ++ii) {
+        const unsigned char* cp = static_cast<unsigned char*>(block[ii]);
+        for (size_t jj = 0; (ii * 4) > jj; ++jj) {
+            if (ii != cp[jj]) {
+                errorf("%s[%d]: (%u!=%u[%lu][%lu])!\n",
+                    __FILE__, __LINE__, ii, cp[jj], ii, jj);
+                ++errors;
+                break;
+            }
+        }
+    }
+
+    if (2 > heap.getChunks()) {
+        errorf("%s[%d]: (%lu>%lu)!\n",
+            __FILE__, __LINE__, 2, heap.getChunks());
+        ++errors;
+    }
+
+    printf("%s[%d]: free\n", __FILE__, __LINE__);
+
+    void* before = heap.malloc(BYTES);
+    heap.free(before);
+    void* after = heap.malloc(BYTES);
+    if (before != after) {
+        errorf("%s[%d]: (%p!=%p)!\n",
+            __FILE__, __LINE__, before, after);
+        ++errors;
+    }
+
+    for (size_t ii = 0; countof(block) > ii; ++ii) {
+        heap.free(block[ii]);
+    }
+    heap.free(after);
+    heap.free(0);
+
+    if (0 != heap.getCurrent()) {
+        errorf("%s[%d]: (%lu!=%lu)!\n",
+            __FILE__, __LINE__, 0, heap.getCurrent());
+        ++errors;
+    }
+
+    if ((countof(block) + 2) != heap.getFrees()) {
+        errorf("%s[%d]: (%lu!=%lu)!\n",
+            __FILE__, __LINE__, countof(block) + 2, heap.getFrees());
+        ++errors;
+    }
+
+    if (1 != heap.getNulls()) {
+        errorf("%s[%d]: (%lu!=%lu)!\n",
+            __FILE__, __LINE__, 1, heap.getNulls());
+        ++errors;
+    }
+
+    printf("%s[%d]: realloc\n", __FILE__, __LINE__);
+
+    //  The block may move once if it runs out of room in its chunk.
+
+    char* string = 0;
+    size_t moves = 0;
+    for (size_t ii = 1; (CHUNK / 2) >= ii; ++ii) {
+        char* was = string;
+        string = static_cast<char*>(heap.realloc(string, ii));
+        if (0 == string) {
+            errorf("%s[%d]: (%p==%p[%lu])!\n",
+                __FILE__, __LINE__, 0, string, ii);
+            ++errors;
+            break;
+        }
+        if ((0 != was) && (was != string)) {
+            ++moves;
+        }
+        string[ii - 1] = 'A' + (ii % 26);
+    }
+
+    if (1 < moves) {
+        errorf("%s[%d]: (%lu<%lu)!\n",
+            __FILE__, __LINE__, 1, moves);
+        ++errors;
+    }
+
+    void* other = heap.malloc(1);
+    char* moved = static_cast<char*>(heap.realloc(string, CHUNK / 2 + 1));
+    if (moved == string) {
+        errorf("%s[%d]: (%p==%p)!\n",
+            __FILE__, __LINE__, moved, string);
+        ++errors;
+    }
+    for (size_t ii = 1; (CHUNK / 2) >= ii; ++ii) {
+        if (moved[ii - 1] != static_cast<char>('A' + (ii % 26))) {
+            errorf("%s[%d]: (%c!=%c[%lu])!\n",
+                __FILE__, __LINE__, moved[ii - 1], 'A' + (ii % 26), ii);
+            ++errors;
+            break;
+        }
+    }
+    heap.free(moved);
+    heap.free(other);
+
+    printf("%s[%d]: large\n", __FILE__, __LINE__);
+
+    size_t chunks = heap.getChunks();
+    void* current = heap.malloc(BYTES);
+    void* large = heap.malloc(CHUNK * 4);
+    void* next = heap.malloc(BYTES);
+    if ((0 == large) || (CHUNK * 4 != heap.size(large))) {
+        errorf("%s[%d]: (%p[%lu])!\n",
+            __FILE__, __LINE__, large, heap.size(large));
+        ++errors;
+    }
+    if ((chunks + 1) != heap.getChunks()) {
+        errorf("%s[%d]: (%lu!=%lu)!\n",
+            __FILE__, __LINE__, chunks + 1, heap.getChunks());
+        ++errors;
+    }
+    if ((static_cast<char*>(current) + BYTES + sizeof(Heap::Alignment)) > next) {
+        errorf("%s[%d]: (%p>%p)!\n",
+            __FILE__, __LINE__, current, next);
+        ++errors;
+    }
+
+    printf("%s[%d]: reset\n", __FILE__, __LINE__);
+
+    heap.reset();
+
+    if (1 != heap.getChunks()) {
+        errorf("%s[%d]: (%lu!=%lu)!\n",
+            __FILE__, __LINE__, 1, heap.getChunks());
+        ++errors;
+    }
+    if (0 != heap.getCurrent()) {
+        errorf("%s[%d]: (%lu!=%lu)!\n",
+            __FILE__, __LINE__, 0, heap.getCurrent());
+        ++errors;
+    }
+
+    printf("%s[%d]: capi\n", __FILE__, __LINE__);
+
+    Heap* hp = &heap;
+    void* cptr = heap_calloc(hp, 10, 10);
+    if (0 == cptr) {
+        errorf("%s[%d]: (%p==%p)!\n",
+            __FILE__, __LINE__, 0, cptr);
+        ++errors;
+    } else {
+        for (size_t ii = 0; 100 > ii; ++ii) {
+            if (0 != static_cast<char*>(cptr)[ii]) {
+                errorf("%s[%d]: (%d!=%d[%lu])!\n",
+                    __FILE__, __LINE__, 0, static_cast<char*>(cptr)[ii], ii);
+                ++errors;
+                break;
+            }
+        }
+    }
+    cptr = heap_realloc(hp, cptr, 200);
+    if ((0 == cptr) || (200 != hp->size(cptr))) {
+        errorf("%s[%d]: (%p[%lu])!\n",
+            __FILE__, __LINE__, cptr, hp->size(cptr));
+        ++errors;
+    }
+    heap_free(hp, cptr);
+    void* mptr = heap_malloc(hp, BYTES);
+    if (mptr != cptr) {
+        errorf("%s[%d]: (%p!=%p)!\n",
+            __FILE__, __LINE__, mptr, cptr);
+        ++errors;
+    }
+    heap_free(hp, mptr);
+
+    printf("%s[%d]: release\n", __FILE__, __LINE__);
+
+    heap.release();
+
+    if (0 != heap.getChunks()) {
+        errorf("%s[%d]: (%lu!=%lu)!\n",
+            __FILE__, __LINE__, 0, heap.getChunks());
+        ++errors;
+    }
+
+    void* again = heap.malloc(BYTES);
+    if ((0 == again) || (1 != heap.getChunks())) {
+        errorf("%s[%d]: (%p[%lu])!\n",
+            __FILE__, __LINE__, again, heap.getChunks());
+        ++errors;
+    }
+
+    heap.show();
+
+    printf("%s[%d]: end errors=%d\n",
+        __FILE__, __LINE__, errors);
+
+    return errors;
+}
@@ -0,0 +1,264 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Implements the AtomicGcra unit test.
+ *
+ *  @see    AtomicGcra
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/UnitTest.h"
+#include "com/diag/grandote/AtomicGcra.h"
+#include "com/diag/grandote/AtomicGcra.h"
+#include "com/diag/grandote/Gcra.h"
+#include "com/diag/grandote/Thread.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/Grandote.h"
+#include <cstdlib>
+
+static const unsigned int contenders = 4;
+static const unsigned long attempts = 50000;
+
+//
+//  Repeatedly tries to admit one event at a fixed time and counts the
+//  admissions.
+//
+class AtomicGcraContender : public Thread {
+
+public:
+
+    AtomicGcraContender() :
+        gcra(0),
+        ticks(0),
+        admitted(0)
+    {}
+
+    virtual void * run() {
+        for (unsigned long ii = 0; attempts > ii; ++ii) {
+            if (this->gcra->tryAdmit(1, this->ticks)) {
+                ++this->admitted;
+            }
+        }
+        return 0;
+    }
+
+    AtomicGcra* gcra;
+
+    ticks_t ticks;
+
+    unsigned long admitted;
+
+};
+
+CXXCAPI int unittestAtomicGcra(void) {
+    Print printf(Platform::instance().output());
+    Print errorf(Platform::instance().error());
+    int errors = 0;
+
+    printf("%s[%d]: begin\n", __FILE__, __LINE__);
+
+    printf("%s[%d]: construction\n", __FILE__, __LINE__);
+
+    AtomicGcra gcra1(100, 250);
+    gcra1.show();
+    if (100 != gcra1.getIncrement()) {
+        errorf("%s[%d]: (%llu!=%llu)!\n",
+            __FILE__, __LINE__, 100ULL, gcra1.getIncrement());
+        ++errors;
+    }
+    if (250 != gcra1.getLimit()) {
+        errorf("%s[%d]: (%llu!=%llu)!\n",
+            __FILE__, __LINE__, 250ULL, gcra1.getLimit());
+        ++errors;
+    }
+    if (gcra1.isApproximate()) {
+        errorf("%s[%d]: approximate!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    if (0 != gcra1.admissible()) {
+        errorf("%s[%d]: (%llu!=%llu)!\n",
+            __FILE__, __LINE__, 0ULL, gcra1.admissible());
+        ++errors;
+    }
+    if (!gcra1.tryAdmit()) {
+        errorf("%s[%d]: refused!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+
+    printf("%s[%d]: burst\n", __FILE__, __LINE__);
+
+    ticks_t now = 1000000;
+    gcra1.reset(now);
+    for (unsigned int ii = 0; 3 > ii; ++ii) {
+        if (!gcra1.tryAdmit(1, now)) {
+            errorf("%s[%d]: (%u) refused!\n", __FILE__, __LINE__, ii);
+            ++errors;
+        }
+    }
+    if (50 != gcra1.admissible(now)) {
+        errorf("%s[%d]: (%llu!=%llu)!\n",
+            __FILE__, __LINE__, 50ULL, gcra1.admissible(now));
+        ++errors;
+    }
+    if (gcra1.tryAdmit(1, now)) {
+        errorf("%s[%d]: admitted!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    if (gcra1.tryAdmit(1, now + 49)) {
+        errorf("%s[%d]: admitted!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    if (!gcra1.tryAdmit(1, now + 50)) {
+        errorf("%s[%d]: refused!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+
+    printf("%s[%d]: equivalence\n", __FILE__, __LINE__);
+
+    static const ticks_t parameters[][2] = {
+        { 100, 0 }, { 100, 250 }, { 7, 1000 }, { 1, 1 }, { 0, 0 }
+    };
+    std::srand(1);
+    for (unsigned int ii = 0; countof(parameters) > ii; ++ii) {
+        Gcra reference(parameters[ii][0], parameters[ii][1]);
+        AtomicGcra candidate(parameters[ii][0], parameters[ii][1]);
+        now = 1000;
+        reference.reset(now);
+        candidate.reset(now);
+        unsigned long admitted = 0;
+        for (unsigned int jj = 0; 100000 > jj; ++jj) {
+            now += std::rand() % 300;
+            size_t n = 1 + (std::rand() % 3);
+            ticks_t delay = candidate.admissible(now);
+            ticks_t expected = reference.admissible(now);
+            if (expected != delay) {
+                errorf("%s[%d]: (%u,%u) (%llu!=%llu)!\n",
+                    __FILE__, __LINE__, ii, jj, expected, delay);
+                ++errors;
+                break;
+            }
+            if (0 == expected) {
+                reference.commit(n);
+            } else {
+                reference.rollback();
+            }
+            bool admit = candidate.tryAdmit(n, now);
+            if ((0 == expected) != admit) {
+                errorf("%s[%d]: (%u,%u) (%d!=%d)!\n",
+                    __FILE__, __LINE__, ii, jj, (0 == expected), admit);
+                ++errors;
+                break;
+            }
+            if (admit) {
+                ++admitted;
+            }
+        }
+        printf("%s[%d]: increment=%llu limit=%llu admitted=%lu\n",
+            __FILE__, __LINE__, parameters[ii][0], parameters[ii][1], admitted);
+        if (reference.isApproximate() != candidate.isApproximate()) {
+            errorf("%s[%d]: (%u) (%d!=%d)!\n", __FILE__, __LINE__,
+                ii, reference.isApproximate(), candidate.isApproximate());
+            ++errors;
+        }
+    }
+
+    printf("%s[%d]: saturation\n", __FILE__, __LINE__);
+
+    AtomicGcra gcra2(intmaxof(ticks_t) / 2, 0, 0);
+    if (!gcra2.tryAdmit(3, 0)) {
+        errorf("%s[%d]: refused!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    if (!gcra2.isApproximate()) {
+        errorf("%s[%d]: exact!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    if (gcra2.tryAdmit(1, intmaxof(ticks_t) - 1)) {
+        errorf("%s[%d]: admitted!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    gcra2.reset(0);
+    if (gcra2.isApproximate()) {
+        errorf("%s[%d]: approximate!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+
+    printf("%s[%d]: threads\n", __FILE__, __LINE__);
+
+    static const ticks_t limit = 99999;
+    AtomicGcra shared(1, limit, 0);
+    AtomicGcraContender contender[contenders];
+    for (unsigned int ii = 0; contenders > ii; ++ii) {
+        contender[ii].gcra = &shared;
+        contender[ii].ticks = 0;
+        if (0 != contender[ii].start()) {
+            errorf("%s[%d]: (%u)!\n", __FILE__, __LINE__, ii);
+            ++errors;
+        }
+    }
+    unsigned long admitted = 0;
+    for (unsigned int ii = 0; contenders > ii; ++ii) {
+        contender[ii].join();
+        printf("%s[%d]: contender=%u admitted=%lu\n",
+            __FILE__, __LINE__, ii, contender[ii].admitted);
+        admitted += contender[ii].admitted;
+    }
+    if ((limit + 1) != admitted) {
+        errorf("%s[%d]: (%llu!=%lu)!\n",
+            __FILE__, __LINE__, limit + 1, admitted);
+        ++errors;
+    }
+
+    shared.show(1);
+
+    printf("%s[%d]: errors=%d\n", __FILE__, __LINE__, errors);
+
+    return errors;
+}
@@ -0,0 +1,264 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Implements the BlockingFifo unit test.
+ *
+ *  @see    BlockingFifo
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/UnitTest.h"
+#include "com/diag/grandote/BlockingFifo.h"
+#include "com/diag/grandote/BlockingFifo.h"
+#include "com/diag/grandote/Thread.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/Grandote.h"
+
+template class BlockingFifo<char>;
+template class BlockingFifo<int>;
+template class BlockingFifo<uint32_t>;
+
+static BlockingFifo<int> staticBlockingFifo;
+
+static const uint32_t limit = 100000;
+
+//
+//  Inserts a sequence of numbers, blocking whenever the queue is full.
+//
+class BlockingFifoProducer : public Thread {
+
+public:
+
+    explicit BlockingFifoProducer(BlockingFifo<uint32_t>& ff) :
+        fifo(ff),
+        failures(0)
+    {}
+
+    virtual void * run() {
+        for (uint32_t ii = 0; limit > ii; ++ii) {
+            if (!this->fifo.insert(ii)) {
+                ++this->failures;
+            }
+        }
+        return 0;
+    }
+
+    BlockingFifo<uint32_t>& fifo;
+
+    unsigned long failures;
+
+};
+
+//
+//  Removes a single entry, blocking until there is one.
+//
+class BlockingFifoConsumer : public Thread {
+
+public:
+
+    explicit BlockingFifoConsumer(BlockingFifo<uint32_t>& ff) :
+        fifo(ff),
+        entry(0),
+        success(false)
+    {}
+
+    virtual void * run() {
+        this->success = this->fifo.remove(this->entry);
+        return 0;
+    }
+
+    BlockingFifo<uint32_t>& fifo;
+
+    uint32_t entry;
+
+    bool success;
+
+};
+
+CXXCAPI int unittestBlockingFifo(void) {
+    Platform& pl = Platform::instance();
+    Print printf(pl.output());
+    Print errorf(pl.error());
+    int errors = 0;
+
+    printf("%s[%d]: begin\n", __FILE__, __LINE__);
+
+    ::staticBlockingFifo.show();
+
+    ticks_t hz = pl.frequency();
+    ticks_t timeout = hz / 10;
+    ticks_t then;
+    ticks_t elapsed;
+
+    printf("%s[%d]: empty\n", __FILE__, __LINE__);
+
+    int ints[4];
+    BlockingFifo<int> fifo(ints, countof(ints));
+    fifo.show();
+    int intinstance = 0;
+
+    bool success = fifo.remove(intinstance, 0);
+    if (false != success) {
+        errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, false, success);
+        ++errors;
+    }
+    success = fifo.peek(intinstance);
+    if (false != success) {
+        errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, false, success);
+        ++errors;
+    }
+    then = pl.time();
+    success = fifo.remove(intinstance, timeout);
+    elapsed = pl.time() - then;
+    if (false != success) {
+        errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, false, success);
+        ++errors;
+    }
+    if (timeout > elapsed) {
+        errorf("%s[%d]: (%llu>%llu)!\n", __FILE__, __LINE__, timeout, elapsed);
+        ++errors;
+    }
+
+    printf("%s[%d]: full\n", __FILE__, __LINE__);
+
+    for (unsigned int jj = 0; countof(ints) > jj; ++jj) {
+        success = fifo.insert(jj, 0);
+        if (true != success) {
+            errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, true, success);
+            ++errors;
+        }
+    }
+    if ((countof(ints) != fifo.used()) || (0 != fifo.free())) {
+        errorf("%s[%d]: (%u!=%u)!\n",
+            __FILE__, __LINE__, countof(ints), fifo.used());
+        ++errors;
+    }
+    success = fifo.insert(countof(ints), 0);
+    if (false != success) {
+        errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, false, success);
+        ++errors;
+    }
+    then = pl.time();
+    success = fifo.insert(countof(ints), timeout);
+    elapsed = pl.time() - then;
+    if (false != success) {
+        errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, false, success);
+        ++errors;
+    }
+    if (timeout > elapsed) {
+        errorf("%s[%d]: (%llu>%llu)!\n", __FILE__, __LINE__, timeout, elapsed);
+        ++errors;
+    }
+    fifo.show(1);
+
+    for (unsigned int jj = 0; countof(ints) > jj; ++jj) {
+        intinstance = -1;
+        success = fifo.remove(intinstance, timeout);
+        if ((true != success) || (static_cast<int>(jj) != intinstance)) {
+            errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, jj, intinstance);
+            ++errors;
+        }
+    }
+
+    printf("%s[%d]: wake\n", __FILE__, __LINE__);
+
+    uint32_t words[8];
+    BlockingFifo<uint32_t> shared(words, countof(words));
+    BlockingFifoConsumer consumer(shared);
+    if (0 != consumer.start()) {
+        errorf("%s[%d]: start!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    pl.yield(timeout);
+    success = shared.insert(0xa5a5a5a5UL, timeout);
+    if (true != success) {
+        errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, true, success);
+        ++errors;
+    }
+    consumer.join();
+    if ((true != consumer.success) || (0xa5a5a5a5UL != consumer.entry)) {
+        errorf("%s[%d]: (0x%x!=0x%x)!\n",
+            __FILE__, __LINE__, 0xa5a5a5a5UL, consumer.entry);
+        ++errors;
+    }
+
+    printf("%s[%d]: threads\n", __FILE__, __LINE__);
+
+    BlockingFifoProducer producer(shared);
+    if (0 != producer.start()) {
+        errorf("%s[%d]: start!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    uint32_t wordinstance;
+    for (uint32_t ii = 0; limit > ii; ++ii) {
+        success = shared.remove(wordinstance);
+        if ((true != success) || (ii != wordinstance)) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, ii, wordinstance);
+            ++errors;
+            break;
+        }
+    }
+    producer.join();
+    if (0 != producer.failures) {
+        errorf("%s[%d]: (%lu!=%lu)!\n",
+            __FILE__, __LINE__, 0UL, producer.failures);
+        ++errors;
+    }
+    if (0 != shared.used()) {
+        errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 0, shared.used());
+        ++errors;
+    }
+
+    shared.show();
+
+    printf("%s[%d]: errors=%d\n", __FILE__, __LINE__, errors);
+
+    return errors;
+}
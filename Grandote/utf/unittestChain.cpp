@@ -132,6 +132,28 @@ static Chain* chain;
 static UT_Chain_Link* links[10];
 static const int LIMIT = countof(links);
 
+class UT_Chain_Sum {
+public:
+    UT_Chain_Sum(int l = -1) : sum(0), count(0), limit(l) {}
+    bool operator() (Link* link) {
+        int sn = static_cast<UT_Chain_Link*>(link->getPayload())->sn;
+        if (sn == limit) { return false; }
+        sum += sn;
+        ++count;
+        return true;
+    }
+    int sum;
+    int count;
+    int limit;
+};
+
+class UT_Chain_Odd {
+public:
+    bool operator() (Link* link) {
+        return (static_cast<UT_Chain_Link*>(link->getPayload())->sn % 2) != 0;
+    }
+};
+
 class UT_Chain_Remove : public Link::Functor {
 public:
     UT_Chain_Remove(bool f = true) : origin(0), forwards(f) {}
@@ -1297,6 +1319,46 @@ CXXCAPI int unittestChain(void) {
 
     chain->apply(dump);
 
+    printf("%s[%d]: forEach and removeIf\n", __FILE__, __LINE__);
+
+    {
+        Chain local;
+        UT_Chain_Link* items[LIMIT];
+        for (sn = 0; sn < LIMIT; ++sn) {
+            items[sn] = new UT_Chain_Link(sn);
+            local.insertLast(&(items[sn]->node));
+        }
+        UT_Chain_Sum all;
+        if ((0 != local.forEach(all)) || (45 != all.sum) || (LIMIT != all.count)) {
+            errorf("%s[%d]: (%d!=%d)!\n",
+                __FILE__, __LINE__, all.sum, 45);
+            ++errors;
+        }
+        UT_Chain_Sum some(4);
+        if ((&(items[4]->node) != local.forEach(some)) || (6 != some.sum)) {
+            errorf("%s[%d]: (%d!=%d)!\n",
+                __FILE__, __LINE__, some.sum, 6);
+            ++errors;
+        }
+        UT_Chain_Odd odd;
+        size_t removed = local.removeIf(odd);
+        UT_Chain_Sum even;
+        local.forEach(even);
+        if ((5 != removed) || (20 != even.sum) || (5 != even.count) || items[3]->node.isChained() || !local.isMember(&(items[4]->node))) {
+            errorf("%s[%d]: (%d!=%d)!\n",
+                __FILE__, __LINE__, even.sum, 20);
+            ++errors;
+        }
+        Chain empty;
+        if ((0 != empty.forEach(all)) || (0 != empty.removeIf(odd))) {
+            errorf("%s[%d]: not empty!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        for (sn = 0; sn < LIMIT; ++sn) {
+            delete items[sn];
+        }
+    }
+
     printf("%s[%d]: show full\n", __FILE__, __LINE__);
 
     chain->show(1);
@@ -0,0 +1,229 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+
+
+/**
+ *  @file
+ *
+ *  Implements the FastChain unit test.
+ *
+ *  @see    FastChain
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/UnitTest.h"
+#include "com/diag/grandote/FastChain.h"
+#include "com/diag/grandote/FastChain.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/Grandote.h"
+
+struct FastChainItem {
+
+    explicit FastChainItem(int n = 0) :
+        sn(n),
+        node(this)
+    {}
+
+    int sn;
+
+    Link node;
+
+};
+
+static int sn(const Link* link) {
+    return static_cast<FastChainItem*>(link->getPayload())->sn;
+}
+
+class FastChainSum {
+
+public:
+
+    explicit FastChainSum(int l = -1) :
+        sum(0),
+        limit(l)
+    {}
+
+    bool operator() (Link* link) {
+        if (sn(link) == this->limit) {
+            return false;
+        }
+        this->sum = (this->sum * 10) + sn(link);
+        return true;
+    }
+
+    int sum;
+
+    int limit;
+
+};
+
+class FastChainOdd {
+
+public:
+
+    bool operator() (Link* link) {
+        return (sn(link) % 2) != 0;
+    }
+
+};
+
+//
+//  Return the serial numbers from first to last as decimal digits.
+//
+static int digits(const FastChain& chain) {
+    FastChainSum sum;
+    chain.forEach(sum);
+    return sum.sum;
+}
+
+CXXCAPI int unittestFastChain(void) {
+    Print printf(Platform::instance().output());
+    Print errorf(Platform::instance().error());
+    int errors = 0;
+
+    printf("%s[%d]: begin\n", __FILE__, __LINE__);
+
+    printf("%s[%d]: empty\n", __FILE__, __LINE__);
+
+    FastChainItem item[10];
+    for (int ii = 0; countof(item) > static_cast<size_t>(ii); ++ii) {
+        item[ii].sn = ii;
+    }
+
+    {
+        FastChain chain;
+        chain.show();
+        if (!chain.isEmpty() || (0 != chain.peekFirst()) || (0 != chain.peekLast()) || (0 != chain.removeFirst()) || (0 != chain.removeLast())) {
+            errorf("%s[%d]: not empty!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+    }
+
+    printf("%s[%d]: insert and peek\n", __FILE__, __LINE__);
+
+    {
+        FastChain chain;
+        if ((&item[2].node != chain.insertFirst(&item[2].node)) ||
+            (&item[3].node != chain.insertLast(&item[3].node)) ||
+            (&item[1].node != chain.insertFirst(&item[1].node)) ||
+            (&item[5].node != chain.insertNext(&item[3].node, &item[5].node)) ||
+            (&item[4].node != chain.insertPrevious(&item[5].node, &item[4].node))) {
+            errorf("%s[%d]: not inserted!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        if ((0 != chain.insertFirst(&item[2].node)) || (0 != chain.insertLast(&item[2].node))) {
+            errorf("%s[%d]: inserted twice!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        chain.show(1);
+        if (12345 != digits(chain)) {
+            errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, 12345, digits(chain));
+            ++errors;
+        }
+        if ((&item[1].node != chain.peekFirst()) || (&item[5].node != chain.peekLast()) ||
+            (&item[3].node != chain.peekNext(&item[2].node)) || (&item[2].node != chain.peekPrevious(&item[3].node)) ||
+            (0 != chain.peekNext(&item[5].node)) || (0 != chain.peekPrevious(&item[1].node))) {
+            errorf("%s[%d]: wrong peek!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        if (!chain.isMember(&item[1].node) || chain.isMember(&item[0].node) || chain.isEmpty()) {
+            errorf("%s[%d]: wrong membership!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+
+        //  Operations relative to a link on some other chain fail.
+
+        FastChain other;
+        other.insertFirst(&item[0].node);
+        if ((0 != chain.peekNext(&item[0].node)) || (0 != chain.removeNext(&item[0].node)) || (0 != chain.insertNext(&item[0].node, &item[9].node)) || item[9].node.isChained()) {
+            errorf("%s[%d]: wrong chain!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+
+        printf("%s[%d]: remove\n", __FILE__, __LINE__);
+
+        if ((&item[1].node != chain.removeFirst()) || (&item[5].node != chain.removeLast()) ||
+            (&item[3].node != chain.removeNext(&item[2].node)) || (&item[2].node != chain.removePrevious(&item[4].node)) ||
+            (4 != digits(chain)) || item[1].node.isChained()) {
+            errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, 4, digits(chain));
+            ++errors;
+        }
+    }
+
+    if (item[4].node.isChained() || item[0].node.isChained()) {
+        errorf("%s[%d]: not removed by destructor!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+
+    printf("%s[%d]: forEach and removeIf\n", __FILE__, __LINE__);
+
+    {
+        FastChain chain;
+        for (int ii = 1; ii < 10; ++ii) {
+            chain.insertLast(&item[ii].node);
+        }
+        FastChainSum some(5);
+        if ((&item[5].node != chain.forEach(some)) || (1234 != some.sum)) {
+            errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, 1234, some.sum);
+            ++errors;
+        }
+        FastChainOdd odd;
+        if ((5 != chain.removeIf(odd)) || (2468 != digits(chain)) || item[9].node.isChained()) {
+            errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, 2468, digits(chain));
+            ++errors;
+        }
+        if (0 != chain.removeIf(odd)) {
+            errorf("%s[%d]: removed!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+    }
+
+    printf("%s[%d]: errors=%d\n", __FILE__, __LINE__, errors);
+
+    return errors;
+}
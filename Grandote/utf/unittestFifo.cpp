@@ -62,6 +62,7 @@
 #include "com/diag/grandote/FifoType.h"
 #include "com/diag/grandote/Platform.h"
 #include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/string.h"
 #include "com/diag/grandote/Grandote.h"
 
 struct Datum { uint32_t one; uint32_t two; };
@@ -360,6 +361,137 @@ CXXCAPI int unittestFifo(void) {
 
     sample.show(1);
 
+    printf("%s[%d]: bulk\n", __FILE__, __LINE__);
+
+    {
+        char ring[16];
+        Fifo<char> bytes(ring, countof(ring));
+        static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz";
+        char buffer[sizeof(alphabet)];
+        size_t inserted = 0;
+        size_t removed = 0;
+        size_t nn;
+
+        //  Walk the head and tail around the ring so that every run
+        //  length meets every wrap point.
+
+        for (size_t pass = 0; (2 * countof(ring)) > pass; ++pass) {
+            size_t want = (pass % 11) + 1;
+            nn = bytes.insert(&alphabet[inserted % 16], want);
+            if (nn != ((want < bytes.total()) ? want : bytes.total())) {
+                errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, want, nn);
+                ++errors;
+            }
+            inserted += nn;
+            std::memset(buffer, 0, sizeof(buffer));
+            nn = bytes.remove(buffer, sizeof(buffer));
+            if (nn != (inserted - removed)) {
+                errorf("%s[%d]: (%u!=%u)!\n",
+                    __FILE__, __LINE__, inserted - removed, nn);
+                ++errors;
+            }
+            if (0 != std::memcmp(buffer, &alphabet[removed % 16], nn)) {
+                errorf("%s[%d]: (\"%.*s\"!=\"%.*s\")!\n", __FILE__, __LINE__,
+                    nn, &alphabet[removed % 16], nn, buffer);
+                ++errors;
+            }
+            removed += nn;
+            inserted %= 16;
+            removed %= 16;
+        }
+
+        nn = bytes.insert(alphabet, sizeof(alphabet) - 1);
+        if (countof(ring) != nn) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, countof(ring), nn);
+            ++errors;
+        }
+        nn = bytes.insert(alphabet, 1);
+        if (0 != nn) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 0, nn);
+            ++errors;
+        }
+        nn = bytes.remove(buffer, sizeof(buffer));
+        if ((countof(ring) != nn) || (0 != std::memcmp(buffer, alphabet, nn))) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, countof(ring), nn);
+            ++errors;
+        }
+        nn = bytes.remove(buffer, sizeof(buffer));
+        if (0 != nn) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 0, nn);
+            ++errors;
+        }
+
+        printf("%s[%d]: spans\n", __FILE__, __LINE__);
+
+        bytes.reset();
+        nn = bytes.insert(alphabet, 10);
+        nn = bytes.release(7);
+        if (7 != nn) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 7, nn);
+            ++errors;
+        }
+
+        //  Three used at [7..9]; the run of unused stops at the wrap.
+
+        char* space = bytes.reserve(nn);
+        if ((&ring[10] != space) || (6 != nn)) {
+            errorf("%s[%d]: (%p!=%p)(%u!=%u)!\n",
+                __FILE__, __LINE__, &ring[10], space, 6, nn);
+            ++errors;
+        }
+        std::memcpy(space, "KLMNOP", 6);
+        nn = bytes.commit(8);
+        if (6 != nn) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 6, nn);
+            ++errors;
+        }
+        space = bytes.reserve(nn);
+        if ((&ring[0] != space) || (7 != nn)) {
+            errorf("%s[%d]: (%p!=%p)(%u!=%u)!\n",
+                __FILE__, __LINE__, &ring[0], space, 7, nn);
+            ++errors;
+        }
+        std::memcpy(space, "QR", 2);
+        nn = bytes.commit(2);
+        if ((2 != nn) || (11 != bytes.used())) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 11, bytes.used());
+            ++errors;
+        }
+
+        const char* here = bytes.peekSpan(nn);
+        if ((&ring[7] != here) || (9 != nn) || (0 != std::memcmp(here, "hijKLMNOP", nn))) {
+            errorf("%s[%d]: (%p!=%p)(%u!=%u)!\n",
+                __FILE__, __LINE__, &ring[7], here, 9, nn);
+            ++errors;
+        }
+        nn = bytes.release(nn);
+        here = bytes.peekSpan(nn);
+        if ((&ring[0] != here) || (2 != nn) || (0 != std::memcmp(here, "QR", nn))) {
+            errorf("%s[%d]: (%p!=%p)(%u!=%u)!\n",
+                __FILE__, __LINE__, &ring[0], here, 2, nn);
+            ++errors;
+        }
+        nn = bytes.release(3);
+        if ((2 != nn) || (0 != bytes.used())) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 2, nn);
+            ++errors;
+        }
+        here = bytes.peekSpan(nn);
+        if (0 != nn) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 0, nn);
+            ++errors;
+        }
+
+        Fifo<char> null5;
+        space = null5.reserve(nn);
+        if ((0 != nn) || (0 != null5.commit(1)) || (0 != null5.insert(alphabet, 1)) || (0 != null5.remove(buffer, 1))) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 0, nn);
+            ++errors;
+        }
+
+        bytes.show(1);
+    }
+
     printf("%s[%d]: errors=%d\n", __FILE__, __LINE__, errors);
 
     return errors;
@@ -0,0 +1,226 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Implements the GcraTable unit test.
+ *
+ *  @see    GcraTable
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/UnitTest.h"
+#include "com/diag/grandote/GcraTable.h"
+#include "com/diag/grandote/GcraTable.h"
+#include "com/diag/grandote/Gcra.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/Grandote.h"
+#include <cstdlib>
+
+CXXCAPI int unittestGcraTable(void) {
+    Print printf(Platform::instance().output());
+    Print errorf(Platform::instance().error());
+    int errors = 0;
+
+    printf("%s[%d]: begin\n", __FILE__, __LINE__);
+
+    printf("%s[%d]: construction\n", __FILE__, __LINE__);
+
+    GcraTable table1(4);
+    table1.show(1);
+    if (4 != table1.size()) {
+        errorf("%s[%d]: (%zu!=%zu)!\n", __FILE__, __LINE__, 4, table1.size());
+        ++errors;
+    }
+    for (size_t flow = 0; table1.size() > flow; ++flow) {
+        if ((0 != table1.getIncrement(flow)) || (intmaxof(ticks_t) != table1.getLimit(flow)) || table1.isApproximate(flow)) {
+            errorf("%s[%d]: (%zu)!\n", __FILE__, __LINE__, flow);
+            ++errors;
+        }
+        for (unsigned int ii = 0; 10 > ii; ++ii) {
+            if (!table1.admit(flow, 1000, 0)) {
+                errorf("%s[%d]: (%zu) refused!\n", __FILE__, __LINE__, flow);
+                ++errors;
+            }
+        }
+    }
+
+    printf("%s[%d]: burst\n", __FILE__, __LINE__);
+
+    ticks_t now = 1000000;
+    table1.configure(2, 100, 250, now);
+    if ((100 != table1.getIncrement(2)) || (250 != table1.getLimit(2))) {
+        errorf("%s[%d]: (%llu,%llu)!\n",
+            __FILE__, __LINE__, table1.getIncrement(2), table1.getLimit(2));
+        ++errors;
+    }
+    static const size_t burst[] = { 2, 1, 2, 3, 2, 2 };
+    static const size_t sizes[] = { 1, 1, 1, 1, 1, 1 };
+    static const bool expected[] = { true, true, true, true, true, false };
+    bool verdicts[countof(burst)];
+    size_t admitted = table1.admit(burst, sizes, countof(burst), now, verdicts);
+    if (5 != admitted) {
+        errorf("%s[%d]: (%zu!=%zu)!\n", __FILE__, __LINE__, 5, admitted);
+        ++errors;
+    }
+    for (unsigned int ii = 0; countof(burst) > ii; ++ii) {
+        if (expected[ii] != verdicts[ii]) {
+            errorf("%s[%d]: (%u) (%d!=%d)!\n",
+                __FILE__, __LINE__, ii, expected[ii], verdicts[ii]);
+            ++errors;
+        }
+    }
+    if (50 != table1.admissible(2, now)) {
+        errorf("%s[%d]: (%llu!=%llu)!\n",
+            __FILE__, __LINE__, 50ULL, table1.admissible(2, now));
+        ++errors;
+    }
+    if (table1.admit(2, 1, now + 49)) {
+        errorf("%s[%d]: admitted!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    if (!table1.admit(2, 1, now + 50)) {
+        errorf("%s[%d]: refused!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    table1.reset(2, now + 50);
+    if (0 != table1.admissible(2, now + 50)) {
+        errorf("%s[%d]: (%llu!=%llu)!\n",
+            __FILE__, __LINE__, 0ULL, table1.admissible(2, now + 50));
+        ++errors;
+    }
+
+    printf("%s[%d]: equivalence\n", __FILE__, __LINE__);
+
+    static const size_t flows = 64;
+    static const size_t batch = 16;
+    GcraTable table2(flows);
+    Gcra* reference[flows];
+    std::srand(2);
+    now = 1000;
+    for (size_t flow = 0; flows > flow; ++flow) {
+        ticks_t increment = (flow % 7) * 10;
+        ticks_t limit = (flow % 5) * 100;
+        reference[flow] = new Gcra(increment, limit);
+        reference[flow]->reset(now);
+        table2.configure(flow, increment, limit, now);
+    }
+    size_t batchflows[batch];
+    size_t batchsizes[batch];
+    bool batchverdicts[batch];
+    size_t total = 0;
+    for (unsigned int ii = 0; 10000 > ii; ++ii) {
+        now += std::rand() % 50;
+        for (size_t jj = 0; batch > jj; ++jj) {
+            batchflows[jj] = std::rand() % flows;
+            batchsizes[jj] = 1 + (std::rand() % 4);
+        }
+        admitted = table2.admit(batchflows, batchsizes, batch, now, batchverdicts);
+        total += admitted;
+        for (size_t jj = 0; batch > jj; ++jj) {
+            Gcra& gcra = *reference[batchflows[jj]];
+            bool admit = (0 == gcra.admissible(now));
+            if (admit) {
+                gcra.commit(batchsizes[jj]);
+                --admitted;
+            } else {
+                gcra.rollback();
+            }
+            if (admit != batchverdicts[jj]) {
+                errorf("%s[%d]: (%u,%zu) (%d!=%d)!\n",
+                    __FILE__, __LINE__, ii, jj, admit, batchverdicts[jj]);
+                ++errors;
+            }
+        }
+        if (0 != admitted) {
+            errorf("%s[%d]: (%u) (%zu!=%zu)!\n",
+                __FILE__, __LINE__, ii, 0, admitted);
+            ++errors;
+        }
+        if (0 != errors) {
+            break;
+        }
+    }
+    printf("%s[%d]: admitted=%zu\n", __FILE__, __LINE__, total);
+    for (size_t flow = 0; flows > flow; ++flow) {
+        if (reference[flow]->admissible(now) != table2.admissible(flow, now)) {
+            errorf("%s[%d]: (%zu) (%llu!=%llu)!\n", __FILE__, __LINE__, flow,
+                reference[flow]->admissible(now), table2.admissible(flow, now));
+            ++errors;
+        }
+        reference[flow]->rollback();
+        delete reference[flow];
+    }
+
+    printf("%s[%d]: saturation\n", __FILE__, __LINE__);
+
+    GcraTable table3(1);
+    table3.configure(0, intmaxof(ticks_t) / 2, 0, 0);
+    if (!table3.admit(0, 3, 0)) {
+        errorf("%s[%d]: refused!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    if (!table3.isApproximate(0)) {
+        errorf("%s[%d]: exact!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    if (table3.admit(0, 1, intmaxof(ticks_t) - 1)) {
+        errorf("%s[%d]: admitted!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    table3.reset(0, 0);
+    if (table3.isApproximate(0)) {
+        errorf("%s[%d]: approximate!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    table3.show();
+
+    printf("%s[%d]: errors=%d\n", __FILE__, __LINE__, errors);
+
+    return errors;
+}
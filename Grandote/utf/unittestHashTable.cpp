@@ -0,0 +1,309 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+
+
+/**
+ *  @file
+ *
+ *  Implements the HashTable unit test.
+ *
+ *  @see    HashTable
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/UnitTest.h"
+#include "com/diag/grandote/HashTable.h"
+#include "com/diag/grandote/HashTable.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/Grandote.h"
+
+//
+//  An object that can be found by its identifier.
+//
+struct HashTableObject {
+
+    HashTableObject() :
+        node(this)
+    {}
+
+    HashNode<uint32_t, HashTableObject> node;
+
+};
+
+//
+//  A deliberately terrible hash function that puts every key in the same
+//  bucket.
+//
+struct HashTableCollide {
+
+    size_t operator()(const uint32_t& /* key */) const {
+        return 0;
+    }
+
+};
+
+template struct HashFunction<uint32_t>;
+template struct HashFunction<HashTableObject*>;
+template class HashNode<uint32_t, HashTableObject>;
+template class HashTable<uint32_t, HashTableObject>;
+template class HashTable<uint32_t, HashTableObject, HashTableCollide>;
+
+//
+//  Check that every object is found on the table if and only if expected,
+//  returning the number of failures.
+//
+template <typename _HASH_>
+static int check(const HashTable<uint32_t, HashTableObject, _HASH_>& table, HashTableObject* objects, const bool* expected, size_t count) {
+    int failures = 0;
+    for (size_t ii = 0; count > ii; ++ii) {
+        HashNode<uint32_t, HashTableObject>* node = table.find(objects[ii].node.getKey());
+        if (expected[ii]) {
+            if ((node != &objects[ii].node) || (node->getPayload() != &objects[ii])) {
+                ++failures;
+            }
+        } else if (node != 0) {
+            ++failures;
+        }
+    }
+    return failures;
+}
+
+CXXCAPI int unittestHashTable(void) {
+    Print printf(Platform::instance().output());
+    Print errorf(Platform::instance().error());
+    int errors = 0;
+
+    printf("%s[%d]: begin\n", __FILE__, __LINE__);
+
+    printf("%s[%d]: hash\n", __FILE__, __LINE__);
+
+    {
+        HashFunction<uint32_t> hash;
+        if ((hash(1) == hash(2)) || ((hash(0x100) & 0xff) == (hash(0x200) & 0xff))) {
+            errorf("%s[%d]: collision!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        HashTableObject one;
+        HashTableObject two;
+        HashFunction<HashTableObject*> pointer;
+        if (pointer(&one) == pointer(&two)) {
+            errorf("%s[%d]: collision!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+    }
+
+    printf("%s[%d]: basic\n", __FILE__, __LINE__);
+
+    {
+        HashTable<uint32_t, HashTableObject> table(5);
+        table.show();
+        if ((8 != table.buckets()) || !table.empty() || (0 != table.size()) || table.isRehashing()) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 8, table.buckets());
+            ++errors;
+        }
+        if ((0 != table.find(1)) || (0 != table.remove(1))) {
+            errorf("%s[%d]: found!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+
+        HashTableObject object[3];
+        for (size_t ii = 0; countof(object) > ii; ++ii) {
+            if (!object[ii].node.setKey(ii + 1) || !table.insert(object[ii].node)) {
+                errorf("%s[%d]: [%u] not inserted!\n", __FILE__, __LINE__, ii);
+                ++errors;
+            }
+        }
+        if (object[0].node.setKey(99) || table.insert(object[0].node)) {
+            errorf("%s[%d]: changed while inserted!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        HashTableObject duplicate;
+        duplicate.node.setKey(2);
+        if (table.insert(duplicate.node) || duplicate.node.isChained()) {
+            errorf("%s[%d]: duplicate inserted!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        table.show(1);
+        if ((3 != table.size()) || (&object[1].node != table.find(2))) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 3, table.size());
+            ++errors;
+        }
+        if ((&object[1].node != table.remove(2)) || (0 != table.find(2)) || (0 != table.remove(object[1].node))) {
+            errorf("%s[%d]: not removed!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        if ((&object[0].node != table.remove(object[0].node)) || object[0].node.isChained()) {
+            errorf("%s[%d]: not removed!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+
+        //  A node on another table is not removed from this one.
+
+        HashTable<uint32_t, HashTableObject> other;
+        HashTableObject stranger;
+        stranger.node.setKey(3);
+        other.insert(stranger.node);
+        if ((0 != table.remove(stranger.node)) || !stranger.node.isChained() || (1 != table.size())) {
+            errorf("%s[%d]: stranger removed!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        other.clear();
+
+        table.clear();
+        if (!table.empty() || object[2].node.isChained()) {
+            errorf("%s[%d]: not cleared!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+    }
+
+    printf("%s[%d]: collisions\n", __FILE__, __LINE__);
+
+    {
+        HashTable<uint32_t, HashTableObject, HashTableCollide> table(1, 0);
+        HashTableObject object[100];
+        bool expected[countof(object)];
+        for (size_t ii = 0; countof(object) > ii; ++ii) {
+            object[ii].node.setKey(ii * 7);
+            table.insert(object[ii].node);
+            expected[ii] = true;
+        }
+        for (size_t ii = 0; countof(object) > ii; ii += 2) {
+            table.remove(object[ii].node.getKey());
+            expected[ii] = false;
+        }
+        int failures = check(table, object, expected, countof(object));
+        if ((0 != failures) || (1 != table.buckets()) || ((countof(object) / 2) != table.size())) {
+            errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, 0, failures);
+            ++errors;
+        }
+        table.clear();
+    }
+
+    printf("%s[%d]: rehash\n", __FILE__, __LINE__);
+
+    {
+        static const size_t count = 20000;
+        HashTableObject* object = new HashTableObject[count];
+        bool* expected = new bool[count]();
+        HashTable<uint32_t, HashTableObject> table(1, 2);
+        size_t grew = 0;
+        size_t rehashing = 0;
+        size_t buckets = table.buckets();
+
+        //  Check everything whenever the table starts, and while it is in
+        //  the middle of, rehashing.
+
+        for (size_t ii = 0; count > ii; ++ii) {
+            object[ii].node.setKey(ii * 0x10000);
+            expected[ii] = true;
+            if (!table.insert(object[ii].node)) {
+                errorf("%s[%d]: [%u] not inserted!\n", __FILE__, __LINE__, ii);
+                ++errors;
+                break;
+            }
+            if ((ii % 3) == 0) {
+                table.remove(object[ii / 2].node);
+                expected[ii / 2] = false;
+            }
+            if (table.buckets() != buckets) {
+                if ((2 * buckets) != table.buckets()) {
+                    errorf("%s[%d]: (%u!=%u)!\n",
+                        __FILE__, __LINE__, 2 * buckets, table.buckets());
+                    ++errors;
+                }
+                buckets = table.buckets();
+                ++grew;
+            }
+            if (table.isRehashing()) {
+                ++rehashing;
+                if (((rehashing % 97) == 1) && (0 != check(table, object, expected, ii + 1))) {
+                    errorf("%s[%d]: [%u] not found while rehashing!\n",
+                        __FILE__, __LINE__, ii);
+                    ++errors;
+                    break;
+                }
+            }
+        }
+        table.show(1);
+
+        size_t present = 0;
+        for (size_t ii = 0; count > ii; ++ii) {
+            if (expected[ii]) {
+                ++present;
+            }
+        }
+        int failures = check(table, object, expected, count);
+        if ((0 != failures) || (present != table.size()) || (0 == grew) || (0 == rehashing)) {
+            errorf("%s[%d]: (%u!=%u) failures=%d grew=%u rehashing=%u!\n",
+                __FILE__, __LINE__, present, table.size(), failures,
+                grew, rehashing);
+            ++errors;
+        }
+
+        for (size_t ii = 0; count > ii; ++ii) {
+            if (expected[ii] && (&object[ii].node != table.remove(object[ii].node.getKey()))) {
+                errorf("%s[%d]: [%u] not removed!\n", __FILE__, __LINE__, ii);
+                ++errors;
+                break;
+            }
+        }
+        if (!table.empty() || table.isRehashing()) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 0, table.size());
+            ++errors;
+        }
+        printf("%s[%d]: buckets=%u grew=%u rehashing=%u\n",
+            __FILE__, __LINE__, table.buckets(), grew, rehashing);
+
+        delete [] expected;
+        delete [] object;
+    }
+
+    printf("%s[%d]: errors=%d\n", __FILE__, __LINE__, errors);
+
+    return errors;
+}
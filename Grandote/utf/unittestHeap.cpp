@@ -54,6 +54,7 @@
 
 
 #include "com/diag/grandote/stdlib.h"
+#include "com/diag/grandote/string.h"
 #include "com/diag/grandote/UnitTest.h"
 #include "com/diag/grandote/Heap.h"
 #include "com/diag/grandote/Heap.h"
@@ -585,6 +586,88 @@ CXXCAPI int unittestHeap(void) {
         ++errors;
     }
 
+    printf("%s[%d]: segregation\n", __FILE__, __LINE__);
+
+    //  Segregation is off by default.
+
+    was = heap.segregate(true);
+    if (was) {
+        errorf("%s[%d]: (%d!=%d)!\n",
+            __FILE__, __LINE__, false, was);
+        ++errors;
+    }
+
+    //  Growing within a size class happens in place.
+
+    block[0] = heap.malloc(BYTES + 1);
+    vp = heap.realloc(block[0], BYTES + 2);
+    if (block[0] != vp) {
+        errorf("%s[%d]: (%p!=%p)!\n",
+            __FILE__, __LINE__, block[0], vp);
+        ++errors;
+    }
+    block[0] = vp;
+
+    //  Blocks allocated either way are freed correctly either way.
+
+    was = heap.segregate(false);
+    if (!was) {
+        errorf("%s[%d]: (%d!=%d)!\n",
+            __FILE__, __LINE__, true, was);
+        ++errors;
+    }
+    block[1] = heap.malloc(BYTES);
+    vp = heap.realloc(block[0], BYTES * 2);
+    if (0 == vp) {
+        errorf("%s[%d]: (%p==%p)!\n",
+            __FILE__, __LINE__, 0, vp);
+        ++errors;
+    }
+    block[0] = vp;
+    was = heap.segregate(true);
+    if (was) {
+        errorf("%s[%d]: (%d!=%d)!\n",
+            __FILE__, __LINE__, false, was);
+        ++errors;
+    }
+    heap.free(block[1]);
+    heap.free(block[0]);
+
+    current = heap.getCurrent();
+    if (0 != current) {
+        errorf("%s[%d]: (%lu!=%lu)!\n",
+            __FILE__, __LINE__, 0, current);
+        ++errors;
+    }
+
+    heap.show();
+
+    printf("%s[%d]: orphans\n", __FILE__, __LINE__);
+
+    //  Blocks outlive the heap that allocated them.
+
+    Heap* parent = new Heap;
+    parent->segregate(true);
+    block[0] = parent->malloc(BYTES);
+    block[1] = parent->malloc(BYTES * 4);
+    if ((0 == block[0]) || (0 == block[1])) {
+        errorf("%s[%d]: (%p,%p)!\n",
+            __FILE__, __LINE__, block[0], block[1]);
+        ++errors;
+    }
+    std::memset(block[0], 0xa5, BYTES);
+    std::memset(block[1], 0x5a, BYTES * 4);
+    delete parent;
+    {
+        Heap survivor;
+        survivor.free(block[0]);
+        survivor.free(block[1]);
+        if (2 != survivor.getFrees()) {
+            errorf("%s[%d]: (%lu!=%lu)!\n",
+                __FILE__, __LINE__, 2, survivor.getFrees());
+            ++errors;
+        }
+    }
 
     printf("%s[%d]: end errors=%d\n",
         __FILE__, __LINE__, errors);
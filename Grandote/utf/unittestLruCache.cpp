@@ -0,0 +1,302 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+
+
+/**
+ *  @file
+ *
+ *  Implements the LruCache unit test.
+ *
+ *  @see    LruCache
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/UnitTest.h"
+#include "com/diag/grandote/LruCache.h"
+#include "com/diag/grandote/LruCache.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/Grandote.h"
+
+//
+//  A cached object.
+//
+struct LruCacheObject {
+
+    LruCacheObject() :
+        node(this),
+        evicted(0)
+    {}
+
+    LruNode<int, LruCacheObject> node;
+
+    unsigned int evicted;
+
+};
+
+typedef LruCache<int, LruCacheObject> LruCacheTest;
+
+//
+//  Counts evictions and remembers the order in which they happened.
+//
+class LruCacheEvictor : public LruCacheTest::Functor {
+
+public:
+
+    LruCacheEvictor() :
+        count(0),
+        last(0),
+        errors(0)
+    {}
+
+    virtual void operator() (LruCacheTest& /* cache */, LruCacheTest::Node& node) {
+        if (node.isCached()) {
+            ++this->errors;
+        }
+        ++node.getPayload()->evicted;
+        this->last = node.getKey();
+        ++this->count;
+    }
+
+    unsigned int count;
+
+    int last;
+
+    unsigned int errors;
+
+};
+
+template class LruNode<int, LruCacheObject>;
+template class LruCache<int, LruCacheObject>;
+
+CXXCAPI int unittestLruCache(void) {
+    Print printf(Platform::instance().output());
+    Print errorf(Platform::instance().error());
+    int errors = 0;
+
+    printf("%s[%d]: begin\n", __FILE__, __LINE__);
+
+    printf("%s[%d]: entries\n", __FILE__, __LINE__);
+
+    {
+        LruCacheEvictor evictor;
+        LruCacheTest cache(3, 0, &evictor);
+        cache.show();
+        if (!cache.empty() || (0 != cache.size()) || (3 != cache.getEntryCapacity()) || (0 != cache.getByteCapacity()) || (0 != cache.oldest())) {
+            errorf("%s[%d]: not empty!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+
+        LruCacheObject object[5];
+        for (size_t ii = 0; countof(object) > ii; ++ii) {
+            object[ii].node.setKey(ii);
+        }
+
+        for (size_t ii = 0; 3 > ii; ++ii) {
+            if (!cache.insert(object[ii].node) || !object[ii].node.isCached()) {
+                errorf("%s[%d]: [%u] not inserted!\n", __FILE__, __LINE__, ii);
+                ++errors;
+            }
+        }
+        if (cache.insert(object[0].node) || object[0].node.setKey(9) || object[0].node.setSize(9)) {
+            errorf("%s[%d]: changed while cached!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        if ((3 != cache.size()) || (0 != evictor.count) || (&object[0].node != cache.oldest())) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 3, cache.size());
+            ++errors;
+        }
+
+        //  Finding 0 makes 1 the oldest, and so the one evicted by 3.
+
+        if ((&object[0].node != cache.find(0)) || (&object[1].node != cache.oldest())) {
+            errorf("%s[%d]: not found!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        if ((0 != cache.find(4)) || (&object[2].node != cache.peek(2)) || (0 != cache.peek(4))) {
+            errorf("%s[%d]: wrong find!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        cache.insert(object[3].node);
+        if ((1 != evictor.count) || (1 != evictor.last) || object[1].node.isCached() || (1 != object[1].evicted) || (3 != cache.size())) {
+            errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, 1, evictor.last);
+            ++errors;
+        }
+
+        //  Peeking 2 did not refresh it, so 2 goes next.
+
+        cache.insert(object[4].node);
+        if ((2 != evictor.count) || (2 != evictor.last)) {
+            errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, 2, evictor.last);
+            ++errors;
+        }
+
+        //  Removal does not call the functor.
+
+        if ((&object[3].node != cache.remove(3)) || (&object[0].node != cache.remove(object[0].node)) || (0 != cache.remove(object[0].node)) || (0 != cache.remove(3))) {
+            errorf("%s[%d]: not removed!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        if ((2 != evictor.count) || (1 != cache.size()) || (0 != evictor.errors)) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 2, evictor.count);
+            ++errors;
+        }
+
+        Counters& counters = cache.getCounters();
+        cache.show(1);
+        if ((1 != counters.get(LruCacheTest::HITS)) ||
+            (1 != counters.get(LruCacheTest::MISSES)) ||
+            (5 != counters.get(LruCacheTest::INSERTS)) ||
+            (2 != counters.get(LruCacheTest::EVICTIONS)) ||
+            (2 != counters.get(LruCacheTest::REMOVALS))) {
+            errorf("%s[%d]: wrong counters!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+
+        cache.clear();
+        if (!cache.empty() || object[4].node.isCached() || (2 != evictor.count)) {
+            errorf("%s[%d]: not cleared!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+    }
+
+    printf("%s[%d]: bytes\n", __FILE__, __LINE__);
+
+    {
+        LruCacheEvictor evictor;
+        LruCacheTest cache(0, 100, &evictor);
+        LruCacheObject object[10];
+        for (size_t ii = 0; countof(object) > ii; ++ii) {
+            object[ii].node.setKey(ii);
+            object[ii].node.setSize(10 * (ii + 1));
+        }
+
+        //  10 + 20 + 30 + 40 = 100 fits; adding 50 evicts 10, 20 and 30.
+
+        for (size_t ii = 0; 4 > ii; ++ii) {
+            cache.insert(object[ii].node);
+        }
+        if ((100 != cache.bytes()) || (0 != evictor.count)) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 100, cache.bytes());
+            ++errors;
+        }
+        cache.insert(object[4].node);
+        if ((90 != cache.bytes()) || (3 != evictor.count) || (2 != evictor.last) || (2 != cache.size())) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 90, cache.bytes());
+            ++errors;
+        }
+
+        //  Too big to ever fit.
+
+        LruCacheObject huge;
+        huge.node.setKey(99);
+        huge.node.setSize(101);
+        if (cache.insert(huge.node) || huge.node.isCached() || (3 != evictor.count)) {
+            errorf("%s[%d]: too big inserted!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+
+        //  Shrinking the capacity evicts.
+
+        if ((1 != cache.setCapacity(0, 50)) || (50 != cache.bytes()) || (3 != evictor.last)) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 50, cache.bytes());
+            ++errors;
+        }
+        if (0 != cache.setCapacity(0, 0)) {
+            errorf("%s[%d]: evicted!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        for (size_t ii = 0; countof(object) > ii; ++ii) {
+            cache.insert(object[ii].node);
+        }
+        if ((10 != cache.size()) || (550 != cache.bytes()) || (4 != evictor.count)) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 550, cache.bytes());
+            ++errors;
+        }
+        cache.clear();
+    }
+
+    printf("%s[%d]: many\n", __FILE__, __LINE__);
+
+    {
+        static const size_t count = 10000;
+        static const size_t capacity = 1000;
+        LruCacheEvictor evictor;
+        LruCacheTest cache(capacity, 0, &evictor);
+        LruCacheObject* object = new LruCacheObject[count];
+        for (size_t ii = 0; count > ii; ++ii) {
+            object[ii].node.setKey(ii);
+            cache.insert(object[ii].node);
+            if (cache.size() > capacity) {
+                errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, capacity, cache.size());
+                ++errors;
+                break;
+            }
+            if ((ii >= capacity) && (static_cast<int>(ii - capacity + 1) != evictor.last)) {
+                errorf("%s[%d]: (%u!=%d)!\n", __FILE__, __LINE__, ii - capacity + 1, evictor.last);
+                ++errors;
+                break;
+            }
+            //  Keep key zero hot.
+            if (0 == cache.find(0)) {
+                errorf("%s[%d]: [%u] lost!\n", __FILE__, __LINE__, ii);
+                ++errors;
+                break;
+            }
+        }
+        if (((count - capacity) != evictor.count) || (0 != evictor.errors)) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, count - capacity, evictor.count);
+            ++errors;
+        }
+        cache.clear();
+        delete [] object;
+    }
+
+    printf("%s[%d]: errors=%d\n", __FILE__, __LINE__, errors);
+
+    return errors;
+}
@@ -0,0 +1,326 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Implements the MpmcFifo unit test.
+ *
+ *  @see    MpmcFifo
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/UnitTest.h"
+#include "com/diag/grandote/MpmcFifo.h"
+#include "com/diag/grandote/MpmcFifo.h"
+#include "com/diag/grandote/Thread.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/Grandote.h"
+
+template class MpmcFifo<char>;
+template class MpmcFifo<int>;
+template class MpmcFifo<uint32_t>;
+template class MpmcFifo<uint64_t>;
+
+static MpmcFifo<int> staticMpmcFifo;
+
+static const unsigned int producers = 4;
+static const unsigned int consumers = 4;
+static const uint32_t limit = 100000;
+
+//
+//  Inserts a sequence of numbers tagged with the producer number.
+//
+class MpmcFifoProducer : public Thread {
+
+public:
+
+    MpmcFifoProducer() :
+        fifo(0),
+        number(0)
+    {}
+
+    virtual void * run() {
+        for (uint32_t ii = 0; limit > ii; ++ii) {
+            while (!this->fifo->insert((static_cast<uint64_t>(this->number) << 32) | ii)) {
+                Thread::yield();
+            }
+        }
+        return 0;
+    }
+
+    MpmcFifo<uint64_t>* fifo;
+
+    uint32_t number;
+
+};
+
+//
+//  Removes numbers until told to stop and the queue is empty, checking
+//  that the numbers from each producer arrive in order.
+//
+class MpmcFifoConsumer : public Thread {
+
+public:
+
+    MpmcFifoConsumer() :
+        fifo(0),
+        done(0),
+        received(0),
+        errors(0)
+    {
+        for (unsigned int ii = 0; producers > ii; ++ii) {
+            this->next[ii] = 0;
+        }
+    }
+
+    virtual void * run() {
+        uint64_t entry;
+        while (true) {
+            if (this->fifo->remove(entry)) {
+                uint32_t nn = entry >> 32;
+                uint32_t ii = entry & 0xffffffffUL;
+                if ((producers <= nn) || (ii < this->next[nn])) {
+                    ++this->errors;
+                } else {
+                    this->next[nn] = ii + 1;
+                }
+                ++this->received;
+            } else if (__atomic_load_n(this->done, __ATOMIC_ACQUIRE)) {
+                break;
+            } else {
+                Thread::yield();
+            }
+        }
+        return 0;
+    }
+
+    MpmcFifo<uint64_t>* fifo;
+
+    int* done;
+
+    unsigned long received;
+
+    unsigned long errors;
+
+    uint32_t next[producers];
+
+};
+
+CXXCAPI int unittestMpmcFifo(void) {
+    Print printf(Platform::instance().output());
+    Print errorf(Platform::instance().error());
+    int errors = 0;
+
+    printf("%s[%d]: begin\n", __FILE__, __LINE__);
+
+    ::staticMpmcFifo.show();
+
+    printf("%s[%d]: sizing\n", __FILE__, __LINE__);
+
+    static const size_t sizes[][2] = {
+        { 0, 0 }, { 1, 2 }, { 2, 2 }, { 3, 4 }, { 6, 8 }, { 16, 16 }, { 17, 32 }
+    };
+    for (unsigned int ii = 0; countof(sizes) > ii; ++ii) {
+        MpmcFifo<char> sized(sizes[ii][0]);
+        if (sizes[ii][1] != sized.total()) {
+            errorf("%s[%d]: (%u!=%u)!\n",
+                __FILE__, __LINE__, sizes[ii][1], sized.total());
+            ++errors;
+        }
+    }
+
+    printf("%s[%d]: null\n", __FILE__, __LINE__);
+
+    MpmcFifo<uint64_t> null1;
+    null1.show();
+    uint64_t longlonginstance = 0;
+    bool success = null1.peek(longlonginstance);
+    if (false != success) {
+        errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, false, success);
+        ++errors;
+    }
+    success = null1.remove(longlonginstance);
+    if (false != success) {
+        errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, false, success);
+        ++errors;
+    }
+    success = null1.insert(longlonginstance);
+    if (false != success) {
+        errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, false, success);
+        ++errors;
+    }
+
+    printf("%s[%d]: fill and empty\n", __FILE__, __LINE__);
+
+    static const unsigned int count = 16;
+
+    MpmcFifo<int> fifo(count);
+    int intinstance;
+    for (unsigned int pass = 0; 3 > pass; ++pass) {
+        for (unsigned int jj = 0; count > jj; ++jj) {
+            success = fifo.insert(jj + pass);
+            if (true != success) {
+                errorf("%s[%d]: (%d!=%d)!\n",
+                    __FILE__, __LINE__, true, success);
+                ++errors;
+            }
+        }
+        success = fifo.insert(count);
+        if (false != success) {
+            errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, false, success);
+            ++errors;
+        }
+        if ((count != fifo.used()) || (0 != fifo.free())) {
+            errorf("%s[%d]: (%u!=%u)!\n",
+                __FILE__, __LINE__, count, fifo.used());
+            ++errors;
+        }
+        fifo.show(1);
+        for (unsigned int jj = 0; count > jj; ++jj) {
+            intinstance = -1;
+            success = fifo.peek(intinstance);
+            if ((true != success) || (static_cast<int>(jj + pass) != intinstance)) {
+                errorf("%s[%d]: (%d!=%d)!\n",
+                    __FILE__, __LINE__, jj + pass, intinstance);
+                ++errors;
+            }
+            intinstance = -1;
+            success = fifo.remove(intinstance);
+            if ((true != success) || (static_cast<int>(jj + pass) != intinstance)) {
+                errorf("%s[%d]: (%d!=%d)!\n",
+                    __FILE__, __LINE__, jj + pass, intinstance);
+                ++errors;
+            }
+        }
+        success = fifo.remove(intinstance);
+        if (false != success) {
+            errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, false, success);
+            ++errors;
+        }
+        success = fifo.peek(intinstance);
+        if (false != success) {
+            errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, false, success);
+            ++errors;
+        }
+        if ((0 != fifo.used()) || (count != fifo.free())) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 0, fifo.used());
+            ++errors;
+        }
+    }
+
+    printf("%s[%d]: reset\n", __FILE__, __LINE__);
+
+    fifo.insert(1);
+    fifo.insert(2);
+    fifo.reset();
+    if (0 != fifo.used()) {
+        errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 0, fifo.used());
+        ++errors;
+    }
+    success = fifo.remove(intinstance);
+    if (false != success) {
+        errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, false, success);
+        ++errors;
+    }
+    success = fifo.insert(3);
+    if ((true != success) || !fifo.remove(intinstance) || (3 != intinstance)) {
+        errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, 3, intinstance);
+        ++errors;
+    }
+
+    printf("%s[%d]: threads\n", __FILE__, __LINE__);
+
+    MpmcFifo<uint64_t> shared(8);
+    int done = 0;
+    MpmcFifoProducer producer[producers];
+    MpmcFifoConsumer consumer[consumers];
+
+    for (unsigned int ii = 0; consumers > ii; ++ii) {
+        consumer[ii].fifo = &shared;
+        consumer[ii].done = &done;
+        if (0 != consumer[ii].start()) {
+            errorf("%s[%d]: (%u)!\n", __FILE__, __LINE__, ii);
+            ++errors;
+        }
+    }
+    for (unsigned int ii = 0; producers > ii; ++ii) {
+        producer[ii].fifo = &shared;
+        producer[ii].number = ii;
+        if (0 != producer[ii].start()) {
+            errorf("%s[%d]: (%u)!\n", __FILE__, __LINE__, ii);
+            ++errors;
+        }
+    }
+    for (unsigned int ii = 0; producers > ii; ++ii) {
+        producer[ii].join();
+    }
+    __atomic_store_n(&done, 1, __ATOMIC_RELEASE);
+    unsigned long received = 0;
+    for (unsigned int ii = 0; consumers > ii; ++ii) {
+        consumer[ii].join();
+        printf("%s[%d]: consumer=%u received=%lu errors=%lu\n",
+            __FILE__, __LINE__, ii, consumer[ii].received, consumer[ii].errors);
+        received += consumer[ii].received;
+        errors += consumer[ii].errors;
+    }
+    if ((producers * limit) != received) {
+        errorf("%s[%d]: (%lu!=%lu)!\n",
+            __FILE__, __LINE__, producers * limit, received);
+        ++errors;
+    }
+    if (0 != shared.used()) {
+        errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 0, shared.used());
+        ++errors;
+    }
+
+    shared.show(1);
+
+    printf("%s[%d]: errors=%d\n", __FILE__, __LINE__, errors);
+
+    return errors;
+}
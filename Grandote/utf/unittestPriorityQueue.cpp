@@ -0,0 +1,315 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+
+
+/**
+ *  @file
+ *
+ *  Implements the PriorityQueue unit test.
+ *
+ *  @see    PriorityQueue
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/UnitTest.h"
+#include "com/diag/grandote/PriorityQueue.h"
+#include "com/diag/grandote/PriorityQueue.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/Grandote.h"
+
+//
+//  A work item ordered by its deadline, embedding its queue node.
+//
+struct PriorityQueueWork {
+
+    PriorityQueueWork() :
+        node(this),
+        deadline(0)
+    {}
+
+    bool operator<(const PriorityQueueWork& that) const {
+        return this->deadline < that.deadline;
+    }
+
+    PriorityNode<PriorityQueueWork> node;
+
+    ticks_t deadline;
+
+};
+
+//
+//  Orders work items latest deadline first.
+//
+struct PriorityQueueLater {
+
+    bool operator()(const PriorityQueueWork& one, const PriorityQueueWork& two) const {
+        return two.deadline < one.deadline;
+    }
+
+};
+
+template class PriorityNode<PriorityQueueWork>;
+template class PriorityQueue<PriorityQueueWork>;
+template class PriorityQueue<PriorityQueueWork, PriorityQueueLater>;
+
+static uint64_t seed = 1;
+
+static uint64_t random64() {
+    seed = (seed * 6364136223846793005ULL) + 1442695040888963407ULL;
+    return seed >> 16;
+}
+
+//
+//  Drain the queue, returning the number of nodes that came off out of
+//  order or without their node having been reset.
+//
+template <typename _LESS_>
+static int drain(PriorityQueue<PriorityQueueWork, _LESS_>& queue, size_t& drained) {
+    _LESS_ less;
+    int errors = 0;
+    PriorityQueueWork* prior = 0;
+    PriorityNode<PriorityQueueWork>* node;
+    drained = 0;
+    while ((node = queue.remove()) != 0) {
+        PriorityQueueWork* work = node->getPayload();
+        if ((prior != 0) && less(*work, *prior)) {
+            ++errors;
+        }
+        if (node->isQueued()) {
+            ++errors;
+        }
+        prior = work;
+        ++drained;
+    }
+    return errors;
+}
+
+CXXCAPI int unittestPriorityQueue(void) {
+    Print printf(Platform::instance().output());
+    Print errorf(Platform::instance().error());
+    int errors = 0;
+
+    printf("%s[%d]: begin\n", __FILE__, __LINE__);
+
+    printf("%s[%d]: basic\n", __FILE__, __LINE__);
+
+    {
+        PriorityQueue<PriorityQueueWork> queue;
+        queue.show();
+        if (!queue.empty() || (0 != queue.size()) || (0 != queue.peek()) || (0 != queue.remove())) {
+            errorf("%s[%d]: not empty!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+
+        PriorityQueueWork work[5];
+        static const ticks_t deadlines[] = { 30, 10, 50, 20, 40 };
+        for (size_t ii = 0; countof(work) > ii; ++ii) {
+            work[ii].deadline = deadlines[ii];
+            if (work[ii].node.isQueued() || !queue.insert(work[ii].node) || !work[ii].node.isQueued()) {
+                errorf("%s[%d]: [%u] not queued!\n", __FILE__, __LINE__, ii);
+                ++errors;
+            }
+        }
+        if (queue.insert(work[0].node)) {
+            errorf("%s[%d]: queued twice!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        queue.show(1);
+        if ((5 != queue.size()) || (&work[1].node != queue.peek())) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 5, queue.size());
+            ++errors;
+        }
+
+        //  Remove from the middle, then the head, by handle.
+
+        if ((&work[0].node != queue.remove(work[0].node)) || work[0].node.isQueued() || (0 != queue.remove(work[0].node))) {
+            errorf("%s[%d]: not removed!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        if ((&work[1].node != queue.remove(work[1].node)) || (&work[3].node != queue.peek())) {
+            errorf("%s[%d]: not removed!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+
+        //  Decrease moves forward; update moves either way.
+
+        work[2].deadline = 5;
+        if (!queue.decrease(work[2].node) || (&work[2].node != queue.peek())) {
+            errorf("%s[%d]: not decreased!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        work[2].deadline = 45;
+        if (!queue.update(work[2].node) || (&work[3].node != queue.peek())) {
+            errorf("%s[%d]: not updated!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        if (queue.decrease(work[0].node) || queue.update(work[0].node)) {
+            errorf("%s[%d]: not queued but changed!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+
+        static const ticks_t expected[] = { 20, 40, 45 };
+        for (size_t ii = 0; countof(expected) > ii; ++ii) {
+            PriorityNode<PriorityQueueWork>* node = queue.remove();
+            if ((0 == node) || (expected[ii] != node->getPayload()->deadline)) {
+                errorf("%s[%d]: [%u] wrong order!\n", __FILE__, __LINE__, ii);
+                ++errors;
+            }
+        }
+        if (!queue.empty() || (0 != queue.size())) {
+            errorf("%s[%d]: not empty!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+
+        //  Clearing leaves every node unqueued.
+
+        for (size_t ii = 0; countof(work) > ii; ++ii) {
+            queue.insert(work[ii].node);
+        }
+        queue.clear();
+        for (size_t ii = 0; countof(work) > ii; ++ii) {
+            if (work[ii].node.isQueued()) {
+                errorf("%s[%d]: [%u] queued!\n", __FILE__, __LINE__, ii);
+                ++errors;
+            }
+        }
+    }
+
+    printf("%s[%d]: comparator\n", __FILE__, __LINE__);
+
+    {
+        PriorityQueue<PriorityQueueWork, PriorityQueueLater> queue;
+        PriorityQueueWork work[100];
+        for (size_t ii = 0; countof(work) > ii; ++ii) {
+            work[ii].deadline = random64() % 50;
+            queue.insert(work[ii].node);
+        }
+        size_t drained;
+        int failures = drain(queue, drained);
+        if ((0 != failures) || (countof(work) != drained)) {
+            errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, 0, failures);
+            ++errors;
+        }
+    }
+
+    printf("%s[%d]: many\n", __FILE__, __LINE__);
+
+    {
+        static const size_t count = 20000;
+        PriorityQueueWork* work = new PriorityQueueWork[count];
+        PriorityQueue<PriorityQueueWork> queue;
+        size_t queued = 0;
+
+        //  Interleave inserts, removals of the head, removals by handle,
+        //  decreases, and updates in both directions.
+
+        for (size_t round = 0; (4 * count) > round; ++round) {
+            PriorityQueueWork& item = work[random64() % count];
+            switch (random64() % 6) {
+            case 0:
+            case 1:
+                if (!item.node.isQueued()) {
+                    item.deadline = random64() % 1000000;
+                    queue.insert(item.node);
+                    ++queued;
+                }
+                break;
+            case 2:
+                if (0 != queue.remove()) {
+                    --queued;
+                }
+                break;
+            case 3:
+                if (0 != queue.remove(item.node)) {
+                    --queued;
+                }
+                break;
+            case 4:
+                if (item.node.isQueued()) {
+                    item.deadline -= item.deadline / 2;
+                    queue.decrease(item.node);
+                }
+                break;
+            case 5:
+                if (item.node.isQueued()) {
+                    item.deadline = random64() % 1000000;
+                    queue.update(item.node);
+                }
+                break;
+            }
+            if ((queued != queue.size()) || ((0 != queue.peek()) && !queue.peek()->isQueued())) {
+                errorf("%s[%d]: [%u] (%u!=%u)!\n",
+                    __FILE__, __LINE__, round, queued, queue.size());
+                ++errors;
+                break;
+            }
+        }
+
+        size_t drained;
+        int failures = drain(queue, drained);
+        if ((0 != failures) || (queued != drained)) {
+            errorf("%s[%d]: (%u!=%u) failures=%d!\n",
+                __FILE__, __LINE__, queued, drained, failures);
+            ++errors;
+        }
+        for (size_t ii = 0; count > ii; ++ii) {
+            if (work[ii].node.isQueued()) {
+                errorf("%s[%d]: [%u] queued!\n", __FILE__, __LINE__, ii);
+                ++errors;
+                break;
+            }
+        }
+        printf("%s[%d]: drained=%u\n", __FILE__, __LINE__, drained);
+
+        delete [] work;
+    }
+
+    printf("%s[%d]: errors=%d\n", __FILE__, __LINE__, errors);
+
+    return errors;
+}
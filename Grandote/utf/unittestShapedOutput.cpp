@@ -0,0 +1,359 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Implements the ShapedOutput unit test.
+ *
+ *  @see    ShapedOutput
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include <poll.h>
+#include "com/diag/grandote/UnitTest.h"
+#include "com/diag/grandote/ShapedOutput.h"
+#include "com/diag/grandote/ShapedOutput.h"
+#include "com/diag/grandote/BufferOutput.h"
+#include "com/diag/grandote/Throttle.h"
+#include "com/diag/grandote/Gcra.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/Grandote.h"
+#include "com/diag/grandote/string.h"
+
+static const char data[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+
+//
+//  Accepts no more octets than its window allows, like a non-blocking
+//  descriptor whose buffer is full.
+//
+class ShortOutput : public BufferOutput {
+
+public:
+
+    ShortOutput(char* sp, size_t sz) :
+        BufferOutput(sp, sz),
+        window(sz)
+    {}
+
+    using BufferOutput::operator();
+
+    virtual ssize_t operator() (const void* buffer, size_t minimum, size_t /* maximum */) {
+        size_t size = (minimum < this->window) ? minimum : this->window;
+        if (size == 0) {
+            return 0;
+        }
+        ssize_t rc = this->BufferOutput::operator()(buffer, size, size);
+        if (rc > 0) {
+            this->window -= rc;
+        }
+        return rc;
+    }
+
+    size_t window;
+
+};
+
+CXXCAPI int unittestShapedOutput(void) {
+    Print printf(Platform::instance().output());
+    Print errorf(Platform::instance().error());
+    int errors = 0;
+    Platform& pl = Platform::instance();
+    ticks_t hz = pl.frequency();
+
+    printf("%s[%d]: begin\n", __FILE__, __LINE__);
+
+    printf("%s[%d]: promiscuous\n", __FILE__, __LINE__);
+
+    {
+        char buffer[sizeof(data)] = { 0 };
+        BufferOutput sink(buffer, sizeof(buffer));
+        Throttle throttle;
+        ShapedOutput output(sink, throttle, 4);
+        output.show();
+        ssize_t rc = output(data, 10, 10);
+        if (10 != rc) {
+            errorf("%s[%d]: (%zd!=%d)!\n", __FILE__, __LINE__, rc, 10);
+            ++errors;
+        }
+        if (10 != output.getSent()) {
+            errorf("%s[%d]: (%llu!=%d)!\n", __FILE__, __LINE__, output.getSent(), 10);
+            ++errors;
+        }
+        if (3 != output.getChunks()) {
+            errorf("%s[%d]: (%llu!=%d)!\n", __FILE__, __LINE__, output.getChunks(), 3);
+            ++errors;
+        }
+        if (0 != output.getDelayed()) {
+            errorf("%s[%d]: (%llu!=%d)!\n", __FILE__, __LINE__, output.getDelayed(), 0);
+            ++errors;
+        }
+        if (0 != ::strncmp(buffer, data, 10)) {
+            errorf("%s[%d]: (\"%.10s\"!=\"%.10s\")!\n", __FILE__, __LINE__, buffer, data);
+            ++errors;
+        }
+        rc = output("0123");
+        if (4 != rc) {
+            errorf("%s[%d]: (%zd!=%d)!\n", __FILE__, __LINE__, rc, 4);
+            ++errors;
+        }
+        if ('5' != output('5')) {
+            errorf("%s[%d]: failed!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        if (0 != ::strncmp(buffer + 10, "01235", 5)) {
+            errorf("%s[%d]: (\"%.5s\"!=\"%s\")!\n", __FILE__, __LINE__, buffer + 10, "01235");
+            ++errors;
+        }
+    }
+
+    printf("%s[%d]: queue\n", __FILE__, __LINE__);
+
+    {
+        char buffer[sizeof(data)] = { 0 };
+        BufferOutput sink(buffer, sizeof(buffer));
+        Throttle octets;
+        Gcra writes(hz, 0);
+        ShapedOutput output(sink, octets, writes, 4, false, 8);
+        ssize_t rc = output(data, 10, 10);
+        if (10 != rc) {
+            errorf("%s[%d]: (%zd!=%d)!\n", __FILE__, __LINE__, rc, 10);
+            ++errors;
+        }
+        if (4 != output.getSent()) {
+            errorf("%s[%d]: (%llu!=%d)!\n", __FILE__, __LINE__, output.getSent(), 4);
+            ++errors;
+        }
+        if (6 != output.getPending()) {
+            errorf("%s[%d]: (%zu!=%d)!\n", __FILE__, __LINE__, output.getPending(), 6);
+            ++errors;
+        }
+        if (1 != output.getDelayed()) {
+            errorf("%s[%d]: (%llu!=%d)!\n", __FILE__, __LINE__, output.getDelayed(), 1);
+            ++errors;
+        }
+        rc = output(data + 10, 5, 5);
+        if (2 != rc) {
+            errorf("%s[%d]: (%zd!=%d)!\n", __FILE__, __LINE__, rc, 2);
+            ++errors;
+        }
+        if (3 != output.getDropped()) {
+            errorf("%s[%d]: (%llu!=%d)!\n", __FILE__, __LINE__, output.getDropped(), 3);
+            ++errors;
+        }
+        if (8 != output.getPending()) {
+            errorf("%s[%d]: (%zu!=%d)!\n", __FILE__, __LINE__, output.getPending(), 8);
+            ++errors;
+        }
+        if (0 > output()) {
+            errorf("%s[%d]: failed!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        if (8 != output.getPending()) {
+            errorf("%s[%d]: (%zu!=%d)!\n", __FILE__, __LINE__, output.getPending(), 8);
+            ++errors;
+        }
+        if (0 != ::strncmp(buffer, data, 4)) {
+            errorf("%s[%d]: (\"%.4s\"!=\"%.4s\")!\n", __FILE__, __LINE__, buffer, data);
+            ++errors;
+        }
+        if (4 != ::strnlen(buffer, sizeof(buffer))) {
+            errorf("%s[%d]: (%zu!=%d)!\n", __FILE__, __LINE__, ::strnlen(buffer, sizeof(buffer)), 4);
+            ++errors;
+        }
+        output.show();
+    }
+
+    printf("%s[%d]: flush\n", __FILE__, __LINE__);
+
+    {
+        char buffer[sizeof(data)] = { 0 };
+        BufferOutput sink(buffer, sizeof(buffer));
+        Throttle octets;
+        Gcra writes(hz / 50, 0);
+        ShapedOutput output(sink, octets, writes, 4, false);
+        ssize_t rc = output(data, 8, 8);
+        if (8 != rc) {
+            errorf("%s[%d]: (%zd!=%d)!\n", __FILE__, __LINE__, rc, 8);
+            ++errors;
+        }
+        if (4 != output.getPending()) {
+            errorf("%s[%d]: (%zu!=%d)!\n", __FILE__, __LINE__, output.getPending(), 4);
+            ++errors;
+        }
+        struct pollfd pfd;
+        pfd.fd = output.getTimer();
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        int ready = ::poll(&pfd, 1, 1000);
+        if (1 != ready) {
+            errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, ready, 1);
+            ++errors;
+        }
+        if (0 > output()) {
+            errorf("%s[%d]: failed!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        if (0 != output.getPending()) {
+            errorf("%s[%d]: (%zu!=%d)!\n", __FILE__, __LINE__, output.getPending(), 0);
+            ++errors;
+        }
+        if (0 != ::strncmp(buffer, data, 8)) {
+            errorf("%s[%d]: (\"%.8s\"!=\"%.8s\")!\n", __FILE__, __LINE__, buffer, data);
+            ++errors;
+        }
+    }
+
+    printf("%s[%d]: short\n", __FILE__, __LINE__);
+
+    {
+        char buffer[sizeof(data)] = { 0 };
+        ShortOutput sink(buffer, sizeof(buffer));
+        Throttle octets;
+        Gcra writes(hz / 50, 0);
+        ShapedOutput output(sink, octets, writes, 4, false);
+        ssize_t rc = output(data, 8, 8);
+        if (8 != rc) {
+            errorf("%s[%d]: (%zd!=%d)!\n", __FILE__, __LINE__, rc, 8);
+            ++errors;
+        }
+        struct pollfd pfd;
+        pfd.fd = output.getTimer();
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        ::poll(&pfd, 1, 1000);
+
+        //  Only half of the queued chunk fits, which is not an error.
+
+        sink.window = 2;
+        rc = output(data + 8, 4, 4);
+        if (4 != rc) {
+            errorf("%s[%d]: (%zd!=%d)!\n", __FILE__, __LINE__, rc, 4);
+            ++errors;
+        }
+        if (6 != output.getPending()) {
+            errorf("%s[%d]: (%zu!=%d)!\n", __FILE__, __LINE__, output.getPending(), 6);
+            ++errors;
+        }
+        if (0 != output.getDropped()) {
+            errorf("%s[%d]: (%llu!=%d)!\n", __FILE__, __LINE__, output.getDropped(), 0);
+            ++errors;
+        }
+        if (0 > output()) {
+            errorf("%s[%d]: failed!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+
+        sink.window = sizeof(buffer);
+        for (int ii = 0; (0 < output.getPending()) && (10 > ii); ++ii) {
+            pfd.revents = 0;
+            ::poll(&pfd, 1, 1000);
+            if (0 > output()) {
+                errorf("%s[%d]: failed!\n", __FILE__, __LINE__);
+                ++errors;
+            }
+        }
+        if (0 != output.getPending()) {
+            errorf("%s[%d]: (%zu!=%d)!\n", __FILE__, __LINE__, output.getPending(), 0);
+            ++errors;
+        }
+        if (12 != output.getSent()) {
+            errorf("%s[%d]: (%llu!=%d)!\n", __FILE__, __LINE__, output.getSent(), 12);
+            ++errors;
+        }
+        if (0 != ::strncmp(buffer, data, 12)) {
+            errorf("%s[%d]: (\"%.12s\"!=\"%.12s\")!\n", __FILE__, __LINE__, buffer, data);
+            ++errors;
+        }
+    }
+
+    printf("%s[%d]: blocking\n", __FILE__, __LINE__);
+
+    {
+        char buffer[sizeof(data)] = { 0 };
+        BufferOutput sink(buffer, sizeof(buffer));
+        Gcra octets(hz / 1000, 0);
+        ShapedOutput output(sink, octets, 10);
+        ticks_t then = pl.time();
+        ssize_t rc = output(data, 30, 30);
+        ticks_t elapsed = pl.time() - then;
+        if (30 != rc) {
+            errorf("%s[%d]: (%zd!=%d)!\n", __FILE__, __LINE__, rc, 30);
+            ++errors;
+        }
+        if (3 != output.getChunks()) {
+            errorf("%s[%d]: (%llu!=%d)!\n", __FILE__, __LINE__, output.getChunks(), 3);
+            ++errors;
+        }
+        if (2 > output.getDelayed()) {
+            errorf("%s[%d]: (%llu<%d)!\n", __FILE__, __LINE__, output.getDelayed(), 2);
+            ++errors;
+        }
+        if (0 != output.getPending()) {
+            errorf("%s[%d]: (%zu!=%d)!\n", __FILE__, __LINE__, output.getPending(), 0);
+            ++errors;
+        }
+        if (elapsed < ((hz / 50) - (hz / 1000))) {
+            errorf("%s[%d]: (%llu<%llu)!\n",
+                __FILE__, __LINE__, elapsed, (hz / 50) - (hz / 1000));
+            ++errors;
+        }
+        if (elapsed >= (hz / 5)) {
+            errorf("%s[%d]: (%llu>=%llu)!\n",
+                __FILE__, __LINE__, elapsed, hz / 5);
+            ++errors;
+        }
+        if (0 != ::strncmp(buffer, data, 30)) {
+            errorf("%s[%d]: (\"%.30s\"!=\"%.30s\")!\n", __FILE__, __LINE__, buffer, data);
+            ++errors;
+        }
+    }
+
+    printf("%s[%d]: errors=%d\n", __FILE__, __LINE__, errors);
+
+    return errors;
+}
@@ -0,0 +1,360 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Implements the Shaper unit test.
+ *
+ *  @see    Shaper
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/UnitTest.h"
+#include "com/diag/grandote/Shaper.h"
+#include "com/diag/grandote/Shaper.h"
+#include "com/diag/grandote/Gcra.h"
+#include "com/diag/grandote/BandwidthThrottle.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/Grandote.h"
+
+static const size_t packets = 64;
+static const size_t bytes = 100;
+
+//
+//  Runs a shaper from the start time to the end time in steps, dequeuing
+//  every packet that is eligible at each step and requeuing it on the
+//  class from which it came, so that every leaf stays backlogged.
+//
+static void UT_Shaper_Run(Shaper& shaper, ShaperClass** leaves, size_t* sent, size_t count, ticks_t start, ticks_t end, ticks_t step) {
+    for (ticks_t now = start; now < end; now += step) {
+        ShaperPacket* packet;
+        while ((packet = shaper.dequeue(now)) != 0) {
+            size_t index = reinterpret_cast<uintptr_t>(packet->getPayload());
+            if (index < count) {
+                ++sent[index];
+                shaper.enqueue(*leaves[index], *packet, now);
+            }
+        }
+    }
+}
+
+CXXCAPI int unittestShaper(void) {
+    Print printf(Platform::instance().output());
+    Print errorf(Platform::instance().error());
+    int errors = 0;
+
+    printf("%s[%d]: begin\n", __FILE__, __LINE__);
+
+    printf("%s[%d]: construction\n", __FILE__, __LINE__);
+
+    Throttle unlimited0;
+    Throttle unlimited1;
+    Throttle unlimited2;
+    ShaperClass root0(0, unlimited0, 1);
+    ShaperClass leafa0(&root0, unlimited1, bytes);
+    ShaperClass leafb0(&root0, unlimited2, bytes * 2);
+    Shaper shaper0;
+    shaper0.show();
+    root0.show();
+    if (root0.isLeaf() || !leafa0.isLeaf() || (&root0 != leafa0.getParent()) || (0 != root0.getParent())) {
+        errorf("%s[%d]: tree!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    if (!shaper0.empty() || (0 != shaper0.size())) {
+        errorf("%s[%d]: (%zu!=%zu)!\n", __FILE__, __LINE__, 0, shaper0.size());
+        ++errors;
+    }
+    if (0 != shaper0.dequeue(0)) {
+        errorf("%s[%d]: dequeued!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    if (intmaxof(ticks_t) != shaper0.delay(0)) {
+        errorf("%s[%d]: (%llu!=%llu)!\n",
+            __FILE__, __LINE__, intmaxof(ticks_t), shaper0.delay(0));
+        ++errors;
+    }
+    ShaperPacket packet0(0, bytes);
+    if (shaper0.enqueue(root0, packet0, 0)) {
+        errorf("%s[%d]: enqueued on interior!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    if (!shaper0.enqueue(leafa0, packet0, 0)) {
+        errorf("%s[%d]: refused!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    if (shaper0.enqueue(leafb0, packet0, 0)) {
+        errorf("%s[%d]: enqueued twice!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    if (!packet0.isQueued() || packet0.setSize(1)) {
+        errorf("%s[%d]: queued!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    if ((1 != shaper0.size()) || (1 != leafa0.getPackets()) || (bytes != leafa0.getBytes())) {
+        errorf("%s[%d]: (%zu,%zu,%zu)!\n", __FILE__, __LINE__,
+            shaper0.size(), leafa0.getPackets(), leafa0.getBytes());
+        ++errors;
+    }
+    packet0.show();
+    if (&packet0 != shaper0.dequeue(0)) {
+        errorf("%s[%d]: not dequeued!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    if (packet0.isQueued() || !shaper0.empty() || (0 != leafa0.getBytes()) || (1 != leafa0.getSent())) {
+        errorf("%s[%d]: still queued!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+
+    printf("%s[%d]: deficit round robin\n", __FILE__, __LINE__);
+
+    ShaperPacket packeta0[packets];
+    ShaperPacket packetb0[packets];
+    for (size_t ii = 0; packets > ii; ++ii) {
+        packeta0[ii].setSize(bytes);
+        packeta0[ii].setPayload(&leafa0);
+        shaper0.enqueue(leafa0, packeta0[ii], 0);
+        packetb0[ii].setSize(bytes);
+        packetb0[ii].setPayload(&leafb0);
+        shaper0.enqueue(leafb0, packetb0[ii], 0);
+    }
+    size_t sent[2] = { 0, 0 };
+    for (size_t ii = 0; (packets * 3 / 2) > ii; ++ii) {
+        ShaperPacket* packet = shaper0.dequeue(0);
+        if (packet == 0) {
+            errorf("%s[%d]: (%zu) null!\n", __FILE__, __LINE__, ii);
+            ++errors;
+            break;
+        }
+        ++sent[(packet->getPayload() == &leafa0) ? 0 : 1];
+    }
+    printf("%s[%d]: a=%zu b=%zu\n", __FILE__, __LINE__, sent[0], sent[1]);
+    if ((packets / 2 != sent[0]) || (packets != sent[1])) {
+        errorf("%s[%d]: (%zu,%zu)!=(%zu,%zu)!\n", __FILE__, __LINE__,
+            packets / 2, packets, sent[0], sent[1]);
+        ++errors;
+    }
+    while (shaper0.dequeue(0) != 0) {
+    }
+    if (!shaper0.empty() || (0 != leafa0.getPackets()) || (0 != leafb0.getPackets()) || (0 != leafa0.getDeficit())) {
+        errorf("%s[%d]: not empty!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+
+    printf("%s[%d]: throttling\n", __FILE__, __LINE__);
+
+    Gcra rate1(10, 0);
+    Gcra ceiling1(10, 0);
+    rate1.reset(0);
+    ceiling1.reset(0);
+    ShaperClass root1(0, unlimited0, bytes);
+    ShaperClass leaf1(&root1, rate1, ceiling1, bytes);
+    Shaper shaper1;
+    ShaperPacket packet1[2];
+    packet1[0].setSize(bytes);
+    packet1[1].setSize(bytes);
+    shaper1.enqueue(leaf1, packet1[0], 0);
+    shaper1.enqueue(leaf1, packet1[1], 0);
+    if (&packet1[0] != shaper1.dequeue(0)) {
+        errorf("%s[%d]: not dequeued!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    if (0 != shaper1.dequeue(0)) {
+        errorf("%s[%d]: dequeued!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    if (1000 != shaper1.delay(0)) {
+        errorf("%s[%d]: (%llu!=%llu)!\n", __FILE__, __LINE__, 1000ULL, shaper1.delay(0));
+        ++errors;
+    }
+    if (0 != shaper1.dequeue(999)) {
+        errorf("%s[%d]: dequeued!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    if (&packet1[1] != shaper1.dequeue(1000)) {
+        errorf("%s[%d]: not dequeued!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    if (!shaper1.empty() || (intmaxof(ticks_t) != shaper1.delay(1000))) {
+        errorf("%s[%d]: not empty!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+
+    printf("%s[%d]: borrowing\n", __FILE__, __LINE__);
+
+    //
+    //  The root allows one packet per thousand ticks, and each leaf is
+    //  assured one packet per four thousand ticks.
+    //
+    static const ticks_t duration = 400000;
+    Gcra rate2(10, 0);
+    Gcra ratea2(40, 0);
+    Gcra rateb2(40, 0);
+    rate2.reset(0);
+    ratea2.reset(0);
+    rateb2.reset(0);
+    ShaperClass root2(0, rate2, bytes);
+    ShaperClass leafa2(&root2, ratea2, bytes);
+    ShaperClass leafb2(&root2, rateb2, bytes);
+    ShaperClass* leaves2[] = { &leafa2, &leafb2 };
+    Shaper shaper2;
+    ShaperPacket packeta2(reinterpret_cast<void*>(0), bytes);
+    ShaperPacket packetb2(reinterpret_cast<void*>(1), bytes);
+    size_t sent2[2] = { 0, 0 };
+    shaper2.enqueue(leafa2, packeta2, 0);
+    UT_Shaper_Run(shaper2, leaves2, sent2, countof(leaves2), 0, duration, 10);
+    printf("%s[%d]: a=%zu borrowed=%llu\n", __FILE__, __LINE__, sent2[0], leafa2.getBorrowed());
+    if ((sent2[0] < 399) || (sent2[0] > 401) || (leafa2.getBorrowed() < 290)) {
+        errorf("%s[%d]: (%zu,%llu)!\n", __FILE__, __LINE__, sent2[0], leafa2.getBorrowed());
+        ++errors;
+    }
+    sent2[0] = 0;
+    shaper2.enqueue(leafb2, packetb2, duration);
+    UT_Shaper_Run(shaper2, leaves2, sent2, countof(leaves2), duration, duration * 2, 10);
+    printf("%s[%d]: a=%zu b=%zu\n", __FILE__, __LINE__, sent2[0], sent2[1]);
+    if (((sent2[0] + sent2[1]) < 399) || ((sent2[0] + sent2[1]) > 401) || (sent2[0] < 195) || (sent2[1] < 195)) {
+        errorf("%s[%d]: (%zu,%zu)!\n", __FILE__, __LINE__, sent2[0], sent2[1]);
+        ++errors;
+    }
+
+    printf("%s[%d]: ceiling\n", __FILE__, __LINE__);
+
+    Gcra rate3(10, 0);
+    Gcra ratea3(40, 0);
+    Gcra ceilinga3(20, 0);
+    rate3.reset(0);
+    ratea3.reset(0);
+    ceilinga3.reset(0);
+    ShaperClass root3(0, rate3, bytes);
+    ShaperClass leafa3(&root3, ratea3, ceilinga3, bytes);
+    ShaperClass* leaves3[] = { &leafa3 };
+    Shaper shaper3;
+    ShaperPacket packeta3(reinterpret_cast<void*>(0), bytes);
+    size_t sent3[1] = { 0 };
+    shaper3.enqueue(leafa3, packeta3, 0);
+    UT_Shaper_Run(shaper3, leaves3, sent3, countof(leaves3), 0, duration, 10);
+    printf("%s[%d]: a=%zu borrowed=%llu\n", __FILE__, __LINE__, sent3[0], leafa3.getBorrowed());
+    if ((sent3[0] < 199) || (sent3[0] > 201)) {
+        errorf("%s[%d]: (%zu)!\n", __FILE__, __LINE__, sent3[0]);
+        ++errors;
+    }
+    shaper3.show(1);
+    leafa3.show(1);
+
+    printf("%s[%d]: hierarchy\n", __FILE__, __LINE__);
+
+    //
+    //  The root allows one packet per thousand ticks, split evenly between
+    //  two groups, the first with two tenants, the second with one, each
+    //  tenant assured one packet per eight thousand ticks.
+    //
+    Gcra rate5(10, 0);
+    Gcra rateg5(20, 0);
+    Gcra rateh5(20, 0);
+    Gcra ratea5(80, 0);
+    Gcra rateb5(80, 0);
+    Gcra ratec5(80, 0);
+    rate5.reset(0);
+    rateg5.reset(0);
+    rateh5.reset(0);
+    ratea5.reset(0);
+    rateb5.reset(0);
+    ratec5.reset(0);
+    ShaperClass root5(0, rate5, bytes);
+    ShaperClass groupg5(&root5, rateg5, bytes);
+    ShaperClass grouph5(&root5, rateh5, bytes);
+    ShaperClass leafa5(&groupg5, ratea5, bytes);
+    ShaperClass leafb5(&groupg5, rateb5, bytes);
+    ShaperClass leafc5(&grouph5, ratec5, bytes);
+    ShaperClass* leaves5[] = { &leafa5, &leafb5, &leafc5 };
+    Shaper shaper5;
+    ShaperPacket packet5[countof(leaves5)];
+    size_t sent5[countof(leaves5)] = { 0, 0, 0 };
+    for (size_t ii = 0; countof(leaves5) > ii; ++ii) {
+        packet5[ii].setPayload(reinterpret_cast<void*>(ii));
+        packet5[ii].setSize(bytes);
+        shaper5.enqueue(*leaves5[ii], packet5[ii], 0);
+    }
+    UT_Shaper_Run(shaper5, leaves5, sent5, countof(leaves5), 0, duration, 10);
+    printf("%s[%d]: a=%zu b=%zu c=%zu\n", __FILE__, __LINE__, sent5[0], sent5[1], sent5[2]);
+    if ((sent5[0] < 95) || (sent5[0] > 105) || (sent5[1] < 95) || (sent5[1] > 105) || (sent5[2] < 195) || (sent5[2] > 205)) {
+        errorf("%s[%d]: (%zu,%zu,%zu)!\n", __FILE__, __LINE__, sent5[0], sent5[1], sent5[2]);
+        ++errors;
+    }
+    if (0 == leafc5.getBorrowed()) {
+        errorf("%s[%d]: (%llu)!\n", __FILE__, __LINE__, leafc5.getBorrowed());
+        ++errors;
+    }
+    while (shaper5.dequeue(duration * 2) != 0) {
+    }
+    if (!shaper5.empty() || root5.isActive() || groupg5.isActive() || leafa5.isActive()) {
+        errorf("%s[%d]: active!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    if (ShaperClass::CAN_SEND != leafa5.getMode()) {
+        errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, ShaperClass::CAN_SEND, leafa5.getMode());
+        ++errors;
+    }
+
+    printf("%s[%d]: bandwidth\n", __FILE__, __LINE__);
+
+    BandwidthThrottle rate4(1000000, 0);
+    BandwidthThrottle ratea4(500000, 0);
+    ShaperClass root4(0, rate4, 1500);
+    ShaperClass leafa4(&root4, ratea4, 1500);
+    Shaper shaper4;
+    ShaperPacket packeta4(0, 1500);
+    shaper4.enqueue(leafa4, packeta4);
+    if (&packeta4 != shaper4.dequeue()) {
+        errorf("%s[%d]: not dequeued!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+
+    printf("%s[%d]: errors=%d\n", __FILE__, __LINE__, errors);
+
+    return errors;
+}
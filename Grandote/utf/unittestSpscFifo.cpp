@@ -0,0 +1,300 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Implements the SpscFifo unit test.
+ *
+ *  @see    SpscFifo
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/UnitTest.h"
+#include "com/diag/grandote/SpscFifo.h"
+#include "com/diag/grandote/SpscFifo.h"
+#include "com/diag/grandote/NewSpscFifo.h"
+#include "com/diag/grandote/NewSpscFifo.h"
+#include "com/diag/grandote/Thread.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/Grandote.h"
+
+template class SpscFifo<char>;
+template class SpscFifo<int>;
+template class SpscFifo<uint32_t>;
+template class SpscFifo<uint64_t>;
+template class NewSpscFifo<int>;
+template class NewSpscFifo<uint32_t>;
+
+static SpscFifo<int> staticSpscFifo;
+static NewSpscFifo<int> staticNewSpscFifo;
+
+//
+//  Inserts a sequence of numbers into the queue as fast as the consumer
+//  makes room for them.
+//
+class SpscFifoProducer : public Thread {
+
+public:
+
+    SpscFifoProducer(SpscFifo<uint32_t>& ff, uint32_t ll) :
+        fifo(ff),
+        limit(ll),
+        full(0)
+    {}
+
+    virtual void * run() {
+        for (uint32_t ii = 0; this->limit > ii; ++ii) {
+            while (!this->fifo.insert(ii)) {
+                ++this->full;
+                Thread::yield();
+            }
+        }
+        return 0;
+    }
+
+    SpscFifo<uint32_t>& fifo;
+
+    uint32_t limit;
+
+    unsigned long full;
+
+};
+
+CXXCAPI int unittestSpscFifo(void) {
+    Print printf(Platform::instance().output());
+    Print errorf(Platform::instance().error());
+    int errors = 0;
+
+    printf("%s[%d]: begin\n", __FILE__, __LINE__);
+
+    ::staticSpscFifo.show();
+    ::staticNewSpscFifo.show();
+
+    printf("%s[%d]: layout\n", __FILE__, __LINE__);
+
+    if (sizeof(SpscFifo<char>) < (3 * SpscFifo<char>::LINESIZE)) {
+        errorf("%s[%d]: (%lu<%lu)!\n", __FILE__, __LINE__,
+            sizeof(SpscFifo<char>), 3 * SpscFifo<char>::LINESIZE);
+        ++errors;
+    }
+
+    printf("%s[%d]: null\n", __FILE__, __LINE__);
+
+    SpscFifo<uint64_t> null1;
+    null1.show();
+    uint64_t longlonginstance = 0;
+    bool success = null1.peek(longlonginstance);
+    if (false != success) {
+        errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, false, success);
+        ++errors;
+    }
+    success = null1.remove(longlonginstance);
+    if (false != success) {
+        errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, false, success);
+        ++errors;
+    }
+    success = null1.insert(longlonginstance);
+    if (false != success) {
+        errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, false, success);
+        ++errors;
+    }
+
+    printf("%s[%d]: construction\n", __FILE__, __LINE__);
+
+    static const unsigned int maximum = 25;
+    static const unsigned int count = 16;
+
+    int ints[maximum] = { 0 };
+    SpscFifo<int> fifo(ints, countof(ints));
+    fifo.show();
+    if (count != fifo.total()) {
+        errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, count, fifo.total());
+        ++errors;
+    }
+    if (count != fifo.free()) {
+        errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, count, fifo.free());
+        ++errors;
+    }
+
+    printf("%s[%d]: fill\n", __FILE__, __LINE__);
+
+    int intinstance;
+    for (unsigned int jj = 0; count > jj; ++jj) {
+        success = fifo.insert(jj + 1);
+        if (true != success) {
+            errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, true, success);
+            ++errors;
+        }
+        if ((jj + 1) != fifo.used()) {
+            errorf("%s[%d]: (%u!=%u)!\n",
+                __FILE__, __LINE__, jj + 1, fifo.used());
+            ++errors;
+        }
+    }
+
+    success = fifo.insert(count + 1);
+    if (false != success) {
+        errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, false, success);
+        ++errors;
+    }
+
+    printf("%s[%d]: show full\n", __FILE__, __LINE__);
+
+    fifo.show(1);
+
+    printf("%s[%d]: empty\n", __FILE__, __LINE__);
+
+    for (unsigned int jj = 0; count > jj; ++jj) {
+        intinstance = 0;
+        success = fifo.peek(intinstance);
+        if (true != success) {
+            errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, true, success);
+            ++errors;
+        }
+        if (static_cast<int>(jj + 1) != intinstance) {
+            errorf("%s[%d]: (%d!=%d)!\n",
+                __FILE__, __LINE__, (jj + 1), intinstance);
+            ++errors;
+        }
+        intinstance = 0;
+        success = fifo.remove(intinstance);
+        if (true != success) {
+            errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, true, success);
+            ++errors;
+        }
+        if (static_cast<int>(jj + 1) != intinstance) {
+            errorf("%s[%d]: (%d!=%d)!\n",
+                __FILE__, __LINE__, (jj + 1), intinstance);
+            ++errors;
+        }
+    }
+
+    success = fifo.remove(intinstance);
+    if (false != success) {
+        errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, false, success);
+        ++errors;
+    }
+    if (0 != fifo.used()) {
+        errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 0, fifo.used());
+        ++errors;
+    }
+
+    printf("%s[%d]: reset\n", __FILE__, __LINE__);
+
+    success = fifo.insert(1);
+    if (true != success) {
+        errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, true, success);
+        ++errors;
+    }
+    fifo.reset();
+    if (0 != fifo.used()) {
+        errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 0, fifo.used());
+        ++errors;
+    }
+    success = fifo.remove(intinstance);
+    if (false != success) {
+        errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, false, success);
+        ++errors;
+    }
+
+    fifo.show(1);
+
+    printf("%s[%d]: threads\n", __FILE__, __LINE__);
+
+    static const uint32_t limit = 1000000;
+
+    NewSpscFifo<uint32_t> shared(6);
+    shared.show();
+    if (8 != shared.total()) {
+        errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 8, shared.total());
+        ++errors;
+    }
+
+    SpscFifoProducer producer(shared, limit);
+    int rc = producer.start();
+    if (0 != rc) {
+        errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, 0, rc);
+        ++errors;
+    } else {
+        uint32_t expected = 0;
+        uint32_t wordinstance;
+        unsigned long empty = 0;
+        while (limit > expected) {
+            if (shared.remove(wordinstance)) {
+                if (expected != wordinstance) {
+                    errorf("%s[%d]: (%u!=%u)!\n",
+                        __FILE__, __LINE__, expected, wordinstance);
+                    ++errors;
+                    break;
+                }
+                ++expected;
+            } else {
+                ++empty;
+                Thread::yield();
+            }
+        }
+        rc = producer.join();
+        if (0 != rc) {
+            errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, 0, rc);
+            ++errors;
+        }
+        printf("%s[%d]: full=%lu empty=%lu\n",
+            __FILE__, __LINE__, producer.full, empty);
+    }
+
+    if (0 != shared.used()) {
+        errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 0, shared.used());
+        ++errors;
+    }
+
+    shared.show(1);
+
+    printf("%s[%d]: errors=%d\n", __FILE__, __LINE__, errors);
+
+    return errors;
+}
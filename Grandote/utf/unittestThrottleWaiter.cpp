@@ -0,0 +1,245 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Implements the ThrottleWaiter unit test.
+ *
+ *  @see    ThrottleWaiter
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include <poll.h>
+#include "com/diag/grandote/UnitTest.h"
+#include "com/diag/grandote/ThrottleWaiter.h"
+#include "com/diag/grandote/ThrottleWaiter.h"
+#include "com/diag/grandote/Throttle.h"
+#include "com/diag/grandote/Gcra.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/Grandote.h"
+
+CXXCAPI int unittestThrottleWaiter(void) {
+    Print printf(Platform::instance().output());
+    Print errorf(Platform::instance().error());
+    int errors = 0;
+    Platform& pl = Platform::instance();
+    ticks_t hz = pl.frequency();
+
+    printf("%s[%d]: begin\n", __FILE__, __LINE__);
+
+    printf("%s[%d]: construction\n", __FILE__, __LINE__);
+
+    ThrottleWaiter waiter;
+    waiter.show();
+    if (0 > waiter.getDescriptor()) {
+        errorf("%s[%d]: (%d<0)!\n",
+            __FILE__, __LINE__, waiter.getDescriptor());
+        ++errors;
+    }
+
+    printf("%s[%d]: empty\n", __FILE__, __LINE__);
+
+    size_t index = 1;
+    if (intmaxof(ticks_t) != waiter.arm(0, 0, index)) {
+        errorf("%s[%d]: armed!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    if (0 != index) {
+        errorf("%s[%d]: (%zu!=%zu)!\n", __FILE__, __LINE__, static_cast<size_t>(0), index);
+        ++errors;
+    }
+    if (0 != waiter.await(0, 0)) {
+        errorf("%s[%d]: admitted!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+
+    printf("%s[%d]: promiscuous\n", __FILE__, __LINE__);
+
+    Throttle throttle;
+    ticks_t then = pl.time();
+    for (int ii = 0; 10 > ii; ++ii) {
+        if (!throttle.await()) {
+            errorf("%s[%d]: alarmed!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+    }
+    ticks_t elapsed = pl.time() - then;
+    if (elapsed >= (hz / 10)) {
+        errorf("%s[%d]: (%llu>=%llu)!\n",
+            __FILE__, __LINE__, elapsed, hz / 10);
+        ++errors;
+    }
+
+    printf("%s[%d]: await\n", __FILE__, __LINE__);
+
+    Gcra gcra(hz / 50, 0);
+    then = pl.time();
+    if (!gcra.await()) {
+        errorf("%s[%d]: alarmed!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    elapsed = pl.time() - then;
+    if (elapsed >= (hz / 100)) {
+        errorf("%s[%d]: (%llu>=%llu)!\n",
+            __FILE__, __LINE__, elapsed, hz / 100);
+        ++errors;
+    }
+    then = pl.time();
+    if (!gcra.await()) {
+        errorf("%s[%d]: alarmed!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    elapsed = pl.time() - then;
+    if (elapsed < (hz / 50) - (hz / 1000)) {
+        errorf("%s[%d]: (%llu<%llu)!\n",
+            __FILE__, __LINE__, elapsed, (hz / 50) - (hz / 1000));
+        ++errors;
+    }
+    if (elapsed >= (hz / 5)) {
+        errorf("%s[%d]: (%llu>=%llu)!\n",
+            __FILE__, __LINE__, elapsed, hz / 5);
+        ++errors;
+    }
+    if (0 == gcra.admissible()) {
+        errorf("%s[%d]: admissible!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    gcra.rollback();
+
+    printf("%s[%d]: caller\n", __FILE__, __LINE__);
+
+    then = pl.time();
+    if (!gcra.await(waiter)) {
+        errorf("%s[%d]: alarmed!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    elapsed = pl.time() - then;
+    if (elapsed < (hz / 50) - (hz / 1000)) {
+        errorf("%s[%d]: (%llu<%llu)!\n",
+            __FILE__, __LINE__, elapsed, (hz / 50) - (hz / 1000));
+        ++errors;
+    }
+    if (elapsed >= (hz / 5)) {
+        errorf("%s[%d]: (%llu>=%llu)!\n",
+            __FILE__, __LINE__, elapsed, hz / 5);
+        ++errors;
+    }
+
+    printf("%s[%d]: earliest\n", __FILE__, __LINE__);
+
+    Gcra slow(hz / 10, 0);
+    Gcra fast(hz / 50, 0);
+    Gcra slower(hz / 5, 0);
+    Throttle* throttles[] = { &slow, &fast, &slower };
+    for (size_t ii = 0; countof(throttles) > ii; ++ii) {
+        throttles[ii]->admissible();
+        throttles[ii]->commit();
+    }
+    ticks_t delay = waiter.arm(throttles, countof(throttles), index);
+    if (1 != index) {
+        errorf("%s[%d]: (%zu!=%zu)!\n", __FILE__, __LINE__, static_cast<size_t>(1), index);
+        ++errors;
+    }
+    if ((0 == delay) || (delay > (hz / 50))) {
+        errorf("%s[%d]: (%llu)!\n", __FILE__, __LINE__, delay);
+        ++errors;
+    }
+    waiter.show();
+
+    printf("%s[%d]: poll\n", __FILE__, __LINE__);
+
+    struct pollfd pfd;
+    pfd.fd = waiter.getDescriptor();
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int rc = ::poll(&pfd, 1, 1000);
+    if (1 != rc) {
+        errorf("%s[%d]: (%d!=%d)!\n", __FILE__, __LINE__, 1, rc);
+        ++errors;
+    }
+    if (0 == (pfd.revents & POLLIN)) {
+        errorf("%s[%d]: (0x%x)!\n", __FILE__, __LINE__, pfd.revents);
+        ++errors;
+    }
+    rc = waiter.wait();
+    if (1 > rc) {
+        errorf("%s[%d]: (%d<%d)!\n", __FILE__, __LINE__, rc, 1);
+        ++errors;
+    }
+    if (0 != fast.admissible()) {
+        errorf("%s[%d]: inadmissible!\n", __FILE__, __LINE__);
+        ++errors;
+    }
+    fast.rollback();
+
+    printf("%s[%d]: multiplex\n", __FILE__, __LINE__);
+
+    index = waiter.await(throttles, countof(throttles));
+    if (1 != index) {
+        errorf("%s[%d]: (%zu!=%zu)!\n", __FILE__, __LINE__, static_cast<size_t>(1), index);
+        ++errors;
+    }
+    throttles[index]->admissible();
+    throttles[index]->commit();
+    then = pl.time();
+    index = waiter.await(throttles, countof(throttles));
+    elapsed = pl.time() - then;
+    if (1 != index) {
+        errorf("%s[%d]: (%zu!=%zu)!\n", __FILE__, __LINE__, static_cast<size_t>(1), index);
+        ++errors;
+    }
+    if (elapsed < (hz / 50) - (hz / 1000)) {
+        errorf("%s[%d]: (%llu<%llu)!\n",
+            __FILE__, __LINE__, elapsed, (hz / 50) - (hz / 1000));
+        ++errors;
+    }
+
+    printf("%s[%d]: errors=%d\n", __FILE__, __LINE__, errors);
+
+    return errors;
+}
@@ -0,0 +1,363 @@
+/* vim: set ts=4 expandtab shiftwidth=4: */
+
+/******************************************************************************
+
+    Copyright 2017 Digital Aggregates Corporation, Colorado, USA.
+    This file is part of the Digital Aggregates Grandote library.
+    
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    As a special exception, if other files instantiate templates or
+    use macros or inline functions from this file, or you compile
+    this file and link it with other works to produce a work based on
+    this file, this file does not by itself cause the resulting work
+    to be covered by the GNU Lesser General Public License. However
+    the source code for this file must still be made available in
+    accordance with the GNU Lesser General Public License.
+
+    This exception does not invalidate any other reasons why a work
+    based on this file might be covered by the GNU Lesser General
+    Public License.
+
+    Alternative commercial licensing terms are available from the copyright
+    holder. Contact Digital Aggregates Corporation for more information.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General
+    Public License along with this library; if not, write to the
+    Free Software Foundation, Inc., 59 Temple Place, Suite 330,
+    Boston, MA 02111-1307 USA, or http://www.gnu.org/copyleft/lesser.txt.
+
+
+
+******************************************************************************/
+
+
+/**
+ *  @file
+ *
+ *  Implements the TimerWheel unit test.
+ *
+ *  @see    TimerWheel
+ *
+ *  @author Chip Overclock (coverclock@diag.com)
+ *
+ *
+ */
+
+
+#include "com/diag/grandote/UnitTest.h"
+#include "com/diag/grandote/TimerWheel.h"
+#include "com/diag/grandote/TimerWheel.h"
+#include "com/diag/grandote/Platform.h"
+#include "com/diag/grandote/generics.h"
+#include "com/diag/grandote/Grandote.h"
+
+//
+//  This is the time passed to the prior advance, or zero if timers may
+//  have been inserted since then with deadlines already past.
+//
+static ticks_t previous = 0;
+
+//
+//  Records when it expired, checking that it was neither early nor later
+//  than the first advance that covered the end of its granule.
+//
+class TimerWheelTimer : public Timer {
+
+public:
+
+    TimerWheelTimer() :
+        expired(0),
+        when(0),
+        period(0),
+        errors(0)
+    {}
+
+    virtual void expire(TimerWheel& wheel, ticks_t now) {
+        ticks_t granularity = wheel.getGranularity();
+        ticks_t granule = (this->getDeadline() + granularity - 1) / granularity;
+        if (now < this->getDeadline()) {
+            ++this->errors;
+        }
+        if ((0 < previous) && (previous >= (granule * granularity))) {
+            ++this->errors;
+        }
+        if (this->isArmed()) {
+            ++this->errors;
+        }
+        ++this->expired;
+        this->when = now;
+        if (0 < this->period) {
+            --this->period;
+            wheel.insert(*this, this->getDeadline() + 1000);
+        }
+    }
+
+    unsigned int expired;
+
+    ticks_t when;
+
+    unsigned int period;
+
+    unsigned int errors;
+
+};
+
+//
+//  Cancels another timer when it expires.
+//
+class TimerWheelCanceller : public Timer {
+
+public:
+
+    TimerWheelCanceller() :
+        victim(0),
+        cancelled(false)
+    {}
+
+    virtual void expire(TimerWheel& /* wheel */, ticks_t /* now */) {
+        this->cancelled = this->victim->cancel();
+    }
+
+    Timer* victim;
+
+    bool cancelled;
+
+};
+
+static uint64_t seed = 1;
+
+static uint64_t random64() {
+    seed = (seed * 6364136223846793005ULL) + 1442695040888963407ULL;
+    return seed >> 16;
+}
+
+CXXCAPI int unittestTimerWheel(void) {
+    Print printf(Platform::instance().output());
+    Print errorf(Platform::instance().error());
+    int errors = 0;
+
+    printf("%s[%d]: begin\n", __FILE__, __LINE__);
+
+    printf("%s[%d]: basic\n", __FILE__, __LINE__);
+
+    {
+        TimerWheel wheel(10, 1000);
+        wheel.show();
+        if ((10 != wheel.getGranularity()) || (1000 != wheel.getTime())) {
+            errorf("%s[%d]: (%llu!=%llu)!\n",
+                __FILE__, __LINE__, 1000ULL, wheel.getTime());
+            ++errors;
+        }
+
+        TimerWheelTimer timer;
+        if (timer.isArmed() || timer.cancel()) {
+            errorf("%s[%d]: armed!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        if (!wheel.insert(timer, 1015) || !timer.isArmed()) {
+            errorf("%s[%d]: not armed!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        if (wheel.insert(timer, 1015)) {
+            errorf("%s[%d]: armed twice!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        wheel.show(1);
+        size_t expired = wheel.advance(1014);
+        if ((0 != expired) || (0 != timer.expired)) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 0, expired);
+            ++errors;
+        }
+        expired = wheel.advance(1019);
+        if ((0 != expired) || (0 != timer.expired)) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 0, expired);
+            ++errors;
+        }
+        expired = wheel.advance(1020);
+        if ((1 != expired) || (1 != timer.expired) || (1020 != timer.when) || timer.isArmed()) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 1, expired);
+            ++errors;
+        }
+
+        //  A deadline in the past expires on the next advance.
+
+        wheel.insert(timer, 0);
+        expired = wheel.advance(1020);
+        if ((1 != expired) || (2 != timer.expired)) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 1, expired);
+            ++errors;
+        }
+
+        //  Cancelling by the wheel, by the timer, and by destruction.
+
+        wheel.insert(timer, 2000);
+        if (!wheel.cancel(timer) || timer.isArmed() || wheel.cancel(timer)) {
+            errorf("%s[%d]: not cancelled!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        wheel.insert(timer, 2000);
+        if (!timer.cancel() || timer.isArmed()) {
+            errorf("%s[%d]: not cancelled!\n", __FILE__, __LINE__);
+            ++errors;
+        }
+        {
+            TimerWheelTimer temporary;
+            wheel.insert(temporary, 2000);
+        }
+        expired = wheel.advance(1000000);
+        if ((0 != expired) || (2 != timer.expired)) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 0, expired);
+            ++errors;
+        }
+        if ((1000010 != wheel.getTime()) || (0 != timer.errors)) {
+            errorf("%s[%d]: (%llu!=%llu)!\n",
+                __FILE__, __LINE__, 1000010ULL, wheel.getTime());
+            ++errors;
+        }
+    }
+
+    printf("%s[%d]: rearm and cancel from expire\n", __FILE__, __LINE__);
+
+    {
+        TimerWheel wheel(1, 0);
+        TimerWheelTimer periodic;
+        periodic.period = 9;
+        wheel.insert(periodic, 1000);
+        TimerWheelTimer victim;
+        wheel.insert(victim, 5000);
+        TimerWheelCanceller canceller;
+        canceller.victim = &victim;
+        wheel.insert(canceller, 5000);
+        size_t expired = 0;
+        for (ticks_t now = 0; 20000 > now; now += 7) {
+            expired += wheel.advance(now);
+        }
+        if ((10 != periodic.expired) || (0 != periodic.errors) || periodic.isArmed()) {
+            errorf("%s[%d]: (%u!=%u)!\n",
+                __FILE__, __LINE__, 10, periodic.expired);
+            ++errors;
+        }
+
+        //  The canceller was inserted after the victim so it expires after
+        //  it on the same slot: the victim must already be gone.
+
+        if (canceller.cancelled || (1 != victim.expired)) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 1, victim.expired);
+            ++errors;
+        }
+        if (12 != expired) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 12, expired);
+            ++errors;
+        }
+
+        wheel.insert(canceller, 30000);
+        wheel.insert(victim, 30000);
+        expired = wheel.advance(30000);
+        if (!canceller.cancelled || (1 != victim.expired) || (1 != expired)) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 1, expired);
+            ++errors;
+        }
+    }
+
+    printf("%s[%d]: many\n", __FILE__, __LINE__);
+
+    {
+        static const size_t count = 20000;
+        static const ticks_t granularity = 3;
+        TimerWheelTimer* timers = new TimerWheelTimer[count];
+        ticks_t start = 123456789;
+        TimerWheel wheel(granularity, start);
+        size_t armed = 0;
+        ticks_t horizon = 0;
+
+        //  Deadlines span every level, including beyond the top one, and
+        //  the past.
+
+        for (size_t ii = 0; count > ii; ++ii) {
+            ticks_t span = static_cast<ticks_t>(1) << (random64() % 40);
+            ticks_t deadline = start + (random64() % span);
+            if (0 == (ii % 100)) {
+                deadline = start - (random64() % 1000);
+            }
+            wheel.insert(timers[ii], deadline);
+            if (deadline > horizon) {
+                horizon = deadline;
+            }
+            ++armed;
+        }
+
+        //  Cancel every third one.
+
+        size_t cancelled = 0;
+        for (size_t ii = 0; count > ii; ii += 3) {
+            if (timers[ii].cancel()) {
+                ++cancelled;
+            }
+        }
+
+        size_t expired = 0;
+        ticks_t now = start;
+        unsigned long advances = 0;
+        while (now <= horizon) {
+            expired += wheel.advance(now);
+            previous = now;
+            now += random64() % ((horizon - start) / 1000);
+            ++advances;
+        }
+        expired += wheel.advance(now);
+        previous = 0;
+
+        if ((armed - cancelled) != expired) {
+            errorf("%s[%d]: (%u!=%u)!\n",
+                __FILE__, __LINE__, armed - cancelled, expired);
+            ++errors;
+        }
+        for (size_t ii = 0; count > ii; ++ii) {
+            unsigned int want = ((ii % 3) == 0) ? 0 : 1;
+            if ((want != timers[ii].expired) || (0 != timers[ii].errors) || timers[ii].isArmed()) {
+                errorf("%s[%d]: [%u] (%u!=%u) deadline=%llu when=%llu errors=%u!\n",
+                    __FILE__, __LINE__, ii, want, timers[ii].expired,
+                    timers[ii].getDeadline(), timers[ii].when,
+                    timers[ii].errors);
+                ++errors;
+                break;
+            }
+        }
+        printf("%s[%d]: armed=%u cancelled=%u expired=%u advances=%lu\n",
+            __FILE__, __LINE__, armed, cancelled, expired, advances);
+
+        delete [] timers;
+    }
+
+    printf("%s[%d]: platform\n", __FILE__, __LINE__);
+
+    {
+        Platform& pl = Platform::instance();
+        ticks_t hz = pl.frequency();
+        TimerWheel wheel(hz / 1000, pl.time());
+        TimerWheelTimer timer;
+        wheel.insert(timer, pl.time() + (hz / 100));
+        size_t expired = 0;
+        while (0 == expired) {
+            pl.yield(hz / 1000);
+            expired = wheel.advance();
+        }
+        if ((1 != timer.expired) || (0 != timer.errors)) {
+            errorf("%s[%d]: (%u!=%u)!\n", __FILE__, __LINE__, 1, timer.expired);
+            ++errors;
+        }
+    }
+
+    printf("%s[%d]: errors=%d\n", __FILE__, __LINE__, errors);
+
+    return errors;
+}